@@ -0,0 +1,26 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (set = 0, binding = 0) uniform uniform_buffer_object
+{
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+} ubo;
+
+// Vertex shader inputs: only the position stream is bound during the depth prepass
+layout (location = 0) in vec3 position;
+
+// Vertex shader outputs
+out gl_PerVertex
+{
+	vec4 gl_Position;
+};
+
+void main()
+{
+	// Note: this must match the transform used by the shading pass, so that the depth values it produces 
+	// pass the depth test against the prepass exactly.
+	//gl_Position = ubo.projection * ubo.view * ubo.model * vec4(position, 1.0);
+	gl_Position = vec4(position, 1.0);
+}
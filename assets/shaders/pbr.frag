@@ -88,7 +88,7 @@ layout (location = 0) out vec4 o_color;
 layout (location = 0) in vec3 vs_world_position;
 layout (location = 1) in vec3 vs_color;
 layout (location = 2) in vec3 vs_normal;
-layout (location = 3) flat in uint vs_instance_id;
+layout (location = 3) flat in uint vs_material_id;
 
 layout (std430, push_constant) uniform push_constants
 {
@@ -192,10 +192,10 @@ void main()
 {
 	float t = constants.time;
 	float r = constants.metallic;
-	float pct = float(vs_instance_id) / 225.0;
+	float pct = float(vs_material_id) / 225.0;
 
 	// For now, use a push constant to vary the roughness between 0..1
-	float a = float(vs_instance_id + 1.0) / 225.0;
+	float a = float(vs_material_id + 1.0) / 225.0;
 
 	// Note that 0: dielectric, 1: metal
 	// Theoretically this should be a binary toggle, but most workflows allow the 'metallic' parameter
@@ -8,11 +8,23 @@ layout (set = 0, binding = 0) uniform UniformBufferObject
 	mat4 projection;
 } ubo;
 
+// Per-instance data, filled in bulk on the CPU (see `InstanceData` in Instancing.h)
+struct instance_data
+{
+	mat4 model;
+	mat3 normal_matrix;
+	uint material_id;
+};
+
+layout (std430, set = 0, binding = 2) readonly buffer instance_buffer
+{
+	instance_data instances[];
+};
+
 // Vertex shader inputs
 layout (location = 0) in vec3 in_position;
 layout (location = 1) in vec3 in_color;
 layout (location = 2) in vec3 in_normal;
-layout (location = 3) in vec3 in_instance_position;
 
 // Vertex shader outputs
 out gl_PerVertex
@@ -23,17 +35,21 @@ out gl_PerVertex
 layout (location = 0) out vec3 vs_world_position;
 layout (location = 1) out vec3 vs_color;
 layout (location = 2) out vec3 vs_normal;
-layout (location = 3) flat out uint vs_instance_id;
+layout (location = 3) flat out uint vs_material_id;
 
 void main()
 {
-	mat4 normal_matrix = transpose(inverse(ubo.view * ubo.model));
+	instance_data instance = instances[gl_InstanceIndex];
+
+	// The normal matrix is precomputed per-instance, so there is no need to invert a matrix per-vertex. Normals are
+	// output in world space (to match `vs_world_position`), assuming that the global model matrix is a rigid transform.
+	mat4 model = ubo.model * instance.model;
+	vec4 world_position = model * vec4(in_position, 1.0);
 
-	vec3 offset_position = in_position + in_instance_position;
-	vs_world_position = (ubo.model * vec4(offset_position, 1.0)).xyz;
+	vs_world_position = world_position.xyz;
 	vs_color = in_color;
-	vs_normal = mat3(normal_matrix) * in_normal;
-	vs_instance_id = gl_InstanceIndex;
+	vs_normal = mat3(ubo.model) * (instance.normal_matrix * in_normal);
+	vs_material_id = instance.material_id;
 
-  gl_Position = ubo.projection * ubo.view * ubo.model * vec4(offset_position, 1.0);
+	gl_Position = ubo.projection * ubo.view * world_position;
 }
@@ -0,0 +1,221 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// A variant of `pbr.frag` that shades with an arbitrary number of point lights. The lights are binned into a 3D grid
+// of view space clusters by `cluster_lights.comp`, and each fragment only loops over the lights of the cluster that
+// contains it. See `pbr.frag` for an overview of the shading model.
+
+layout (location = 0) out vec4 o_color;
+
+layout (location = 0) in vec3 vs_world_position;
+layout (location = 1) in vec3 vs_color;
+layout (location = 2) in vec3 vs_normal;
+layout (location = 3) flat in uint vs_material_id;
+
+layout (std430, push_constant) uniform push_constants
+{
+	float time;
+	float metallic;
+} constants;
+
+layout (set = 0, binding = 1) uniform sampler2D irradiance_map;
+
+// Matches `plume::geom::PointLight`
+struct PointLight
+{
+	vec3 position;
+	float radius;
+	vec3 color;
+	float intensity;
+};
+
+// The bindings below match the ones in `cluster_lights.comp` (binding 3, the light index count, is only needed there)
+layout (std430, set = 1, binding = 0) readonly buffer LightBuffer
+{
+	PointLight lights[];
+};
+
+layout (std430, set = 1, binding = 1) readonly buffer LightGridBuffer
+{
+	uvec2 light_grid[];
+};
+
+layout (std430, set = 1, binding = 2) readonly buffer LightIndexBuffer
+{
+	uint light_indices[];
+};
+
+// Matches `plume::geom::ClusteredLightingParameters`
+layout (set = 1, binding = 4) uniform ClusteredLightingParameters
+{
+	mat4 view;
+	mat4 inverse_projection;
+	vec4 grid_size;
+	vec4 screen_size;
+	vec4 depth_slicing;
+} parameters;
+
+const float pi = 3.1415926535897932384626433832795;
+
+// Cosine-based color palette generator from IQ: https://www.shadertoy.com/view/ll2GD3
+vec3 palette(in float t,
+			 in vec3 a,
+			 in vec3 b,
+			 in vec3 c,
+			 in vec3 d)
+{
+	return a + b * cos(2.0 * pi * (c * t + d));
+}
+
+vec4 sample_equirectangular_map(in vec3 direction,
+								sampler2D equirectangular)
+{
+	// From the OpenGL SuperBible, 6th Ed.
+	vec2 uv;
+	uv.y = direction.y;
+	direction.x = normalize( direction.xz ).x * 0.5;
+	float s = sign( direction.z ) * 0.5;
+	uv.x = 0.75 - s * (0.5 - uv.x);
+	uv.y = 0.5 + 0.5 * uv.y;
+
+	return texture(equirectangular, uv);
+}
+
+// Trowbridge-Reitz GGX normal distribution function
+float normal_distribution(float n_dot_h,
+						  float a)
+{
+	float a_squared = a * a;
+	float denonimator = n_dot_h * n_dot_h * (a_squared - 1.0) + 1.0;
+	denonimator = pi * denonimator * denonimator;
+
+	return a_squared / denonimator;
+}
+
+// Smith's Schlick-GGX geometric shadowing function
+float ggx(float n_dot_v,
+		  float k)
+{
+	float denonimator = n_dot_v * (1.0 - k) + k;
+
+	return n_dot_v / denonimator;
+}
+
+float geometric_shadowing(float n_dot_v,
+						  float n_dot_l,
+						  float a)
+{
+	float k = ((a + 1.0) * (a + 1.0)) / 8.0; // Remapping of roughness parameter for direct lighting
+
+	float ggx_0 = ggx(n_dot_v, k); // Geometric obstruction
+	float ggx_1 = ggx(n_dot_l, k); // Geometric shadowing
+
+	return ggx_0 * ggx_1;
+}
+
+// Fresnel-Schlick approximation
+vec3 fresnel(in vec3 r0,
+			 float n_dot_v)
+{
+	return r0 + (1.0 - r0) * pow(1.0 - n_dot_v, 5.0);
+}
+
+// Inverse square falloff, windowed so that it reaches zero at the light's radius: without the window, lights would
+// visibly cut off at the boundaries of the clusters that they were binned into
+float distance_attenuation(float distance_to_light,
+						   float radius)
+{
+	float ratio = distance_to_light / radius;
+	float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+
+	return (window * window) / (distance_to_light * distance_to_light + 1.0);
+}
+
+// Returns the index of the cluster that contains the current fragment
+uint get_cluster_index(float view_depth)
+{
+	uvec2 tile = uvec2(gl_FragCoord.xy / parameters.screen_size.z);
+	int slice = int(floor(log(view_depth) * parameters.depth_slicing.z + parameters.depth_slicing.w));
+	slice = clamp(slice, 0, int(parameters.grid_size.z) - 1);
+
+	uvec3 grid_size = uvec3(parameters.grid_size.xyz);
+	tile = min(tile, grid_size.xy - 1u);
+
+	return tile.x + grid_size.x * (tile.y + grid_size.y * uint(slice));
+}
+
+void main()
+{
+	float pct = float(vs_material_id) / 225.0;
+
+	// For now, use the material ID to vary the roughness between 0..1
+	float a = float(vs_material_id + 1.0) / 225.0;
+
+	// Note that 0: dielectric, 1: metal
+	float metallic = constants.metallic;
+	float ambient_occlusion = 1.0;
+	vec3 albedo = palette(pct * 0.3, vec3(0.5,0.5,0.5), vec3(0.5,0.5,0.5), vec3(1.0,1.0,1.0), vec3(0.0,0.10,0.20));
+
+	// Determine the base reflectivity of our material based on the 'metallic' parameter the Fresenel term
+	vec3 r0 = vec3(0.04);
+	r0 = mix(r0, albedo, metallic);
+
+	// The view matrix is a rigid transform, so the camera's world-space position is -R^T * t
+	vec3 camera_position = -transpose(mat3(parameters.view)) * parameters.view[3].xyz;
+	float view_depth = -(parameters.view * vec4(vs_world_position, 1.0)).z;
+
+	vec3 n = normalize(vs_normal);
+	vec3 v = normalize(camera_position - vs_world_position);
+	float n_dot_v = max(dot(n, v), 0.0);
+
+	// Calculate direct lighting from the lights that overlap this fragment's cluster
+	vec3 outgoing_radiance = vec3(0.0);
+
+	uvec2 cluster = light_grid[get_cluster_index(view_depth)];
+	for (uint i = 0; i < cluster.y; ++i)
+	{
+		PointLight scene_light = lights[light_indices[cluster.x + i]];
+
+		// Calculate the observed radiance coming from the current light source at the fragment's position
+		vec3 to_light = scene_light.position - vs_world_position;
+		float distance_to_light = length(to_light);
+		vec3 radiance = scene_light.color * scene_light.intensity * distance_attenuation(distance_to_light, scene_light.radius);
+
+		vec3 l = to_light / distance_to_light;
+		vec3 h = normalize(l + v);
+
+		float n_dot_h = max(dot(n, h), 0.0);
+		float n_dot_l = max(dot(n, l), 0.0);
+
+		// Calculate the terms for the Cook-Torrance BRDF
+		float D = normal_distribution(n_dot_h, a);
+		float G = geometric_shadowing(n_dot_v, n_dot_l, a);
+		vec3 F = fresnel(r0, n_dot_v);
+
+		vec3 cook_torrance = (D * G * F) / (4.0 * n_dot_v * n_dot_l + 0.001);
+
+		// The diffuse contribution is whatever isn't reflected, and metals have no diffuse component
+		vec3 ks = F;
+		vec3 kd = vec3(1.0) - ks;
+		kd *= 1.0 - metallic;
+
+		outgoing_radiance += (kd * (albedo / pi) + cook_torrance) * radiance * n_dot_l;
+	}
+
+	// Calculate the indirect lighting term from the irradiance map
+	vec3 ks = fresnel(r0, n_dot_v);
+	vec3 kd = 1.0 - ks;
+	kd *= 1.0 - metallic;
+	vec3 irradiance = sample_equirectangular_map(n, irradiance_map).rgb;
+	vec3 ambient = irradiance * albedo * kd * ambient_occlusion;
+
+	// Add the ambient term
+	outgoing_radiance += ambient;
+
+	// Apply tone mapping then gamma correction
+	outgoing_radiance /= outgoing_radiance + vec3(1.0);
+	outgoing_radiance = vec3(1.0) - exp(-outgoing_radiance * 2.0);
+	outgoing_radiance = pow(outgoing_radiance, vec3(1.0 / 2.2));
+
+	o_color = vec4(outgoing_radiance, 1.0);
+}
@@ -0,0 +1,51 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_conservative_depth : enable
+
+layout (set = 0, binding = 0) uniform uniform_buffer_object
+{
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+} ubo;
+
+layout (location = 0) in vec3 vs_view_position;
+layout (location = 1) flat in vec3 vs_view_center;
+layout (location = 2) flat in float vs_radius;
+layout (location = 3) flat in vec3 vs_color;
+
+layout (location = 0) out vec4 o_color;
+
+// The ray-traced surface always lies behind the quad (see `sphere_impostor.vert`), so the depth written below never 
+// decreases: this lets the device reject occluded fragments before the shader runs
+layout (depth_greater) out float gl_FragDepth;
+
+void main()
+{
+	// Intersect the ray from the eye (the origin of view space) through this fragment with the sphere: solve
+	// |t * ray - center|^2 = r^2 for the nearest t
+	vec3 ray = normalize(vs_view_position);
+	float b = dot(ray, vs_view_center);
+	float c = dot(vs_view_center, vs_view_center) - vs_radius * vs_radius;
+	float discriminant = b * b - c;
+
+	if (discriminant < 0.0)
+	{
+		discard;
+	}
+
+	float t = b - sqrt(discriminant);
+	vec3 hit = ray * t;
+	vec3 normal = (hit - vs_view_center) / vs_radius;
+
+	// Write the depth of the actual surface, so that impostors intersect each other (and regular geometry) correctly
+	vec4 clip_position = ubo.projection * vec4(hit, 1.0);
+	gl_FragDepth = clip_position.z / clip_position.w;
+
+	// Simple Blinn-Phong shading with a light at the eye, in view space
+	vec3 to_eye = -ray;
+	float diffuse = max(dot(normal, to_eye), 0.0);
+	float specular = pow(diffuse, 64.0);
+
+	o_color = vec4(vs_color * (0.1 + 0.9 * diffuse) + vec3(0.25 * specular), 1.0);
+}
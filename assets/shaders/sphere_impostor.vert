@@ -0,0 +1,65 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (set = 0, binding = 0) uniform uniform_buffer_object
+{
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+} ubo;
+
+// Vertex shader inputs: the corners of a unit `Rect` (in the range [-1..1]) followed by per-instance data 
+// (see `SphereInstance` in Instancing.h)
+layout (location = 0) in vec3 in_position;
+layout (location = 1) in vec4 in_center_radius;
+layout (location = 2) in vec4 in_color;
+
+// Vertex shader outputs
+out gl_PerVertex
+{
+	vec4 gl_Position;
+};
+
+layout (location = 0) out vec3 vs_view_position;
+layout (location = 1) flat out vec3 vs_view_center;
+layout (location = 2) flat out float vs_radius;
+layout (location = 3) flat out vec3 vs_color;
+
+void main()
+{
+	vec3 center = (ubo.view * ubo.model * vec4(in_center_radius.xyz, 1.0)).xyz;
+	float radius = in_center_radius.w;
+	float distance_squared = dot(center, center);
+
+	vs_view_center = center;
+	vs_radius = radius;
+	vs_color = in_color.rgb;
+
+	// The camera is inside of the sphere: there is no silhouette to cover, so collapse the quad outside of the clip volume
+	if (distance_squared <= radius * radius)
+	{
+		vs_view_position = vec3(0.0);
+		gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+		return;
+	}
+
+	// The quad faces the eye (rather than lying parallel to the image plane) so that it is perpendicular to the axis of
+	// the sphere's tangent cone. It is placed at the front of the sphere, where the cone's cross-section is a circle 
+	// whose radius is `(d - r) * r / sqrt(d^2 - r^2)`: the quad covers the sphere's silhouette exactly, without 
+	// wasting fragments around the edges. 
+	//
+	// Note: because the quad is in front of the sphere, every ray-traced depth is greater than or equal to the depth of
+	// the quad itself, which is what allows the fragment shader to declare `depth_greater` and keep early depth 
+	// testing. The flip side is that spheres which intersect the near plane are clipped slightly too early.
+	float distance = sqrt(distance_squared);
+	vec3 axis = -center / distance;
+	vec3 up = abs(axis.y) > 0.999 ? vec3(1.0, 0.0, 0.0) : vec3(0.0, 1.0, 0.0);
+	vec3 right = normalize(cross(up, axis));
+	up = cross(axis, right);
+
+	float half_size = (distance - radius) * radius / sqrt(distance_squared - radius * radius);
+	vec3 quad_center = center + axis * radius;
+
+	vs_view_position = quad_center + (right * in_position.x + up * in_position.y) * half_size;
+	gl_Position = ubo.projection * vec4(vs_view_position, 1.0);
+}
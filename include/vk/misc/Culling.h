@@ -0,0 +1,218 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "Geometry.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		//! The six planes of a view frustum, each stored as `(normal, distance)` such that points inside the frustum 
+		//! satisfy `dot(normal, point) + distance >= 0`. The normals point into the frustum.
+		struct Frustum
+		{
+			enum Plane
+			{
+				PLANE_LEFT,
+				PLANE_RIGHT,
+				PLANE_BOTTOM,
+				PLANE_TOP,
+				PLANE_NEAR,
+				PLANE_FAR
+			};
+
+			//! Extracts the world space frustum planes from a combined `projection * view` matrix (Gribb and Hartmann, 
+			//! "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix"). The near plane assumes
+			//! an OpenGL-style [-1..1] depth range (glm's default): for a [0..1] projection, this places the near plane 
+			//! slightly behind the true one, which is conservative.
+			static Frustum from_view_projection(const glm::mat4& view_projection);
+
+			//! Returns `false` if the sphere lies entirely outside of at least one plane.
+			bool intersects(const BoundingSphere& sphere) const;
+
+			//! Returns `false` if the box lies entirely outside of at least one plane.
+			bool intersects(const BoundingBox& box) const;
+
+			glm::vec4 planes[6];
+		};
+
+		//! A single object that is tested by `occlusion_cull.comp`: its world space bounding sphere and the indexed draw 
+		//! that renders it (for example, a range of a GeometryPool). The layout matches the std430 `CullingObject` struct 
+		//! in the shader.
+		struct CullingObject
+		{
+			//! xyz: the world space center, w: the radius.
+			glm::vec4 bounding_sphere;
+
+			uint32_t first_index;
+			uint32_t index_count;
+			int32_t vertex_offset;
+
+			//! Passed through to the draw, so that the vertex shader can find the object's instance data via `gl_InstanceIndex`.
+			uint32_t first_instance;
+		};
+
+		static_assert(sizeof(CullingObject) == 32, "The size of `CullingObject` must match its std430 layout in GLSL");
+
+		//! The std140 uniform block that `occlusion_cull.comp` reads its per-frame culling parameters from.
+		struct OcclusionCullingParameters
+		{
+			//! Builds the culling parameters for a camera with the combined view-projection matrix `view_projection`. 
+			//! Occlusion is tested against a hierarchical depth pyramid that was built from the previous frame's depth buffer,
+			//! so bounds are projected with the previous frame's matrix, `previous_view_projection`. The pyramid's base 
+			//! level is `pyramid_width` x `pyramid_height` texels and it has `pyramid_mip_levels` levels. Passing zero 
+			//! levels disables the occlusion test (i.e. on the first frame, or after a camera cut).
+			static OcclusionCullingParameters create(const glm::mat4& view_projection, 
+													 const glm::mat4& previous_view_projection, 
+													 uint32_t pyramid_width, 
+													 uint32_t pyramid_height, 
+													 uint32_t pyramid_mip_levels);
+
+			glm::mat4 previous_view_projection;
+
+			//! The world space frustum planes (see `Frustum`).
+			glm::vec4 frustum_planes[6];
+
+			//! xy: the size of the pyramid's base level, z: the number of levels, w: 1 if the occlusion test is enabled.
+			glm::vec4 pyramid_size;
+		};
+
+		//! A point light that is binned by `cluster_lights.comp` and shaded by `pbr_clustered.frag`. The layout matches the
+		//! std430 `PointLight` struct in the shaders. The light's contribution is windowed so that it falls to zero at 
+		//! `radius`, which is what allows it to be skipped by every cluster that its sphere of influence doesn't touch.
+		struct PointLight
+		{
+			glm::vec3 position;
+			float radius;
+			glm::vec3 color;
+			float intensity;
+		};
+
+		static_assert(sizeof(PointLight) == 32, "The size of `PointLight` must match its std430 layout in GLSL");
+
+		//! The std140 uniform block that `cluster_lights.comp` and `pbr_clustered.frag` read the layout of the cluster 
+		//! grid from. The view frustum is split into `tile_size` x `tile_size` pixel tiles on screen and into `slice_count`
+		//! slices along the view axis. Slices are distributed exponentially between `z_near` and `z_far`, so that clusters
+		//! stay roughly cubical as they get further from the camera.
+		struct ClusteredLightingParameters
+		{
+			//! Builds the grid parameters for a camera with the matrices `view` and `projection`, rendering into a 
+			//! `width` x `height` framebuffer. `z_near` and `z_far` should match the distances that `projection` was built 
+			//! with: fragments beyond `z_far` are shaded with the lights of the last slice.
+			static ClusteredLightingParameters create(const glm::mat4& view, 
+													  const glm::mat4& projection, 
+													  uint32_t width, 
+													  uint32_t height, 
+													  float z_near, 
+													  float z_far, 
+													  uint32_t tile_size, 
+													  uint32_t slice_count);
+
+			glm::mat4 view;
+			glm::mat4 inverse_projection;
+
+			//! xyz: the number of clusters along each axis, w: the total number of clusters.
+			glm::vec4 grid_size;
+
+			//! xy: the size of the framebuffer, z: the size of a tile in pixels, w: unused.
+			glm::vec4 screen_size;
+
+			//! x: z_near, y: z_far, z and w: the scale and bias that map the log of a view space depth to a slice.
+			glm::vec4 depth_slicing;
+		};
+
+		//! Culls large numbers of objects against a view frustum. World space bounds are stored as a structure-of-arrays 
+		//! (one array per component), so that the plane tests can run on 4 (SSE) or 8 (AVX, if the compiler targets it) 
+		//! objects at once without any shuffling, and the arrays are split into chunks that are tested in parallel on 
+		//! `utils::ThreadPool::global()`.
+		//!
+		//! Every object is stored with both a box (center and extents) and a radius. Against each plane, an object is 
+		//! only rejected if it lies further outside than the smaller of its two projected radii. For objects added as
+		//! boxes the radius never wins and the test is an exact box test, and vice versa for spheres.
+		//!
+		//! A typical frame looks like:
+		//!
+		//!		culler.set_bounds(object_id, mesh_bounds.transformed(model));	// for each object that moved
+		//!		culler.cull(Frustum::from_view_projection(projection * view), visible);
+		//!		for (uint32_t object_id : visible) { ... }
+		class FrustumCuller
+		{
+		public:
+
+			//! Adds an object and returns its index, which is also the value that `cull()` writes for it. Objects with empty
+			//! bounds are never visible.
+			uint32_t add(const BoundingBox& world_bounds);
+
+			//! Adds an object and returns its index, which is also the value that `cull()` writes for it.
+			uint32_t add(const BoundingSphere& world_bounds);
+
+			//! Replaces the bounds of the object at `index` (i.e. after it has moved).
+			void set_bounds(uint32_t index, const BoundingBox& world_bounds);
+
+			//! Replaces the bounds of the object at `index` (i.e. after it has moved).
+			void set_bounds(uint32_t index, const BoundingSphere& world_bounds);
+
+			void reserve(size_t count);
+
+			void clear();
+
+			size_t size() const { return m_count; }
+
+			//! Tests every object against `frustum` and replaces the contents of `visible` with the indices of the objects 
+			//! that (may) intersect it, in increasing order. `visible` is only reallocated if it is too small to hold every
+			//! object, so reusing the same vector every frame avoids allocations.
+			void cull(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+
+		private:
+
+			void set(uint32_t index, const glm::vec3& center, const glm::vec3& extents, float radius);
+
+			//! Tests the objects in [`begin`, `end`) and writes the indices of the visible ones to `destination`. Returns 
+			//! the number of indices written.
+			size_t cull_range(const Frustum& frustum, size_t begin, size_t end, uint32_t* destination) const;
+
+			size_t m_count = 0;
+
+			// Each array is padded to a multiple of the SIMD width, so that the last group of objects can be loaded 
+			// without a separate remainder loop. Padding objects are never written to the output.
+			std::vector<float> m_center_x;
+			std::vector<float> m_center_y;
+			std::vector<float> m_center_z;
+			std::vector<float> m_extent_x;
+			std::vector<float> m_extent_y;
+			std::vector<float> m_extent_z;
+			std::vector<float> m_radius;
+		};
+
+	} // namespace geom
+
+} // namespace plume
@@ -31,6 +31,7 @@
 #include <iostream>
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <random>
 #include <math.h>
 
@@ -60,7 +61,167 @@ namespace plume
 		enum class AttributeMode
 		{
 			MODE_INTERLEAVED,
-			MODE_SEPARATE
+			MODE_SEPARATE,
+			MODE_SPLIT_POSITIONS	// Positions in one tightly packed stream, all other attributes interleaved in a second stream
+		};
+
+		//! Selects which vertex attributes a graphics pipeline consumes (see `Geometry::get_vertex_input_state()`).
+		enum class VertexInputPreset
+		{
+			PRESET_ALL_ATTRIBUTES,	// Every active attribute, for shading passes
+			PRESET_POSITION_ONLY	// Only the position stream, for depth prepasses and shadow passes
+		};
+
+		enum class PositionEncoding
+		{
+			POSITION_FLOAT32,	// 3 x 32-bit floats (12 bytes)
+			POSITION_FLOAT16,	// 4 x 16-bit floats, relative to the center of the mesh bounds (8 bytes)
+			POSITION_UNORM16	// 4 x 16-bit normalized integers, relative to the mesh bounds (8 bytes)
+		};
+
+		enum class NormalEncoding
+		{
+			NORMAL_FLOAT32,				// 3 x 32-bit floats (12 bytes)
+			NORMAL_OCTAHEDRAL_SNORM16	// 2 x 16-bit normalized integers, octahedral-encoded (4 bytes)
+		};
+
+		enum class ColorEncoding
+		{
+			COLOR_FLOAT32,	// 3 x 32-bit floats (12 bytes)
+			COLOR_UNORM8	// 4 x 8-bit normalized integers (4 bytes)
+		};
+
+		enum class TextureCoordinateEncoding
+		{
+			TEXTURE_COORDINATES_FLOAT32,	// 2 x 32-bit floats (8 bytes)
+			TEXTURE_COORDINATES_FLOAT16		// 2 x 16-bit floats (4 bytes)
+		};
+
+		//! Describes how each vertex attribute is stored in packed vertex data. The default encoding stores every 
+		//! attribute as 32-bit floats (44 bytes per vertex), while `compact()` uses 20 bytes per vertex. Note that 
+		//! 3-component 16-bit formats are rarely supported for vertex input, so 16-bit positions are padded to 4 components.
+		//!
+		//! Shaders must decode compact attributes:
+		//!
+		//!		position = dequantization.offset + dequantization.scale * in_position.xyz;	// See `get_position_dequantization()`
+		//!
+		//!		vec3 normal = vec3(in_normal.xy, 1.0 - abs(in_normal.x) - abs(in_normal.y));
+		//!		if (normal.z < 0.0) normal.xy = (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+		//!		normal = normalize(normal);
+		//!
+		//! Colors and texture coordinates are expanded to floats by the vertex input stage and need no decoding.
+		struct VertexEncoding
+		{
+			PositionEncoding positions = PositionEncoding::POSITION_FLOAT32;
+			NormalEncoding normals = NormalEncoding::NORMAL_FLOAT32;
+			ColorEncoding colors = ColorEncoding::COLOR_FLOAT32;
+			TextureCoordinateEncoding texture_coordinates = TextureCoordinateEncoding::TEXTURE_COORDINATES_FLOAT32;
+
+			//! Returns the most compact encoding available: 16-bit normalized positions, octahedral normals, 8-bit 
+			//! colors, and half-float texture coordinates.
+			static VertexEncoding compact()
+			{
+				VertexEncoding encoding;
+				encoding.positions = PositionEncoding::POSITION_UNORM16;
+				encoding.normals = NormalEncoding::NORMAL_OCTAHEDRAL_SNORM16;
+				encoding.colors = ColorEncoding::COLOR_UNORM8;
+				encoding.texture_coordinates = TextureCoordinateEncoding::TEXTURE_COORDINATES_FLOAT16;
+				return encoding;
+			}
+		};
+
+		//! The tolerances used when welding vertices (see `Geometry::weld_vertices()`). Each attribute is quantized to a grid
+		//! with the given spacing before it is compared, so a tolerance of zero requires an exact match, while an infinite 
+		//! tolerance ignores the attribute entirely (i.e. welded vertices keep the attribute of the first vertex). 
+		struct WeldOptions
+		{
+			float position_epsilon = 1e-6f;
+			float color_epsilon = 1.0f / 255.0f;
+			float normal_epsilon = 1e-3f;
+			float texture_coordinate_epsilon = 1e-5f;
+		};
+
+		//! The transform that maps encoded positions back into object space: `position = offset + scale * encoded`.
+		struct PositionDequantization
+		{
+			glm::vec3 offset;
+			glm::vec3 scale;
+		};
+
+		//! An axis-aligned bounding box. A box that contains no points has `min` greater than `max` on every axis.
+		struct BoundingBox
+		{
+			glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+			glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+			bool is_empty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+			glm::vec3 get_center() const { return (min + max) * 0.5f; }
+
+			//! Returns the half-size of the box along each axis.
+			glm::vec3 get_extents() const { return (max - min) * 0.5f; }
+
+			//! Grows the box (if necessary) so that it contains `point`.
+			void expand(const glm::vec3& point) { min = glm::min(min, point); max = glm::max(max, point); }
+
+			//! Returns the axis-aligned box that encloses this box after it has been transformed by `transform`.
+			BoundingBox transformed(const glm::mat4& transform) const;
+		};
+
+		//! A bounding sphere. A sphere with a negative radius contains no points.
+		struct BoundingSphere
+		{
+			glm::vec3 center = glm::vec3(0.0f);
+			float radius = -1.0f;
+
+			bool is_empty() const { return radius < 0.0f; }
+
+			//! Returns a sphere that encloses this sphere after it has been transformed by `transform`. Non-uniform scales
+			//! are accounted for by scaling the radius by the longest axis.
+			BoundingSphere transformed(const glm::mat4& transform) const;
+		};
+
+		//! Controls how the procedural generators (i.e. `Grid` and `Sphere`) build their vertices and indices. Rows are
+		//! generated independently into preallocated ranges, so the output is identical whether or not `parallel` is set.
+		struct GenerationOptions
+		{
+			//! Whether or not rows should be distributed across `utils::ThreadPool::global()`
+			bool parallel = true;
+
+			//! The minimum number of rows handed to a single task
+			size_t rows_per_task = 16;
+		};
+
+		//! Generated vertex data stored as a structure-of-arrays: each component lives in its own tightly packed float 
+		//! array, which suits SIMD processing and uploads with `AttributeMode::MODE_SEPARATE`-style layouts.
+		struct SoAVertexData
+		{
+			void resize(size_t count)
+			{
+				for (auto stream : { &position_x, &position_y, &position_z, &normal_x, &normal_y, &normal_z, &texture_coordinate_u, &texture_coordinate_v })
+				{
+					stream->resize(count);
+				}
+			}
+
+			size_t size() const { return position_x.size(); }
+
+			std::vector<float> position_x;
+			std::vector<float> position_y;
+			std::vector<float> position_z;
+			std::vector<float> normal_x;
+			std::vector<float> normal_y;
+			std::vector<float> normal_z;
+			std::vector<float> texture_coordinate_u;
+			std::vector<float> texture_coordinate_v;
+			std::vector<uint32_t> indices;
+		};
+
+		//! The vertex input bindings and attributes that a graphics pipeline needs in order to consume packed vertex data.
+		struct VertexInputState
+		{
+			std::vector<vk::VertexInputBindingDescription> bindings;
+			std::vector<vk::VertexInputAttributeDescription> attributes;
 		};
 
 		using VertexAttributeSet = std::vector<VertexAttribute>;
@@ -69,23 +230,74 @@ namespace plume
 		{
 		public:
 
-			static vk::Format get_vertex_attribute_format(VertexAttribute attribute);
+			static vk::Format get_vertex_attribute_format(VertexAttribute attribute, const VertexEncoding& encoding = VertexEncoding{});
 			static uint32_t get_vertex_attribute_dimensions(VertexAttribute attribute);
-			static uint32_t get_vertex_attribute_size(VertexAttribute attribute);
-			static uint32_t get_vertex_attribute_offset(VertexAttribute attribute);
-			static std::vector<vk::VertexInputAttributeDescription> get_vertex_input_attribute_descriptions(uint32_t start_binding = 0, AttributeMode mode = AttributeMode::MODE_INTERLEAVED);
-			static std::vector<vk::VertexInputBindingDescription> get_vertex_input_binding_descriptions(uint32_t start_binding = 0, AttributeMode mode = AttributeMode::MODE_INTERLEAVED);
+			static uint32_t get_vertex_attribute_size(VertexAttribute attribute, const VertexEncoding& encoding = VertexEncoding{});
+			static uint32_t get_vertex_attribute_offset(VertexAttribute attribute, const VertexEncoding& encoding = VertexEncoding{});
+			static std::vector<vk::VertexInputAttributeDescription> get_vertex_input_attribute_descriptions(uint32_t start_binding = 0, AttributeMode mode = AttributeMode::MODE_INTERLEAVED, const VertexEncoding& encoding = VertexEncoding{});
+			static std::vector<vk::VertexInputBindingDescription> get_vertex_input_binding_descriptions(uint32_t start_binding = 0, AttributeMode mode = AttributeMode::MODE_INTERLEAVED, const VertexEncoding& encoding = VertexEncoding{});
+
+			//! Returns the vertex input state for vertex data packed with `mode`, starting at binding `start_binding`. With 
+			//! VertexInputPreset::PRESET_POSITION_ONLY, only the position attribute (location 0) is fetched. This is most 
+			//! effective with AttributeMode::MODE_SPLIT_POSITIONS or AttributeMode::MODE_SEPARATE, where the pipeline reads
+			//! a tightly packed position stream rather than striding over entire interleaved vertices.
+			static VertexInputState get_vertex_input_state(VertexInputPreset preset, AttributeMode mode = AttributeMode::MODE_INTERLEAVED, uint32_t start_binding = 0, const VertexEncoding& encoding = VertexEncoding{});
+
+			//! Returns the number of bytes between consecutive vertices when all of the active vertex attributes are interleaved.
+			static uint32_t get_vertex_stride(const VertexEncoding& encoding = VertexEncoding{});
 
 			virtual ~Geometry() = default;
 
-			virtual vk::PrimitiveTopology get_topology() const = 0;
+			//! The index value that marks the end of a strip in stripified index data. When packed as 16-bit indices, 
+			//! this is written as 0xFFFF.
+			static const uint32_t primitive_restart_index = 0xFFFFFFFF;
+
+			//! Returns the primitive topology of this geometry's indices: vk::PrimitiveTopology::eTriangleStrip if
+			//! `stripify()` was called, otherwise the topology produced by the geometry's generator.
+			vk::PrimitiveTopology get_topology() const { return m_is_stripified ? vk::PrimitiveTopology::eTriangleStrip : get_generated_topology(); }
+
+			//! Returns `true` if the indices contain `primitive_restart_index` strip separators, in which case the pipeline
+			//! used to draw this geometry must be created with primitive restart enabled.
+			bool is_primitive_restart_enabled() const { return m_is_stripified; }
 
 			//! Returns the number of vertices.
 			size_t get_vertex_count() const { return m_positions.size(); }
 
 			//! Constructs a container that holds all of this geometry's vertex attributes packed into a single vector.
-			//! This is most useful for uploading vertex data into a buffer object.
-			std::vector<float> get_packed_vertex_attributes();
+			//! This is most useful for uploading vertex data into a buffer object. To avoid the intermediate container,
+			//! see `pack_vertex_attributes()`.
+			std::vector<float> get_packed_vertex_attributes(AttributeMode mode = AttributeMode::MODE_INTERLEAVED) const;
+
+			//! Returns the number of bytes that `pack_vertex_attributes()` will write (for either attribute mode).
+			size_t get_packed_vertex_attributes_size(const VertexEncoding& encoding = VertexEncoding{}) const { return get_vertex_count() * get_vertex_stride(encoding); }
+
+			//! Returns the byte offset of the stream that holds `attribute` within vertex data that was packed with 
+			//! AttributeMode::MODE_SEPARATE. This is the offset that should be used when binding that stream.
+			size_t get_vertex_stream_offset(VertexAttribute attribute, const VertexEncoding& encoding = VertexEncoding{}) const;
+
+			//! Returns the byte offset of the interleaved (non-position) attribute stream within vertex data that was packed 
+			//! with AttributeMode::MODE_SPLIT_POSITIONS. The position stream always starts at offset zero.
+			size_t get_attribute_stream_offset(const VertexEncoding& encoding = VertexEncoding{}) const { return get_vertex_count() * get_vertex_attribute_size(VertexAttribute::ATTRIBUTE_POSITION, encoding); }
+
+			//! Writes all of this geometry's vertex attributes directly into `destination`, which must point to at least
+			//! `get_packed_vertex_attributes_size()` bytes (for example, a mapped staging or vertex buffer). With 
+			//! AttributeMode::MODE_INTERLEAVED, each vertex occupies `get_vertex_stride()` bytes. With AttributeMode::MODE_SEPARATE, 
+			//! each attribute is written as its own tightly packed stream (see `get_vertex_stream_offset()`). With 
+			//! AttributeMode::MODE_SPLIT_POSITIONS, all positions are written first, followed by the remaining attributes 
+			//! interleaved (see `get_attribute_stream_offset()`). Attributes are converted to the formats described by `encoding`.
+			void pack_vertex_attributes(void* destination, AttributeMode mode = AttributeMode::MODE_INTERLEAVED, const VertexEncoding& encoding = VertexEncoding{}) const;
+
+			//! Returns the transform that a shader must apply to positions that were packed with `encoding` in order to
+			//! recover object space positions. For 32-bit float positions, this is the identity transform.
+			PositionDequantization get_position_dequantization(const VertexEncoding& encoding) const;
+
+			//! Returns the axis-aligned box that encloses every vertex position, in object space. The bounds are computed 
+			//! on each call, so callers that need them repeatedly should store the result.
+			BoundingBox get_bounding_box() const;
+
+			//! Returns a sphere that encloses every vertex position, in object space. The sphere is centered on the bounding
+			//! box, which is not necessarily optimal, but is cheap to compute and shares its center with the box.
+			BoundingSphere get_bounding_sphere() const;
 
 			//! Returns a vector containing all of this geometry's vertex positions.
 			const std::vector<glm::vec3>& get_positions() const { return m_positions; }
@@ -102,6 +314,23 @@ namespace plume
 			//! Returns a vector containing all of this geometry's indices.
 			const std::vector<uint32_t>& get_indices() const { return m_indices; }
 
+			//! Returns the smallest index type that can address every vertex of this geometry: vk::IndexType::eUint16
+			//! if there are no more than 65,535 vertices (0xFFFF is reserved for primitive restart), otherwise 
+			//! vk::IndexType::eUint32.
+			vk::IndexType get_index_type() const { return (get_vertex_count() <= 0xFFFF) ? vk::IndexType::eUint16 : vk::IndexType::eUint32; }
+
+			//! Returns the number of bytes that `pack_indices()` will write.
+			size_t get_packed_indices_size() const { return m_indices.size() * ((get_index_type() == vk::IndexType::eUint16) ? sizeof(uint16_t) : sizeof(uint32_t)); }
+
+			//! Writes this geometry's indices directly into `destination` as `get_index_type()` values. `destination` must
+			//! point to at least `get_packed_indices_size()` bytes (for example, a mapped index buffer).
+			void pack_indices(void* destination) const;
+
+			//! Converts this geometry's triangle list into triangle strips that are separated by `primitive_restart_index`.
+			//! The conversion is skipped if the strips would not require fewer indices than the triangle list. Returns 
+			//! `true` if the geometry was stripified.
+			bool stripify();
+
 			//! Returns a pointer to the underlying data for the specified vertex `attribute`.
 			float* get_vertex_attribute_data_ptr(VertexAttribute attribute);
 
@@ -115,8 +344,55 @@ namespace plume
 			void set_colors_solid(const glm::vec3& color) { m_colors = std::vector<glm::vec3>(get_vertex_count(), color); }
 			void set_colors_random();
 
+			//! Replaces the index buffer of this geometry. Every index must refer to an existing vertex.
+			void set_indices(const std::vector<uint32_t>& indices);
+
+			//! Moves the vertex at index `i` to index `remap[i]`, reordering every vertex attribute and rewriting the 
+			//! index buffer accordingly. `remap` must be a permutation of the vertex indices.
+			void remap_vertices(const std::vector<uint32_t>& remap);
+
+			//! Merges vertices whose attributes are equal within the tolerances in `options`, compacting every attribute 
+			//! in place and rewriting the indices. Vertices keep their relative order. Triangles of triangle list geometry 
+			//! that become degenerate are removed. Returns the number of vertices that were removed. Note that values 
+			//! which are closer than a tolerance but straddle a grid boundary are not merged.
+			size_t weld_vertices(const WeldOptions& options = WeldOptions{});
+
 		protected:
 
+			//! Returns the primitive topology of the indices generated by the derived geometry type.
+			virtual vk::PrimitiveTopology get_generated_topology() const = 0;
+
+			//! Throws if any index (other than `primitive_restart_index`) refers to a vertex that does not exist. Operations
+			//! that use indices to address per-vertex tables call this first, so that a bad index buffer fails instead of
+			//! reading out of bounds.
+			void check_indices() const;
+
+			//! Converts the vertex attribute `attribute` of every vertex into the format described by `encoding` and writes 
+			//! the results to `destination`, `stride` bytes apart. Streams that don't need to be converted are copied directly.
+			void encode_vertex_stream(VertexAttribute attribute, 
+									  const VertexEncoding& encoding, 
+									  const PositionDequantization& dequantization, 
+									  uint8_t* destination, 
+									  size_t stride) const;
+
+			//! The inverse of `pack_vertex_attributes()`: replaces every vertex attribute with the `vertex_count` vertices that
+			//! were packed into `source` with `mode` and `encoding`. Compact encodings are lossy, so the attributes are only
+			//! as precise as the packed data. `dequantization` must be the transform that the positions were packed with.
+			void unpack_vertex_attributes(const void* source, 
+										  size_t vertex_count, 
+										  AttributeMode mode, 
+										  const VertexEncoding& encoding, 
+										  const PositionDequantization& dequantization);
+
+			//! The inverse of `encode_vertex_stream()`: reads the vertex attribute `attribute` of every vertex from `source`,
+			//! `stride` bytes apart, and converts it from the format described by `encoding`. The attribute must already have
+			//! one element per vertex.
+			void decode_vertex_stream(VertexAttribute attribute, 
+									  const VertexEncoding& encoding, 
+									  const PositionDequantization& dequantization, 
+									  const uint8_t* source, 
+									  size_t stride);
+
 			struct Vertex
 			{
 				glm::vec3 m_position;
@@ -130,6 +406,7 @@ namespace plume
 			std::vector<glm::vec3> m_normals;
 			std::vector<glm::vec2> m_texture_coordinates;
 			std::vector<uint32_t> m_indices;
+			bool m_is_stripified = false;
 		};
 
 		class Rect : public Geometry
@@ -146,16 +423,24 @@ namespace plume
 			//! in a clockwise fashion, beginning with the upper-left.
 			void colors(const glm::vec3& ul, const glm::vec3& ur, const glm::vec3& lr, const glm::vec3& ll);
 
-			vk::PrimitiveTopology get_topology() const override { return vk::PrimitiveTopology::eTriangleStrip; }
+		protected:
+
+			vk::PrimitiveTopology get_generated_topology() const override { return vk::PrimitiveTopology::eTriangleList; }
 		};
 
 		class Grid : public Geometry
 		{
 		public:
 
-			Grid(float width = 1.0f, float height = 1.0f, uint32_t u_subdivisions = 4, uint32_t v_subdivisions = 4, const glm::vec3& center = { 0.0f, 0.0f, 0.0f });
+			Grid(float width = 1.0f, float height = 1.0f, uint32_t u_subdivisions = 4, uint32_t v_subdivisions = 4, const glm::vec3& center = { 0.0f, 0.0f, 0.0f }, const GenerationOptions& options = GenerationOptions{});
 
-			vk::PrimitiveTopology get_topology() const override { return vk::PrimitiveTopology::eTriangleStrip; }
+			//! Generates the same vertices and indices as the constructor, but in a structure-of-arrays layout (colors are
+			//! omitted, since they are always white).
+			static SoAVertexData generate_soa(float width = 1.0f, float height = 1.0f, uint32_t u_subdivisions = 4, uint32_t v_subdivisions = 4, const glm::vec3& center = { 0.0f, 0.0f, 0.0f }, const GenerationOptions& options = GenerationOptions{});
+
+		protected:
+
+			vk::PrimitiveTopology get_generated_topology() const override { return vk::PrimitiveTopology::eTriangleList; }
 		};
 
 		class Circle : public Geometry
@@ -164,16 +449,24 @@ namespace plume
 
 			Circle(float radius = 1.0f, const glm::vec3& center = { 0.0f, 0.0f, 0.0f }, uint32_t subdivisions = 30);
 
-			vk::PrimitiveTopology get_topology() const override { return vk::PrimitiveTopology::eTriangleFan; }
+		protected:
+
+			vk::PrimitiveTopology get_generated_topology() const override { return vk::PrimitiveTopology::eTriangleFan; }
 		};
 
 		class Sphere : public Geometry
 		{
 		public:
 
-			Sphere(float radius = 1.0f, const glm::vec3& center = { 0.0f, 0.0f, 0.0f }, size_t u_divisions = 30, size_t v_divisions = 30);
+			Sphere(float radius = 1.0f, const glm::vec3& center = { 0.0f, 0.0f, 0.0f }, size_t u_divisions = 30, size_t v_divisions = 30, const GenerationOptions& options = GenerationOptions{});
 
-			vk::PrimitiveTopology get_topology() const override { return vk::PrimitiveTopology::eTriangleStrip; }
+			//! Generates the same vertices and indices as the constructor, but in a structure-of-arrays layout (colors are
+			//! omitted, since they are always white).
+			static SoAVertexData generate_soa(float radius = 1.0f, const glm::vec3& center = { 0.0f, 0.0f, 0.0f }, size_t u_divisions = 30, size_t v_divisions = 30, const GenerationOptions& options = GenerationOptions{});
+
+		protected:
+
+			vk::PrimitiveTopology get_generated_topology() const override { return vk::PrimitiveTopology::eTriangleList; }
 		};
 
 		class IcoSphere : public Geometry
@@ -182,7 +475,9 @@ namespace plume
 
 			IcoSphere(float radius = 1.0f, const glm::vec3& center = { 0.0f, 0.0f, 0.0f });
 
-			vk::PrimitiveTopology get_topology() const override { return vk::PrimitiveTopology::eTriangleList; }
+		protected:
+
+			vk::PrimitiveTopology get_generated_topology() const override { return vk::PrimitiveTopology::eTriangleList; }
 		};
 
 	} // namespace geo
@@ -0,0 +1,97 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "Geometry.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		//! The data required to draw a single instance of a mesh. The layout of this struct matches the std430 
+		//! `instance_data` struct in `pbr.vert`, so an array of instances can be uploaded to a storage buffer as-is and
+		//! indexed with `gl_InstanceIndex`. This lets thousands of objects be drawn with a single instanced draw call.
+		struct InstanceData
+		{
+			//! Builds the per-instance data for an object with the transform `model`. The normal matrix (the inverse 
+			//! transpose of the upper 3x3 of `model`) is computed here, once, rather than for every vertex on the GPU.
+			static InstanceData create(const glm::mat4& model, uint32_t material_id = 0);
+
+			//! Object space to world space.
+			glm::mat4 model;
+
+			//! The columns of the normal matrix (a mat3 in GLSL), each padded to 16 bytes as required by std430.
+			glm::vec4 normal_matrix[3];
+
+			//! An index into the material parameters used to shade this instance.
+			uint32_t material_id;
+
+			uint32_t padding[3];
+		};
+
+		static_assert(sizeof(InstanceData) == 128, "The size of `InstanceData` must match its std430 layout in GLSL");
+
+		//! The data required to draw a single sphere impostor: a camera-facing quad that is ray-traced against an analytic 
+		//! sphere in the fragment shader (see `sphere_impostor.vert` and `sphere_impostor.frag`). An impostor costs two 
+		//! triangles regardless of how finely the sphere would otherwise need to be tessellated, so millions of them can
+		//! be drawn with a single instanced draw call. The layout matches two `vec4`s in both std430 and as instance-rate
+		//! vertex attributes.
+		struct SphereInstance
+		{
+			//! The center of the sphere, in world space.
+			glm::vec3 center;
+
+			float radius;
+
+			//! The color of the sphere (the alpha component is currently unused).
+			glm::vec4 color;
+		};
+
+		static_assert(sizeof(SphereInstance) == 32, "The size of `SphereInstance` must match its layout in GLSL");
+
+		//! Writes one InstanceData struct per entry of `models` into `destination`, which must point to at least
+		//! `models.size() * sizeof(InstanceData)` bytes (for example, a mapped storage or vertex buffer). If 
+		//! `material_ids` is empty, every instance uses material zero. Instances are computed in parallel.
+		void pack_instances(const std::vector<glm::mat4>& models, const std::vector<uint32_t>& material_ids, void* destination);
+
+		//! Returns the vertex input state for instance data that is bound as a vertex buffer with vk::VertexInputRate::eInstance,
+		//! rather than read from a storage buffer. The model matrix occupies four consecutive locations starting at 
+		//! `first_location`, the normal matrix occupies the next three, and the material ID occupies the last one.
+		VertexInputState get_instance_input_state(uint32_t binding, uint32_t first_location);
+
+		//! Returns the vertex input state for an array of SphereInstance structs bound as a vertex buffer with 
+		//! vk::VertexInputRate::eInstance. The center and radius occupy `first_location` (as a single `vec4`) and the 
+		//! color occupies the next location.
+		VertexInputState get_sphere_instance_input_state(uint32_t binding, uint32_t first_location);
+
+	} // namespace geom
+
+} // namespace plume
@@ -0,0 +1,77 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "Platform.h"
+
+namespace plume
+{
+
+	namespace fsys
+	{
+
+		//! A read-only view of a file's contents that is mapped directly into the address space of the process. Pages 
+		//! are loaded by the operating system on first access, so opening a large file is (nearly) free, and data 
+		//! can be copied straight from the mapping into a staging or vertex buffer.
+		class MappedFile
+		{
+		public:
+
+			//! Maps the entire file at `path`. Throws if the file cannot be opened or mapped.
+			MappedFile(const std::string& path);
+
+			MappedFile(const MappedFile& other) = delete;
+
+			MappedFile& operator=(const MappedFile& other) = delete;
+
+			~MappedFile();
+
+			//! Returns a pointer to the first byte of the file.
+			const uint8_t* get_data() const { return m_data; }
+
+			//! Returns the size of the file in bytes.
+			size_t get_size() const { return m_size; }
+
+			const std::string& get_path() const { return m_path; }
+
+		private:
+
+			std::string m_path;
+			const uint8_t* m_data = nullptr;
+			size_t m_size = 0;
+
+			// Native handles: the file descriptor on Linux, or the file and file mapping handles on Windows.
+			intptr_t m_file_handle = -1;
+			void* m_mapping_handle = nullptr;
+		};
+
+	} // namespace fsys
+
+} // namespace plume
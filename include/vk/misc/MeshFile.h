@@ -0,0 +1,176 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "Geometry.h"
+#include "MappedFile.h"
+#include "Meshlets.h"
+#include "MeshSimplifier.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		//! The sections of a `.plmesh` file. Every section starts at a multiple of `MeshFileHeader::section_alignment` 
+		//! bytes from the beginning of the file, and sections that are not present have a size of zero.
+		enum class MeshFileSection : uint32_t
+		{
+			VERTICES,				// Vertex data in GPU layout (see `MeshFileHeader::vertex_stride` and the encodings)
+			INDICES,				// Index data of type `MeshFileHeader::index_type`
+			LOD_LEVELS,				// An array of `LevelOfDetail` structs
+			LOD_INDICES,			// Index data of every LOD level, of type `MeshFileHeader::index_type`
+			MESHLETS,				// An array of `Meshlet` structs
+			MESHLET_INDICES,		// Index data of every meshlet, of type `MeshFileHeader::index_type`
+			COUNT
+		};
+
+		struct MeshFileSectionEntry
+		{
+			uint64_t offset;
+			uint64_t size;
+		};
+
+		//! The header at the beginning of every `.plmesh` file. All values are stored in little-endian byte order, and 
+		//! enumerations are stored as their (32-bit) underlying values.
+		struct MeshFileHeader
+		{
+			static const uint32_t current_version = 2;
+			static const uint32_t section_alignment = 64;
+
+			char magic[4];
+			uint32_t version;
+			uint64_t file_size;
+
+			uint32_t vertex_count;
+			uint32_t index_count;
+			uint32_t vertex_stride;
+			uint32_t attribute_mode;
+			uint32_t position_encoding;
+			uint32_t normal_encoding;
+			uint32_t color_encoding;
+			uint32_t texture_coordinate_encoding;
+
+			uint32_t index_type;
+			uint32_t topology;
+			uint32_t primitive_restart;
+			uint32_t lod_count;
+			uint32_t meshlet_count;
+			uint32_t reserved;
+
+			float dequantization_offset[3];
+			float dequantization_scale[3];
+			float bounds_min[3];
+			float bounds_max[3];
+			float bounding_sphere[4];
+
+			MeshFileSectionEntry sections[static_cast<size_t>(MeshFileSection::COUNT)];
+		};
+
+		//! Options that control what is written to a `.plmesh` file.
+		struct MeshFileWriteOptions
+		{
+			AttributeMode attribute_mode = AttributeMode::MODE_INTERLEAVED;
+			VertexEncoding encoding = VertexEncoding{};
+
+			//! Optional LOD chain and meshlets (built from the same geometry) to store alongside the mesh.
+			const LodChain* lods = nullptr;
+			const MeshletMesh* meshlets = nullptr;
+		};
+
+		//! A versioned, binary mesh container. Opening a file memory-maps it and validates its header, section table and
+		//! indices: there is no parsing step, and the vertex and index sections can be copied directly into GPU buffers.
+		//! Vertices are only stored in the GPU layout that they were written with (see `get_attribute_mode()` and 
+		//! `get_encoding()`).
+		class MeshFile
+		{
+		public:
+
+			//! Memory-maps and validates the `.plmesh` file at path `ResourceManager::default_path` + `file_name`.
+			static std::shared_ptr<MeshFile> load(const std::string& file_name);
+
+			//! Writes `geometry` (and any LODs and meshlets in `options`) to a `.plmesh` file at `path`.
+			static void write(const std::string& path, const Geometry& geometry, const MeshFileWriteOptions& options = MeshFileWriteOptions{});
+
+			const MeshFileHeader& get_header() const { return *reinterpret_cast<const MeshFileHeader*>(m_mapped_file->get_data()); }
+
+			//! Returns a pointer to the first byte of `section`.
+			const void* get_section_data(MeshFileSection section) const;
+
+			//! Returns the size of `section` in bytes, which is zero if the section is not present.
+			size_t get_section_size(MeshFileSection section) const { return static_cast<size_t>(get_header().sections[static_cast<size_t>(section)].size); }
+
+			VertexEncoding get_encoding() const;
+
+			AttributeMode get_attribute_mode() const { return static_cast<AttributeMode>(get_header().attribute_mode); }
+
+			//! Returns the transform that a shader must apply to the packed positions (see `Geometry::get_position_dequantization()`).
+			PositionDequantization get_position_dequantization() const;
+
+			vk::IndexType get_index_type() const { return static_cast<vk::IndexType>(get_header().index_type); }
+
+			const LevelOfDetail* get_lods() const { return static_cast<const LevelOfDetail*>(get_section_data(MeshFileSection::LOD_LEVELS)); }
+
+			const Meshlet* get_meshlets() const { return static_cast<const Meshlet*>(get_section_data(MeshFileSection::MESHLETS)); }
+
+		private:
+
+			//! Validates the `.plmesh` file in `mapped_file`, throwing if it is malformed or was written with a different version.
+			MeshFile(const std::shared_ptr<fsys::MappedFile>& mapped_file);
+
+			std::shared_ptr<fsys::MappedFile> m_mapped_file;
+		};
+
+		//! A geometry whose attributes and indices are read from a `.plmesh` file. The file remains mapped for the lifetime
+		//! of the geometry, so its GPU-ready sections should be uploaded directly (see `get_mesh_file()`) rather than packed
+		//! again. The attributes are decoded from the packed vertices for use on the host, so with compact encodings they 
+		//! are only as precise as the file.
+		class MeshFileGeometry : public Geometry
+		{
+		public:
+
+			MeshFileGeometry(const std::shared_ptr<MeshFile>& mesh_file);
+
+			const MeshFile& get_mesh_file() const { return *m_mesh_file; }
+
+		protected:
+
+			vk::PrimitiveTopology get_generated_topology() const override { return m_topology; }
+
+		private:
+
+			std::shared_ptr<MeshFile> m_mesh_file;
+			vk::PrimitiveTopology m_topology;
+		};
+
+	} // namespace geom
+
+} // namespace plume
@@ -0,0 +1,109 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "Geometry.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		struct ImportOptions
+		{
+			//! Merge vertices that are identical (for OBJ files: corners that reference the same position, texture 
+			//! coordinate, and normal; for glTF files: vertices whose attributes are bitwise identical).
+			bool deduplicate_vertices = true;
+
+			//! Reverse the winding order of every triangle. Both formats use counter-clockwise front faces.
+			bool flip_winding = false;
+
+			//! The number of bytes of OBJ text that are parsed by a single task.
+			size_t chunk_size = 1 << 20;
+		};
+
+		//! Timings and counts that are gathered while importing a mesh.
+		struct ImportStatistics
+		{
+			size_t file_size = 0;
+
+			//! The number of vertices before and after deduplication.
+			size_t input_vertex_count = 0;
+			size_t vertex_count = 0;
+			size_t triangle_count = 0;
+
+			float parse_milliseconds = 0.0f;
+			float deduplicate_milliseconds = 0.0f;
+			float total_milliseconds = 0.0f;
+
+			//! Returns the import throughput in megabytes (of the main file) per second.
+			float get_throughput() const { return (total_milliseconds > 0.0f) ? (file_size / (1024.0f * 1024.0f)) / (total_milliseconds / 1000.0f) : 0.0f; }
+		};
+
+		//! A geometry that is imported from an OBJ or glTF 2.0 file. Parsing and attribute conversion are split into chunks
+		//! that are processed on `utils::ThreadPool::global()`. Only triangle (and polygon, in the case of OBJ) primitives 
+		//! are imported: materials, node transforms, and skinning data are ignored, and the primitives of every mesh
+		//! in a glTF file are merged into a single geometry. Missing normals are computed from the triangles, missing
+		//! colors default to white, and missing texture coordinates default to zero.
+		class ImportedGeometry : public Geometry
+		{
+		public:
+
+			//! Imports the file at path `ResourceManager::default_path` + `file_name`, choosing the importer based on 
+			//! the file's extension (".obj", ".gltf", or ".glb").
+			static std::shared_ptr<ImportedGeometry> load(const std::string& file_name, const ImportOptions& options = ImportOptions{});
+
+			//! Imports a Wavefront OBJ file from `path`. Vertex colors (i.e. "v x y z r g b") are supported.
+			static std::shared_ptr<ImportedGeometry> load_obj(const std::string& path, const ImportOptions& options = ImportOptions{});
+
+			//! Imports a glTF 2.0 file from `path`, which may be either a ".gltf" file (with external or embedded base64 
+			//! buffers) or a binary ".glb" file.
+			static std::shared_ptr<ImportedGeometry> load_gltf(const std::string& path, const ImportOptions& options = ImportOptions{});
+
+			const ImportStatistics& get_import_statistics() const { return m_import_statistics; }
+
+		protected:
+
+			vk::PrimitiveTopology get_generated_topology() const override { return vk::PrimitiveTopology::eTriangleList; }
+
+		private:
+
+			ImportedGeometry() = default;
+
+			//! Fills in any missing attributes, after `m_positions` and `m_indices` have been set.
+			void complete_attributes();
+
+			ImportStatistics m_import_statistics;
+		};
+
+	} // namespace geom
+
+} // namespace plume
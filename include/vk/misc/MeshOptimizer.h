@@ -0,0 +1,89 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "Geometry.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		//! Statistics gathered by simulating a FIFO post-transform vertex cache over an index buffer. The average cache 
+		//! miss ratio (ACMR) is the number of vertices that must be transformed per triangle: it is bounded below by 
+		//! roughly 0.5 for regular meshes and above by 3.0. The average transformed vertex ratio (ATVR) is the number 
+		//! of vertices that must be transformed per unique vertex, which is 1.0 for an ideal ordering.
+		struct VertexCacheStatistics
+		{
+			uint32_t vertices_transformed = 0;
+			float acmr = 0.0f;
+			float atvr = 0.0f;
+		};
+
+		//! The vertex cache statistics of a mesh before and after a call to `optimize_mesh()`.
+		struct MeshOptimizationStatistics
+		{
+			VertexCacheStatistics before;
+			VertexCacheStatistics after;
+		};
+
+		//! Simulates a FIFO post-transform vertex cache of `cache_size` entries over the triangle list `indices`.
+		VertexCacheStatistics analyze_vertex_cache(const std::vector<uint32_t>& indices, size_t vertex_count, uint32_t cache_size = 16);
+
+		//! Reorders the triangles of the triangle list `indices` to improve post-transform vertex cache locality, using 
+		//! Tom Forsyth's "Linear-Speed Vertex Cache Optimisation". The algorithm does not depend on the exact size of 
+		//! the hardware cache and performs well for any LRU or FIFO cache of 16 or more entries.
+		std::vector<uint32_t> optimize_vertex_cache(const std::vector<uint32_t>& indices, size_t vertex_count);
+
+		//! Reorders clusters of triangles in the (vertex cache optimized) triangle list `indices` so that triangles which
+		//! are likely to occlude others are drawn first, reducing overdraw. This follows Sander et al., "Fast Triangle 
+		//! Reordering for Vertex Locality and Reduced Overdraw": the index buffer is split into clusters wherever the
+		//! vertex cache would be flushed anyway, and clusters are further split as long as their ACMR stays within 
+		//! `threshold` times the original ACMR. Clusters are then sorted by how much they face away from the mesh centroid.
+		std::vector<uint32_t> optimize_overdraw(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold = 1.05f);
+
+		//! Returns a table that maps each old vertex index to a new vertex index, such that vertices are numbered in 
+		//! the order in which they are first referenced by `indices`. This improves the locality of vertex fetches.
+		//! Vertices that are never referenced are placed after all referenced vertices.
+		std::vector<uint32_t> optimize_vertex_fetch_remap(const std::vector<uint32_t>& indices, size_t vertex_count);
+
+		//! Converts the triangle list `indices` into triangle strips, separated by `restart_index`, by greedily walking 
+		//! across shared edges. The winding order of every triangle is preserved, and degenerate triangles are dropped.
+		//! The result should be drawn with the vk::PrimitiveTopology::eTriangleStrip topology and primitive restart enabled.
+		std::vector<uint32_t> stripify(const std::vector<uint32_t>& indices, size_t vertex_count, uint32_t restart_index = 0xFFFFFFFF);
+
+		//! Runs the full optimization pipeline on a triangle list geometry: vertex cache optimization, optional overdraw
+		//! optimization, and vertex fetch optimization. The geometry's indices and vertex attributes are reordered in 
+		//! place. Returns the vertex cache statistics of the mesh before and after optimization.
+		MeshOptimizationStatistics optimize_mesh(Geometry& geometry, bool reduce_overdraw = false, float overdraw_threshold = 1.05f);
+
+	} // namespace geom
+
+} // namespace plume
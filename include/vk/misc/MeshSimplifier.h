@@ -0,0 +1,109 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "Geometry.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		//! Parameters that control how a mesh is simplified. The attribute weights scale the squared difference between
+		//! the attributes of two vertices that are merged, which is added to the squared geometric (quadric) error. A
+		//! weight of zero ignores the corresponding attribute. 
+		struct SimplificationOptions
+		{
+			//! The maximum number of levels in a LOD chain, including the original mesh.
+			uint32_t max_levels = 6;
+
+			//! The target index count of each level, relative to the previous level.
+			float reduction_ratio = 0.5f;
+
+			//! The largest error that any level may introduce, relative to the radius of the mesh's bounding sphere.
+			float max_error = 0.05f;
+
+			float normal_weight = 0.5f;
+			float color_weight = 0.25f;
+			float texture_coordinate_weight = 1.0f;
+		};
+
+		//! A single level of a LOD chain: a range of indices within the chain's index buffer.
+		struct LevelOfDetail
+		{
+			uint32_t first_index;
+			uint32_t index_count;
+
+			//! The object space error introduced by this level, which never decreases from one level to the next.
+			float error;
+		};
+
+		//! A chain of progressively simpler versions of a mesh. Every level references the same vertices (those of the 
+		//! original geometry), so the entire chain can be drawn from a single vertex buffer and a single index buffer:
+		//! each level is drawn by passing its `first_index` and `index_count` to an indexed draw command.
+		struct LodChain
+		{
+			//! Returns the size, in pixels, of an object space error `error` that is projected onto a viewport of height 
+			//! `viewport_height` by a perspective camera with vertical field of view `vertical_fov` (in radians) from 
+			//! `distance` units away.
+			static float compute_screen_space_error(float error, float distance, float vertical_fov, float viewport_height);
+
+			//! Returns the index of the coarsest level whose projected error is no larger than `pixel_threshold` pixels. 
+			//! `scale` is the (largest) scale factor of the object's model matrix.
+			size_t select_level(float distance, float vertical_fov, float viewport_height, float pixel_threshold = 1.0f, float scale = 1.0f) const;
+
+			//! Writes the indices of every level into `destination` as `index_type` values (see `Geometry::get_index_type()`).
+			void pack_indices(void* destination, vk::IndexType index_type) const;
+
+			std::vector<uint32_t> indices;
+			std::vector<LevelOfDetail> levels;
+		};
+
+		//! Reduces the number of triangles in the triangle list `indices` (which must reference the vertices of `geometry`) 
+		//! by collapsing edges in the order of increasing quadric error, until at most `target_index_count` indices remain
+		//! or the next collapse would exceed `target_error` (in object space units). Vertices are never moved or created, 
+		//! so the result references the same vertex data as the input. Vertices on open boundaries and attribute seams
+		//! (i.e. vertices that share a position with another vertex) are preserved. If `result_error` is not null, it 
+		//! receives the largest error that was introduced.
+		std::vector<uint32_t> simplify(const Geometry& geometry, 
+									   const std::vector<uint32_t>& indices, 
+									   size_t target_index_count, 
+									   float target_error, 
+									   const SimplificationOptions& options = SimplificationOptions{},
+									   float* result_error = nullptr);
+
+		//! Builds a LOD chain from `geometry`, which must use the vk::PrimitiveTopology::eTriangleList topology. The first
+		//! level holds the original triangles. Each level is optimized for the post-transform vertex cache. Generation stops 
+		//! early once a level can no longer be reduced meaningfully within `options.max_error`.
+		LodChain generate_lod_chain(const Geometry& geometry, const SimplificationOptions& options = SimplificationOptions{});
+
+	} // namespace geom
+
+} // namespace plume
@@ -0,0 +1,97 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "Geometry.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		//! A small cluster of triangles, along with the data required to cull it on the GPU. The layout of this struct 
+		//! matches the std430 `Meshlet` struct in `meshlet_cull.comp`, so an array of meshlets can be uploaded to a 
+		//! storage buffer as-is.
+		struct Meshlet
+		{
+			//! xyz: the center of the meshlet's bounding sphere, w: its radius (in object space).
+			glm::vec4 bounding_sphere;
+
+			//! xyz: the average normal of the meshlet's triangles, w: the cone cutoff. The meshlet is back-facing (and can
+			//! be culled) when `dot(center - camera, axis) >= cutoff * length(center - camera) + radius`. A cutoff of 1.0
+			//! means that the triangles face too many directions for the meshlet to ever be culled this way.
+			glm::vec4 normal_cone;
+
+			//! The range of the meshlet's triangles within `MeshletMesh::indices`.
+			uint32_t first_index;
+			uint32_t index_count;
+
+			//! The number of unique vertices that the meshlet's triangles reference.
+			uint32_t vertex_count;
+
+			uint32_t padding;
+		};
+
+		static_assert(sizeof(Meshlet) == 48, "The size of `Meshlet` must match its std430 layout in GLSL");
+
+		//! A mesh that has been partitioned into meshlets. The indices of each meshlet are stored contiguously and 
+		//! reference the vertices of the original geometry, so they can be drawn with regular indexed (indirect) draws.
+		struct MeshletMesh
+		{
+			std::vector<Meshlet> meshlets;
+			std::vector<uint32_t> indices;
+		};
+
+		//! The std140 uniform block that `meshlet_cull.comp` reads its per-object culling parameters from.
+		struct MeshletCullingParameters
+		{
+			//! Builds culling parameters for an object with model matrix `model`, seen by a camera at `camera_position` 
+			//! (in world space) with the combined view-projection matrix `view_projection`. `scale` must be the largest 
+			//! scale factor of `model`, which is applied to the meshlets' bounding spheres.
+			static MeshletCullingParameters create(const glm::mat4& model, const glm::mat4& view_projection, const glm::vec3& camera_position, float scale = 1.0f);
+
+			glm::mat4 model;
+
+			//! The world space frustum planes (left, right, bottom, top, near, far) as (normal, distance) pairs, where the 
+			//! normals point into the frustum.
+			glm::vec4 frustum_planes[6];
+
+			//! xyz: the world space position of the camera, w: the largest scale factor of `model`.
+			glm::vec4 camera_position;
+		};
+
+		//! Partitions the triangle list of `geometry` into meshlets with at most `max_vertices` unique vertices and 
+		//! `max_triangles` triangles each. Triangles are consumed in order, so running `optimize_mesh()` (see 
+		//! MeshOptimizer.h) beforehand produces meshlets that are more spatially coherent and thus easier to cull.
+		MeshletMesh build_meshlets(const Geometry& geometry, uint32_t max_vertices = 64, uint32_t max_triangles = 124);
+
+	} // namespace geom
+
+} // namespace plume
@@ -30,9 +30,12 @@
 #include <fstream>
 #include <string>
 #include <iostream>
+#include <memory>
 
 #include "shaderc/shaderc.hpp"
 
+#include "MappedFile.h"
+
 namespace plume
 {
 
@@ -78,6 +81,9 @@ namespace plume
 			//! Loads a binary file at path `ResourceManager::default_path` + `file_name`.
 			static FileResource load_binary_file(const std::string& file_name);
 
+			//! Memory-maps a file at path `ResourceManager::default_path` + `file_name`, without reading its contents.
+			static std::shared_ptr<MappedFile> map_file(const std::string& file_name) { return std::make_shared<MappedFile>(default_path + file_name); }
+
 			//! Loads an image file at path `ResourceManager::default_path` + `file_name`.
 			static ImageResource load_image(const std::string& file_name, bool force_alpha = true);
 
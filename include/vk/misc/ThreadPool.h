@@ -0,0 +1,85 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace plume
+{
+
+	namespace utils
+	{
+
+		//! A fixed set of worker threads that execute tasks from a shared queue. Most code should use the process-wide
+		//! pool returned by `ThreadPool::global()` rather than creating pools of its own.
+		class ThreadPool
+		{
+		public:
+
+			//! Returns a pool with one worker per hardware thread (minus one for the calling thread), created on first use.
+			static ThreadPool& global();
+
+			//! Creates a pool with `thread_count` worker threads. A pool with zero workers runs all work on the calling thread.
+			ThreadPool(size_t thread_count);
+
+			ThreadPool(const ThreadPool& other) = delete;
+
+			ThreadPool& operator=(const ThreadPool& other) = delete;
+
+			//! Waits for all queued tasks to finish before joining the worker threads.
+			~ThreadPool();
+
+			size_t get_thread_count() const { return m_threads.size(); }
+
+			//! Queues `task` to run on one of the worker threads.
+			void submit(std::function<void()> task);
+
+			//! Splits [`begin`, `end`) into contiguous chunks of at least `grain_size` elements and calls `func(chunk_begin, 
+			//! chunk_end)` for each chunk, on both the worker threads and the calling thread. Returns once every chunk has 
+			//! been processed. If `func` throws, the first exception is rethrown on the calling thread. It is safe to call
+			//! this from within a task (i.e. nested parallel loops do not deadlock).
+			void parallel_for(size_t begin, size_t end, size_t grain_size, const std::function<void(size_t, size_t)>& func);
+
+		private:
+
+			void worker_loop();
+
+			std::vector<std::thread> m_threads;
+			std::deque<std::function<void()>> m_tasks;
+			std::mutex m_mutex;
+			std::condition_variable m_condition;
+			bool m_is_stopping = false;
+		};
+
+	} // namespace utils
+
+} // namespace plume
@@ -58,6 +58,24 @@ namespace plume
 		//! Translate an image format into the appropriate aspect mask flags.
 		vk::ImageAspectFlags format_to_aspect_mask(vk::Format format);
 
+		//! The type that the components of a format are converted to when they are read in a shader. For example, UNORM, SNORM, 
+		//! and SFLOAT formats are all read as floating-point values.
+		enum class FormatNumericType
+		{
+			FLOAT,
+			SINT,
+			UINT,
+			UNKNOWN
+		};
+
+		//! Returns the number of components (i.e. 3 for vk::Format::eR32G32B32Sfloat) of an uncompressed, 8-, 16-, or 32-bit 
+		//! color format, or 0 for any other format.
+		uint32_t get_format_component_count(vk::Format format);
+
+		//! Returns the numeric type of an uncompressed, 8-, 16-, or 32-bit color format, or FormatNumericType::UNKNOWN for any 
+		//! other format.
+		FormatNumericType get_format_numeric_type(vk::Format format);
+
 		//! Translates a sample count (integer) into the correspond vk::SampleCountFlagBits. 
 		//! A `count` of 4 would return vk::SampleCountFlagBits::e4, for example.
 		vk::SampleCountFlagBits sample_count_to_flags(uint32_t count);
@@ -0,0 +1,283 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Geometry.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		//! The compile-time description of a single attribute within a vertex struct.
+		struct VertexAttributeLayout
+		{
+			uint32_t location;
+			vk::Format format;
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		//! Maps the C++ type of a vertex struct member to the vk::Format used to fetch it. Types without a specialization
+		//! must pass an explicit format to `VertexField`.
+		template<class T> struct VertexFormatTraits;
+		template<> struct VertexFormatTraits<float> { static constexpr vk::Format format = vk::Format::eR32Sfloat; };
+		template<> struct VertexFormatTraits<glm::vec2> { static constexpr vk::Format format = vk::Format::eR32G32Sfloat; };
+		template<> struct VertexFormatTraits<glm::vec3> { static constexpr vk::Format format = vk::Format::eR32G32B32Sfloat; };
+		template<> struct VertexFormatTraits<glm::vec4> { static constexpr vk::Format format = vk::Format::eR32G32B32A32Sfloat; };
+		template<> struct VertexFormatTraits<int32_t> { static constexpr vk::Format format = vk::Format::eR32Sint; };
+		template<> struct VertexFormatTraits<uint32_t> { static constexpr vk::Format format = vk::Format::eR32Uint; };
+
+		//! Describes where the data for a vertex attribute comes from when packing a Geometry with `VertexLayout::pack()`.
+		template<VertexAttribute attribute> struct VertexAttributeSource;
+
+		template<> struct VertexAttributeSource<VertexAttribute::ATTRIBUTE_POSITION>
+		{
+			static const std::vector<glm::vec3>& get(const Geometry& geometry) { return geometry.get_positions(); }
+		};
+
+		template<> struct VertexAttributeSource<VertexAttribute::ATTRIBUTE_COLOR>
+		{
+			static const std::vector<glm::vec3>& get(const Geometry& geometry) { return geometry.get_colors(); }
+		};
+
+		template<> struct VertexAttributeSource<VertexAttribute::ATTRIBUTE_NORMAL>
+		{
+			static const std::vector<glm::vec3>& get(const Geometry& geometry) { return geometry.get_normals(); }
+		};
+
+		template<> struct VertexAttributeSource<VertexAttribute::ATTRIBUTE_TEXTURE_COORDINATES>
+		{
+			static const std::vector<glm::vec2>& get(const Geometry& geometry) { return geometry.get_texture_coordinates(); }
+		};
+
+		//! Converts an attribute from the type stored by Geometry to the type of the vertex struct member. By default, this
+		//! is a plain conversion: specialize it for any other combination of types.
+		template<class Destination, class Source> 
+		struct VertexAttributeConverter
+		{
+			static Destination convert(const Source& value) { return Destination(value); }
+		};
+
+		template<> 
+		struct VertexAttributeConverter<glm::vec4, glm::vec3>
+		{
+			static glm::vec4 convert(const glm::vec3& value) { return glm::vec4(value, 1.0f); }
+		};
+
+		//! Tags a member of a vertex struct with the attribute that it holds. Prefer the `PL_VERTEX_FIELD` macro, which 
+		//! fills out the type and offset of the member automatically.
+		template<VertexAttribute Attribute, class T, size_t Offset, vk::Format Format = VertexFormatTraits<T>::format>
+		struct VertexField
+		{
+			using type = T;
+
+			static constexpr VertexAttribute attribute = Attribute;
+			static constexpr uint32_t location = static_cast<uint32_t>(Attribute);
+			static constexpr uint32_t offset = static_cast<uint32_t>(Offset);
+			static constexpr uint32_t size = static_cast<uint32_t>(sizeof(T));
+			static constexpr vk::Format format = Format;
+
+			static constexpr VertexAttributeLayout describe() { return { location, format, offset, size }; }
+		};
+
+		namespace detail
+		{
+
+			template<size_t N>
+			constexpr bool are_all_true(const std::array<bool, N>& values)
+			{
+				for (size_t i = 0; i < N; ++i)
+				{
+					if (!values[i]) return false;
+				}
+				return true;
+			}
+
+			template<size_t N>
+			constexpr bool are_unique(const std::array<uint32_t, N>& values)
+			{
+				for (size_t i = 0; i < N; ++i)
+				{
+					for (size_t j = i + 1; j < N; ++j)
+					{
+						if (values[i] == values[j]) return false;
+					}
+				}
+				return true;
+			}
+
+		} // namespace detail
+
+		//! A vertex layout derived entirely at compile time from a vertex struct and the tagged fields that it contains. 
+		//! For example:
+		//!
+		//!		struct MyVertex
+		//!		{
+		//!			glm::vec3 position;
+		//!			glm::vec2 uv;
+		//!		};
+		//!
+		//!		using MyLayout = VertexLayout<MyVertex, 
+		//!									  PL_VERTEX_FIELD(MyVertex, position, ATTRIBUTE_POSITION),
+		//!									  PL_VERTEX_FIELD(MyVertex, uv, ATTRIBUTE_TEXTURE_COORDINATES)>;
+		//!
+		//! The stride, offsets, formats, and shader locations are all constant expressions, and the layout is validated 
+		//! with static assertions. Attribute descriptions built from the layout are checked against the reflected inputs
+		//! of the vertex shader when a GraphicsPipeline is created. `pack()` fills an array of vertices from a Geometry 
+		//! with a loop that is specialized for the layout, so there is no per-attribute branching.
+		template<class Vertex, class... Fields>
+		struct VertexLayout
+		{
+			using vertex_type = Vertex;
+
+			static_assert(sizeof...(Fields) > 0, "A vertex layout must contain at least one field");
+			static_assert(std::is_standard_layout<Vertex>::value, "Vertex structs must be standard layout, so that `offsetof` is well-defined");
+			static_assert(detail::are_unique(std::array<uint32_t, sizeof...(Fields)>{ { Fields::location... } }), "Each field of a vertex layout must use a unique attribute");
+			static_assert(detail::are_all_true(std::array<bool, sizeof...(Fields)>{ { (Fields::offset + Fields::size <= sizeof(Vertex))... } }), "A vertex field extends past the end of the vertex struct");
+
+			static constexpr uint32_t stride = static_cast<uint32_t>(sizeof(Vertex));
+			static constexpr size_t attribute_count = sizeof...(Fields);
+			static constexpr std::array<VertexAttributeLayout, sizeof...(Fields)> attributes = { { Fields::describe()... } };
+
+			//! Returns `true` if this layout contains `attribute`.
+			static constexpr bool has_attribute(VertexAttribute attribute)
+			{
+				for (size_t i = 0; i < attribute_count; ++i)
+				{
+					if (attributes[i].location == static_cast<uint32_t>(attribute)) return true;
+				}
+				return false;
+			}
+
+			//! Returns the byte offset of `attribute` within the vertex struct. The attribute must be part of this layout.
+			static constexpr uint32_t get_offset(VertexAttribute attribute)
+			{
+				for (size_t i = 0; i < attribute_count; ++i)
+				{
+					if (attributes[i].location == static_cast<uint32_t>(attribute)) return attributes[i].offset;
+				}
+				return stride;
+			}
+
+			static vk::VertexInputBindingDescription get_binding_description(uint32_t binding = 0, vk::VertexInputRate input_rate = vk::VertexInputRate::eVertex)
+			{
+				return { binding, stride, input_rate };
+			}
+
+			static std::vector<vk::VertexInputAttributeDescription> get_attribute_descriptions(uint32_t binding = 0)
+			{
+				std::vector<vk::VertexInputAttributeDescription> attribute_descriptions;
+				for (const auto& attribute : attributes)
+				{
+					attribute_descriptions.push_back({ attribute.location, binding, attribute.format, attribute.offset });
+				}
+				return attribute_descriptions;
+			}
+
+			//! Returns the vertex input state for a pipeline that reads vertices of this layout from `binding`.
+			static VertexInputState get_vertex_input_state(uint32_t binding = 0, vk::VertexInputRate input_rate = vk::VertexInputRate::eVertex)
+			{
+				return { { get_binding_description(binding, input_rate) }, get_attribute_descriptions(binding) };
+			}
+
+			//! Writes every vertex of `geometry` into `destination`, which must point to at least `get_vertex_count() * stride`
+			//! bytes. Bytes that aren't covered by any field (i.e. padding) are left untouched.
+			static void pack(const Geometry& geometry, void* destination)
+			{
+				pack(geometry, destination, std::index_sequence_for<Fields...>{});
+			}
+
+		private:
+
+			template<size_t... I>
+			static void pack(const Geometry& geometry, void* destination, std::index_sequence<I...>)
+			{
+				const size_t vertex_count = geometry.get_vertex_count();
+				const auto sources = std::make_tuple(VertexAttributeSource<Fields::attribute>::get(geometry).data()...);
+
+				using expand = int[];
+				(void)expand{ 0, (check_source_size(VertexAttributeSource<Fields::attribute>::get(geometry).size(), vertex_count), 0)... };
+
+				uint8_t* vertex_ptr = static_cast<uint8_t*>(destination);
+				for (size_t i = 0; i < vertex_count; ++i, vertex_ptr += stride)
+				{
+					(void)expand{ 0, (store<Fields>(vertex_ptr, std::get<I>(sources)[i]), 0)... };
+				}
+			}
+
+			static void check_source_size(size_t size, size_t vertex_count)
+			{
+				if (size != vertex_count)
+				{
+					throw std::runtime_error("All vertex attributes must have the same number of elements before they can be packed");
+				}
+			}
+
+			template<class Field, class Source>
+			static void store(uint8_t* vertex_ptr, const Source& value)
+			{
+				const typename Field::type converted = VertexAttributeConverter<typename Field::type, Source>::convert(value);
+				memcpy(vertex_ptr + Field::offset, &converted, sizeof(converted));
+			}
+		};
+
+		template<class Vertex, class... Fields>
+		constexpr std::array<VertexAttributeLayout, sizeof...(Fields)> VertexLayout<Vertex, Fields...>::attributes;
+
+		//! Declares a VertexField for `member` of the struct `vertex`, holding the attribute `VertexAttribute::attribute`.
+		#define PL_VERTEX_FIELD(vertex, member, attribute) ::plume::geom::VertexField<::plume::geom::VertexAttribute::attribute, decltype(vertex::member), offsetof(vertex, member)>
+
+		//! The vertex struct that matches the default interleaved layout of Geometry (i.e. AttributeMode::MODE_INTERLEAVED
+		//! with a default VertexEncoding).
+		struct DefaultVertex
+		{
+			glm::vec3 position;
+			glm::vec3 color;
+			glm::vec3 normal;
+			glm::vec2 texture_coordinates;
+		};
+
+		using DefaultVertexLayout = VertexLayout<DefaultVertex,
+												 PL_VERTEX_FIELD(DefaultVertex, position, ATTRIBUTE_POSITION),
+												 PL_VERTEX_FIELD(DefaultVertex, color, ATTRIBUTE_COLOR),
+												 PL_VERTEX_FIELD(DefaultVertex, normal, ATTRIBUTE_NORMAL),
+												 PL_VERTEX_FIELD(DefaultVertex, texture_coordinates, ATTRIBUTE_TEXTURE_COORDINATES)>;
+
+		static_assert(DefaultVertexLayout::stride == 44, "The default vertex layout must match `Geometry::get_vertex_stride()`");
+
+	} // namespace geom
+
+} // namespace plume
@@ -0,0 +1,174 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include "Buffer.h"
+#include "Device.h"
+#include "Image.h"
+#include "Sampler.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		//! A BindlessHeap is a single, large descriptor set that contains an array of combined image samplers (at binding
+		//! `image_binding`) and an array of storage buffers (at binding `buffer_binding`). Resources are added to the heap 
+		//! once and referred to by their index thereafter, so materials that would otherwise each require their own 
+		//! descriptor set can all share the same set. Shaders index into the arrays with an ID that is passed as a push 
+		//! constant or as per-instance data:
+		//!
+		//!		#extension GL_EXT_nonuniform_qualifier : require
+		//!
+		//!		layout (set = 1, binding = 0) uniform sampler2D textures[];
+		//!		layout (set = 1, binding = 1) buffer materials_block { float data[]; } materials[];
+		//!
+		//!		vec4 albedo = texture(textures[nonuniformEXT(constants.material_id)], vs_texcoord);
+		//!
+		//! The heap requires the VK_EXT_descriptor_indexing device extension, along with the subset of its features listed
+		//! in `Device::DescriptorIndexingFeatures` (the device must be constructed with its instance, so that they can be 
+		//! queried). Both bindings are created with the
+		//! "update-after-bind" and "partially bound" flags, so descriptors can be added while the set is bound and 
+		//! unused array elements never need to be written. Pipelines that use the heap must be created with its layout 
+		//! (see `GraphicsPipeline::Options::descriptor_set_layout()`), since the sizes of unsized arrays can't be inferred.
+		//!
+		//! Removed indices are recycled through a free-list, but only after `frames_in_flight` calls to `next_frame()`, 
+		//! so that a descriptor is never overwritten while a command buffer that might reference it is still executing.
+		class BindlessHeap
+		{
+		public:
+
+			//! The binding of the combined image sampler array within the heap's descriptor set.
+			static const uint32_t image_binding = 0;
+
+			//! The binding of the storage buffer array within the heap's descriptor set.
+			static const uint32_t buffer_binding = 1;
+
+			//! Factory method for constructing a new shared BindlessHeap.
+			static std::shared_ptr<BindlessHeap> create(const Device& device, uint32_t max_images = 4096, uint32_t max_buffers = 1024, uint32_t frames_in_flight = 2)
+			{
+				return std::shared_ptr<BindlessHeap>(new BindlessHeap(device, max_images, max_buffers, frames_in_flight));
+			}
+
+			//! Returns the layout of the heap's descriptor set, which should be passed to any pipeline that uses the heap.
+			vk::DescriptorSetLayout get_layout_handle() const { return m_descriptor_set_layout_handle.get(); }
+
+			//! Returns the heap's descriptor set.
+			vk::DescriptorSet get_descriptor_set() const { return m_descriptor_set; }
+
+			//! Adds a combined image sampler to the heap and returns its index.
+			uint32_t add_image(const vk::DescriptorImageInfo& image_info);
+
+			uint32_t add_image(const ImageView& image_view, const Sampler& sampler, vk::ImageLayout image_layout = vk::ImageLayout::eShaderReadOnlyOptimal)
+			{
+				return add_image(image_view.build_descriptor_info(sampler, image_layout));
+			}
+
+			//! Adds a storage buffer to the heap and returns its index.
+			uint32_t add_buffer(const vk::DescriptorBufferInfo& buffer_info);
+
+			uint32_t add_buffer(const Buffer& buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE)
+			{
+				return add_buffer(buffer.build_descriptor_info(offset, range));
+			}
+
+			//! Replaces the combined image sampler at `index`. The previous descriptor must not be in use by the device.
+			void update_image(uint32_t index, const vk::DescriptorImageInfo& image_info);
+
+			//! Replaces the storage buffer at `index`. The previous descriptor must not be in use by the device.
+			void update_buffer(uint32_t index, const vk::DescriptorBufferInfo& buffer_info);
+
+			//! Removes the combined image sampler at `index` from the heap. The index will be recycled once it can no longer
+			//! be referenced by any frame-in-flight.
+			void remove_image(uint32_t index) { m_image_indices.retire(index, m_current_frame); }
+
+			//! Removes the storage buffer at `index` from the heap. The index will be recycled once it can no longer be 
+			//! referenced by any frame-in-flight.
+			void remove_buffer(uint32_t index) { m_buffer_indices.retire(index, m_current_frame); }
+
+			//! Advances the heap's frame counter and recycles any indices that were removed at least `frames_in_flight` 
+			//! frames ago. This should be called once per frame.
+			void next_frame();
+
+			//! Returns the maximum number of combined image samplers that the heap can hold.
+			uint32_t get_image_capacity() const { return m_image_indices.capacity; }
+
+			//! Returns the maximum number of storage buffers that the heap can hold.
+			uint32_t get_buffer_capacity() const { return m_buffer_indices.capacity; }
+
+			//! Returns the number of combined image samplers that are currently in the heap.
+			uint32_t get_image_count() const { return m_image_indices.get_count(); }
+
+			//! Returns the number of storage buffers that are currently in the heap.
+			uint32_t get_buffer_count() const { return m_buffer_indices.get_count(); }
+
+		private:
+
+			//! Constructs a heap with room for `max_images` combined image samplers and `max_buffers` storage buffers.
+			BindlessHeap(const Device& device, uint32_t max_images = 4096, uint32_t max_buffers = 1024, uint32_t frames_in_flight = 2);
+
+			//! Hands out array indices: recycled indices are preferred over fresh ones, in order to keep the range of 
+			//! indices that are in use (and therefore the number of descriptors that the device must consider) small.
+			struct IndexAllocator
+			{
+				uint32_t capacity = 0;
+				uint32_t next_index = 0;
+				std::vector<uint32_t> free_indices;
+				std::vector<std::pair<uint32_t, uint64_t>> retired_indices;
+
+				//! `true` for every index that has been allocated and not yet retired.
+				std::vector<bool> live;
+
+				uint32_t allocate();
+
+				void retire(uint32_t index, uint64_t frame);
+
+				void recycle(uint64_t current_frame, uint64_t frames_in_flight);
+
+				bool is_live(uint32_t index) const { return index < live.size() && live[index]; }
+
+				uint32_t get_count() const
+				{
+					return next_index - static_cast<uint32_t>(free_indices.size() + retired_indices.size());
+				}
+			};
+
+			const Device* m_device_ptr;
+			vk::UniqueDescriptorSetLayout m_descriptor_set_layout_handle;
+			vk::UniqueDescriptorPool m_descriptor_pool_handle;
+			vk::DescriptorSet m_descriptor_set;
+
+			IndexAllocator m_image_indices;
+			IndexAllocator m_buffer_indices;
+			uint32_t m_frames_in_flight;
+			uint64_t m_current_frame;
+		};
+
+	} // namespace graphics
+
+} // namespace plume
@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include "DeviceMemory.h"
 #include "Log.h"
 
@@ -52,7 +54,11 @@ namespace plume
 				   const std::vector<T>& data,
 				   const std::vector<QueueType> queues = { QueueType::GRAPHICS }) :
 
-				Buffer(device, buffer_usage_flags, sizeof(T) * data.size(), data.data(), queues) {}
+				Buffer(device, buffer_usage_flags, sizeof(T) * data.size(), data.data(), queues)
+			{
+				// Index buffers built from 16-bit data are bound with the matching index type by default.
+				m_index_type = std::is_same<T, uint16_t>::value ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+			}
 
 
 			Buffer(const Device& device,
@@ -74,25 +80,19 @@ namespace plume
 			//! allocation size, which can be queried from the buffer's device memory reference.
 			size_t get_requested_size() const { return m_requested_size; }
 
-			//! Uploads data to the buffer's device memory region. Note that if the device memory associated with this buffer is not marked
-			//! as vk::MemoryPropertyFlagBits::eHostCoherent, then you must use a flush command after writing to the memory.
+			//! Returns the type of the indices stored in this buffer, which is used by `CommandBuffer::bind_index_buffer()`
+			//! when no index type is specified. Defaults to vk::IndexType::eUint32.
+			vk::IndexType get_index_type() const { return m_index_type; }
+
+			//! Sets the type of the indices stored in this buffer (for example, to `Geometry::get_index_type()`).
+			void set_index_type(vk::IndexType index_type) { m_index_type = index_type; }
+
+			//! Uploads data to the buffer's device memory region. If the device memory associated with this buffer is not marked
+			//! as vk::MemoryPropertyFlagBits::eHostCoherent, the written range is flushed (see `write_immediately()`).
 			template<class T>
 			void upload_immediately(const T* data, size_t size, vk::DeviceSize offset = 0)
 			{
-				void* mapped_ptr = m_device_memory->map();
-				memcpy(mapped_ptr, data + offset, size);
-				m_device_memory->unmap();
-
-				// If the device memory associated with this buffer is not host coherent, we need to flush.
-				if (!m_device_memory->is_host_coherent())
-				{
-					vk::MappedMemoryRange mapped_memory_range;
-					mapped_memory_range.memory = m_device_memory->get_handle();
-					mapped_memory_range.offset = offset;
-					mapped_memory_range.size = size;
-
-					m_device_ptr->get_handle().flushMappedMemoryRanges(mapped_memory_range);
-				}
+				write_immediately([&](void* mapped_ptr) { memcpy(mapped_ptr, data, size); }, size, offset);
 			}
 
 			template<class T>
@@ -101,12 +101,28 @@ namespace plume
 				upload_immediately(data.data(), sizeof(T) * data.size(), offset);
 			}
 
+			//! Maps `size` bytes of the buffer's device memory, starting at byte `offset`, and invokes `func` with a pointer to 
+			//! the mapped region. This allows data to be generated or packed directly into the buffer (for example, with 
+			//! `Geometry::pack_vertex_attributes()`), rather than being built in an intermediate container and copied. If the 
+			//! memory is not host coherent, the enclosing `nonCoherentAtomSize` aligned range is flushed before it is unmapped.
+			void write_immediately(const std::function<void(void*)>& func, vk::DeviceSize size = VK_WHOLE_SIZE, vk::DeviceSize offset = 0);
+
+			//! Maps `size` bytes of the buffer's device memory, starting at byte `offset`, and invokes `func` with a pointer to 
+			//! the mapped region, so that results written by the device can be read back on the host. If the memory is not host
+			//! coherent, the enclosing `nonCoherentAtomSize` aligned range is invalidated before `func` is called. Note that the
+			//! caller must make sure that the device writes have completed (i.e. by waiting on a fence) beforehand.
+			void read_immediately(const std::function<void(const void*)>& func, vk::DeviceSize size = VK_WHOLE_SIZE, vk::DeviceSize offset = 0) const;
+
 			//! Returns a vk::DescriptorBufferInfo for this buffer object. By default, `offset` is set to zero, and `range` is set to
 			//! the special value VK_WHOLE_SIZE, meaning that the descriptor will access the entire extent of this buffer's memory.
 			vk::DescriptorBufferInfo build_descriptor_info(vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE) const;
 
 		private:
 
+			//! Returns the smallest range of this buffer's device memory that contains `size` bytes starting at byte `offset`
+			//! and that can legally be flushed or invalidated (i.e. aligned to `nonCoherentAtomSize`).
+			vk::MappedMemoryRange build_mapped_memory_range(vk::DeviceSize size, vk::DeviceSize offset) const;
+
 			const Device* m_device_ptr;
 			vk::UniqueBuffer m_buffer_handle;
 			std::unique_ptr<DeviceMemory> m_device_memory;
@@ -114,6 +130,7 @@ namespace plume
 			vk::BufferUsageFlags m_buffer_usage_flags;
 			vk::MemoryRequirements m_memory_requirements;
 			size_t m_requested_size;
+			vk::IndexType m_index_type = vk::IndexType::eUint32;
 		};
 
 	} // namespace graphics
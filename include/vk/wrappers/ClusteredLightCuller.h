@@ -0,0 +1,219 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Buffer.h"
+#include "CommandBuffer.h"
+#include "Culling.h"
+#include "DescriptorAllocator.h"
+#include "DescriptorWriter.h"
+#include "Pipeline.h"
+#include "Synchronization.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		//! Bins point lights into a 3D grid of view space clusters ("froxels"), so that forward shading only has to 
+		//! evaluate the lights that can actually reach each fragment. The screen is split into square tiles, and the 
+		//! view frustum behind each tile is split into exponentially distributed depth slices. A compute pass 
+		//! (`cluster_lights.comp`) tests every light's sphere of influence against the bounding box of every cluster 
+		//! and writes a compact list of light indices per cluster. The fragment shader (`pbr_clustered.frag`) then finds
+		//! the cluster that contains each fragment and loops over its list, so the cost of shading scales with the number
+		//! of lights that overlap a fragment rather than with the total number of lights in the scene.
+		//!
+		//! The light indices of all clusters share a single buffer that holds `average_lights_per_cluster` indices per 
+		//! cluster. If the lists don't fit, later clusters are truncated: `read_light_index_count()` returns the number
+		//! of indices that were requested, which can be used to pick a larger budget.
+		//!
+		//! A typical frame looks like:
+		//!
+		//!		culler->begin_frame(frame_index, fences[frame_index]);	// waits for the frame's fence, then syncs its region
+		//!		culler->update(view, projection, z_near, z_far);
+		//!		culler->record(command_buffer);					// outside of a render pass
+		//!		command_buffer.begin_render_pass(...);
+		//!		command_buffer.bind_descriptor_sets(pipeline, 1, { lighting_sets[frame_index] });	// see `write_lighting_descriptors()`
+		//!		...
+		//!
+		//! Like DynamicMesh, the light and parameter buffers are divided into one region per frame-in-flight, so the host
+		//! never writes to memory that a previous frame may still be reading. The light grid and light indices are only 
+		//! written on the device and are shared by every frame: the barriers inserted by `record()` order them between 
+		//! frames that are submitted to the same queue.
+		class ClusteredLightCuller
+		{
+		public:
+
+			//! Factory method for constructing a new shared ClusteredLightCuller.
+			static std::shared_ptr<ClusteredLightCuller> create(const Device& device, 
+																const std::shared_ptr<ShaderModule>& compute_shader_module, 
+																uint32_t max_lights, 
+																uint32_t width, 
+																uint32_t height, 
+																uint32_t tile_size = 64, 
+																uint32_t slice_count = 24, 
+																uint32_t average_lights_per_cluster = 32, 
+																uint32_t frames_in_flight = 2)
+			{
+				return std::shared_ptr<ClusteredLightCuller>(new ClusteredLightCuller(device, compute_shader_module, max_lights, width, height, tile_size, slice_count, average_lights_per_cluster, frames_in_flight));
+			}
+
+			//! Makes `frame_index` the current frame and brings the frame's light region up-to-date with all of the lights
+			//! that were set since the frame was last current. The caller must guarantee that the device is no longer using 
+			//! this frame's regions.
+			void begin_frame(uint32_t frame_index);
+
+			//! Waits for `fence` (which should be the fence that was signaled by the last submission of this frame) and then
+			//! calls `begin_frame()`.
+			void begin_frame(uint32_t frame_index, Fence& fence)
+			{
+				fence.wait_for();
+				begin_frame(frame_index);
+			}
+
+			//! Replaces the set of lights that are binned (and shaded). The lights are written to the current frame's region
+			//! right away, and to every other frame's region when that frame next begins.
+			void set_lights(const std::vector<geom::PointLight>& lights);
+
+			//! Replaces the light at `index`. The index must be less than the current light count.
+			void set_light(uint32_t index, const geom::PointLight& light);
+
+			//! Uploads the camera that the clusters are built for to the current frame's region. `z_near` and `z_far` should
+			//! match the distances that `projection` was built with.
+			void update(const glm::mat4& view, const glm::mat4& projection, float z_near, float z_far);
+
+			//! Records the binning pass for the current frame: waits for the previous frame's fragment shaders to finish 
+			//! reading the light lists, clears the light index count, dispatches the compute shader, and inserts the barrier
+			//! that makes the light lists visible to fragment shaders. This must be recorded outside of a render pass.
+			void record(CommandBuffer& command_buffer) const;
+
+			//! Writes the lights, the light grid, the light indices and the grid parameters of frame `frame_index` into `set`,
+			//! using the bindings that `pbr_clustered.frag` expects (0, 1, 2 and 4, respectively). Since the lights and 
+			//! parameters live in per-frame regions, a separate set is needed for every frame-in-flight.
+			void write_lighting_descriptors(DescriptorWriter& descriptor_writer, vk::DescriptorSet set, uint32_t frame_index) const;
+
+			//! Returns the total number of light indices that were requested by all of the clusters during the most recent
+			//! pass. The caller must ensure that the pass has finished executing.
+			uint32_t read_light_index_count() const;
+
+			uint32_t get_light_count() const { return m_light_count; }
+
+			uint32_t get_max_lights() const { return m_max_lights; }
+
+			uint32_t get_cluster_count() const { return m_cluster_count; }
+
+			uint32_t get_light_index_capacity() const { return m_light_index_capacity; }
+
+			//! Returns the number of frames-in-flight, each of which owns a separate region of the light and parameter buffers.
+			uint32_t get_frames_in_flight() const { return static_cast<uint32_t>(m_frames.size()); }
+
+			//! Returns the index of the frame whose regions are currently written to and binned.
+			uint32_t get_current_frame_index() const { return m_current_frame_index; }
+
+			const Buffer& get_light_buffer() const { return *m_light_buffer; }
+
+			const Buffer& get_light_grid_buffer() const { return *m_light_grid_buffer; }
+
+			const Buffer& get_light_index_buffer() const { return *m_light_index_buffer; }
+
+			const Buffer& get_parameters_buffer() const { return *m_parameters_buffer; }
+
+		private:
+
+			//! Constructs a culler for up to `max_lights` lights and a `width` x `height` framebuffer, which is split into 
+			//! `tile_size` x `tile_size` pixel tiles and `slice_count` depth slices. `compute_shader_module` must contain 
+			//! `cluster_lights.comp`. The grid is fixed at construction, so a new culler must be created if the framebuffer
+			//! is resized.
+			ClusteredLightCuller(const Device& device, 
+								 const std::shared_ptr<ShaderModule>& compute_shader_module, 
+								 uint32_t max_lights, 
+								 uint32_t width, 
+								 uint32_t height, 
+								 uint32_t tile_size = 64, 
+								 uint32_t slice_count = 24, 
+								 uint32_t average_lights_per_cluster = 32, 
+								 uint32_t frames_in_flight = 2);
+
+			//! The range `[begin, end)` of lights that have changed since a frame's region was last brought up-to-date.
+			struct DirtyRange
+			{
+				void add(size_t first, size_t count);
+
+				bool is_empty() const { return begin == end; }
+
+				size_t begin = 0;
+				size_t end = 0;
+			};
+
+			struct FrameRegion
+			{
+				vk::DescriptorSet descriptor_set;
+				DirtyRange lights;
+			};
+
+			vk::DeviceSize get_light_region_offset(uint32_t frame_index) const { return frame_index * m_light_region_size; }
+
+			vk::DeviceSize get_parameters_region_offset(uint32_t frame_index) const { return frame_index * m_parameters_region_size; }
+
+			//! Uploads lights from the CPU-side copy into the current frame's region and marks them dirty for all other frames.
+			void commit_lights(size_t first_light, size_t light_count);
+
+			const Device* m_device_ptr;
+			uint32_t m_max_lights;
+			uint32_t m_light_count = 0;
+			uint32_t m_current_frame_index = 0;
+			uint32_t m_width;
+			uint32_t m_height;
+			uint32_t m_tile_size;
+			uint32_t m_slice_count;
+			uint32_t m_cluster_count;
+			uint32_t m_light_index_capacity;
+
+			//! The size of each frame's region, rounded up to the device's minimum offset alignment for the buffer's usage.
+			vk::DeviceSize m_light_region_size;
+			vk::DeviceSize m_parameters_region_size;
+
+			ComputePipeline m_pipeline;
+			std::shared_ptr<DescriptorAllocator> m_descriptor_allocator;
+
+			std::vector<geom::PointLight> m_lights;
+			std::vector<FrameRegion> m_frames;
+
+			std::unique_ptr<Buffer> m_light_buffer;
+			std::unique_ptr<Buffer> m_light_grid_buffer;
+			std::unique_ptr<Buffer> m_light_index_buffer;
+			std::unique_ptr<Buffer> m_light_index_count_buffer;
+			std::unique_ptr<Buffer> m_parameters_buffer;
+		};
+
+	} // namespace graphics
+
+} // namespace plume
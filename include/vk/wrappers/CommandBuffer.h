@@ -38,6 +38,8 @@ namespace plume
 	namespace graphics
 	{
 
+		class DescriptorAllocator;
+
 		//! Command buffers are objects used to record commands which can be subsequently submitted to a device
 		//! queue for execution. When a command buffer begins recording, all state in that command buffer is 
 		//! undefined. Unless otherwise specified, and without explicit synchronization, the various commands 
@@ -64,8 +66,9 @@ namespace plume
 			//! A struct for aggregating the parameters passed to non-indexed drawing commands.
 			struct DrawParamsNonIndexed
 			{
-				DrawParamsNonIndexed(uint32_t vertex_count) :
-					m_vertex_count(vertex_count)
+				DrawParamsNonIndexed(uint32_t vertex_count, uint32_t instance_count = 1) :
+					m_vertex_count(vertex_count),
+					m_instance_count(instance_count)
 				{}
 
 				uint32_t m_vertex_count = 1;	// The number of vertices to draw.
@@ -77,8 +80,9 @@ namespace plume
 			//! A struct for aggregating the parameters passed to indexed drawing commands.
 			struct DrawParamsIndexed
 			{
-				DrawParamsIndexed(uint32_t index_count) :
-					m_index_count(index_count)
+				DrawParamsIndexed(uint32_t index_count, uint32_t instance_count = 1) :
+					m_index_count(index_count),
+					m_instance_count(instance_count)
 				{}
 
 				uint32_t m_index_count = 1;		// The number of vertices to draw.
@@ -149,8 +153,12 @@ namespace plume
 			//! Binds the specified vertex buffers for use in subsequent draw commands.
 			void bind_vertex_buffer(const Buffer& buffer, uint32_t binding = 0, vk::DeviceSize offset = 0);
 
-			//! Binds the specified index buffer for use in subsequent indexed draw commands.
-			void bind_index_buffer(const Buffer& buffer, uint32_t offset = 0, vk::IndexType index_type = vk::IndexType::eUint32);
+			//! Binds the specified index buffer for use in subsequent indexed draw commands. The indices are interpreted 
+			//! according to the buffer's index type (see `Buffer::set_index_type()`).
+			void bind_index_buffer(const Buffer& buffer, uint32_t offset = 0) { bind_index_buffer(buffer, offset, buffer.get_index_type()); }
+
+			//! Binds the specified index buffer for use in subsequent indexed draw commands, overriding the buffer's index type.
+			void bind_index_buffer(const Buffer& buffer, uint32_t offset, vk::IndexType index_type);
 
 			//! Update a series of push constants, starting at the specified offset. Note that 
 			//! all push constants are undefined at the start of a command buffer.
@@ -178,12 +186,62 @@ namespace plume
 			//! Binds the specified descriptor sets.
 			void bind_descriptor_sets(const Pipeline& pipeline, uint32_t first_set, const std::vector<vk::DescriptorSet>& descriptor_sets, const std::vector<uint32_t>& dynamic_offsets = {});
 
+			//! Records the descriptor writes in `writes` directly into the command buffer as the contents of the set at index
+			//! `set`, without allocating or updating a descriptor set. The `dstSet` member of each write is ignored. This 
+			//! requires the VK_KHR_push_descriptor device extension and a pipeline whose layout for `set` was created with 
+			//! the push descriptor flag (see `DescriptorSetLayoutBuilder::begin_push_descriptor_set_record()` and 
+			//! `GraphicsPipeline::Options::descriptor_set_layout()`).
+			//!
+			//! If the extension is not enabled, or `Pipeline::is_push_descriptor_set()` returns `false` for `set`, a transient 
+			//! descriptor set is allocated from the allocator passed to `set_push_descriptor_fallback()`, updated, and bound instead.
+			void push_descriptor_set(const Pipeline& pipeline, uint32_t set, const std::vector<vk::WriteDescriptorSet>& writes);
+
+			//! A convenience version of `push_descriptor_set()` that takes buffer and image infos keyed by binding. The 
+			//! descriptor type of each binding is retrieved from the pipeline's reflected descriptor set layout bindings.
+			void push_descriptor_set(const Pipeline& pipeline, 
+									 uint32_t set, 
+									 const std::map<uint32_t, vk::DescriptorBufferInfo>& buffer_infos, 
+									 const std::map<uint32_t, vk::DescriptorImageInfo>& image_infos = {});
+
+			//! Sets the allocator that transient descriptor sets are allocated from when `push_descriptor_set()` is called
+			//! on a device that doesn't support VK_KHR_push_descriptor. This should be the per-frame allocator whose
+			//! current frame corresponds to the frame that this command buffer is recorded for.
+			void set_push_descriptor_fallback(const std::shared_ptr<DescriptorAllocator>& allocator) { m_push_descriptor_fallback = allocator; }
+
 			//! Issue a non-indexed draw command.
 			void draw(const DrawParamsNonIndexed& draw_params);
 
 			//! Issue an indexed draw command.
 			void draw_indexed(const DrawParamsIndexed& draw_params);
 
+			//! Issue `draw_count` indexed draw commands whose parameters are read from `buffer` (as tightly packed
+			//! vk::DrawIndexedIndirectCommand structs, by default), starting at byte `offset`. The buffer must have been 
+			//! created with the vk::BufferUsageFlagBits::eIndirectBuffer bit set.
+			void draw_indexed_indirect(const Buffer& buffer, uint32_t draw_count, vk::DeviceSize offset = 0, uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand));
+
+			//! Issue indexed draw commands whose parameters are read from `buffer`, like `draw_indexed_indirect()`, but read 
+			//! the number of draws from a uint32_t in `count_buffer` at byte `count_offset` when the command executes. At most 
+			//! `max_draw_count` draws are issued. This requires the VK_KHR_draw_indirect_count (or VK_AMD_draw_indirect_count) 
+			//! device extension: see `supports_draw_indirect_count()`.
+			void draw_indexed_indirect_count(const Buffer& buffer, 
+											 const Buffer& count_buffer, 
+											 uint32_t max_draw_count, 
+											 vk::DeviceSize offset = 0, 
+											 vk::DeviceSize count_offset = 0, 
+											 uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand));
+
+			//! Returns `true` if `draw_indexed_indirect_count()` can be recorded, i.e. if one of the draw indirect count
+			//! extensions was enabled when the logical device was created.
+			bool supports_draw_indirect_count() const;
+
+			//! Dispatch the currently bound compute pipeline with the specified number of local workgroups.
+			void dispatch(uint32_t group_count_x, uint32_t group_count_y = 1, uint32_t group_count_z = 1);
+
+			//! Fill `size` bytes of `buffer`, starting at byte `offset`, with repeated copies of the 32-bit word `data`. Both
+			//! `offset` and `size` must be multiples of 4 (or `size` must be VK_WHOLE_SIZE). The buffer must have been 
+			//! created with the vk::BufferUsageFlagBits::eTransferDst bit set.
+			void fill_buffer(const Buffer& buffer, uint32_t data, vk::DeviceSize offset = 0, vk::DeviceSize size = VK_WHOLE_SIZE);
+
 			//! Stop recording the commands for a render pass' final subpass.
 			void end_render_pass();
 
@@ -223,6 +281,20 @@ namespace plume
 				get_handle().resetEvent(event.get_handle(), stage_flags);
 			}
 
+			//! Resets `query_count` queries of `query_pool`, starting at `first_query`. Queries must be reset before they are
+			//! written, and this must be recorded outside of a render pass.
+			void reset_query_pool(vk::QueryPool query_pool, uint32_t first_query, uint32_t query_count)
+			{
+				get_handle().resetQueryPool(query_pool, first_query, query_count);
+			}
+
+			//! Writes the device's timestamp into query `query` of `query_pool` once all previous commands have reached
+			//! `stage_flag_bits`. Timestamps are measured in units of vk::PhysicalDeviceLimits::timestampPeriod nanoseconds.
+			void write_timestamp(vk::PipelineStageFlagBits stage_flag_bits, vk::QueryPool query_pool, uint32_t query)
+			{
+				get_handle().writeTimestamp(stage_flag_bits, query_pool, query);
+			}
+
 			/*
 			 * Common synchronization use cases, expressed as pipeline barriers.
 			 *
@@ -256,6 +328,18 @@ namespace plume
 			//! a WAR (write-after-read) hazard.
 			void barrier_compute_read_storage_buffer_compute_write_storage_buffer();
 
+			//! Creates a pipeline barrier representing a compute shader dispatch that reads from a storage image followed
+			//! by a compute shader dispatch that overwrites the entire image. The image's previous contents are discarded
+			//! (it is transitioned from vk::ImageLayout::eUndefined to vk::ImageLayout::eGeneral), so this can also be
+			//! used the first time that the image is written. This avoids a WAR (write-after-read) hazard.
+			void barrier_compute_read_storage_image_compute_overwrite_storage_image(const Image& image,
+																					const vk::ImageSubresourceRange& image_subresource_range = Image::build_single_layer_subresource());
+
+			//! Creates a pipeline barrier representing a transfer command (i.e. `fill_buffer()`) that writes to a
+			//! buffer followed by a compute shader dispatch that reads from and/or writes to that same buffer as
+			//! a storage buffer. This avoids RAW (read-after-write) and WAW (write-after-write) hazards.
+			void barrier_transfer_write_compute_read_write_storage_buffer();
+
 			//! Creates a pipeline barrier representing a compute shader dispatch that writes into a storage
 			//! buffer followed by a draw command that consumes that buffer as an index buffer. This avoids
 			//! a RAW (read-after-write) hazard.
@@ -266,6 +350,23 @@ namespace plume
 			//! avoids a RAW (read-after-write) hazard.
 			void barrier_compute_write_storage_buffer_graphics_read_as_draw_indirect();
 
+			//! Creates a pipeline barrier representing a draw command that consumes a buffer as a draw indirect buffer
+			//! followed by a transfer command (i.e. `fill_buffer()`) that writes to that same buffer. This avoids a WAR
+			//! (write-after-read) hazard, so only an execution dependency is needed.
+			void barrier_graphics_read_as_draw_indirect_transfer_write();
+
+			//! Creates a pipeline barrier representing a draw command that reads from a storage buffer in one or more of its
+			//! shader stages followed by a compute shader dispatch that writes into that same buffer. By default, the buffer 
+			//! is assumed to be read in the fragment shader. This avoids a WAR (write-after-read) hazard, so only an execution
+			//! dependency is needed.
+			void barrier_graphics_read_compute_write_storage_buffer(vk::PipelineStageFlags read_stage_flags = vk::PipelineStageFlagBits::eFragmentShader);
+
+			//! Creates a pipeline barrier representing a compute shader dispatch that writes into a storage
+			//! buffer followed by a draw command that reads from that buffer (as a storage or uniform buffer)
+			//! in one or more of its shader stages. By default, the buffer is assumed to be read in the fragment
+			//! shader. This avoids a RAW (read-after-write) hazard.
+			void barrier_compute_write_storage_buffer_graphics_read(vk::PipelineStageFlags read_stage_flags = vk::PipelineStageFlagBits::eFragmentShader);
+
 			//! Creates a pipeline barrier representing a compute shader dispatch that writes into a storage
 			//! image followed by a draw command that samples that image in one or more of its subsequent shader
 			//! stages. This avoids a RAW (read-after-write) hazard.
@@ -291,6 +392,12 @@ namespace plume
 			void barrier_graphics_write_depth_attachment_compute_read(const Image& image,
 																	  const vk::ImageSubresourceRange& image_subresource_range = Image::build_single_layer_subresource());
 
+			//! Creates a pipeline barrier representing a compute shader dispatch that reads from a depth image
+			//! (i.e. after `barrier_graphics_write_depth_attachment_compute_read()`) followed by a draw command
+			//! that uses that image as a depth attachment again. This avoids a WAR (write-after-read) hazard.
+			void barrier_compute_read_graphics_write_depth_attachment(const Image& image,
+																	  const vk::ImageSubresourceRange& image_subresource_range = Image::build_single_layer_subresource());
+
 			//! Creates a pipeline barrier representing a draw command that writes to a depth attachment
 			//! followed by another draw command that samples that image in one or more of its subsequent
 			//! shader stages. This is useful for shadow map rendering. This avoids a RAW (read-after-write) 
@@ -349,6 +456,12 @@ namespace plume
 			vk::CommandBufferLevel m_command_buffer_level;
 			bool m_is_recording;
 			bool m_is_inside_render_pass;
+
+			std::shared_ptr<DescriptorAllocator> m_push_descriptor_fallback;
+			PFN_vkCmdPushDescriptorSetKHR m_push_descriptor_set_proc = nullptr;
+
+			// The KHR and AMD versions of the draw indirect count extension share the same signature.
+			PFN_vkCmdDrawIndexedIndirectCountAMD m_draw_indexed_indirect_count_proc = nullptr;
 		};
 
 		class ScopedRecord
@@ -0,0 +1,185 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <cmath>
+
+#include "DescriptorPool.h"
+#include "Synchronization.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		//! A descriptor allocator manages a growable chain of descriptor pools, so that descriptor set allocations
+		//! never fail because a single pool ran out of space. When the current pool is exhausted (either according 
+		//! to the allocator's own bookkeeping or because the driver returned vk::Result::eErrorOutOfPoolMemoryKHR or
+		//! vk::Result::eErrorFragmentedPool), the allocator simply moves on to the next pool in the chain, creating
+		//! a new one if necessary. New pools are sized from the descriptor usage that the allocator has observed 
+		//! so far, and each new pool can hold twice as many sets as the previous one (up to a fixed limit).
+		//!
+		//! There are two kinds of allocations:
+		//!
+		//! 1) Persistent descriptor sets, allocated with `allocate()`, which live for as long as the allocator.
+		//! 2) Transient descriptor sets, allocated with `allocate_transient()`, which are only valid for the frame
+		//!    in which they were allocated. Each frame-in-flight owns its own pool chain, which is reset wholesale
+		//!    (with a single call to vkResetDescriptorPool per pool) by `begin_frame()`. This makes per-draw
+		//!    descriptor sets very cheap.
+		//!
+		//! A typical frame looks like:
+		//!
+		//!		allocator->begin_frame(frame_index, fences[frame_index]);	// waits for the frame's fence, then resets
+		//!		auto set = allocator->allocate_transient(builder, 0);		
+		//!		...
+		class DescriptorAllocator
+		{
+		public:
+
+			//! Factory method for constructing a new shared DescriptorAllocator.
+			static std::shared_ptr<DescriptorAllocator> create(const Device& device, uint32_t frames_in_flight = 2, uint32_t initial_sets_per_pool = 64)
+			{
+				return std::shared_ptr<DescriptorAllocator>(new DescriptorAllocator(device, frames_in_flight, initial_sets_per_pool));
+			}
+
+			//! Allocates a persistent descriptor set for the set at index `set` that was recorded into `builder`. Throws if
+			//! the set was recorded as a push descriptor set, since those are never allocated.
+			vk::DescriptorSet allocate(const std::shared_ptr<DescriptorSetLayoutBuilder>& builder, uint32_t set)
+			{
+				if (builder->is_push_descriptor_set(set))
+				{
+					throw std::runtime_error("Descriptor sets with a push descriptor layout cannot be allocated from a DescriptorAllocator");
+				}
+
+				return allocate(builder->get_cached_layout_for_set(set), builder->get_bindings_for_set(set));
+			}
+
+			//! Allocates a persistent descriptor set with the specified `layout`. The `bindings` are the layout 
+			//! bindings that were used to create `layout`: they are used to track how many descriptors of each
+			//! type the allocation consumes.
+			vk::DescriptorSet allocate(vk::DescriptorSetLayout layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+			{
+				return allocate_from_chain(m_persistent_chain, layout, bindings);
+			}
+
+			//! Allocates a transient descriptor set for the set at index `set` that was recorded into `builder`. The 
+			//! descriptor set is only valid until the next call to `begin_frame()` with the current frame index.
+			vk::DescriptorSet allocate_transient(const std::shared_ptr<DescriptorSetLayoutBuilder>& builder, uint32_t set)
+			{
+				if (builder->is_push_descriptor_set(set))
+				{
+					throw std::runtime_error("Descriptor sets with a push descriptor layout cannot be allocated from a DescriptorAllocator");
+				}
+
+				return allocate_transient(builder->get_cached_layout_for_set(set), builder->get_bindings_for_set(set));
+			}
+
+			//! Allocates a transient descriptor set with the specified `layout`. See `allocate()` for a description
+			//! of the `bindings` parameter.
+			vk::DescriptorSet allocate_transient(vk::DescriptorSetLayout layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+			{
+				return allocate_from_chain(m_frame_chains[m_current_frame_index], layout, bindings);
+			}
+
+			//! Makes `frame_index` the current frame and resets all of the pools that were used for transient 
+			//! allocations the last time this frame index was current. The caller must guarantee that the device 
+			//! is no longer using any descriptor sets allocated during that frame.
+			void begin_frame(uint32_t frame_index);
+
+			//! Waits for `fence` (which should be the fence that was signaled by the last submission of this 
+			//! frame) and then calls `begin_frame()`.
+			void begin_frame(uint32_t frame_index, Fence& fence)
+			{
+				fence.wait_for();
+				begin_frame(frame_index);
+			}
+
+			//! Returns the number of frames-in-flight, each of which owns a separate pool chain.
+			uint32_t get_frames_in_flight() const { return static_cast<uint32_t>(m_frame_chains.size()); }
+
+			//! Returns the index of the frame that transient allocations are currently made from.
+			uint32_t get_current_frame_index() const { return m_current_frame_index; }
+
+			//! Returns the total number of descriptor pools that have been created by this allocator.
+			size_t get_pool_count() const;
+
+		private:
+
+			//! Constructs an allocator with `frames_in_flight` transient pool chains. The first pool created by 
+			//! each chain will be large enough to hold `initial_sets_per_pool` descriptor sets.
+			DescriptorAllocator(const Device& device, uint32_t frames_in_flight = 2, uint32_t initial_sets_per_pool = 64);
+
+			//! A single descriptor pool, along with the bookkeeping needed to decide whether or not an allocation
+			//! will fit before ever calling into the driver.
+			struct PoolInternals
+			{
+				vk::UniqueDescriptorPool handle;
+				uint32_t max_sets;
+				uint32_t available_sets;
+				std::map<vk::DescriptorType, uint32_t> capacity_mapping;
+				std::map<vk::DescriptorType, uint32_t> available_mapping;
+			};
+
+			//! An ordered list of pools. Allocations are always made from the pool at `current`: earlier pools
+			//! are considered full, and later pools are empty pools that are waiting to be reused after a reset.
+			struct PoolChain
+			{
+				std::vector<PoolInternals> pools;
+				size_t current = 0;
+			};
+
+			//! Returns the number of descriptors of each type that are required by a set with the specified `bindings`.
+			static std::map<vk::DescriptorType, uint32_t> count_descriptors(const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+
+			//! Returns `true` if the allocator's bookkeeping indicates that a set with the specified descriptor counts will fit in `pool`.
+			static bool can_fit(const PoolInternals& pool, const std::map<vk::DescriptorType, uint32_t>& descriptor_counts);
+
+			vk::DescriptorSet allocate_from_chain(PoolChain& chain, vk::DescriptorSetLayout layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+
+			//! Creates a new descriptor pool that is sized according to the observed descriptor usage. The pool is 
+			//! guaranteed to be large enough to hold at least one set with the specified descriptor counts.
+			PoolInternals create_pool(const std::map<vk::DescriptorType, uint32_t>& descriptor_counts);
+
+			//! Resets every pool in `chain` and rewinds the chain to its first pool.
+			void reset_chain(PoolChain& chain);
+
+			const Device* m_device_ptr;
+
+			PoolChain m_persistent_chain;
+			std::vector<PoolChain> m_frame_chains;
+			uint32_t m_current_frame_index;
+			uint32_t m_next_sets_per_pool;
+
+			// The total number of sets and descriptors (per type) that have ever been requested from this allocator.
+			uint64_t m_observed_sets;
+			std::map<vk::DescriptorType, uint64_t> m_observed_descriptors_mapping;
+		};
+
+	} // namespace graphics
+
+} // namespace plume
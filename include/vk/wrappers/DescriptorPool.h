@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <set>
+
 #include "Device.h"
 
 namespace plume
@@ -64,6 +66,22 @@ namespace plume
 				m_is_recording = true;
 			}
 
+			//! Begin recording bindings into a new set whose layout will be created with the push descriptor flag, if the 
+			//! VK_KHR_push_descriptor device extension is enabled. Push descriptor sets are never allocated: instead, their
+			//! contents are recorded directly into a command buffer with `CommandBuffer::push_descriptor_set()`. If the 
+			//! extension is not available, the set is recorded as an ordinary descriptor set so that it can be allocated 
+			//! from a DescriptorAllocator instead (see `is_push_descriptor_set()`).
+			void begin_push_descriptor_set_record(uint32_t set)
+			{
+				begin_descriptor_set_record(set);
+
+				if (m_device_ptr->is_device_extension_enabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+				{
+					m_cached_layouts_mapping.erase(set);
+					m_push_descriptor_sets.insert(set);
+				}
+			}
+
 			//! End recording into the current set.
 			void end_descriptor_set_record()
 			{
@@ -124,10 +142,25 @@ namespace plume
 			//! exception if the set at the specified index does not exist.
 			vk::DescriptorSetLayout build_layout_for_set(uint32_t set) const;
 
+			//! Returns a descriptor set layout for the set at the specified index `set` that is owned by this 
+			//! DescriptorSetLayoutBuilder. Unlike `build_layout_for_set()`, the layout is only created once: 
+			//! subsequent calls return the same handle until the set is modified or the builder is reset. This
+			//! is the preferred way to retrieve layouts for repeated descriptor set allocations.
+			vk::DescriptorSetLayout get_cached_layout_for_set(uint32_t set) const;
+
+			//! Returns `true` if the set at index `set` was recorded with `begin_push_descriptor_set_record()` and its
+			//! layout will be created with the push descriptor flag, and `false` otherwise.
+			bool is_push_descriptor_set(uint32_t set) const
+			{
+				return m_push_descriptor_sets.find(set) != m_push_descriptor_sets.end();
+			}
+
 			//! Clears all previously recorded descriptor sets and descriptor set layout bindings.
 			void reset()
 			{
+				m_cached_layouts_mapping.clear();
 				m_descriptor_sets_mapping.clear();
+				m_push_descriptor_sets.clear();
 				m_current_set = 0;
 				m_is_recording = false;
 			}
@@ -210,11 +243,19 @@ namespace plume
 			{
 			}
 
+			//! Returns the flags that the descriptor set layout for the set at index `set` should be created with.
+			vk::DescriptorSetLayoutCreateFlags get_layout_flags_for_set(uint32_t set) const
+			{
+				return is_push_descriptor_set(set) ? vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR : vk::DescriptorSetLayoutCreateFlags{};
+			}
+
 			const Device* m_device_ptr;
 
 			uint32_t m_current_set;
 			bool m_is_recording;
+			std::set<uint32_t> m_push_descriptor_sets;
 			std::map<uint32_t, std::vector<vk::DescriptorSetLayoutBinding>> m_descriptor_sets_mapping;
+			mutable std::map<uint32_t, vk::UniqueDescriptorSetLayout> m_cached_layouts_mapping;
 
 			friend class DescriptorPool;
 		};
@@ -277,13 +318,17 @@ namespace plume
 						throw std::runtime_error("One or more of the requested descriptor set indices was not found in the DescriptorSetLayoutBuilder's\
 											      map of recorded descriptor sets");
 					}
+					if (builder->is_push_descriptor_set(set_index))
+					{
+						throw std::runtime_error("Descriptor sets with a push descriptor layout cannot be allocated from a DescriptorPool");
+					}
 				}
 
 				// Build a descriptor set layout object for each of the requested sets.
 				std::vector<vk::DescriptorSetLayout> requested_layouts;
 				for (auto set_index : set_indices)
 				{
-					requested_layouts.push_back(builder->build_layout_for_set(set_index));
+					requested_layouts.push_back(builder->get_cached_layout_for_set(set_index));
 
 					// Update this pool's internal mapping structure to reflect the new allocation(s). In other 
 					// words, if this allocation requests 2 uniform buffers, subtract 2 from the current value
@@ -321,8 +366,6 @@ namespace plume
 					requested_layouts.data()							// descriptor set layout
 				};
 
-				// TODO: the descriptor set layouts created above need to either be destroyed or cached.
-
 				// Allocate the descriptor sets.
 				return m_device_ptr->get_handle().allocateDescriptorSets(descriptor_set_allocate_info);
 			}
@@ -0,0 +1,234 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <unordered_map>
+
+#include "DescriptorAllocator.h"
+#include "DescriptorWriter.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		//! A DescriptorSetCache returns descriptor sets based on their contents, rather than on their identity. Each
+		//! request is hashed from the descriptor set layout and the handles of all of the resources that are bound to it
+		//! (buffers, offsets, and ranges; samplers, image views, and layouts; texel buffer views). If an identical set has 
+		//! already been allocated and written, that set is returned directly. Otherwise, a set is allocated (or recycled),
+		//! written once, and inserted into the cache. In steady state, this means that no descriptor sets are allocated or 
+		//! updated at all, even if the application "rebuilds" the same sets every frame.
+		//!
+		//! Entries are kept in least-recently-used order. An entry is evicted when:
+		//!
+		//! 1) it hasn't been requested for more than `max_unused_frames` frames (see `next_frame()`)
+		//! 2) the cache holds more than `max_entries` entries, in which case the least recently used entry is evicted
+		//! 3) one of the resources that it references is about to be destroyed (see `invalidate_buffer()`, etc.)
+		//!
+		//! Evicted descriptor sets are never freed. Instead, they are retired and reused for future cache misses with the 
+		//! same layout once the device can no longer be using them (i.e. after the allocator's number of frames-in-flight).
+		class DescriptorSetCache
+		{
+		public:
+
+			//! A list of the resources that should be bound to a descriptor set. This is used both to look up an existing
+			//! descriptor set and to write a new one on a cache miss.
+			class ResourceList
+			{
+			public:
+
+				ResourceList& add_buffer(uint32_t binding, vk::DescriptorType type, const vk::DescriptorBufferInfo& buffer_info, uint32_t array_element = 0);
+
+				ResourceList& add_image(uint32_t binding, vk::DescriptorType type, const vk::DescriptorImageInfo& image_info, uint32_t array_element = 0);
+
+				ResourceList& add_texel_buffer(uint32_t binding, vk::DescriptorType type, vk::BufferView buffer_view, uint32_t array_element = 0);
+
+				/*
+				 *
+				 * Some useful shortcuts - all of these call one of the functions above and simply fill out the descriptor type.
+				 *
+				 */
+				ResourceList& add_ubo(uint32_t binding, const Buffer& buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE)
+				{
+					return add_buffer(binding, vk::DescriptorType::eUniformBuffer, buffer.build_descriptor_info(offset, range));
+				}
+
+				ResourceList& add_ssbo(uint32_t binding, const Buffer& buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE)
+				{
+					return add_buffer(binding, vk::DescriptorType::eStorageBuffer, buffer.build_descriptor_info(offset, range));
+				}
+
+				ResourceList& add_cis(uint32_t binding, const ImageView& image_view, const Sampler& sampler, vk::ImageLayout image_layout = vk::ImageLayout::eShaderReadOnlyOptimal)
+				{
+					return add_image(binding, vk::DescriptorType::eCombinedImageSampler, image_view.build_descriptor_info(sampler, image_layout));
+				}
+
+			private:
+
+				//! A single bound resource. The meaning of the three handles depends on the descriptor type: 
+				//! {buffer, offset, range}, {sampler, image view, image layout}, or {buffer view, 0, 0}.
+				struct Record
+				{
+					uint32_t binding;
+					uint32_t array_element;
+					vk::DescriptorType type;
+					uint64_t handles[3];
+
+					bool operator==(const Record& other) const
+					{
+						return binding == other.binding &&
+							array_element == other.array_element &&
+							type == other.type &&
+							handles[0] == other.handles[0] &&
+							handles[1] == other.handles[1] &&
+							handles[2] == other.handles[2];
+					}
+				};
+
+				std::vector<Record> m_records;
+
+				friend class DescriptorSetCache;
+			};
+
+			//! Factory method for constructing a new shared DescriptorSetCache.
+			static std::shared_ptr<DescriptorSetCache> create(const Device& device, 
+															  const std::shared_ptr<DescriptorAllocator>& allocator, 
+															  uint32_t max_unused_frames = 8, 
+															  size_t max_entries = 4096)
+			{
+				return std::shared_ptr<DescriptorSetCache>(new DescriptorSetCache(device, allocator, max_unused_frames, max_entries));
+			}
+
+			//! Returns a descriptor set for the set at index `set` of `builder` with the specified resources bound to it.
+			vk::DescriptorSet get(const std::shared_ptr<DescriptorSetLayoutBuilder>& builder, uint32_t set, const ResourceList& resources)
+			{
+				return get(builder->get_cached_layout_for_set(set), builder->get_bindings_for_set(set), resources);
+			}
+
+			//! Returns a descriptor set with the specified `layout` and resources bound to it. The `bindings` are the layout
+			//! bindings that were used to create `layout`: they are only used if a new descriptor set must be allocated.
+			vk::DescriptorSet get(vk::DescriptorSetLayout layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const ResourceList& resources);
+
+			//! Advances the cache's frame counter. Entries that haven't been requested for more than `max_unused_frames` 
+			//! frames are evicted, and retired descriptor sets that are no longer in use by the device become available 
+			//! for reuse. This should be called once per frame.
+			void next_frame();
+
+			//! Evicts every entry that references `buffer`. This must be called before the buffer is destroyed.
+			void invalidate_buffer(vk::Buffer buffer) { invalidate_handle(handle_to_key(static_cast<VkBuffer>(buffer))); }
+
+			//! Evicts every entry that references `image_view`. This must be called before the image view is destroyed.
+			void invalidate_image_view(vk::ImageView image_view) { invalidate_handle(handle_to_key(static_cast<VkImageView>(image_view))); }
+
+			//! Evicts every entry that references `sampler`. This must be called before the sampler is destroyed.
+			void invalidate_sampler(vk::Sampler sampler) { invalidate_handle(handle_to_key(static_cast<VkSampler>(sampler))); }
+
+			//! Evicts every entry that references `buffer_view`. This must be called before the buffer view is destroyed.
+			void invalidate_buffer_view(vk::BufferView buffer_view) { invalidate_handle(handle_to_key(static_cast<VkBufferView>(buffer_view))); }
+
+			//! Evicts every entry in the cache.
+			void clear();
+
+			//! Returns the number of descriptor sets that are currently cached.
+			size_t get_entry_count() const { return m_entries.size(); }
+
+			//! Returns the number of requests that were satisfied by an existing descriptor set.
+			uint64_t get_hit_count() const { return m_hit_count; }
+
+			//! Returns the number of requests that required a descriptor set to be written.
+			uint64_t get_miss_count() const { return m_miss_count; }
+
+		private:
+
+			DescriptorSetCache(const Device& device, const std::shared_ptr<DescriptorAllocator>& allocator, uint32_t max_unused_frames = 8, size_t max_entries = 4096);
+
+			struct Entry
+			{
+				vk::DescriptorSetLayout layout;
+				std::vector<ResourceList::Record> records;
+				size_t hash;
+				vk::DescriptorSet descriptor_set;
+				uint64_t last_used_frame;
+			};
+
+			//! A descriptor set that was evicted from the cache and can be rewritten once the device is done with it.
+			struct RetiredSet
+			{
+				vk::DescriptorSet descriptor_set;
+				uint64_t last_used_frame;
+			};
+
+			//! Converts a (non-dispatchable) Vulkan handle into an integer that can be hashed and compared.
+			template<class T>
+			static uint64_t handle_to_key(T handle)
+			{
+				return (uint64_t)(handle);
+			}
+
+			//! Converts an integer produced by `handle_to_key()` back into a (non-dispatchable) Vulkan handle.
+			template<class T>
+			static T key_to_handle(uint64_t key)
+			{
+				return reinterpret_cast<T>(key);
+			}
+
+			//! Returns `true` if the record refers to a sampler and / or image view, and `false` otherwise.
+			static bool is_image_record(const ResourceList::Record& record);
+
+			//! Computes a hash from a descriptor set layout and a sorted list of resource records.
+			static size_t compute_hash(vk::DescriptorSetLayout layout, const std::vector<ResourceList::Record>& records);
+
+			//! Returns a descriptor set with the specified layout, reusing a retired set if one is available.
+			vk::DescriptorSet acquire_descriptor_set(vk::DescriptorSetLayout layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+
+			//! Removes the entry at `it` from the cache and retires its descriptor set.
+			void evict(std::list<Entry>::iterator it);
+
+			void invalidate_handle(uint64_t handle);
+
+			const Device* m_device_ptr;
+			std::shared_ptr<DescriptorAllocator> m_allocator;
+			DescriptorWriter m_writer;
+
+			uint32_t m_max_unused_frames;
+			size_t m_max_entries;
+			uint64_t m_current_frame;
+			uint64_t m_hit_count;
+			uint64_t m_miss_count;
+
+			// Entries are ordered from most recently used (front) to least recently used (back).
+			std::list<Entry> m_entries;
+			std::unordered_multimap<size_t, std::list<Entry>::iterator> m_lookup;
+			std::map<uint64_t, std::vector<RetiredSet>> m_retired_sets_mapping;
+		};
+
+	} // namespace graphics
+
+} // namespace plume
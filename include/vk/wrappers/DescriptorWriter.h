@@ -0,0 +1,229 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include "Buffer.h"
+#include "Image.h"
+#include "Pipeline.h"
+#include "Sampler.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		//! A DescriptorWriter collects descriptor writes (buffers, images, and texel buffer views) across any number of
+		//! descriptor sets and submits all of them with a single call to vkUpdateDescriptorSets when `flush()` is called.
+		//! The descriptor info structs are copied into the writer, so callers are free to pass temporaries:
+		//!
+		//!		DescriptorWriter writer{ device };
+		//!		writer.write_ubo(set_a, 0, ubo_a)
+		//!			  .write_cis(set_a, 1, image_view, sampler)
+		//!			  .write_ubo(set_b, 0, ubo_b);
+		//!		writer.flush();
+		//!
+		//! Note that descriptor sets must not be updated while they are in use by a command buffer that is pending
+		//! execution (unless they were allocated with update-after-bind semantics).
+		class DescriptorWriter
+		{
+		public:
+
+			DescriptorWriter(const Device& device) :
+
+				m_device_ptr(&device)
+			{
+			}
+
+			//! Records a write of one or more buffer descriptors into `set` at the specified `binding`, starting at array 
+			//! element `array_element`. The descriptor type must be one of the (dynamic) uniform or storage buffer types.
+			DescriptorWriter& write_buffers(vk::DescriptorSet set, uint32_t binding, vk::DescriptorType type, const std::vector<vk::DescriptorBufferInfo>& buffer_infos, uint32_t array_element = 0);
+
+			//! Records a write of one or more image descriptors into `set` at the specified `binding`, starting at array 
+			//! element `array_element`. The descriptor type must be one of the sampler, image, or input attachment types.
+			DescriptorWriter& write_images(vk::DescriptorSet set, uint32_t binding, vk::DescriptorType type, const std::vector<vk::DescriptorImageInfo>& image_infos, uint32_t array_element = 0);
+
+			//! Records a write of one or more texel buffer views into `set` at the specified `binding`, starting at array 
+			//! element `array_element`. The descriptor type must be one of the uniform or storage texel buffer types.
+			DescriptorWriter& write_texel_buffers(vk::DescriptorSet set, uint32_t binding, vk::DescriptorType type, const std::vector<vk::BufferView>& buffer_views, uint32_t array_element = 0);
+
+			/*
+			 *
+			 * Some useful shortcuts - all of these call one of the functions above and simply fill out the descriptor type.
+			 *
+			 */
+			DescriptorWriter& write_ubo(vk::DescriptorSet set, uint32_t binding, const Buffer& buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE)
+			{
+				return write_buffers(set, binding, vk::DescriptorType::eUniformBuffer, { buffer.build_descriptor_info(offset, range) });
+			}
+
+			DescriptorWriter& write_ubo_dynamic(vk::DescriptorSet set, uint32_t binding, const Buffer& buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE)
+			{
+				return write_buffers(set, binding, vk::DescriptorType::eUniformBufferDynamic, { buffer.build_descriptor_info(offset, range) });
+			}
+
+			DescriptorWriter& write_ssbo(vk::DescriptorSet set, uint32_t binding, const Buffer& buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE)
+			{
+				return write_buffers(set, binding, vk::DescriptorType::eStorageBuffer, { buffer.build_descriptor_info(offset, range) });
+			}
+
+			DescriptorWriter& write_ssbo_dynamic(vk::DescriptorSet set, uint32_t binding, const Buffer& buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE)
+			{
+				return write_buffers(set, binding, vk::DescriptorType::eStorageBufferDynamic, { buffer.build_descriptor_info(offset, range) });
+			}
+
+			DescriptorWriter& write_cis(vk::DescriptorSet set, uint32_t binding, const ImageView& image_view, const Sampler& sampler, vk::ImageLayout image_layout = vk::ImageLayout::eShaderReadOnlyOptimal)
+			{
+				return write_images(set, binding, vk::DescriptorType::eCombinedImageSampler, { image_view.build_descriptor_info(sampler, image_layout) });
+			}
+
+			//! Submits all of the recorded writes with a single call to vkUpdateDescriptorSets and clears the writer.
+			void flush();
+
+			//! Discards all of the recorded writes without submitting them.
+			void clear()
+			{
+				m_writes.clear();
+				m_write_info_indices.clear();
+				m_buffer_infos.clear();
+				m_image_infos.clear();
+				m_buffer_views.clear();
+			}
+
+			//! Returns the number of writes that will be submitted by the next call to `flush()`.
+			size_t get_pending_write_count() const { return m_writes.size(); }
+
+		private:
+
+			//! Returns `true` if descriptors of the specified type are described by a vk::DescriptorBufferInfo struct.
+			static bool is_buffer_type(vk::DescriptorType type);
+
+			//! Returns `true` if descriptors of the specified type are described by a vk::DescriptorImageInfo struct.
+			static bool is_image_type(vk::DescriptorType type);
+
+			//! Returns `true` if descriptors of the specified type are described by a vk::BufferView handle.
+			static bool is_texel_buffer_type(vk::DescriptorType type);
+
+			const Device* m_device_ptr;
+
+			// The info structs are stored in growable containers, so the pointers inside of each write are only
+			// patched (using the indices below) right before the writes are submitted.
+			std::vector<vk::WriteDescriptorSet> m_writes;
+			std::vector<size_t> m_write_info_indices;
+			std::vector<vk::DescriptorBufferInfo> m_buffer_infos;
+			std::vector<vk::DescriptorImageInfo> m_image_infos;
+			std::vector<vk::BufferView> m_buffer_views;
+
+			friend class DescriptorUpdateTemplate;
+		};
+
+		//! A descriptor update template (VK_KHR_descriptor_update_template) describes how to update every binding of a
+		//! descriptor set from a single, packed block of host memory. The template is generated from the layout bindings
+		//! of the set (usually obtained through shader reflection), with one entry per binding, in order of increasing
+		//! binding index. Each entry occupies `descriptorCount` consecutive vk::DescriptorBufferInfo, vk::DescriptorImageInfo,
+		//! or vk::BufferView structs, depending on its descriptor type. For example, for the set:
+		//!
+		//!				layout (set = 0, binding = 0) uniform uniform_buffer_object { ... } ubo;
+		//!				layout (set = 0, binding = 1) uniform sampler2D albedo_map;
+		//!
+		//! the packed data would look like:
+		//!
+		//!				struct MaterialDescriptors
+		//!				{
+		//!					vk::DescriptorBufferInfo ubo;
+		//!					vk::DescriptorImageInfo albedo_map;
+		//!				};
+		//!
+		//! and the entire set can be updated with a single call to `update()`. If the extension was not enabled on the
+		//! logical device, the template falls back to building an equivalent list of writes for vkUpdateDescriptorSets.
+		class DescriptorUpdateTemplate
+		{
+		public:
+
+			//! Factory method for constructing a new shared DescriptorUpdateTemplate for the descriptor set at index `set`
+			//! of a pipeline whose layouts were inferred through reflection.
+			static std::shared_ptr<DescriptorUpdateTemplate> create(const Device& device, const Pipeline& pipeline, uint32_t set)
+			{
+				return std::shared_ptr<DescriptorUpdateTemplate>(new DescriptorUpdateTemplate(device, pipeline.get_descriptor_set_layout(set), pipeline.get_descriptor_set_layout_bindings(set)));
+			}
+
+			//! Factory method for constructing a new shared DescriptorUpdateTemplate from the descriptors that were reflected 
+			//! from one or more shader modules. Only descriptors that belong to the set at index `set` are considered.
+			static std::shared_ptr<DescriptorUpdateTemplate> create(const Device& device,
+																	vk::DescriptorSetLayout layout,
+																	uint32_t set,
+																	const std::vector<std::shared_ptr<ShaderModule>>& modules);
+
+			~DescriptorUpdateTemplate();
+
+			DescriptorUpdateTemplate(const DescriptorUpdateTemplate& other) = delete;
+
+			DescriptorUpdateTemplate& operator=(const DescriptorUpdateTemplate& other) = delete;
+
+			VkDescriptorUpdateTemplateKHR get_handle() const { return m_descriptor_update_template_handle; }
+
+			//! Returns `true` if this template is backed by a VkDescriptorUpdateTemplateKHR object and `false` if it falls
+			//! back to vkUpdateDescriptorSets.
+			bool is_native() const { return m_descriptor_update_template_handle != VK_NULL_HANDLE; }
+
+			//! Returns the size, in bytes, of the packed data that must be passed to `update()`.
+			size_t get_data_size() const { return m_data_size; }
+
+			//! Returns the byte offset of the specified `binding` within the packed data.
+			size_t get_binding_offset(uint32_t binding) const;
+
+			//! Updates every binding of `set` from the packed `data`, which must be at least `get_data_size()` bytes.
+			void update(vk::DescriptorSet set, const void* data) const;
+
+			//! Updates every binding of `set` from a packed struct. This has a different name from `update()` so that passing a 
+			//! pointer to the packed data never silently selects this overload and reads the pointer value itself.
+			template<class T>
+			void update_from_struct(vk::DescriptorSet set, const T& data) const
+			{
+				if (sizeof(T) < m_data_size)
+				{
+					throw std::runtime_error("The struct passed to `update_from_struct()` is smaller than the descriptor update template's packed data");
+				}
+
+				update(set, static_cast<const void*>(&data));
+			}
+
+		private:
+
+			DescriptorUpdateTemplate(const Device& device, vk::DescriptorSetLayout layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+
+			const Device* m_device_ptr;
+			VkDescriptorUpdateTemplateKHR m_descriptor_update_template_handle;
+			PFN_vkUpdateDescriptorSetWithTemplateKHR m_update_func;
+
+			std::vector<VkDescriptorUpdateTemplateEntryKHR> m_entries;
+			size_t m_data_size;
+		};
+
+	} // namespace graphics
+
+} // namespace plume
@@ -59,14 +59,31 @@ namespace plume
 				std::vector<vk::PresentModeKHR> m_present_modes;
 			};
 
+			//! The subset of the VK_EXT_descriptor_indexing features that "bindless" resource arrays rely on (see BindlessHeap).
+			//! Each member is `true` if the feature was reported by the physical device and enabled on this logical device.
+			struct DescriptorIndexingFeatures
+			{
+				bool shader_sampled_image_array_non_uniform_indexing = false;
+				bool shader_storage_buffer_array_non_uniform_indexing = false;
+				bool sampled_image_update_after_bind = false;
+				bool storage_buffer_update_after_bind = false;
+				bool update_unused_while_pending = false;
+				bool partially_bound = false;
+				bool runtime_descriptor_array = false;
+			};
+
 			Device() = default; 
 
-			//! Construct a logical device around a physical device (GPU).
+			//! Construct a logical device around a physical device (GPU). The `instance` that the physical device was
+			//! enumerated from is only needed to query the features of optional extensions (i.e. VK_EXT_descriptor_indexing)
+			//! via vkGetPhysicalDeviceFeatures2KHR, which requires the VK_KHR_get_physical_device_properties2 instance 
+			//! extension. Without it, none of these features are enabled.
 			Device(vk::PhysicalDevice physical_device,
 				   vk::SurfaceKHR surface,
 				   vk::QueueFlags required_queue_flags = vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eTransfer,
 				   bool use_swapchain = true,
-				   const std::vector<const char*>& required_device_extensions = {});
+				   const std::vector<const char*>& required_device_extensions = {},
+				   vk::Instance instance = {});
 
 			~Device();
 
@@ -94,6 +111,18 @@ namespace plume
 			//! Returns a vector of structs specifying information about each available device-specific extension.
 			const std::vector<vk::ExtensionProperties>& get_physical_device_extension_properties() const { return m_gpu_details.m_extension_properties; }
 
+			//! Returns `true` if the physical device supports the device extension named `name` and `false` otherwise.
+			bool is_device_extension_supported(const std::string& name) const;
+
+			//! Returns `true` if the device extension named `name` was enabled when this logical device was created
+			//! and `false` otherwise. Functionality that depends on optional extensions should check this before
+			//! attempting to load any extension entry points.
+			bool is_device_extension_enabled(const std::string& name) const;
+
+			//! Returns the VK_EXT_descriptor_indexing features that were enabled when this logical device was created. 
+			//! All of them are `false` if the extension wasn't enabled.
+			const DescriptorIndexingFeatures& get_descriptor_indexing_features() const { return m_descriptor_indexing_features; }
+
 			//! Format features are properties of the physical device.
 			vk::FormatProperties get_physical_device_format_properties(vk::Format format) const { return m_gpu_details.m_handle.getFormatProperties(format); }
 
@@ -200,6 +229,7 @@ namespace plume
 
 			GPUDetails m_gpu_details;
 			std::vector<const char*> m_required_device_extensions;
+			DescriptorIndexingFeatures m_descriptor_indexing_features;
 
 			std::map<QueueType, QueueInternals> m_queue_families_mapping =
 			{
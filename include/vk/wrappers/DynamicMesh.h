@@ -0,0 +1,198 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Buffer.h"
+#include "CommandBuffer.h"
+#include "Geometry.h"
+#include "Synchronization.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		//! A dynamic mesh holds geometry that changes frequently (i.e. every frame), such as CPU-simulated particles, 
+		//! deforming grids, or debug geometry. Its vertex and index buffers are divided into one region per frame-in-flight,
+		//! so that the CPU never writes to memory that the GPU may still be reading from a previous frame.
+		//!
+		//! All writes go to a CPU-side copy of the mesh and to the current frame's region. The written ranges are also 
+		//! recorded as dirty for every other frame, and are copied into a frame's region the next time that frame begins.
+		//! Therefore, a partial update (i.e. `write_vertices()` with a small range) only ever uploads the data that 
+		//! actually changed. When the mesh outgrows its buffers, the capacity is doubled: the old buffers are kept alive 
+		//! until every frame that might still reference them has finished.
+		//!
+		//! A typical frame looks like:
+		//!
+		//!		mesh->begin_frame(frame_index, fences[frame_index]);		// waits for the frame's fence, then syncs its region
+		//!		mesh->write_vertices(particles.data(), 0, particles.size());
+		//!		...
+		//!		mesh->bind(command_buffer);
+		//!		mesh->draw(command_buffer);
+		class DynamicMesh
+		{
+		public:
+
+			//! Factory method for constructing a new shared DynamicMesh.
+			static std::shared_ptr<DynamicMesh> create(const Device& device, 
+													   uint32_t vertex_stride = geom::Geometry::get_vertex_stride(), 
+													   uint32_t frames_in_flight = 2, 
+													   size_t vertex_capacity = 1024, 
+													   size_t index_capacity = 4096)
+			{
+				return std::shared_ptr<DynamicMesh>(new DynamicMesh(device, vertex_stride, frames_in_flight, vertex_capacity, index_capacity));
+			}
+
+			//! Makes `frame_index` the current frame, releases any buffers that are no longer referenced by a frame-in-flight,
+			//! and brings the frame's region up-to-date with all of the writes that happened since the frame was last current.
+			//! The caller must guarantee that the device is no longer using this frame's region.
+			void begin_frame(uint32_t frame_index);
+
+			//! Waits for `fence` (which should be the fence that was signaled by the last submission of this frame) and then
+			//! calls `begin_frame()`.
+			void begin_frame(uint32_t frame_index, Fence& fence)
+			{
+				fence.wait_for();
+				begin_frame(frame_index);
+			}
+
+			//! Sets the number of vertices and indices in the mesh, growing the buffers if necessary. The contents of any 
+			//! newly added vertices or indices are undefined until they are written.
+			void resize(size_t vertex_count, size_t index_count);
+
+			//! Copies `vertex_count` vertices (each `get_vertex_stride()` bytes) from `vertices` into the mesh, starting at
+			//! vertex `first_vertex`. The range must lie within the current vertex count.
+			void write_vertices(const void* vertices, size_t first_vertex, size_t vertex_count);
+
+			//! Copies `index_count` indices into the mesh, starting at index `first_index`. The range must lie within the 
+			//! current index count.
+			void write_indices(const uint32_t* indices, size_t first_index, size_t index_count);
+
+			//! Replaces the entire contents of the mesh with `geometry`, packed with AttributeMode::MODE_INTERLEAVED and 
+			//! `encoding`. The mesh's vertex stride must match the packed vertex stride.
+			void update(const geom::Geometry& geometry, const geom::VertexEncoding& encoding = geom::VertexEncoding{});
+
+			//! Binds the current frame's vertex region to `binding` and (if the mesh has any indices) its index region.
+			void bind(CommandBuffer& command_buffer, uint32_t binding = 0) const;
+
+			//! Draws the mesh from the current frame's regions: with `draw_indexed()` if the mesh has indices, and 
+			//! with `draw()` otherwise. The mesh must already be bound.
+			void draw(CommandBuffer& command_buffer, uint32_t instance_count = 1) const;
+
+			//! Returns the size of a single vertex, in bytes.
+			uint32_t get_vertex_stride() const { return m_vertex_stride; }
+
+			//! Returns the number of frames-in-flight, each of which owns a separate region of the buffers.
+			uint32_t get_frames_in_flight() const { return static_cast<uint32_t>(m_frames.size()); }
+
+			//! Returns the index of the frame whose region is currently written to, bound, and drawn.
+			uint32_t get_current_frame_index() const { return m_current_frame_index; }
+
+			size_t get_vertex_count() const { return m_vertex_count; }
+
+			size_t get_index_count() const { return m_index_count; }
+
+			//! Returns the number of vertices that each region can hold before the buffers must grow.
+			size_t get_vertex_capacity() const { return m_vertex_capacity; }
+
+			//! Returns the number of indices that each region can hold before the buffers must grow.
+			size_t get_index_capacity() const { return m_index_capacity; }
+
+		private:
+
+			//! Constructs a dynamic mesh whose vertices are `vertex_stride` bytes each. Every frame-in-flight initially has
+			//! room for `vertex_capacity` vertices and `index_capacity` 32-bit indices.
+			DynamicMesh(const Device& device, 
+						uint32_t vertex_stride = geom::Geometry::get_vertex_stride(), 
+						uint32_t frames_in_flight = 2, 
+						size_t vertex_capacity = 1024, 
+						size_t index_capacity = 4096);
+
+			//! The range `[begin, end)` of elements that have changed since a frame's region was last brought up-to-date.
+			struct DirtyRange
+			{
+				void add(size_t first, size_t count);
+
+				bool is_empty() const { return begin == end; }
+
+				size_t begin = 0;
+				size_t end = 0;
+			};
+
+			struct FrameRegion
+			{
+				DirtyRange vertices;
+				DirtyRange indices;
+			};
+
+			//! A buffer that was replaced while growing, along with the number of calls to `begin_frame()` that must 
+			//! happen before it is guaranteed to be unused.
+			struct RetiredBuffer
+			{
+				std::unique_ptr<Buffer> buffer;
+				uint32_t frames_remaining;
+			};
+
+			vk::DeviceSize get_vertex_region_offset(uint32_t frame_index) const { return frame_index * m_vertex_capacity * m_vertex_stride; }
+
+			vk::DeviceSize get_index_region_offset(uint32_t frame_index) const { return frame_index * m_index_capacity * sizeof(uint32_t); }
+
+			//! Uploads vertices from the CPU-side copy into the current frame's region and marks them dirty for all other frames.
+			void commit_vertices(size_t first_vertex, size_t vertex_count);
+
+			//! Uploads indices from the CPU-side copy into the current frame's region and marks them dirty for all other frames.
+			void commit_indices(size_t first_index, size_t index_count);
+
+			void grow_vertex_buffer(size_t vertex_capacity);
+
+			void grow_index_buffer(size_t index_capacity);
+
+			const Device* m_device_ptr;
+			uint32_t m_vertex_stride;
+			uint32_t m_current_frame_index = 0;
+
+			size_t m_vertex_capacity;
+			size_t m_index_capacity;
+			size_t m_vertex_count = 0;
+			size_t m_index_count = 0;
+
+			std::vector<uint8_t> m_vertices;
+			std::vector<uint32_t> m_indices;
+			std::unique_ptr<Buffer> m_vertex_buffer;
+			std::unique_ptr<Buffer> m_index_buffer;
+
+			std::vector<FrameRegion> m_frames;
+			std::vector<RetiredBuffer> m_retired_buffers;
+		};
+
+	} // namespace graphics
+
+} // namespace plume
@@ -0,0 +1,211 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Buffer.h"
+#include "CommandBuffer.h"
+#include "Geometry.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		//! The location of a single mesh within a GeometryPool. Indices are stored relative to the mesh's first vertex, 
+		//! so `vertex_offset` must be passed along with the index range when drawing.
+		struct GeometryRange
+		{
+			//! Returns the parameters needed to draw this range with `CommandBuffer::draw_indexed()`.
+			CommandBuffer::DrawParamsIndexed get_draw_params(uint32_t instance_count = 1, uint32_t first_instance = 0) const
+			{
+				CommandBuffer::DrawParamsIndexed draw_params{ index_count, instance_count };
+				draw_params.m_first_index = first_index;
+				draw_params.m_vertex_offset = vertex_offset;
+				draw_params.m_first_instance = first_instance;
+				return draw_params;
+			}
+
+			//! Returns an indirect draw command for this range, which can be written to an indirect buffer and drawn
+			//! with `CommandBuffer::draw_indexed_indirect()`.
+			vk::DrawIndexedIndirectCommand build_indirect_command(uint32_t instance_count = 1, uint32_t first_instance = 0) const
+			{
+				return { index_count, instance_count, first_index, static_cast<int32_t>(vertex_offset), first_instance };
+			}
+
+			uint32_t first_index;
+			uint32_t index_count;
+			uint32_t vertex_offset;
+			uint32_t vertex_count;
+
+			//! The transform that recovers object space positions from this mesh's packed positions (see 
+			//! `Geometry::get_position_dequantization()`). This differs per mesh for quantized position encodings.
+			geom::PositionDequantization dequantization;
+		};
+
+		//! A geometry pool packs many meshes into a handful of large, shared buffers: one vertex buffer per vertex 
+		//! stream (one for AttributeMode::MODE_INTERLEAVED, two for AttributeMode::MODE_SPLIT_POSITIONS, etc.) and a 
+		//! single 32-bit index buffer. The pool is bound once, after which any number of meshes can be drawn by range 
+		//! (with `draw()`, or with indirect draws built from `GeometryRange::build_indirect_command()`) without 
+		//! rebinding any buffers in between.
+		//!
+		//! Freed ranges are recycled by later additions (first-fit). `compact()` moves all live meshes to the front of
+		//! the buffers, closing any holes. Handles remain valid across compaction, but the ranges they refer to move, so
+		//! ranges (and any indirect commands built from them) should be re-queried afterwards. The buffers grow as 
+		//! needed. Note that growing and compacting rewrite the pool's buffers: the caller must ensure that the device
+		//! is not using them.
+		class GeometryPool
+		{
+		public:
+
+			//! An opaque reference to a single mesh in the pool.
+			using Handle = uint32_t;
+
+			//! Factory method for constructing a new shared GeometryPool.
+			static std::shared_ptr<GeometryPool> create(const Device& device, 
+														size_t vertex_capacity = 65536, 
+														size_t index_capacity = 262144, 
+														geom::AttributeMode mode = geom::AttributeMode::MODE_INTERLEAVED, 
+														const geom::VertexEncoding& encoding = geom::VertexEncoding{})
+			{
+				return std::shared_ptr<GeometryPool>(new GeometryPool(device, vertex_capacity, index_capacity, mode, encoding));
+			}
+
+			//! Packs `geometry` into the pool and returns a handle to it. The geometry's topology must match that of the
+			//! pipeline(s) used to draw the pool. Primitive restart indices are preserved. The data is written directly into
+			//! the pool's host visible buffers (which may also grow), so the caller must ensure that the device is not reading
+			//! them, i.e. by waiting for the device to be idle or for the fences of all in-flight frames that draw the pool.
+			Handle add(const geom::Geometry& geometry);
+
+			//! Releases the ranges used by the mesh referenced by `handle`, which may then be reused by later additions.
+			void free(Handle handle);
+
+			//! Moves all live meshes to the front of the pool's buffers, so that all free space is contiguous.
+			void compact();
+
+			//! Returns the range of the mesh referenced by `handle`.
+			const GeometryRange& get_range(Handle handle) const { return get_entry(handle).range; }
+
+			//! Binds every vertex stream (stream `i` is bound to binding `first_binding + i`) and the index buffer.
+			void bind(CommandBuffer& command_buffer, uint32_t first_binding = 0) const;
+
+			//! Draws the mesh referenced by `handle`. The pool must already be bound.
+			void draw(CommandBuffer& command_buffer, Handle handle, uint32_t instance_count = 1, uint32_t first_instance = 0) const
+			{
+				command_buffer.draw_indexed(get_range(handle).get_draw_params(instance_count, first_instance));
+			}
+
+			//! Returns the vertex input state for pipelines that draw this pool.
+			geom::VertexInputState get_vertex_input_state(geom::VertexInputPreset preset = geom::VertexInputPreset::PRESET_ALL_ATTRIBUTES, uint32_t first_binding = 0) const
+			{
+				return geom::Geometry::get_vertex_input_state(preset, m_attribute_mode, first_binding, m_encoding);
+			}
+
+			//! Returns the number of vertex streams (and therefore vertex buffers) used by this pool.
+			size_t get_stream_count() const { return m_vertex_buffers.size(); }
+
+			//! Returns the vertex buffer that holds the vertex stream at index `stream`.
+			const Buffer& get_vertex_buffer(size_t stream = 0) const { return *m_vertex_buffers.at(stream); }
+
+			//! Returns the index buffer shared by all meshes in the pool.
+			const Buffer& get_index_buffer() const { return *m_index_buffer; }
+
+			//! Returns the number of live meshes in the pool.
+			size_t get_mesh_count() const { return m_entries.size() - m_free_handles.size(); }
+
+			//! Returns the number of vertices that the pool can hold before it must grow.
+			size_t get_vertex_capacity() const { return m_vertex_capacity; }
+
+			//! Returns the number of indices that the pool can hold before it must grow.
+			size_t get_index_capacity() const { return m_index_capacity; }
+
+			//! Returns the number of vertices occupied by live meshes.
+			size_t get_used_vertex_count() const { return m_used_vertex_count; }
+
+			//! Returns the number of indices occupied by live meshes.
+			size_t get_used_index_count() const { return m_used_index_count; }
+
+		private:
+
+			//! Constructs a pool that can initially hold `vertex_capacity` vertices and `index_capacity` indices. Vertices
+			//! are packed according to `mode` and `encoding`.
+			GeometryPool(const Device& device, 
+						 size_t vertex_capacity = 65536, 
+						 size_t index_capacity = 262144, 
+						 geom::AttributeMode mode = geom::AttributeMode::MODE_INTERLEAVED, 
+						 const geom::VertexEncoding& encoding = geom::VertexEncoding{});
+
+			//! Tracks the unused regions of a linear range of elements (i.e. vertices or indices). Regions are kept sorted
+			//! by offset, and adjacent regions are merged when they are released.
+			struct FreeList
+			{
+				//! Returns the offset of a free region of `count` elements, or `end` if no free region is large enough.
+				size_t allocate(size_t count);
+
+				void release(size_t offset, size_t count);
+
+				//! Everything at or beyond `end` is unused.
+				size_t end = 0;
+				std::vector<std::pair<size_t, size_t>> regions;
+			};
+
+			struct Entry
+			{
+				GeometryRange range;
+				bool is_live;
+			};
+
+			const Entry& get_entry(Handle handle) const;
+
+			void grow_vertex_buffers(size_t vertex_capacity);
+
+			void grow_index_buffer(size_t index_capacity);
+
+			const Device* m_device_ptr;
+			geom::AttributeMode m_attribute_mode;
+			geom::VertexEncoding m_encoding;
+			std::vector<uint32_t> m_stream_strides;
+			std::vector<std::unique_ptr<Buffer>> m_vertex_buffers;
+			std::unique_ptr<Buffer> m_index_buffer;
+
+			size_t m_vertex_capacity;
+			size_t m_index_capacity;
+			size_t m_used_vertex_count = 0;
+			size_t m_used_index_count = 0;
+			FreeList m_free_vertices;
+			FreeList m_free_indices;
+
+			std::vector<Entry> m_entries;
+			std::vector<Handle> m_free_handles;
+		};
+
+	} // namespace graphics
+
+} // namespace plume
@@ -0,0 +1,147 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "CommandBuffer.h"
+#include "DescriptorAllocator.h"
+#include "Image.h"
+#include "Pipeline.h"
+#include "Sampler.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		//! A hierarchical depth (Hi-Z) pyramid: a mip chain built from a depth attachment, where every texel of level `n`
+		//! covers the texels of level `n - 1` that fall inside its footprint. Each texel stores the farthest depth in its
+		//! red channel and the nearest depth in its green channel, so the pyramid can be used for conservative occlusion
+		//! tests (see OcclusionCuller) as well as for other depth-aware passes (i.e. screen-space ray marching).
+		//!
+		//! The pyramid is built by a chain of compute dispatches: `hiz_init.comp` (or `hiz_init_ms.comp` for multisampled
+		//! depth attachments, which reduces all of the samples of each pixel) copies the depth attachment into level 0, and
+		//! `hiz_downsample.comp` reduces each level into the next. Level sizes are halved and rounded down, so when a level
+		//! has an odd size along an axis, the last texel of the next level also covers the level's final row or column.
+		//!
+		//! A typical frame looks like:
+		//!
+		//!		command_buffer.begin_render_pass(...);
+		//!		...											// write depth
+		//!		command_buffer.end_render_pass();
+		//!		pyramid->record(command_buffer);				// outside of a render pass
+		//!		...
+		//!		float ms = pyramid->get_last_gpu_time_ms();		// once the submission has finished
+		//!
+		//! The pyramid image is kept in vk::ImageLayout::eGeneral, so it can be read as a storage image or sampled without
+		//! any further layout transitions. The depth attachment is transitioned to vk::ImageLayout::eShaderReadOnlyOptimal 
+		//! for the duration of the build and back to vk::ImageLayout::eDepthStencilAttachmentOptimal afterwards.
+		class HiZPyramid
+		{
+		public:
+
+			//! Factory method for constructing a new shared HiZPyramid.
+			static std::shared_ptr<HiZPyramid> create(const Device& device, 
+													  const Image& depth_image, 
+													  const ImageView& depth_image_view,
+													  const std::shared_ptr<ShaderModule>& init_shader_module,
+													  const std::shared_ptr<ShaderModule>& downsample_shader_module)
+			{
+				return std::shared_ptr<HiZPyramid>(new HiZPyramid(device, depth_image, depth_image_view, init_shader_module, downsample_shader_module));
+			}
+
+			//! Records the dispatches that build the pyramid from the current contents of the depth image, along with
+			//! all of the required barriers. The depth image must be in vk::ImageLayout::eDepthStencilAttachmentOptimal
+			//! and the command buffer must not be inside of a render pass.
+			void record(CommandBuffer& command_buffer);
+
+			//! Returns the time (in milliseconds) that the device spent building the pyramid during the most recently
+			//! recorded pass. The caller must ensure that the pass has finished executing. Returns zero if nothing has 
+			//! been recorded yet or if the device doesn't support timestamps on its graphics and compute queues.
+			float get_last_gpu_time_ms() const;
+
+			//! Returns a view that covers every level of the pyramid.
+			const ImageView& get_image_view() const { return *m_image_view; }
+
+			//! Returns a view of a single level of the pyramid.
+			const ImageView& get_level_image_view(uint32_t level) const { return *m_level_image_views[level]; }
+
+			//! Returns a sampler with nearest filtering and clamp-to-edge addressing that can be used with `get_image_view()`.
+			const Sampler& get_sampler() const { return *m_sampler; }
+
+			const Image& get_image() const { return *m_image; }
+
+			//! Returns the layout that the pyramid image is kept in.
+			vk::ImageLayout get_image_layout() const { return vk::ImageLayout::eGeneral; }
+
+			uint32_t get_width() const { return m_width; }
+
+			uint32_t get_height() const { return m_height; }
+
+			uint32_t get_level_count() const { return m_level_count; }
+
+		private:
+
+			//! Constructs a pyramid for `depth_image`, which must have been created with vk::ImageUsageFlagBits::eSampled. 
+			//! `depth_image_view` must only cover the depth aspect of the image. `init_shader_module` must contain 
+			//! `hiz_init_ms.comp` if the depth image is multisampled and `hiz_init.comp` otherwise, and
+			//! `downsample_shader_module` must contain `hiz_downsample.comp`.
+			HiZPyramid(const Device& device, 
+					   const Image& depth_image, 
+					   const ImageView& depth_image_view,
+					   const std::shared_ptr<ShaderModule>& init_shader_module,
+					   const std::shared_ptr<ShaderModule>& downsample_shader_module);
+
+			const Device* m_device_ptr;
+			const Image* m_depth_image_ptr;
+			uint32_t m_width;
+			uint32_t m_height;
+			uint32_t m_level_count;
+			uint32_t m_sample_count;
+			bool m_has_timestamps;
+			bool m_has_recorded = false;
+
+			std::unique_ptr<Image> m_image;
+			std::unique_ptr<ImageView> m_image_view;
+			std::vector<std::unique_ptr<ImageView>> m_level_image_views;
+			std::unique_ptr<Sampler> m_sampler;
+
+			ComputePipeline m_init_pipeline;
+			ComputePipeline m_downsample_pipeline;
+			std::shared_ptr<DescriptorAllocator> m_descriptor_allocator;
+			vk::DescriptorSet m_init_descriptor_set;
+			std::vector<vk::DescriptorSet> m_downsample_descriptor_sets;
+
+			vk::UniqueQueryPool m_query_pool;
+		};
+
+	} // namespace graphics
+
+} // namespace plume
@@ -0,0 +1,201 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Buffer.h"
+#include "CommandBuffer.h"
+#include "Culling.h"
+#include "DescriptorAllocator.h"
+#include "Image.h"
+#include "Pipeline.h"
+#include "Sampler.h"
+#include "Synchronization.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		//! Decides which objects are visible on the device, so that the cost of culling on the host stays flat no matter 
+		//! how many objects the scene contains. A compute pass (`occlusion_cull.comp`) tests the bounding sphere of each
+		//! object against the view frustum and against a hierarchical depth (Hi-Z) pyramid built from the previous frame's
+		//! depth buffer. It appends one vk::DrawIndexedIndirectCommand per visible object to an indirect buffer and 
+		//! counts the number of visible objects in a separate buffer.
+		//!
+		//! When VK_KHR_draw_indirect_count (or VK_AMD_draw_indirect_count) is enabled, `draw()` reads the number of draws 
+		//! from the count buffer, so only the visible objects are drawn. Otherwise, the draw buffer is cleared to zero before
+		//! each culling pass and `draw()` issues a command for every object (in batches of at most `maxDrawIndirectCount`): 
+		//! the commands past the visible count are empty. The count itself is available to the host via `read_draw_count()`, 
+		//! or to other device passes via `get_draw_count_buffer()`.
+		//!
+		//! The pyramid must store the farthest depth covered by each texel in its red channel (see HiZPyramid). Texels
+		//! are fetched directly, so the sampler's filtering modes are irrelevant.
+		//!
+		//! A typical frame looks like:
+		//!
+		//!		culler->begin_frame(frame_index, fences[frame_index]);		// waits for the frame's fence, then syncs its region
+		//!		culler->update(OcclusionCullingParameters::create(view_projection, previous_view_projection, ...));
+		//!		culler->record(command_buffer);				// outside of a render pass
+		//!		command_buffer.begin_render_pass(...);
+		//!		geometry_pool->bind(command_buffer);
+		//!		culler->draw(command_buffer);
+		//!
+		//! Like DynamicMesh, the object and parameter buffers are divided into one region per frame-in-flight, so the host 
+		//! never writes to memory that a previous frame's culling pass may still be reading. The draw and count buffers are
+		//! only written on the device and are shared by every frame: the barriers inserted by `record()` order them between
+		//! frames that are submitted to the same queue.
+		class OcclusionCuller
+		{
+		public:
+
+			//! Factory method for constructing a new shared OcclusionCuller.
+			static std::shared_ptr<OcclusionCuller> create(const Device& device, 
+														   const std::shared_ptr<ShaderModule>& compute_shader_module, 
+														   uint32_t max_objects, 
+														   uint32_t frames_in_flight = 2)
+			{
+				return std::shared_ptr<OcclusionCuller>(new OcclusionCuller(device, compute_shader_module, max_objects, frames_in_flight));
+			}
+
+			//! Makes `frame_index` the current frame and brings the frame's object region up-to-date with all of the objects
+			//! that were set since the frame was last current. The caller must guarantee that the device is no longer using 
+			//! this frame's regions.
+			void begin_frame(uint32_t frame_index);
+
+			//! Waits for `fence` (which should be the fence that was signaled by the last submission of this frame) and then
+			//! calls `begin_frame()`.
+			void begin_frame(uint32_t frame_index, Fence& fence)
+			{
+				fence.wait_for();
+				begin_frame(frame_index);
+			}
+
+			//! Replaces the set of objects that are culled (and drawn). The objects are written to the current frame's region
+			//! right away, and to every other frame's region when that frame next begins.
+			void set_objects(const std::vector<geom::CullingObject>& objects);
+
+			//! Replaces the object at `index` (i.e. after it has moved). The index must be less than the current object count.
+			void set_object(uint32_t index, const geom::CullingObject& object);
+
+			//! Uploads the culling parameters to the current frame's region.
+			void update(const geom::OcclusionCullingParameters& parameters);
+
+			//! Sets the Hi-Z pyramid that objects are tested against (for example, `HiZPyramid::get_image_view()`). This must
+			//! be called at least once before `record()`, even if the occlusion test is disabled, since the descriptor must 
+			//! always be valid. `image_view` must cover every mip level of the pyramid and the image must be in 
+			//! `image_layout` when the culling pass executes. Every frame's descriptor set is updated, so no frame that uses
+			//! the culler may be in-flight (i.e. call this after waiting for the device, as when the pyramid is recreated).
+			void set_hiz_pyramid(const ImageView& image_view, const Sampler& sampler, vk::ImageLayout image_layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+
+			//! Records the culling pass for the current frame: waits for the previous frame's indirect draws, clears the draw 
+			//! and count buffers, dispatches the compute shader, and inserts the barrier that makes the results visible to 
+			//! `draw()`. This must be recorded outside of a render pass.
+			void record(CommandBuffer& command_buffer) const;
+
+			//! Issues the indirect draws written by the culling pass. The vertex and index buffers that the objects refer to
+			//! (and a compatible graphics pipeline) must already be bound.
+			void draw(CommandBuffer& command_buffer) const;
+
+			//! Returns the number of objects that were visible during the most recent culling pass. The caller must ensure
+			//! that the pass has finished executing (i.e. by waiting on the fence that was signaled by its submission).
+			uint32_t read_draw_count() const;
+
+			uint32_t get_object_count() const { return m_object_count; }
+
+			uint32_t get_max_objects() const { return m_max_objects; }
+
+			//! Returns the number of frames-in-flight, each of which owns a separate region of the object and parameter buffers.
+			uint32_t get_frames_in_flight() const { return static_cast<uint32_t>(m_frames.size()); }
+
+			//! Returns the index of the frame whose regions are currently written to and culled.
+			uint32_t get_current_frame_index() const { return m_current_frame_index; }
+
+			const Buffer& get_draw_buffer() const { return *m_draw_buffer; }
+
+			const Buffer& get_draw_count_buffer() const { return *m_draw_count_buffer; }
+
+		private:
+
+			//! Constructs a culler for up to `max_objects` objects. `compute_shader_module` must contain `occlusion_cull.comp`.
+			OcclusionCuller(const Device& device, const std::shared_ptr<ShaderModule>& compute_shader_module, uint32_t max_objects, uint32_t frames_in_flight);
+
+			//! The range `[begin, end)` of objects that have changed since a frame's region was last brought up-to-date.
+			struct DirtyRange
+			{
+				void add(size_t first, size_t count);
+
+				bool is_empty() const { return begin == end; }
+
+				size_t begin = 0;
+				size_t end = 0;
+			};
+
+			struct FrameRegion
+			{
+				vk::DescriptorSet descriptor_set;
+				DirtyRange objects;
+			};
+
+			vk::DeviceSize get_object_region_offset(uint32_t frame_index) const { return frame_index * m_object_region_size; }
+
+			vk::DeviceSize get_parameters_region_offset(uint32_t frame_index) const { return frame_index * m_parameters_region_size; }
+
+			//! Uploads objects from the CPU-side copy into the current frame's region and marks them dirty for all other frames.
+			void commit_objects(size_t first_object, size_t object_count);
+
+			//! Returns `true` if `draw()` reads the number of draws from the count buffer rather than issuing every command.
+			bool uses_draw_indirect_count(const CommandBuffer& command_buffer) const;
+
+			const Device* m_device_ptr;
+			uint32_t m_max_objects;
+			uint32_t m_object_count = 0;
+			uint32_t m_current_frame_index = 0;
+			bool m_has_hiz_pyramid = false;
+
+			//! The size of each frame's region, rounded up to the device's minimum offset alignment for the buffer's usage.
+			vk::DeviceSize m_object_region_size;
+			vk::DeviceSize m_parameters_region_size;
+
+			ComputePipeline m_pipeline;
+			std::shared_ptr<DescriptorAllocator> m_descriptor_allocator;
+
+			std::vector<geom::CullingObject> m_objects;
+			std::vector<FrameRegion> m_frames;
+
+			std::unique_ptr<Buffer> m_object_buffer;
+			std::unique_ptr<Buffer> m_draw_buffer;
+			std::unique_ptr<Buffer> m_draw_count_buffer;
+			std::unique_ptr<Buffer> m_parameters_buffer;
+		};
+
+	} // namespace graphics
+
+} // namespace plume
@@ -27,6 +27,7 @@
 #pragma once
 
 #include <iterator>
+#include <set>
 #include <string>
 
 #include "DescriptorPool.h"
@@ -115,11 +116,23 @@ namespace plume
 				return m_descriptor_set_layouts_mapping.at(set);
 			}
 
+			//! Returns the descriptor set layout bindings for the descriptor set with the given index. These are gathered from 
+			//! all of the pipeline's shader stages during reflection.
+			virtual const std::vector<vk::DescriptorSetLayoutBinding>& get_descriptor_set_layout_bindings(uint32_t set) const final
+			{
+				return m_descriptors_mapping.at(set);
+			}
+
 			//! Returns `true` if this pipeline owns any descriptor set layouts and `false` otherwise. If a pipeline
 			//! is told to infer its own layout during construction, it will examine all of the resources used by its
 			//! shader modules and create an appropriate pipeline layout.
 			bool has_cached_layouts() { return m_descriptor_set_layouts_mapping.size() > 0; }
 
+			//! Returns `true` if the descriptor set layout for the set at index `set` was created with the push descriptor flag 
+			//! (see `DescriptorSetLayoutBuilder::begin_push_descriptor_set_record()`), and `false` otherwise. Only these sets 
+			//! can be updated with vkCmdPushDescriptorSetKHR.
+			bool is_push_descriptor_set(uint32_t set) const { return m_push_descriptor_sets.find(set) != m_push_descriptor_sets.end(); }
+
 			friend std::ostream& operator<<(std::ostream& stream, const Pipeline& pipeline);
 
 		protected:
@@ -134,8 +147,12 @@ namespace plume
 			//! Given a shader module and shader stage, add all of the module's descriptors to the pipeline object's global map.
 			void add_descriptors_to_global_map(const std::shared_ptr<ShaderModule>& module);
 
-			//! Generate all of the descriptor set layout handles.		
-			void build_descriptor_set_layouts();
+			//! Generate all of the descriptor set layout handles. Any set that appears in `external_descriptor_set_layouts`
+			//! uses the provided layout instead of one inferred from reflection: this is required for sets that contain 
+			//! unsized arrays, as well as for sets that need special creation flags (i.e. update-after-bind). Each set in 
+			//! `push_descriptor_sets` must have an external layout that was created with the push descriptor flag.
+			void build_descriptor_set_layouts(const std::map<uint32_t, vk::DescriptorSetLayout>& external_descriptor_set_layouts = {},
+											  const std::set<uint32_t>& push_descriptor_sets = {});
 
 			const Device* m_device_ptr;
 			vk::UniquePipeline m_pipeline_handle;
@@ -144,6 +161,7 @@ namespace plume
 			std::map<std::string, vk::PushConstantRange> m_push_constants_mapping;
 			std::map<uint32_t, std::vector<vk::DescriptorSetLayoutBinding>> m_descriptors_mapping;
 			std::map<uint32_t, vk::DescriptorSetLayout> m_descriptor_set_layouts_mapping;
+			std::set<uint32_t> m_push_descriptor_sets;
 		};
 
 		class GraphicsPipeline : public Pipeline
@@ -182,6 +200,10 @@ namespace plume
 					m_color_blend_attachment_states = color_blend_attachment_states; return *this;
 				}
 
+				//! Set which color components are written to the color attachments. Passing an empty mask disables color 
+				//! writes entirely, which is useful for depth-only passes (i.e. a depth prepass or a shadow pass).
+				Options& color_write_mask(vk::ColorComponentFlags mask) { m_color_write_mask = mask; return *this; }
+
 				//! Set the logical operation for all framebuffer attachments. Note that if a logical operation is 
 				//! enabled, this will override (disable) all per-attachment blend states. Logical operations are 
 				//! applied only for signed/unsigned integer and normalized integer framebuffers. They are not applied 
@@ -196,6 +218,10 @@ namespace plume
 				//! Enable depth testing.
 				Options& depth_test_enabled(bool enabled = true) { m_depth_stencil_state_create_info.depthTestEnable = enabled; return *this; }
 
+				//! Enable or disable depth writes. A pass that follows a depth prepass typically disables depth writes and tests
+				//! against the prepass depth with vk::CompareOp::eLessOrEqual (or vk::CompareOp::eEqual).
+				Options& depth_write_enabled(bool enabled = true) { m_depth_stencil_state_create_info.depthWriteEnable = enabled; return *this; }
+
 				//! Enable stencil testing.
 				Options& stencil_test_enable(bool enabled = true) { m_depth_stencil_state_create_info.stencilTestEnable = enabled; return *this; }
 
@@ -301,6 +327,27 @@ namespace plume
 				//! Specify which subpass of the render pass that this pipeline will be associated with.
 				Options& subpass_index(uint32_t index) { m_subpass_index = index; return *this; }
 
+				//! Use an existing descriptor set layout for the set at index `set`, rather than inferring one from the 
+				//! pipeline's shader stages. For example, this is how a BindlessHeap is made compatible with a pipeline.
+				Options& descriptor_set_layout(uint32_t set, vk::DescriptorSetLayout layout) { m_descriptor_set_layouts[set] = layout; m_push_descriptor_sets.erase(set); return *this; }
+
+				//! Use the layout that `builder` recorded for the set at index `set`. Unlike the overload above, this also 
+				//! records whether or not the layout was created with the push descriptor flag, which is required in order
+				//! to update the set with `CommandBuffer::push_descriptor_set()`.
+				Options& descriptor_set_layout(uint32_t set, const std::shared_ptr<DescriptorSetLayoutBuilder>& builder)
+				{
+					m_descriptor_set_layouts[set] = builder->get_cached_layout_for_set(set);
+					if (builder->is_push_descriptor_set(set))
+					{
+						m_push_descriptor_sets.insert(set);
+					}
+					else
+					{
+						m_push_descriptor_sets.erase(set);
+					}
+					return *this;
+				}
+
 			private:
 
 				vk::PipelineColorBlendStateCreateInfo		m_color_blend_state_create_info;	// TODO: this needs to be re-worked.
@@ -323,6 +370,9 @@ namespace plume
 				std::vector<vk::Rect2D>								m_scissors;
 
 				std::vector<std::shared_ptr<ShaderModule>> m_shader_stages;
+				std::map<uint32_t, vk::DescriptorSetLayout> m_descriptor_set_layouts;
+				std::set<uint32_t> m_push_descriptor_sets;
+				vk::ColorComponentFlags m_color_write_mask;
 				uint32_t m_subpass_index;
 
 				friend class GraphicsPipeline;
@@ -375,7 +425,13 @@ namespace plume
 
 			ComputePipeline() = default; 
 
-			ComputePipeline(const Device& device, const std::shared_ptr<ShaderModule>& compute_shader_module);
+			//! Construct a compute pipeline. Any set that appears in `external_descriptor_set_layouts` uses the provided layout 
+			//! rather than one inferred from the compute shader (see `GraphicsPipeline::Options::descriptor_set_layout()`). 
+			//! Any set in `push_descriptor_sets` must be one of these, and its layout must have the push descriptor flag.
+			ComputePipeline(const Device& device, 
+							const std::shared_ptr<ShaderModule>& compute_shader_module, 
+							const std::map<uint32_t, vk::DescriptorSetLayout>& external_descriptor_set_layouts = {},
+							const std::set<uint32_t>& push_descriptor_sets = {});
 
 			vk::PipelineBindPoint get_pipeline_bind_point() const override { return vk::PipelineBindPoint::eCompute; }
 
@@ -125,8 +125,10 @@ namespace plume
 			void add_color_transient_attachment(const std::string& name, vk::Format format, uint32_t sample_count = 1);
 
 			//! Constructs an attachment description for a depth stencil attachment with the specified image format and sample count. 
-			//! The initial and final layouts will be set to vk::ImageLayout::eDepthStencilAttachmentOptimal.
-			void add_depth_stencil_attachment(const std::string& name, vk::Format format, uint32_t sample_count = 1);
+			//! The initial and final layouts will be set to vk::ImageLayout::eDepthStencilAttachmentOptimal. By default, the depth
+			//! contents are discarded at the end of the render pass: pass vk::AttachmentStoreOp::eStore as the `store_op` if they 
+			//! will be read afterwards (i.e. to build a HiZPyramid).
+			void add_depth_stencil_attachment(const std::string& name, vk::Format format, uint32_t sample_count = 1, vk::AttachmentStoreOp store_op = vk::AttachmentStoreOp::eDontCare);
 
 			//! Returns `true` if a subpass is currently being recorded into and `false` otherwise.
 			bool is_recording() const { return m_is_recording; }
@@ -72,6 +72,8 @@ namespace plume
 			{
 				uint32_t layout_location;
 				uint32_t size;
+				uint32_t component_count;
+				spirv_cross::SPIRType::BaseType base_type;
 				std::string name;
 			};
 
@@ -84,11 +86,20 @@ namespace plume
 			//!						mat4 view;
 			//!						mat4 projection
 			//!					} ubo;
+			//!
+			//! Arrays of descriptors are also supported, in which case the descriptor count of the layout binding is the 
+			//! total number of array elements. Unsized (runtime) arrays, which are typically used for "bindless" resources:
+			//!
+			//!					layout (set = 1, binding = 0) uniform sampler2D textures[];
+			//!
+			//! are reported with a descriptor count of zero, since their size is only known by the application. Such sets 
+			//! must be created from an explicit descriptor set layout (i.e. the one returned by a BindlessHeap).
 			struct Descriptor
 			{
 				uint32_t layout_set;
 				std::string name;
 				vk::DescriptorSetLayoutBinding layout_binding;
+				bool is_unsized_array;
 			};
 
 			//! Factory method for constructing a new shared ShaderModule.
@@ -105,6 +116,9 @@ namespace plume
 			//! Retrieve a list of available entry points within this GLSL shader (usually "main").
 			const std::vector<std::string>& get_entry_points() const { return m_entry_points; }
 
+			//! Retrieve a list of low-level details about the inputs to this shader stage (i.e. vertex attributes).
+			const std::vector<StageInput>& get_stage_inputs() const { return m_stage_inputs; }
+
 			//! Retrieve a list of low-level details about the push constants contained within this GLSL shader.
 			const std::vector<PushConstant>& get_push_constants() const { return m_push_constants; }
 
@@ -26,14 +26,23 @@
 
 #pragma once
 
+#include "BindlessHeap.h"
 #include "Buffer.h"
+#include "ClusteredLightCuller.h"
 #include "CommandBuffer.h"
 #include "CommandPool.h"
+#include "DescriptorAllocator.h"
 #include "DescriptorPool.h"
+#include "DescriptorSetCache.h"
+#include "DescriptorWriter.h"
 #include "Device.h"
+#include "DynamicMesh.h"
 #include "Framebuffer.h"
+#include "GeometryPool.h"
+#include "HiZPyramid.h"
 #include "Image.h"
 #include "Instance.h"
+#include "OcclusionCuller.h"
 #include "Pipeline.h"
 #include "RenderPass.h"
 #include "Sampler.h"
@@ -2,6 +2,7 @@
 
 #include "Vk.h"
 #include "Geometry.h"
+#include "Instancing.h"
 
 #include "gtc/matrix_transform.hpp"  
 
@@ -17,6 +18,9 @@ UniformBufferData ubo_data;
 static const uint32_t width = 800;
 static const uint32_t height = 800;
 static const uint32_t msaa = 8;
+static const bool depth_prepass = true;
+static const bool sphere_impostors = false;
+static const bool hiz_pyramid = false;
 const std::string base_shader_path = "shaders/";
 
 int main()
@@ -44,7 +48,8 @@ int main()
 	std::shared_ptr<pl::graphics::RenderPassBuilder> rpb = pl::graphics::RenderPassBuilder::create();
 	rpb->add_color_transient_attachment("color_inter", swapchain_format, msaa);	// multisampling
 	rpb->add_color_present_attachment("color_final", swapchain_format);			// no multisampling
-	rpb->add_depth_stencil_attachment("depth", device.get_supported_depth_format(), msaa);
+	// The depth contents are only needed after the render pass if they are used to build the Hi-Z pyramid.
+	rpb->add_depth_stencil_attachment("depth", device.get_supported_depth_format(), msaa, hiz_pyramid ? vk::AttachmentStoreOp::eStore : vk::AttachmentStoreOp::eDontCare);
 
 	rpb->begin_subpass_record();
 	rpb->append_attachment_to_subpass("color_inter", pl::graphics::AttachmentCategory::CATEGORY_COLOR);
@@ -59,9 +64,13 @@ int main()
 	 * Geometry, buffers, and pipeline
 	 *
 	 ***********************************************************************************/
+	// Positions are stored in their own stream, so that the depth prepass doesn't have to fetch any other attributes.
+	const auto attribute_mode = pl::geom::AttributeMode::MODE_SPLIT_POSITIONS;
+
+	// All meshes share the pool's vertex and index buffers, so they can be drawn without rebinding anything.
 	pl::geom::Rect geometry = pl::geom::Rect();
-	pl::graphics::Buffer vbo{ device, vk::BufferUsageFlagBits::eVertexBuffer, geometry.get_packed_vertex_attributes() };
-	pl::graphics::Buffer ibo{ device, vk::BufferUsageFlagBits::eIndexBuffer, geometry.get_indices() };
+	auto geometry_pool = pl::graphics::GeometryPool::create(device, 65536, 262144, attribute_mode);
+	auto geometry_handle = geometry_pool->add(geometry);
 	pl::graphics::Buffer ubo{ device, vk::BufferUsageFlagBits::eUniformBuffer, sizeof(UniformBufferData), nullptr };
 
 	ubo_data =
@@ -72,8 +81,7 @@ int main()
 	};
 	ubo.upload_immediately(&ubo_data, sizeof(ubo_data));
 
-	auto binds = geometry.get_vertex_input_binding_descriptions();
-	auto attrs = geometry.get_vertex_input_attribute_descriptions();
+	auto vertex_input = geometry_pool->get_vertex_input_state();
 
 	auto v_resource = pl::fsys::ResourceManager::load_binary_file(base_shader_path + "raymarch.vert.spv");
 	auto f_resource = pl::fsys::ResourceManager::load_binary_file(base_shader_path + "raymarch.frag.spv");
@@ -81,14 +89,17 @@ int main()
 	auto f_shader = pl::graphics::ShaderModule::create(device, f_resource);
 
 	auto pipeline_options = pl::graphics::GraphicsPipeline::Options()
-							.vertex_input_binding_descriptions(binds)
-							.vertex_input_attribute_descriptions(attrs)
+							.vertex_input_binding_descriptions(vertex_input.bindings)
+							.vertex_input_attribute_descriptions(vertex_input.attributes)
 							.viewports({ window.get_fullscreen_viewport() })
 							.scissors({ window.get_fullscreen_scissor_rect2d() })
 							.attach_shader_stages({ v_shader, f_shader })
 							.primitive_topology(geometry.get_topology())
+							.primitive_restart_enabled(geometry.is_primitive_restart_enabled())
 							.cull_back()
 							.depth_test_enabled()
+							.depth_write_enabled(!depth_prepass)
+							.depth_compare_op(vk::CompareOp::eLessOrEqual)
 							.samples(msaa);
 	pl::graphics::GraphicsPipeline pipeline{ device, render_pass, pipeline_options };
 
@@ -107,7 +118,7 @@ int main()
 
 	pl::graphics::Image image_depth{ device,
 									 vk::ImageType::e2D,
-									 vk::ImageUsageFlagBits::eDepthStencilAttachment,
+									 vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled,
 									 device.get_supported_depth_format(), fs_extent, 1, 1,
 									 vk::ImageTiling::eOptimal, msaa };
 
@@ -176,13 +187,108 @@ int main()
 
 	vk::DescriptorSet descriptor_set = descriptor_pool.allocate_descriptor_sets(dslb, { set_id })[0];
 
-	vk::DescriptorBufferInfo dbuff_info = ubo.build_descriptor_info();				
-	vk::DescriptorImageInfo dimag_info = image_sdf_map_view.build_descriptor_info(sampler);
-	vk::WriteDescriptorSet wds_buff = { descriptor_set, binding_id_ubo, 0, 1, vk::DescriptorType::eUniformBuffer, nullptr, &dbuff_info };
-	vk::WriteDescriptorSet wds_samp = { descriptor_set, binding_id_cis, 0, 1, vk::DescriptorType::eCombinedImageSampler, &dimag_info, nullptr};
-	std::vector<vk::WriteDescriptorSet> w_descriptor_sets = { wds_buff, wds_samp };
+	pl::graphics::DescriptorWriter descriptor_writer{ device };
+	descriptor_writer.write_ubo(descriptor_set, binding_id_ubo, ubo)
+					 .write_cis(descriptor_set, binding_id_cis, image_sdf_map_view, sampler);
+	descriptor_writer.flush();
+
+	/***********************************************************************************
+	 *
+	 * Depth prepass pipeline
+	 *
+	 ***********************************************************************************/
+	auto depth_vertex_input = geometry_pool->get_vertex_input_state(pl::geom::VertexInputPreset::PRESET_POSITION_ONLY);
+
+	auto d_resource = pl::fsys::ResourceManager::load_binary_file(base_shader_path + "depth_prepass.vert.spv");
+	auto d_shader = pl::graphics::ShaderModule::create(device, d_resource);
+
+	// The prepass only fetches the position stream and writes depth: there is no fragment shader and color writes are disabled.
+	auto depth_pipeline_options = pl::graphics::GraphicsPipeline::Options()
+								  .vertex_input_binding_descriptions(depth_vertex_input.bindings)
+								  .vertex_input_attribute_descriptions(depth_vertex_input.attributes)
+								  .viewports({ window.get_fullscreen_viewport() })
+								  .scissors({ window.get_fullscreen_scissor_rect2d() })
+								  .attach_shader_stages({ d_shader })
+								  .primitive_topology(geometry.get_topology())
+								  .primitive_restart_enabled(geometry.is_primitive_restart_enabled())
+								  .cull_back()
+								  .depth_test_enabled()
+								  .depth_compare_op(vk::CompareOp::eLess)
+								  .color_write_mask({})
+								  .descriptor_set_layout(set_id, dslb->get_cached_layout_for_set(set_id))
+								  .samples(msaa);
+	pl::graphics::GraphicsPipeline depth_pipeline{ device, render_pass, depth_pipeline_options };
+
+	/***********************************************************************************
+	 *
+	 * Sphere impostor pipeline
+	 *
+	 ***********************************************************************************/
+	// Binding 1 holds the pool's non-position attributes, so the instance data goes in binding 2.
+	const uint32_t binding_id_spheres = 2;
+	uint32_t sphere_count = 0;
+	std::unique_ptr<pl::graphics::Buffer> sphere_instance_buffer;
+	std::unique_ptr<pl::graphics::GraphicsPipeline> impostor_pipeline;
+	if (sphere_impostors)
+	{
+		// A lattice of one million spheres, each of which is drawn as a single (ray-traced) quad: the pool's `Rect`
+		// supplies the corners and the instance buffer supplies the center, radius, and color of each sphere.
+		const uint32_t spheres_per_axis = 100;
+		std::vector<pl::geom::SphereInstance> sphere_instances;
+		sphere_instances.reserve(spheres_per_axis * spheres_per_axis * spheres_per_axis);
+		for (uint32_t i = 0; i < spheres_per_axis; ++i)
+		{
+			for (uint32_t j = 0; j < spheres_per_axis; ++j)
+			{
+				for (uint32_t k = 0; k < spheres_per_axis; ++k)
+				{
+					const glm::vec3 uvw = glm::vec3{ i, j, k } / static_cast<float>(spheres_per_axis - 1);
+					sphere_instances.push_back({ uvw * 2.0f - 1.0f, 0.4f / spheres_per_axis, glm::vec4{ uvw, 1.0f } });
+				}
+			}
+		}
+		sphere_instance_buffer = std::make_unique<pl::graphics::Buffer>(device, vk::BufferUsageFlagBits::eVertexBuffer, sphere_instances);
+		sphere_count = static_cast<uint32_t>(sphere_instances.size());
+
+		auto impostor_vertex_input = geometry_pool->get_vertex_input_state(pl::geom::VertexInputPreset::PRESET_POSITION_ONLY);
+		auto sphere_instance_input = pl::geom::get_sphere_instance_input_state(binding_id_spheres, 1);
+		impostor_vertex_input.bindings.insert(impostor_vertex_input.bindings.end(), sphere_instance_input.bindings.begin(), sphere_instance_input.bindings.end());
+		impostor_vertex_input.attributes.insert(impostor_vertex_input.attributes.end(), sphere_instance_input.attributes.begin(), sphere_instance_input.attributes.end());
+
+		auto iv_resource = pl::fsys::ResourceManager::load_binary_file(base_shader_path + "sphere_impostor.vert.spv");
+		auto if_resource = pl::fsys::ResourceManager::load_binary_file(base_shader_path + "sphere_impostor.frag.spv");
+		auto iv_shader = pl::graphics::ShaderModule::create(device, iv_resource);
+		auto if_shader = pl::graphics::ShaderModule::create(device, if_resource);
+
+		// The quads always face the eye, so there is nothing to cull: the winding just depends on the projection.
+		auto impostor_pipeline_options = pl::graphics::GraphicsPipeline::Options()
+										 .vertex_input_binding_descriptions(impostor_vertex_input.bindings)
+										 .vertex_input_attribute_descriptions(impostor_vertex_input.attributes)
+										 .viewports({ window.get_fullscreen_viewport() })
+										 .scissors({ window.get_fullscreen_scissor_rect2d() })
+										 .attach_shader_stages({ iv_shader, if_shader })
+										 .primitive_topology(geometry.get_topology())
+										 .cull_mode(vk::CullModeFlagBits::eNone)
+										 .depth_test_enabled()
+										 .depth_compare_op(vk::CompareOp::eLess)
+										 .descriptor_set_layout(set_id, dslb->get_cached_layout_for_set(set_id))
+										 .samples(msaa);
+		impostor_pipeline = std::make_unique<pl::graphics::GraphicsPipeline>(device, render_pass, impostor_pipeline_options);
+	}
 
-	device.get_handle().updateDescriptorSets(w_descriptor_sets, {});
+	// The pyramid is rebuilt from the depth attachment at the end of every frame. The depth attachment is multisampled,
+	// so every sample of a pixel is reduced into level 0.
+	std::shared_ptr<pl::graphics::HiZPyramid> hiz;
+	if (hiz_pyramid)
+	{
+		auto hiz_init_resource = pl::fsys::ResourceManager::load_binary_file(base_shader_path + (msaa > 1 ? "hiz_init_ms.comp.spv" : "hiz_init.comp.spv"));
+		auto hiz_downsample_resource = pl::fsys::ResourceManager::load_binary_file(base_shader_path + "hiz_downsample.comp.spv");
+		hiz = pl::graphics::HiZPyramid::create(device, 
+											   image_depth, 
+											   image_depth_view, 
+											   pl::graphics::ShaderModule::create(device, hiz_init_resource), 
+											   pl::graphics::ShaderModule::create(device, hiz_downsample_resource));
+	}
 
    /***********************************************************************************
 	*
@@ -216,14 +322,36 @@ int main()
 		{
 			pl::graphics::ScopedRecord record(command_buffer);
 			command_buffer.begin_render_pass(render_pass, framebuffers[image_index], clear_vals);
+			geometry_pool->bind(command_buffer);
+
+			// Lay down depth first, binding only the position stream. The shading pass below then only runs the
+			// fragment shader for visible fragments.
+			if (depth_prepass)
+			{
+				command_buffer.bind_pipeline(depth_pipeline);
+				command_buffer.bind_descriptor_sets(depth_pipeline, set_id, { descriptor_set });
+				geometry_pool->draw(command_buffer, geometry_handle);
+			}
+
 			command_buffer.bind_pipeline(pipeline);
-			command_buffer.bind_vertex_buffer(vbo);
-			command_buffer.bind_index_buffer(ibo);
 			command_buffer.update_push_constant_ranges(pipeline, "time", pl::utils::app::get_elapsed_seconds());
 			command_buffer.update_push_constant_ranges(pipeline, "mouse", window.get_mouse_position(true, true));
 			command_buffer.bind_descriptor_sets(pipeline, set_id, { descriptor_set });
-			command_buffer.draw_indexed(static_cast<uint32_t>(geometry.num_indices()));
+			geometry_pool->draw(command_buffer, geometry_handle);
+
+			if (sphere_impostors)
+			{
+				command_buffer.bind_pipeline(*impostor_pipeline);
+				command_buffer.bind_descriptor_sets(*impostor_pipeline, set_id, { descriptor_set });
+				command_buffer.bind_vertex_buffer(*sphere_instance_buffer, binding_id_spheres);
+				geometry_pool->draw(command_buffer, geometry_handle, sphere_count);
+			}
 			command_buffer.end_render_pass();
+
+			if (hiz_pyramid)
+			{
+				hiz->record(command_buffer);
+			}
 		}
 		device.submit_with_semaphores(pl::graphics::QueueType::GRAPHICS, command_buffer, image_available_sem, render_complete_sem, {});
 		
@@ -0,0 +1,422 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define PLUME_CULLING_SSE
+#endif
+
+#include "Culling.h"
+#include "ThreadPool.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		namespace
+		{
+
+			//! The arrays are padded to a multiple of the widest SIMD width that we support (AVX), regardless of which
+			//! instruction set is actually used.
+			const size_t simd_padding = 8;
+
+			//! The number of objects tested by each task. This is a multiple of `simd_padding`, so that every chunk 
+			//! starts at the beginning of a SIMD group.
+			const size_t chunk_size = 16384;
+
+			size_t get_padded_size(size_t count)
+			{
+				return (count + simd_padding - 1) / simd_padding * simd_padding;
+			}
+
+			//! A frustum plane split into components (and absolute values of components) for testing several objects at once.
+			struct PlaneComponents
+			{
+				float x, y, z, w;
+				float abs_x, abs_y, abs_z;
+			};
+
+			void get_plane_components(const Frustum& frustum, PlaneComponents* components)
+			{
+				for (size_t i = 0; i < 6; ++i)
+				{
+					const glm::vec4& plane = frustum.planes[i];
+					components[i] = { plane.x, plane.y, plane.z, plane.w, fabsf(plane.x), fabsf(plane.y), fabsf(plane.z) };
+				}
+			}
+
+		} // anonymous
+
+		Frustum Frustum::from_view_projection(const glm::mat4& view_projection)
+		{
+			// glm matrices are column-major, so gather the rows first.
+			glm::vec4 rows[4];
+			for (int row = 0; row < 4; ++row)
+			{
+				rows[row] = glm::vec4{ view_projection[0][row], view_projection[1][row], view_projection[2][row], view_projection[3][row] };
+			}
+
+			Frustum frustum;
+			frustum.planes[PLANE_LEFT] = rows[3] + rows[0];
+			frustum.planes[PLANE_RIGHT] = rows[3] - rows[0];
+			frustum.planes[PLANE_BOTTOM] = rows[3] + rows[1];
+			frustum.planes[PLANE_TOP] = rows[3] - rows[1];
+			frustum.planes[PLANE_NEAR] = rows[3] + rows[2];
+			frustum.planes[PLANE_FAR] = rows[3] - rows[2];
+
+			// Normalize, so that plane distances are in world units (which is required for sphere tests).
+			for (auto& plane : frustum.planes)
+			{
+				plane /= glm::length(glm::vec3(plane));
+			}
+
+			return frustum;
+		}
+
+		bool Frustum::intersects(const BoundingSphere& sphere) const
+		{
+			if (sphere.is_empty())
+			{
+				return false;
+			}
+
+			for (const auto& plane : planes)
+			{
+				if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		bool Frustum::intersects(const BoundingBox& box) const
+		{
+			if (box.is_empty())
+			{
+				return false;
+			}
+
+			const glm::vec3 center = box.get_center();
+			const glm::vec3 extents = box.get_extents();
+			for (const auto& plane : planes)
+			{
+				// The projection of the box's extents onto the plane normal.
+				const float radius = glm::dot(glm::abs(glm::vec3(plane)), extents);
+				if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		OcclusionCullingParameters OcclusionCullingParameters::create(const glm::mat4& view_projection, 
+																	  const glm::mat4& previous_view_projection, 
+																	  uint32_t pyramid_width, 
+																	  uint32_t pyramid_height, 
+																	  uint32_t pyramid_mip_levels)
+		{
+			OcclusionCullingParameters parameters;
+			parameters.previous_view_projection = previous_view_projection;
+
+			const Frustum frustum = Frustum::from_view_projection(view_projection);
+			std::copy(std::begin(frustum.planes), std::end(frustum.planes), std::begin(parameters.frustum_planes));
+
+			parameters.pyramid_size = glm::vec4{ static_cast<float>(pyramid_width), 
+												 static_cast<float>(pyramid_height), 
+												 static_cast<float>(pyramid_mip_levels), 
+												 (pyramid_mip_levels > 0) ? 1.0f : 0.0f };
+
+			return parameters;
+		}
+
+		ClusteredLightingParameters ClusteredLightingParameters::create(const glm::mat4& view, 
+																		const glm::mat4& projection, 
+																		uint32_t width, 
+																		uint32_t height, 
+																		float z_near, 
+																		float z_far, 
+																		uint32_t tile_size, 
+																		uint32_t slice_count)
+		{
+			ClusteredLightingParameters parameters;
+			parameters.view = view;
+			parameters.inverse_projection = glm::inverse(projection);
+
+			const uint32_t tiles_x = (width + tile_size - 1) / tile_size;
+			const uint32_t tiles_y = (height + tile_size - 1) / tile_size;
+			parameters.grid_size = glm::vec4{ static_cast<float>(tiles_x), 
+											  static_cast<float>(tiles_y), 
+											  static_cast<float>(slice_count), 
+											  static_cast<float>(tiles_x * tiles_y * slice_count) };
+
+			parameters.screen_size = glm::vec4{ static_cast<float>(width), static_cast<float>(height), static_cast<float>(tile_size), 0.0f };
+
+			// slice = log(depth / z_near) / log(z_far / z_near) * slice_count, which is split into a scale and bias so that the
+			// shader only has to evaluate a single log and multiply-add per fragment.
+			const float log_depth_range = std::log(z_far / z_near);
+			parameters.depth_slicing = glm::vec4{ z_near, 
+												  z_far, 
+												  static_cast<float>(slice_count) / log_depth_range, 
+												  -static_cast<float>(slice_count) * std::log(z_near) / log_depth_range };
+
+			return parameters;
+		}
+
+		uint32_t FrustumCuller::add(const BoundingBox& world_bounds)
+		{
+			if (m_count >= std::numeric_limits<uint32_t>::max())
+			{
+				throw std::runtime_error("The frustum culler cannot hold more than 2^32 objects");
+			}
+
+			const uint32_t index = static_cast<uint32_t>(m_count++);
+			reserve(m_count);
+			set_bounds(index, world_bounds);
+
+			return index;
+		}
+
+		uint32_t FrustumCuller::add(const BoundingSphere& world_bounds)
+		{
+			if (m_count >= std::numeric_limits<uint32_t>::max())
+			{
+				throw std::runtime_error("The frustum culler cannot hold more than 2^32 objects");
+			}
+
+			const uint32_t index = static_cast<uint32_t>(m_count++);
+			reserve(m_count);
+			set_bounds(index, world_bounds);
+
+			return index;
+		}
+
+		void FrustumCuller::set_bounds(uint32_t index, const BoundingBox& world_bounds)
+		{
+			if (world_bounds.is_empty())
+			{
+				// NaN centers fail every comparison, so the object is always rejected.
+				set(index, glm::vec3(std::numeric_limits<float>::quiet_NaN()), glm::vec3(0.0f), 0.0f);
+				return;
+			}
+
+			// The radius of the sphere that encloses the box: this never projects to less than the box itself.
+			const glm::vec3 extents = world_bounds.get_extents();
+			set(index, world_bounds.get_center(), extents, glm::length(extents));
+		}
+
+		void FrustumCuller::set_bounds(uint32_t index, const BoundingSphere& world_bounds)
+		{
+			if (world_bounds.is_empty())
+			{
+				set(index, glm::vec3(std::numeric_limits<float>::quiet_NaN()), glm::vec3(0.0f), 0.0f);
+				return;
+			}
+
+			// The box that encloses the sphere: this never projects to less than the sphere itself.
+			set(index, world_bounds.center, glm::vec3(world_bounds.radius), world_bounds.radius);
+		}
+
+		void FrustumCuller::reserve(size_t count)
+		{
+			const size_t padded_size = get_padded_size(count);
+			if (padded_size <= m_radius.size())
+			{
+				return;
+			}
+
+			// Grow geometrically, so that adding objects one at a time is amortized constant time.
+			const size_t new_size = std::max(padded_size, m_radius.size() * 2);
+			for (auto* component : { &m_center_x, &m_center_y, &m_center_z, &m_extent_x, &m_extent_y, &m_extent_z, &m_radius })
+			{
+				component->resize(new_size, 0.0f);
+			}
+		}
+
+		void FrustumCuller::clear()
+		{
+			m_count = 0;
+		}
+
+		void FrustumCuller::cull(const Frustum& frustum, std::vector<uint32_t>& visible) const
+		{
+			visible.resize(m_count);
+
+			// Each chunk writes its visible indices to the start of its own range of the output, then the ranges are 
+			// moved down to close the gaps. This keeps the output in order without any synchronization between tasks.
+			const size_t chunk_count = (m_count + chunk_size - 1) / chunk_size;
+			std::vector<size_t> chunk_visible_counts(chunk_count);
+
+			utils::ThreadPool::global().parallel_for(0, chunk_count, 1, [&](size_t begin, size_t end)
+			{
+				for (size_t chunk = begin; chunk < end; ++chunk)
+				{
+					const size_t first = chunk * chunk_size;
+					const size_t last = std::min(first + chunk_size, m_count);
+					chunk_visible_counts[chunk] = cull_range(frustum, first, last, visible.data() + first);
+				}
+			});
+
+			size_t visible_count = 0;
+			for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+			{
+				if (visible_count != chunk * chunk_size)
+				{
+					memmove(visible.data() + visible_count, visible.data() + chunk * chunk_size, chunk_visible_counts[chunk] * sizeof(uint32_t));
+				}
+				visible_count += chunk_visible_counts[chunk];
+			}
+			visible.resize(visible_count);
+		}
+
+		void FrustumCuller::set(uint32_t index, const glm::vec3& center, const glm::vec3& extents, float radius)
+		{
+			if (index >= m_count)
+			{
+				throw std::runtime_error("Attempting to set the bounds of an object that was never added to the frustum culler");
+			}
+
+			m_center_x[index] = center.x;
+			m_center_y[index] = center.y;
+			m_center_z[index] = center.z;
+			m_extent_x[index] = extents.x;
+			m_extent_y[index] = extents.y;
+			m_extent_z[index] = extents.z;
+			m_radius[index] = radius;
+		}
+
+		size_t FrustumCuller::cull_range(const Frustum& frustum, size_t begin, size_t end, uint32_t* destination) const
+		{
+			PlaneComponents planes[6];
+			get_plane_components(frustum, planes);
+
+			size_t visible_count = 0;
+
+#if defined(__AVX__)
+			for (size_t i = begin; i < end; i += 8)
+			{
+				const __m256 center_x = _mm256_loadu_ps(m_center_x.data() + i);
+				const __m256 center_y = _mm256_loadu_ps(m_center_y.data() + i);
+				const __m256 center_z = _mm256_loadu_ps(m_center_z.data() + i);
+				const __m256 extent_x = _mm256_loadu_ps(m_extent_x.data() + i);
+				const __m256 extent_y = _mm256_loadu_ps(m_extent_y.data() + i);
+				const __m256 extent_z = _mm256_loadu_ps(m_extent_z.data() + i);
+				const __m256 radius = _mm256_loadu_ps(m_radius.data() + i);
+
+				__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (const auto& plane : planes)
+				{
+					const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(center_x, _mm256_set1_ps(plane.x)), 
+																		_mm256_mul_ps(center_y, _mm256_set1_ps(plane.y))),
+														  _mm256_add_ps(_mm256_mul_ps(center_z, _mm256_set1_ps(plane.z)), 
+																		_mm256_set1_ps(plane.w)));
+					const __m256 box_radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(extent_x, _mm256_set1_ps(plane.abs_x)),
+																		  _mm256_mul_ps(extent_y, _mm256_set1_ps(plane.abs_y))),
+															_mm256_mul_ps(extent_z, _mm256_set1_ps(plane.abs_z)));
+					const __m256 projected_radius = _mm256_min_ps(box_radius, radius);
+
+					// distance + radius >= 0 (false for NaN)
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, projected_radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+				}
+
+				const size_t lanes = std::min(end - i, size_t{ 8 });
+				const int mask = _mm256_movemask_ps(inside);
+				for (size_t lane = 0; lane < lanes; ++lane)
+				{
+					// Branchless compaction: always write, but only advance past visible objects.
+					destination[visible_count] = static_cast<uint32_t>(i + lane);
+					visible_count += (mask >> lane) & 1;
+				}
+			}
+#elif defined(PLUME_CULLING_SSE)
+			for (size_t i = begin; i < end; i += 4)
+			{
+				const __m128 center_x = _mm_loadu_ps(m_center_x.data() + i);
+				const __m128 center_y = _mm_loadu_ps(m_center_y.data() + i);
+				const __m128 center_z = _mm_loadu_ps(m_center_z.data() + i);
+				const __m128 extent_x = _mm_loadu_ps(m_extent_x.data() + i);
+				const __m128 extent_y = _mm_loadu_ps(m_extent_y.data() + i);
+				const __m128 extent_z = _mm_loadu_ps(m_extent_z.data() + i);
+				const __m128 radius = _mm_loadu_ps(m_radius.data() + i);
+
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (const auto& plane : planes)
+				{
+					const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(center_x, _mm_set1_ps(plane.x)), 
+																  _mm_mul_ps(center_y, _mm_set1_ps(plane.y))),
+													   _mm_add_ps(_mm_mul_ps(center_z, _mm_set1_ps(plane.z)), 
+																  _mm_set1_ps(plane.w)));
+					const __m128 box_radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extent_x, _mm_set1_ps(plane.abs_x)),
+																	_mm_mul_ps(extent_y, _mm_set1_ps(plane.abs_y))),
+														 _mm_mul_ps(extent_z, _mm_set1_ps(plane.abs_z)));
+					const __m128 projected_radius = _mm_min_ps(box_radius, radius);
+
+					// distance + radius >= 0 (false for NaN)
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, projected_radius), _mm_setzero_ps()));
+				}
+
+				const size_t lanes = std::min(end - i, size_t{ 4 });
+				const int mask = _mm_movemask_ps(inside);
+				for (size_t lane = 0; lane < lanes; ++lane)
+				{
+					// Branchless compaction: always write, but only advance past visible objects.
+					destination[visible_count] = static_cast<uint32_t>(i + lane);
+					visible_count += (mask >> lane) & 1;
+				}
+			}
+#else
+			for (size_t i = begin; i < end; ++i)
+			{
+				bool inside = true;
+				for (const auto& plane : planes)
+				{
+					const float distance = m_center_x[i] * plane.x + m_center_y[i] * plane.y + m_center_z[i] * plane.z + plane.w;
+					const float box_radius = m_extent_x[i] * plane.abs_x + m_extent_y[i] * plane.abs_y + m_extent_z[i] * plane.abs_z;
+					inside &= (distance + std::min(box_radius, m_radius[i]) >= 0.0f);
+				}
+
+				destination[visible_count] = static_cast<uint32_t>(i);
+				visible_count += inside ? 1 : 0;
+			}
+#endif
+
+			return visible_count;
+		}
+
+	} // namespace geom
+
+} // namespace plume
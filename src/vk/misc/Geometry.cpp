@@ -24,200 +24,1305 @@
 *
 */
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
 #include "Geometry.h"
+#include "MeshOptimizer.h"
+#include "ThreadPool.h"
+#include "VertexLayout.h"
 
 namespace plume
 {
 
-	namespace geom
-	{
+	namespace geom
+	{
+
+		static const VertexAttributeSet active_attributes =
+		{
+			VertexAttribute::ATTRIBUTE_POSITION,
+			VertexAttribute::ATTRIBUTE_COLOR,
+			VertexAttribute::ATTRIBUTE_NORMAL,
+			VertexAttribute::ATTRIBUTE_TEXTURE_COORDINATES
+		};
+
+		namespace
+		{
+
+			//! Converts a 32-bit float to a 16-bit (IEEE 754 half precision) float, rounding to the nearest even value.
+			uint16_t float_to_half(float value)
+			{
+				uint32_t bits;
+				memcpy(&bits, &value, sizeof(float));
+
+				const uint32_t sign = (bits >> 16) & 0x8000;
+				const uint32_t biased_exponent = (bits >> 23) & 0xff;
+				uint32_t mantissa = bits & 0x7fffff;
+
+				// Infinity and NaN (keep NaNs quiet).
+				if (biased_exponent == 0xff)
+				{
+					return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+				}
+
+				const int32_t exponent = static_cast<int32_t>(biased_exponent) - 127 + 15;
+
+				// Values that are too large to represent become infinity.
+				if (exponent >= 31)
+				{
+					return static_cast<uint16_t>(sign | 0x7c00);
+				}
+
+				// Values that are too small to be normalized become subnormals (or zero).
+				if (exponent <= 0)
+				{
+					if (exponent < -10)
+					{
+						return static_cast<uint16_t>(sign);
+					}
+
+					mantissa |= 0x800000;
+					const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+					const uint32_t remainder = mantissa & ((1u << shift) - 1);
+					const uint32_t halfway = 1u << (shift - 1);
+
+					uint32_t half = mantissa >> shift;
+					if (remainder > halfway || (remainder == halfway && (half & 1)))
+					{
+						++half;
+					}
+					return static_cast<uint16_t>(sign | half);
+				}
+
+				// Note that rounding may carry into the exponent, which correctly produces the next power of two.
+				uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+				const uint32_t remainder = mantissa & 0x1fff;
+				if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+				{
+					++half;
+				}
+				return static_cast<uint16_t>(half);
+			}
+
+			uint16_t float_to_unorm16(float value)
+			{
+				return static_cast<uint16_t>(roundf(glm::clamp(value, 0.0f, 1.0f) * 65535.0f));
+			}
+
+			int16_t float_to_snorm16(float value)
+			{
+				return static_cast<int16_t>(roundf(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+			}
+
+			uint8_t float_to_unorm8(float value)
+			{
+				return static_cast<uint8_t>(roundf(glm::clamp(value, 0.0f, 1.0f) * 255.0f));
+			}
+
+			//! Maps a unit vector onto the octahedron |x| + |y| + |z| = 1, which is then unfolded onto the square [-1..1]^2.
+			//! See: "A Survey of Efficient Representations for Independent Unit Vectors" (Cigolle et al., 2014).
+			glm::vec2 octahedral_encode(const glm::vec3& normal)
+			{
+				const float l1_norm = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+				if (l1_norm == 0.0f)
+				{
+					return { 0.0f, 0.0f };
+				}
+
+				glm::vec2 encoded = glm::vec2(normal.x, normal.y) / l1_norm;
+
+				// Fold the lower hemisphere over the diagonals.
+				if (normal.z < 0.0f)
+				{
+					encoded = glm::vec2((1.0f - fabsf(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f),
+										(1.0f - fabsf(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f));
+				}
+
+				return encoded;
+			}
+
+			//! Converts a 16-bit (IEEE 754 half precision) float to a 32-bit float. Every half value is exactly representable.
+			float half_to_float(uint16_t value)
+			{
+				const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+				uint32_t exponent = (value >> 10) & 0x1f;
+				uint32_t mantissa = value & 0x3ff;
+
+				uint32_t bits;
+				if (exponent == 0x1f)
+				{
+					// Infinity and NaN.
+					bits = sign | 0x7f800000 | (mantissa << 13);
+				}
+				else if (exponent == 0)
+				{
+					if (mantissa == 0)
+					{
+						bits = sign;
+					}
+					else
+					{
+						// Subnormals are normalized, since they are well within the range of a 32-bit float.
+						exponent = 127 - 15 + 1;
+						while (!(mantissa & 0x400))
+						{
+							mantissa <<= 1;
+							--exponent;
+						}
+						bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+					}
+				}
+				else
+				{
+					bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+				}
+
+				float result;
+				memcpy(&result, &bits, sizeof(float));
+				return result;
+			}
+
+			float unorm16_to_float(uint16_t value)
+			{
+				return value / 65535.0f;
+			}
+
+			float snorm16_to_float(int16_t value)
+			{
+				return std::max(value / 32767.0f, -1.0f);
+			}
+
+			float unorm8_to_float(uint8_t value)
+			{
+				return value / 255.0f;
+			}
+
+			//! The inverse of `octahedral_encode()`.
+			glm::vec3 octahedral_decode(const glm::vec2& encoded)
+			{
+				glm::vec3 normal{ encoded.x, encoded.y, 1.0f - fabsf(encoded.x) - fabsf(encoded.y) };
+
+				// Unfold the lower hemisphere.
+				if (normal.z < 0.0f)
+				{
+					normal.x = (1.0f - fabsf(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f);
+					normal.y = (1.0f - fabsf(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f);
+				}
+
+				const float length = glm::length(normal);
+				return (length > 0.0f) ? normal / length : normal;
+			}
+
+			//! Writes every element of `source` to `destination`, `stride` bytes apart. Tightly packed streams are written with
+			//! a single copy.
+			template<class T>
+			void copy_stream(const std::vector<T>& source, uint8_t* destination, size_t stride)
+			{
+				if (stride == sizeof(T))
+				{
+					memcpy(destination, source.data(), source.size() * sizeof(T));
+					return;
+				}
+
+				for (const auto& element : source)
+				{
+					memcpy(destination, &element, sizeof(T));
+					destination += stride;
+				}
+			}
+
+			//! Converts every element of `source` with `encode`, which must return a trivially copyable value, and writes the
+			//! results to `destination`, `stride` bytes apart.
+			template<class T, class Encoder>
+			void encode_stream(const std::vector<T>& source, uint8_t* destination, size_t stride, Encoder encode)
+			{
+				for (const auto& element : source)
+				{
+					const auto encoded = encode(element);
+					memcpy(destination, &encoded, sizeof(encoded));
+					destination += stride;
+				}
+			}
+
+			//! The inverse of `copy_stream()`: reads every element of `destination` from `source`, `stride` bytes apart.
+			template<class T>
+			void read_stream(const uint8_t* source, std::vector<T>& destination, size_t stride)
+			{
+				if (stride == sizeof(T))
+				{
+					memcpy(destination.data(), source, destination.size() * sizeof(T));
+					return;
+				}
+
+				for (auto& element : destination)
+				{
+					memcpy(&element, source, sizeof(T));
+					source += stride;
+				}
+			}
+
+			//! The inverse of `encode_stream()`: reads a value of type `Encoded` from `source` for every element of `destination`,
+			//! `stride` bytes apart, and converts it with `decode`.
+			template<class Encoded, class T, class Decoder>
+			void decode_stream(const uint8_t* source, std::vector<T>& destination, size_t stride, Decoder decode)
+			{
+				for (auto& element : destination)
+				{
+					Encoded encoded;
+					memcpy(&encoded, source, sizeof(Encoded));
+					element = decode(encoded);
+					source += stride;
+				}
+			}
+
+			//! Quantizes `value` to a multiple of `epsilon`. An epsilon of zero keeps the exact bits of the value.
+			int64_t quantize(float value, float epsilon)
+			{
+				if (epsilon <= 0.0f)
+				{
+					int32_t bits;
+					memcpy(&bits, &value, sizeof(bits));
+					return bits;
+				}
+
+				const float scaled = std::round(value / epsilon);
+				return std::isfinite(scaled) ? static_cast<int64_t>(scaled) : 0;
+			}
+
+			//! Pointers to the first vertex of a single row within a set of structure-of-arrays streams.
+			struct SoARow
+			{
+				float* position_x;
+				float* position_y;
+				float* position_z;
+				float* normal_x;
+				float* normal_y;
+				float* normal_z;
+				float* texture_coordinate_u;
+				float* texture_coordinate_v;
+			};
+
+			SoARow get_soa_row(SoAVertexData& data, size_t first_vertex)
+			{
+				return 
+				{
+					data.position_x.data() + first_vertex,
+					data.position_y.data() + first_vertex,
+					data.position_z.data() + first_vertex,
+					data.normal_x.data() + first_vertex,
+					data.normal_y.data() + first_vertex,
+					data.normal_z.data() + first_vertex,
+					data.texture_coordinate_u.data() + first_vertex,
+					data.texture_coordinate_v.data() + first_vertex
+				};
+			}
+
+			//! Invokes `func` over `[0, row_count)`, either on the calling thread or split into ranges across the global
+			//! thread pool. Callers must only write to preallocated storage owned by the rows they are given.
+			void for_each_row_range(size_t row_count, const GenerationOptions& options, const std::function<void(size_t, size_t)>& func)
+			{
+				const size_t rows_per_task = std::max<size_t>(options.rows_per_task, 1);
+
+				if (options.parallel && row_count > rows_per_task)
+				{
+					utils::ThreadPool::global().parallel_for(0, row_count, rows_per_task, func);
+				}
+				else
+				{
+					func(0, row_count);
+				}
+			}
+
+			float remap(float v, float in_min, float in_max, float out_min, float out_max)
+			{
+				return (v - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+			}
+
+			//! Returns the number of indices that `Grid` emits for every row except the last one.
+			size_t get_grid_indices_per_row(uint32_t u_subdivisions)
+			{
+				return (u_subdivisions > 1) ? 6 * static_cast<size_t>(u_subdivisions - 1) : 0;
+			}
+
+			void generate_grid_row(size_t row, float width, float height, uint32_t u_subdivisions, uint32_t v_subdivisions, const glm::vec3& center, const SoARow& out, uint32_t* indices)
+			{
+				const float v = static_cast<float>(row) / (v_subdivisions - 1);
+
+				for (size_t col = 0; col < u_subdivisions; ++col)
+				{
+					const float u = static_cast<float>(col) / (u_subdivisions - 1);
+
+					glm::vec3 pt = { remap(u, 0.0f, 1.0f, -1.0f, 1.0f),
+									 remap(v, 0.0f, 1.0f, -1.0f, 1.0f),
+									 0.0f };
+					pt.x *= width;
+					pt.y *= height;
+					pt += center;
+
+					out.position_x[col] = pt.x;
+					out.position_y[col] = pt.y;
+					out.position_z[col] = pt.z;
+					out.normal_x[col] = 0.0f;
+					out.normal_y[col] = 0.0f;
+					out.normal_z[col] = 1.0f;
+					out.texture_coordinate_u[col] = u;
+					out.texture_coordinate_v[col] = v;
+				}
+
+				// If `u_divisions` is set to 4, we have:
+				// 
+				// 0 -- 1 -- 2 -- 3
+				// | \  | \  |  \ |
+				// 4 -- 5 -- 6 -- 7
+				// . . . 
+				// .
+				// .
+				// Note: we assume a clockwise winding pattern.
+
+				// We don't need to form any triangles for the last row
+				if (row + 1 == v_subdivisions)
+				{
+					return;
+				}
+
+				for (size_t col = 0; col < u_subdivisions; ++col)
+				{
+					const uint32_t cell = static_cast<uint32_t>(col + u_subdivisions * row);
+
+					// Form the first triangle (i.e. 0 -> 5 -> 4...).
+					if (col + 1 != u_subdivisions)
+					{
+						*indices++ = cell;
+						*indices++ = cell + u_subdivisions + 1;
+						*indices++ = cell + u_subdivisions;
+					}
+
+					// Only form this triangle if we aren't on the first (0-th) column.
+					if (col != 0)
+					{
+						*indices++ = cell;
+						*indices++ = cell + u_subdivisions;
+						*indices++ = cell - 1;
+					}
+				}
+			}
+
+			//! The per-column rotational angles of a `Sphere`, evaluated once and shared by every row.
+			struct SphereColumns
+			{
+				SphereColumns(size_t u_divisions) :
+					cos_theta(u_divisions + 1),
+					sin_theta(u_divisions + 1)
+				{
+					for (size_t j = 0; j <= u_divisions; ++j)
+					{
+						float u = j / static_cast<float>(u_divisions);	// Fraction along the u-axis, 0..1
+						float theta = u * (glm::pi<float>() * 2);		// Rotational angle, 0..2 * pi
+
+						cos_theta[j] = cosf(theta);
+						sin_theta[j] = sinf(theta);
+					}
+				}
+
+				std::vector<float> cos_theta;
+				std::vector<float> sin_theta;
+			};
+
+			void generate_sphere_row(size_t row, float radius, const glm::vec3& center, size_t u_divisions, size_t v_divisions, const SphereColumns& columns, const SoARow& out)
+			{
+				float v = row / static_cast<float>(v_divisions);		// Fraction along the v-axis, 0..1
+				float phi = v * glm::pi<float>();						// Vertical angle, 0..pi
+
+				const float sin_phi = sinf(phi);
+				const float cos_phi = cosf(phi);
+
+				for (size_t j = 0; j <= u_divisions; ++j)
+				{
+					// Spherical to Cartesian coordinates.
+					float x = columns.cos_theta[j] * sin_phi;
+					float y = cos_phi;
+					float z = columns.sin_theta[j] * sin_phi;
+					auto vertex = glm::vec3(x, y, z) * radius + center;
+					auto normal = glm::normalize(vertex - center);
+
+					out.position_x[j] = vertex.x;
+					out.position_y[j] = vertex.y;
+					out.position_z[j] = vertex.z;
+					out.normal_x[j] = normal.x;
+					out.normal_y[j] = normal.y;
+					out.normal_z[j] = normal.z;
+
+					// TODO: figure out how to calculate uv-coordinates.
+					out.texture_coordinate_u[j] = 0.0f;
+					out.texture_coordinate_v[j] = 0.0f;
+				}
+			}
+
+			//! Writes the indices of `Sphere`, which emits six indices (two triangles) per quad and `u_divisions` quads for 
+			//! each of its `v_divisions` rows of quads. Each row of vertices holds `u_divisions + 1` vertices, since the 
+			//! first and last column are duplicated along the seam.
+			void generate_sphere_indices(size_t u_divisions, size_t v_divisions, const GenerationOptions& options, uint32_t* indices)
+			{
+				const size_t row_size = u_divisions + 1;
+
+				for_each_row_range(v_divisions, options, [&](size_t begin, size_t end)
+				{
+					for (size_t row = begin; row < end; ++row)
+					{
+						for (size_t column = 0; column < u_divisions; ++column)
+						{
+							const size_t base = row * row_size + column;
+
+							uint32_t* quad = indices + (row * u_divisions + column) * 6;
+							quad[0] = static_cast<uint32_t>(base);
+							quad[1] = static_cast<uint32_t>(base + row_size + 1);
+							quad[2] = static_cast<uint32_t>(base + row_size);
+							quad[3] = static_cast<uint32_t>(base + row_size + 1);
+							quad[4] = static_cast<uint32_t>(base);
+							quad[5] = static_cast<uint32_t>(base + 1);
+						}
+					}
+				});
+			}
+
+		} // anonymous
+
+		vk::Format Geometry::get_vertex_attribute_format(VertexAttribute attribute, const VertexEncoding& encoding)
+		{
+			switch (attribute)
+			{
+			case VertexAttribute::ATTRIBUTE_POSITION:
+				switch (encoding.positions)
+				{
+				case PositionEncoding::POSITION_FLOAT16: return vk::Format::eR16G16B16A16Sfloat;
+				case PositionEncoding::POSITION_UNORM16: return vk::Format::eR16G16B16A16Unorm;
+				default: return vk::Format::eR32G32B32Sfloat;
+				}
+			case VertexAttribute::ATTRIBUTE_COLOR: return (encoding.colors == ColorEncoding::COLOR_UNORM8) ? vk::Format::eR8G8B8A8Unorm : vk::Format::eR32G32B32Sfloat;
+			case VertexAttribute::ATTRIBUTE_NORMAL: return (encoding.normals == NormalEncoding::NORMAL_OCTAHEDRAL_SNORM16) ? vk::Format::eR16G16Snorm : vk::Format::eR32G32B32Sfloat;
+			case VertexAttribute::ATTRIBUTE_TEXTURE_COORDINATES: return (encoding.texture_coordinates == TextureCoordinateEncoding::TEXTURE_COORDINATES_FLOAT16) ? vk::Format::eR16G16Sfloat : vk::Format::eR32G32Sfloat;
+			default: return vk::Format::eUndefined;
+			}
+		}
+
+		uint32_t Geometry::get_vertex_attribute_dimensions(VertexAttribute attribute)
+		{
+			switch (attribute)
+			{
+			case VertexAttribute::ATTRIBUTE_POSITION:
+			case VertexAttribute::ATTRIBUTE_COLOR:
+			case VertexAttribute::ATTRIBUTE_NORMAL: return 3;
+			case VertexAttribute::ATTRIBUTE_TEXTURE_COORDINATES: return 2;
+			default: return 0;
+			}
+		}
+
+		uint32_t Geometry::get_vertex_attribute_size(VertexAttribute attribute, const VertexEncoding& encoding)
+		{
+			switch (get_vertex_attribute_format(attribute, encoding))
+			{
+			case vk::Format::eR16G16B16A16Sfloat:
+			case vk::Format::eR16G16B16A16Unorm: return sizeof(uint16_t) * 4;
+			case vk::Format::eR8G8B8A8Unorm: return sizeof(uint8_t) * 4;
+			case vk::Format::eR16G16Snorm:
+			case vk::Format::eR16G16Sfloat: return sizeof(uint16_t) * 2;
+			default: return get_vertex_attribute_dimensions(attribute) * sizeof(float);
+			}
+		}
+
+		uint32_t Geometry::get_vertex_attribute_offset(VertexAttribute attribute, const VertexEncoding& encoding)
+		{
+			// Interleaved attributes are laid out in the same order as the active attributes.
+			uint32_t offset = 0;
+			for (auto available_attribute : active_attributes)
+			{
+				if (available_attribute == attribute)
+				{
+					break;
+				}
+				offset += get_vertex_attribute_size(available_attribute, encoding);
+			}
+
+			return offset;
+		}
+
+		std::vector<vk::VertexInputAttributeDescription> Geometry::get_vertex_input_attribute_descriptions(uint32_t start_binding, AttributeMode mode, const VertexEncoding& encoding)
+		{
+			std::vector<vk::VertexInputAttributeDescription> input_attribute_descriptions;
+			uint32_t attribute_binding = start_binding;		// The binding number which this attribute takes its data from.
+			uint32_t attribute_offset = 0;					// The byte offset of this attribute relative to the start of an element in the vertex input binding
+
+			for (auto available_attribute : active_attributes)
+			{
+				uint32_t attribute_location = static_cast<uint32_t>(available_attribute);		// The shader binding location number for this attribute.
+				vk::Format attribute_format = get_vertex_attribute_format(available_attribute, encoding);	// The size and type of the vertex attribute data.
+
+				// If the vertex attributes are interleaved, we need to do some work to figure out
+				// the byte offset of each attribute relative to the start of an element (vertex or instance).
+				if (mode == AttributeMode::MODE_INTERLEAVED)
+				{
+					attribute_offset = get_vertex_attribute_offset(available_attribute, encoding);
+				}
+
+				// With split positions, positions occupy the first binding and everything else is interleaved in the 
+				// second binding. Positions are always the first active attribute, so they can simply be skipped over.
+				else if (mode == AttributeMode::MODE_SPLIT_POSITIONS)
+				{
+					const bool is_position = (available_attribute == VertexAttribute::ATTRIBUTE_POSITION);
+					const uint32_t position_size = get_vertex_attribute_size(VertexAttribute::ATTRIBUTE_POSITION, encoding);
+
+					attribute_binding = is_position ? start_binding : start_binding + 1;
+					attribute_offset = is_position ? 0 : get_vertex_attribute_offset(available_attribute, encoding) - position_size;
+				}
+
+				input_attribute_descriptions.push_back({
+					attribute_location,
+					attribute_binding,
+					attribute_format,
+					attribute_offset
+				});
+
+				// If the vertex attributes are separate, then we increment the binding index. 
+				if (mode == AttributeMode::MODE_SEPARATE)
+				{
+					attribute_binding++;
+				}
+			}
+			return input_attribute_descriptions;
+		}
+
+		std::vector<vk::VertexInputBindingDescription> Geometry::get_vertex_input_binding_descriptions(uint32_t start_binding, AttributeMode mode, const VertexEncoding& encoding)
+		{
+			// Note that instanced attributes (i.e. vk::VertexInputRate::eInstance) are described separately: see `get_instance_input_state()`
+			// in Instancing.h. Also, this doesn't let you create vertex bindings that are not sequential (i.e. 0, 2, 4, 6, etc...), although 
+			// I'm not sure this actually matters.
+
+			std::vector<vk::VertexInputBindingDescription> binding_descriptions;
+			uint32_t binding_index = start_binding;
+
+			// If the attributes are interleaved (and assuming we are not instancing), then the vertex
+			// data will all belong to a single buffer with a stride equal to the total size of all
+			// vertex attributes combined.
+			if (mode == AttributeMode::MODE_INTERLEAVED)
+			{
+				binding_descriptions.push_back({
+					binding_index,
+					get_vertex_stride(encoding),
+					vk::VertexInputRate::eVertex
+				});
+
+				return binding_descriptions;
+			}
+
+			// With split positions, there is one binding for the position stream and one for all of the remaining attributes.
+			if (mode == AttributeMode::MODE_SPLIT_POSITIONS)
+			{
+				const uint32_t position_size = get_vertex_attribute_size(VertexAttribute::ATTRIBUTE_POSITION, encoding);
+
+				binding_descriptions.push_back({
+					binding_index,
+					position_size,
+					vk::VertexInputRate::eVertex
+				});
+				binding_descriptions.push_back({
+					binding_index + 1,
+					get_vertex_stride(encoding) - position_size,
+					vk::VertexInputRate::eVertex
+				});
+
+				return binding_descriptions;
+			}
+
+			// Otherwise, the attributes are separate and will each exist in a unique buffer (or region
+			// of buffer memory).
+			for (auto available_attribute : active_attributes)
+			{
+				uint32_t binding_stride = get_vertex_attribute_size(available_attribute, encoding);
+
+				binding_descriptions.push_back({
+					binding_index,
+					binding_stride,
+					vk::VertexInputRate::eVertex
+				});
+
+				if (mode == AttributeMode::MODE_SEPARATE)
+				{
+					binding_index++;
+				}
+			}
+			return binding_descriptions;
+		}
+
+		VertexInputState Geometry::get_vertex_input_state(VertexInputPreset preset, AttributeMode mode, uint32_t start_binding, const VertexEncoding& encoding)
+		{
+			if (preset == VertexInputPreset::PRESET_ALL_ATTRIBUTES)
+			{
+				return { get_vertex_input_binding_descriptions(start_binding, mode, encoding), get_vertex_input_attribute_descriptions(start_binding, mode, encoding) };
+			}
+
+			// Positions are always the first stream (or the first attribute of each interleaved vertex), so a position-only
+			// pipeline only needs a single binding. With interleaved data, it still has to stride over entire vertices.
+			const uint32_t stride = (mode == AttributeMode::MODE_INTERLEAVED) ? 
+									get_vertex_stride(encoding) : 
+									get_vertex_attribute_size(VertexAttribute::ATTRIBUTE_POSITION, encoding);
+
+			VertexInputState state;
+			state.bindings.push_back({
+				start_binding,
+				stride,
+				vk::VertexInputRate::eVertex
+			});
+			state.attributes.push_back({
+				static_cast<uint32_t>(VertexAttribute::ATTRIBUTE_POSITION),
+				start_binding,
+				get_vertex_attribute_format(VertexAttribute::ATTRIBUTE_POSITION, encoding),
+				0
+			});
+
+			return state;
+		}
+
+		uint32_t Geometry::get_vertex_stride(const VertexEncoding& encoding)
+		{
+			uint32_t stride = 0;
+			for (auto available_attribute : active_attributes)
+			{
+				stride += get_vertex_attribute_size(available_attribute, encoding);
+			}
+
+			return stride;
+		}
+
+		std::vector<float> Geometry::get_packed_vertex_attributes(AttributeMode mode) const
+		{
+			std::vector<float> packed_vertex_attributes(get_packed_vertex_attributes_size() / sizeof(float));
+			pack_vertex_attributes(packed_vertex_attributes.data(), mode);
+
+			return packed_vertex_attributes;
+		}
+
+		size_t Geometry::get_vertex_stream_offset(VertexAttribute attribute, const VertexEncoding& encoding) const
+		{
+			// Streams are laid out one after another, in the same order as the active attributes.
+			size_t offset = 0;
+			for (auto available_attribute : active_attributes)
+			{
+				if (available_attribute == attribute)
+				{
+					return offset;
+				}
+				offset += get_vertex_count() * get_vertex_attribute_size(available_attribute, encoding);
+			}
+
+			throw std::runtime_error("The requested vertex attribute is not active");
+		}
+
+		void Geometry::pack_vertex_attributes(void* destination, AttributeMode mode, const VertexEncoding& encoding) const
+		{
+			const size_t vertex_count = get_vertex_count();
+
+			if (m_colors.size() != vertex_count ||
+				m_normals.size() != vertex_count ||
+				m_texture_coordinates.size() != vertex_count)
+			{
+				throw std::runtime_error("All vertex attributes must have the same number of elements before they can be packed");
+			}
+
+			// Uncompressed, interleaved vertices match `DefaultVertex` exactly, so they can be packed with a loop that is
+			// specialized for that layout at compile time.
+			if (mode == AttributeMode::MODE_INTERLEAVED &&
+				encoding.positions == PositionEncoding::POSITION_FLOAT32 &&
+				encoding.normals == NormalEncoding::NORMAL_FLOAT32 &&
+				encoding.colors == ColorEncoding::COLOR_FLOAT32 &&
+				encoding.texture_coordinates == TextureCoordinateEncoding::TEXTURE_COORDINATES_FLOAT32)
+			{
+				DefaultVertexLayout::pack(*this, destination);
+				return;
+			}
+
+			uint8_t* destination_ptr = static_cast<uint8_t*>(destination);
+			const PositionDequantization dequantization = get_position_dequantization(encoding);
+
+			// Hoist the layout out of the loops below, since it's the same for every vertex.
+			std::vector<uint32_t> attribute_sizes;
+			std::vector<size_t> attribute_offsets;
+			for (auto available_attribute : active_attributes)
+			{
+				attribute_sizes.push_back(get_vertex_attribute_size(available_attribute, encoding));
+				attribute_offsets.push_back((mode == AttributeMode::MODE_SEPARATE) ? 
+											get_vertex_stream_offset(available_attribute, encoding) : 
+											get_vertex_attribute_offset(available_attribute, encoding));
+			}
+
+			if (mode == AttributeMode::MODE_SPLIT_POSITIONS)
+			{
+				// Positions are written as their own tightly packed stream, followed by the remaining attributes interleaved.
+				const uint32_t position_size = attribute_sizes[0];
+				const uint32_t attribute_stride = get_vertex_stride(encoding) - position_size;
+
+				encode_vertex_stream(VertexAttribute::ATTRIBUTE_POSITION, encoding, dequantization, destination_ptr, position_size);
+
+				uint8_t* attribute_ptr = destination_ptr + get_attribute_stream_offset(encoding);
+				for (size_t attribute_index = 1; attribute_index < active_attributes.size(); ++attribute_index)
+				{
+					encode_vertex_stream(active_attributes[attribute_index], encoding, dequantization, attribute_ptr + attribute_offsets[attribute_index] - position_size, attribute_stride);
+				}
+				return;
+			}
+
+			if (mode == AttributeMode::MODE_SEPARATE)
+			{
+				// Each attribute is written as its own tightly packed stream: uncompressed streams are copied in one go.
+				for (size_t attribute_index = 0; attribute_index < active_attributes.size(); ++attribute_index)
+				{
+					encode_vertex_stream(active_attributes[attribute_index], encoding, dequantization, destination_ptr + attribute_offsets[attribute_index], attribute_sizes[attribute_index]);
+				}
+				return;
+			}
+
+			// Any other interleaved layout is written one attribute at a time, striding over entire vertices.
+			const uint32_t stride = get_vertex_stride(encoding);
+			for (size_t attribute_index = 0; attribute_index < active_attributes.size(); ++attribute_index)
+			{
+				encode_vertex_stream(active_attributes[attribute_index], encoding, dequantization, destination_ptr + attribute_offsets[attribute_index], stride);
+			}
+		}
+
+		BoundingBox BoundingBox::transformed(const glm::mat4& transform) const
+		{
+			if (is_empty())
+			{
+				return *this;
+			}
+
+			// Transform the center, then project the (rotated and scaled) extents back onto each axis: see Arvo, 
+			// "Transforming Axis-Aligned Bounding Boxes" (Graphics Gems, 1990).
+			const glm::vec3 center = glm::vec3(transform * glm::vec4(get_center(), 1.0f));
+			const glm::vec3 extents = get_extents();
+
+			glm::vec3 transformed_extents(0.0f);
+			for (int column = 0; column < 3; ++column)
+			{
+				transformed_extents += glm::abs(glm::vec3(transform[column])) * extents[column];
+			}
+
+			BoundingBox bounds;
+			bounds.min = center - transformed_extents;
+			bounds.max = center + transformed_extents;
+
+			return bounds;
+		}
+
+		BoundingSphere BoundingSphere::transformed(const glm::mat4& transform) const
+		{
+			if (is_empty())
+			{
+				return *this;
+			}
+
+			const float scale = std::max({ glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2])) });
+
+			BoundingSphere sphere;
+			sphere.center = glm::vec3(transform * glm::vec4(center, 1.0f));
+			sphere.radius = radius * scale;
+
+			return sphere;
+		}
+
+		PositionDequantization Geometry::get_position_dequantization(const VertexEncoding& encoding) const
+		{
+			if (encoding.positions == PositionEncoding::POSITION_FLOAT32 || m_positions.empty())
+			{
+				return { glm::vec3(0.0f), glm::vec3(1.0f) };
+			}
+
+			const BoundingBox bounds = get_bounding_box();
+
+			// Half floats have the most precision near zero, so they are stored relative to the center of the bounds. 
+			// Normalized integers are stored relative to the bounds, such that [0..1] spans the entire mesh.
+			if (encoding.positions == PositionEncoding::POSITION_FLOAT16)
+			{
+				return { bounds.get_center(), glm::vec3(1.0f) };
+			}
+
+			return { bounds.min, bounds.max - bounds.min };
+		}
+
+		BoundingBox Geometry::get_bounding_box() const
+		{
+			BoundingBox bounds;
+			for (const auto& position : m_positions)
+			{
+				bounds.expand(position);
+			}
+
+			return bounds;
+		}
+
+		BoundingSphere Geometry::get_bounding_sphere() const
+		{
+			BoundingSphere sphere;
+			if (m_positions.empty())
+			{
+				return sphere;
+			}
+
+			sphere.center = get_bounding_box().get_center();
+
+			float radius_squared = 0.0f;
+			for (const auto& position : m_positions)
+			{
+				const glm::vec3 offset = position - sphere.center;
+				radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+			}
+			sphere.radius = sqrtf(radius_squared);
+
+			return sphere;
+		}
+
+		void Geometry::encode_vertex_stream(VertexAttribute attribute, 
+											const VertexEncoding& encoding, 
+											const PositionDequantization& dequantization, 
+											uint8_t* destination, 
+											size_t stride) const
+		{
+			// The encoding is resolved once per stream, so each of the loops below is specialized for a single format.
+			switch (attribute)
+			{
+			case VertexAttribute::ATTRIBUTE_POSITION:
+				if (encoding.positions == PositionEncoding::POSITION_FLOAT32)
+				{
+					copy_stream(m_positions, destination, stride);
+				}
+				else if (encoding.positions == PositionEncoding::POSITION_FLOAT16)
+				{
+					encode_stream(m_positions, destination, stride, [&](const glm::vec3& position) {
+						const glm::vec3 relative = position - dequantization.offset;
+						return std::array<uint16_t, 4>{ { float_to_half(relative.x), float_to_half(relative.y), float_to_half(relative.z), 0 } };
+					});
+				}
+				else
+				{
+					// Avoid dividing by zero along flat axes (i.e. a planar grid): every position lies at the offset there, so
+					// dividing by one still maps them to zero.
+					glm::vec3 scale;
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						scale[axis] = (dequantization.scale[axis] > 0.0f) ? dequantization.scale[axis] : 1.0f;
+					}
+
+					encode_stream(m_positions, destination, stride, [&](const glm::vec3& position) {
+						const glm::vec3 normalized = (position - dequantization.offset) / scale;
+						return std::array<uint16_t, 4>{ { float_to_unorm16(normalized.x), float_to_unorm16(normalized.y), float_to_unorm16(normalized.z), 0 } };
+					});
+				}
+				break;
+			case VertexAttribute::ATTRIBUTE_COLOR:
+				if (encoding.colors == ColorEncoding::COLOR_UNORM8)
+				{
+					encode_stream(m_colors, destination, stride, [](const glm::vec3& color) {
+						return std::array<uint8_t, 4>{ { float_to_unorm8(color.r), float_to_unorm8(color.g), float_to_unorm8(color.b), 255 } };
+					});
+				}
+				else
+				{
+					copy_stream(m_colors, destination, stride);
+				}
+				break;
+			case VertexAttribute::ATTRIBUTE_NORMAL:
+				if (encoding.normals == NormalEncoding::NORMAL_OCTAHEDRAL_SNORM16)
+				{
+					encode_stream(m_normals, destination, stride, [](const glm::vec3& normal) {
+						const glm::vec2 octahedral = octahedral_encode(normal);
+						return std::array<int16_t, 2>{ { float_to_snorm16(octahedral.x), float_to_snorm16(octahedral.y) } };
+					});
+				}
+				else
+				{
+					copy_stream(m_normals, destination, stride);
+				}
+				break;
+			case VertexAttribute::ATTRIBUTE_TEXTURE_COORDINATES:
+				if (encoding.texture_coordinates == TextureCoordinateEncoding::TEXTURE_COORDINATES_FLOAT16)
+				{
+					encode_stream(m_texture_coordinates, destination, stride, [](const glm::vec2& texture_coordinate) {
+						return std::array<uint16_t, 2>{ { float_to_half(texture_coordinate.x), float_to_half(texture_coordinate.y) } };
+					});
+				}
+				else
+				{
+					copy_stream(m_texture_coordinates, destination, stride);
+				}
+				break;
+			default:
+				break;
+			}
+		}
 
-		static const VertexAttributeSet active_attributes =
+		void Geometry::unpack_vertex_attributes(const void* source, 
+												size_t vertex_count, 
+												AttributeMode mode, 
+												const VertexEncoding& encoding, 
+												const PositionDequantization& dequantization)
 		{
-			VertexAttribute::ATTRIBUTE_POSITION,
-			VertexAttribute::ATTRIBUTE_COLOR,
-			VertexAttribute::ATTRIBUTE_NORMAL,
-			VertexAttribute::ATTRIBUTE_TEXTURE_COORDINATES
-		};
+			m_positions.resize(vertex_count);
+			m_colors.resize(vertex_count);
+			m_normals.resize(vertex_count);
+			m_texture_coordinates.resize(vertex_count);
+
+			// Each stream is read from the same place that `pack_vertex_attributes()` writes it to.
+			const uint8_t* source_ptr = static_cast<const uint8_t*>(source);
+			const uint32_t position_size = get_vertex_attribute_size(VertexAttribute::ATTRIBUTE_POSITION, encoding);
+			const uint32_t stride = get_vertex_stride(encoding);
+			for (auto attribute : active_attributes)
+			{
+				if (mode == AttributeMode::MODE_SEPARATE)
+				{
+					decode_vertex_stream(attribute, encoding, dequantization, source_ptr + get_vertex_stream_offset(attribute, encoding), get_vertex_attribute_size(attribute, encoding));
+				}
+				else if (mode == AttributeMode::MODE_SPLIT_POSITIONS && attribute == VertexAttribute::ATTRIBUTE_POSITION)
+				{
+					decode_vertex_stream(attribute, encoding, dequantization, source_ptr, position_size);
+				}
+				else if (mode == AttributeMode::MODE_SPLIT_POSITIONS)
+				{
+					decode_vertex_stream(attribute, encoding, dequantization, source_ptr + get_attribute_stream_offset(encoding) + get_vertex_attribute_offset(attribute, encoding) - position_size, stride - position_size);
+				}
+				else
+				{
+					decode_vertex_stream(attribute, encoding, dequantization, source_ptr + get_vertex_attribute_offset(attribute, encoding), stride);
+				}
+			}
+		}
 
-		vk::Format Geometry::get_vertex_attribute_format(VertexAttribute attribute)
+		void Geometry::decode_vertex_stream(VertexAttribute attribute, 
+											const VertexEncoding& encoding, 
+											const PositionDequantization& dequantization, 
+											const uint8_t* source, 
+											size_t stride)
 		{
 			switch (attribute)
 			{
 			case VertexAttribute::ATTRIBUTE_POSITION:
+				if (encoding.positions == PositionEncoding::POSITION_FLOAT32)
+				{
+					read_stream(source, m_positions, stride);
+				}
+				else if (encoding.positions == PositionEncoding::POSITION_FLOAT16)
+				{
+					decode_stream<std::array<uint16_t, 4>>(source, m_positions, stride, [&](const std::array<uint16_t, 4>& encoded) {
+						return dequantization.offset + dequantization.scale * glm::vec3{ half_to_float(encoded[0]), half_to_float(encoded[1]), half_to_float(encoded[2]) };
+					});
+				}
+				else
+				{
+					decode_stream<std::array<uint16_t, 4>>(source, m_positions, stride, [&](const std::array<uint16_t, 4>& encoded) {
+						return dequantization.offset + dequantization.scale * glm::vec3{ unorm16_to_float(encoded[0]), unorm16_to_float(encoded[1]), unorm16_to_float(encoded[2]) };
+					});
+				}
+				break;
 			case VertexAttribute::ATTRIBUTE_COLOR:
-			case VertexAttribute::ATTRIBUTE_NORMAL: return vk::Format::eR32G32B32Sfloat;
-			case VertexAttribute::ATTRIBUTE_TEXTURE_COORDINATES: return vk::Format::eR32G32Sfloat;
+				if (encoding.colors == ColorEncoding::COLOR_UNORM8)
+				{
+					decode_stream<std::array<uint8_t, 4>>(source, m_colors, stride, [](const std::array<uint8_t, 4>& encoded) {
+						return glm::vec3{ unorm8_to_float(encoded[0]), unorm8_to_float(encoded[1]), unorm8_to_float(encoded[2]) };
+					});
+				}
+				else
+				{
+					read_stream(source, m_colors, stride);
+				}
+				break;
+			case VertexAttribute::ATTRIBUTE_NORMAL:
+				if (encoding.normals == NormalEncoding::NORMAL_OCTAHEDRAL_SNORM16)
+				{
+					decode_stream<std::array<int16_t, 2>>(source, m_normals, stride, [](const std::array<int16_t, 2>& encoded) {
+						return octahedral_decode(glm::vec2{ snorm16_to_float(encoded[0]), snorm16_to_float(encoded[1]) });
+					});
+				}
+				else
+				{
+					read_stream(source, m_normals, stride);
+				}
+				break;
+			case VertexAttribute::ATTRIBUTE_TEXTURE_COORDINATES:
+				if (encoding.texture_coordinates == TextureCoordinateEncoding::TEXTURE_COORDINATES_FLOAT16)
+				{
+					decode_stream<std::array<uint16_t, 2>>(source, m_texture_coordinates, stride, [](const std::array<uint16_t, 2>& encoded) {
+						return glm::vec2{ half_to_float(encoded[0]), half_to_float(encoded[1]) };
+					});
+				}
+				else
+				{
+					read_stream(source, m_texture_coordinates, stride);
+				}
+				break;
+			default:
+				break;
 			}
 		}
 
-		uint32_t Geometry::get_vertex_attribute_dimensions(VertexAttribute attribute)
+		float* Geometry::get_vertex_attribute_data_ptr(VertexAttribute attribute)
 		{
 			switch (attribute)
 			{
-			case VertexAttribute::ATTRIBUTE_POSITION:
-			case VertexAttribute::ATTRIBUTE_COLOR:
-			case VertexAttribute::ATTRIBUTE_NORMAL: return 3;
-			case VertexAttribute::ATTRIBUTE_TEXTURE_COORDINATES: return 2;
+			case VertexAttribute::ATTRIBUTE_POSITION: return reinterpret_cast<float*>(m_positions.data());
+			case VertexAttribute::ATTRIBUTE_COLOR: return reinterpret_cast<float*>(m_colors.data());
+			case VertexAttribute::ATTRIBUTE_NORMAL: return reinterpret_cast<float*>(m_normals.data());
+			case VertexAttribute::ATTRIBUTE_TEXTURE_COORDINATES: return reinterpret_cast<float*>(m_texture_coordinates.data());
 			}
 		}
 
-		uint32_t Geometry::get_vertex_attribute_size(VertexAttribute attribute)
+		void Geometry::set_colors(const std::vector<glm::vec3>& colors, const glm::vec3& fill_rest)
 		{
-			return get_vertex_attribute_dimensions(attribute) * sizeof(float);
+			m_colors = colors;
+			m_colors.resize(get_vertex_count(), fill_rest);
 		}
 
-		uint32_t Geometry::get_vertex_attribute_offset(VertexAttribute attribute)
+		void Geometry::set_colors_random()
 		{
-			switch (attribute)
+			static std::random_device rand;
+			static std::mt19937 mersenne(rand());
+			static std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+			m_colors.clear();
+			m_colors.resize(get_vertex_count());
+
+			std::generate(m_colors.begin(),
+				m_colors.end(),
+				[&]() -> glm::vec3 { return{ distribution(mersenne), distribution(mersenne), distribution(mersenne) }; });
+		}
+
+		void Geometry::set_indices(const std::vector<uint32_t>& indices)
+		{
+			for (auto index : indices)
 			{
-			case VertexAttribute::ATTRIBUTE_POSITION: return 0;
-			case VertexAttribute::ATTRIBUTE_COLOR: return sizeof(float) * 3;
-			case VertexAttribute::ATTRIBUTE_NORMAL: return sizeof(float) * 6;
-			case VertexAttribute::ATTRIBUTE_TEXTURE_COORDINATES: return sizeof(float) * 9;
+				if (index >= get_vertex_count())
+				{
+					throw std::runtime_error("One or more indices refer to a vertex that does not exist");
+				}
 			}
+
+			m_indices = indices;
+			m_is_stripified = false;
 		}
 
-		std::vector<vk::VertexInputAttributeDescription> Geometry::get_vertex_input_attribute_descriptions(uint32_t start_binding, AttributeMode mode)
+		void Geometry::check_indices() const
 		{
-			std::vector<vk::VertexInputAttributeDescription> input_attribute_descriptions;
-			uint32_t attribute_binding = start_binding;		// The binding number which this attribute takes its data from.
-			uint32_t attribute_offset = 0;					// The byte offset of this attribute relative to the start of an element in the vertex input binding
+			const size_t vertex_count = get_vertex_count();
+			for (auto index : m_indices)
+			{
+				if (index != primitive_restart_index && index >= vertex_count)
+				{
+					throw std::runtime_error("One or more indices refer to a vertex that does not exist");
+				}
+			}
+		}
 
-			for (auto available_attribute : active_attributes)
+		void Geometry::remap_vertices(const std::vector<uint32_t>& remap)
+		{
+			if (remap.size() != get_vertex_count())
 			{
-				uint32_t attribute_location = static_cast<uint32_t>(available_attribute);		// The shader binding location number for this attribute.
-				vk::Format attribute_format = get_vertex_attribute_format(available_attribute);	// The size and type of the vertex attribute data.
+				throw std::runtime_error("The vertex remap table must contain exactly one entry per vertex");
+			}
 
-				// If the vertex attributes are interleaved, we need to do some work to figure out
-				// the byte offset of each attribute relative to the start of an element (vertex or instance).
-				if (mode == AttributeMode::MODE_INTERLEAVED)
+			std::vector<bool> is_target(remap.size(), false);
+			for (auto target : remap)
+			{
+				if (target >= remap.size() || is_target[target])
 				{
-					// TODO: use `offsetof(...)` and some sort vertex struct to organize this.
-					attribute_offset = get_vertex_attribute_offset(available_attribute);
+					throw std::runtime_error("The vertex remap table must be a permutation of the vertex indices");
 				}
+				is_target[target] = true;
+			}
 
-				input_attribute_descriptions.push_back({
-					attribute_location,
-					attribute_binding,
-					attribute_format,
-					attribute_offset
-				});
+			check_indices();
 
-				// If the vertex attributes are separate, then we increment the binding index. 
-				if (mode == AttributeMode::MODE_SEPARATE)
+			auto apply_remap = [&](auto& attribute)
+			{
+				// Optional attributes (i.e. colors) may be empty.
+				if (attribute.size() != remap.size())
 				{
-					attribute_binding++;
+					return;
+				}
+
+				auto remapped = attribute;
+				for (size_t i = 0; i < remap.size(); ++i)
+				{
+					remapped[remap[i]] = attribute[i];
+				}
+				attribute = std::move(remapped);
+			};
+
+			apply_remap(m_positions);
+			apply_remap(m_colors);
+			apply_remap(m_normals);
+			apply_remap(m_texture_coordinates);
+
+			for (auto& index : m_indices)
+			{
+				if (index != primitive_restart_index)
+				{
+					index = remap[index];
 				}
 			}
-			return input_attribute_descriptions;
 		}
 
-		std::vector<vk::VertexInputBindingDescription> Geometry::get_vertex_input_binding_descriptions(uint32_t start_binding, AttributeMode mode)
+		size_t Geometry::weld_vertices(const WeldOptions& options)
 		{
-			// TOOD: this does not take into account any custom attributes that might be instanced, i.e. vk::VertexInputRate::eInstance.
-			// Also, it doesn't let you create vertex bindings that are not sequential (i.e. 0, 2, 4, 6, etc...), although I'm not sure
-			// this actually matters.
+			check_indices();
 
-			std::vector<vk::VertexInputBindingDescription> binding_descriptions;
-			uint32_t binding_index = start_binding;
+			const size_t vertex_count = get_vertex_count();
 
-			// If the attributes are interleaved (and assuming we are not instancing), then the vertex
-			// data will all belong to a single buffer with a stride equal to the total size of all
-			// vertex attributes combined.
-			if (mode == AttributeMode::MODE_INTERLEAVED)
+			// Build the quantized key of every vertex: 3 position, 3 color, 3 normal, and 2 texture coordinate components.
+			const size_t key_size = 11;
+			std::vector<int64_t> keys(vertex_count * key_size, 0);
+			std::vector<uint64_t> hashes(vertex_count);
+
+			for (size_t v = 0; v < vertex_count; ++v)
 			{
-				uint32_t binding_stride = 0;
-				for (const auto& available_attribute : active_attributes)
+				int64_t* key = &keys[v * key_size];
+				for (int i = 0; i < 3; ++i)
 				{
-					binding_stride += get_vertex_attribute_size(available_attribute);
+					key[i] = quantize(m_positions[v][i], options.position_epsilon);
+					key[3 + i] = (m_colors.size() == vertex_count) ? quantize(m_colors[v][i], options.color_epsilon) : 0;
+					key[6 + i] = (m_normals.size() == vertex_count) ? quantize(m_normals[v][i], options.normal_epsilon) : 0;
+				}
+				for (int i = 0; i < 2; ++i)
+				{
+					key[9 + i] = (m_texture_coordinates.size() == vertex_count) ? quantize(m_texture_coordinates[v][i], options.texture_coordinate_epsilon) : 0;
 				}
 
-				binding_descriptions.push_back({
-					binding_index,
-					binding_stride,
-					vk::VertexInputRate::eVertex
-				});
-
-				return binding_descriptions;
+				// FNV-1a over the quantized components.
+				uint64_t hash = 14695981039346656037ull;
+				for (size_t i = 0; i < key_size; ++i)
+				{
+					hash = (hash ^ static_cast<uint64_t>(key[i])) * 1099511628211ull;
+				}
+				hashes[v] = hash ^ (hash >> 29);
 			}
 
-			// Otherwise, the attributes are separate and will each exist in a unique buffer (or region
-			// of buffer memory).
-			for (auto available_attribute : active_attributes)
+			// Insert every vertex into an open-addressing (linear probing) table that maps keys to welded vertices.
+			size_t capacity = 16;
+			while (capacity < vertex_count * 2)
 			{
-				uint32_t binding_stride = get_vertex_attribute_size(available_attribute);
+				capacity <<= 1;
+			}
+			const size_t mask = capacity - 1;
+			const uint32_t empty = std::numeric_limits<uint32_t>::max();
 
-				binding_descriptions.push_back({
-					binding_index,
-					binding_stride,
-					vk::VertexInputRate::eVertex
-				});
+			std::vector<uint32_t> table(capacity, empty);
+			std::vector<uint32_t> remap(vertex_count);
+			std::vector<uint32_t> representatives;
 
-				if (mode == AttributeMode::MODE_SEPARATE)
+			for (size_t v = 0; v < vertex_count; ++v)
+			{
+				for (size_t slot = hashes[v] & mask; ; slot = (slot + 1) & mask)
 				{
-					binding_index++;
+					const uint32_t welded = table[slot];
+					if (welded == empty)
+					{
+						table[slot] = static_cast<uint32_t>(representatives.size());
+						remap[v] = table[slot];
+						representatives.push_back(static_cast<uint32_t>(v));
+						break;
+					}
+
+					const uint32_t candidate = representatives[welded];
+					if (hashes[candidate] == hashes[v] && std::equal(&keys[candidate * key_size], &keys[candidate * key_size] + key_size, &keys[v * key_size]))
+					{
+						remap[v] = welded;
+						break;
+					}
 				}
 			}
-			return binding_descriptions;
-		}
-
-		std::vector<float> Geometry::get_packed_vertex_attributes()
-		{
-			// TOOD: need to check if all attribute vectors have the same size.
-
-			std::vector<float> packed_vertex_attributes;
 
-			for (size_t i = 0; i < m_positions.size(); ++i)
+			// Welded vertices are numbered in order of first occurrence, so `remap[v] <= v` for each representative 
+			// and the attributes can be compacted in place.
+			auto compact = [&](auto& attribute)
 			{
-				packed_vertex_attributes.push_back(m_positions[i].x);
-				packed_vertex_attributes.push_back(m_positions[i].y);
-				packed_vertex_attributes.push_back(m_positions[i].z);
+				if (attribute.size() != vertex_count)
+				{
+					return;
+				}
 
-				packed_vertex_attributes.push_back(m_colors[i].x);
-				packed_vertex_attributes.push_back(m_colors[i].y);
-				packed_vertex_attributes.push_back(m_colors[i].z);
+				for (size_t i = 0; i < representatives.size(); ++i)
+				{
+					attribute[i] = attribute[representatives[i]];
+				}
+				attribute.resize(representatives.size());
+			};
 
-				packed_vertex_attributes.push_back(m_normals[i].x);
-				packed_vertex_attributes.push_back(m_normals[i].y);
-				packed_vertex_attributes.push_back(m_normals[i].z);
+			compact(m_positions);
+			compact(m_colors);
+			compact(m_normals);
+			compact(m_texture_coordinates);
 
-				packed_vertex_attributes.push_back(m_texture_coordinates[i].x);
-				packed_vertex_attributes.push_back(m_texture_coordinates[i].y);
+			for (auto& index : m_indices)
+			{
+				if (index != primitive_restart_index)
+				{
+					index = remap[index];
+				}
 			}
 
-			return packed_vertex_attributes;
+			if (get_topology() == vk::PrimitiveTopology::eTriangleList)
+			{
+				size_t write = 0;
+				for (size_t i = 0; i + 2 < m_indices.size(); i += 3)
+				{
+					const uint32_t a = m_indices[i];
+					const uint32_t b = m_indices[i + 1];
+					const uint32_t c = m_indices[i + 2];
+					if (a != b && b != c && c != a)
+					{
+						m_indices[write++] = a;
+						m_indices[write++] = b;
+						m_indices[write++] = c;
+					}
+				}
+				m_indices.resize(write);
+			}
+
+			return vertex_count - representatives.size();
 		}
 
-		float* Geometry::get_vertex_attribute_data_ptr(VertexAttribute attribute)
+		void Geometry::pack_indices(void* destination) const
 		{
-			switch (attribute)
+			if (get_index_type() == vk::IndexType::eUint32)
 			{
-			case VertexAttribute::ATTRIBUTE_POSITION: return reinterpret_cast<float*>(m_positions.data());
-			case VertexAttribute::ATTRIBUTE_COLOR: return reinterpret_cast<float*>(m_colors.data());
-			case VertexAttribute::ATTRIBUTE_NORMAL: return reinterpret_cast<float*>(m_normals.data());
-			case VertexAttribute::ATTRIBUTE_TEXTURE_COORDINATES: return reinterpret_cast<float*>(m_texture_coordinates.data());
+				memcpy(destination, m_indices.data(), get_packed_indices_size());
+				return;
 			}
-		}
 
-		void Geometry::set_colors(const std::vector<glm::vec3>& colors, const glm::vec3& fill_rest)
-		{
-			m_colors = colors;
-			m_colors.resize(get_vertex_count(), fill_rest);
+			// Narrowing the restart index (0xFFFFFFFF) produces the 16-bit restart index (0xFFFF).
+			uint16_t* destination_16 = static_cast<uint16_t*>(destination);
+			for (size_t i = 0; i < m_indices.size(); ++i)
+			{
+				destination_16[i] = static_cast<uint16_t>(m_indices[i]);
+			}
 		}
 
-		void Geometry::set_colors_random()
+		bool Geometry::stripify()
 		{
-			static std::random_device rand;
-			static std::mt19937 mersenne(rand());
-			static std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+			if (get_topology() != vk::PrimitiveTopology::eTriangleList)
+			{
+				throw std::runtime_error("Only geometry with the vk::PrimitiveTopology::eTriangleList topology can be stripified");
+			}
 
-			m_colors.clear();
-			m_colors.resize(get_vertex_count());
+			std::vector<uint32_t> strips = geom::stripify(m_indices, get_vertex_count(), primitive_restart_index);
+			if (strips.size() >= m_indices.size())
+			{
+				return false;
+			}
 
-			std::generate(m_colors.begin(),
-				m_colors.end(),
-				[&]() -> glm::vec3 { return{ distribution(mersenne), distribution(mersenne), distribution(mersenne) }; });
+			m_indices = std::move(strips);
+			m_is_stripified = true;
+
+			return true;
 		}
 
 		Rect::Rect(float width, float height, const glm::vec3& center)
@@ -250,7 +1355,7 @@ namespace plume
 			m_indices =
 			{
 				0, 1, 2,
-				0, 3, 2
+				0, 2, 3
 			};
 		}
 
@@ -270,68 +1375,59 @@ namespace plume
 			m_colors[3] = ll;
 		}
 
-		Grid::Grid(float width, float height, uint32_t u_subdivisions, uint32_t v_subdivisions, const glm::vec3& center)
+		Grid::Grid(float width, float height, uint32_t u_subdivisions, uint32_t v_subdivisions, const glm::vec3& center, const GenerationOptions& options)
 		{
-			auto map = [](float v, float in_min, float in_max, float out_min, float out_max)
-			{
-				return (v - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
-			};
+			const size_t vertex_count = static_cast<size_t>(u_subdivisions) * v_subdivisions;
+			const size_t indices_per_row = get_grid_indices_per_row(u_subdivisions);
 
-			for (size_t row = 0; row < v_subdivisions; ++row)
+			m_positions.resize(vertex_count);
+			m_normals.resize(vertex_count);
+			m_texture_coordinates.resize(vertex_count);
+			m_indices.resize((v_subdivisions > 1) ? indices_per_row * (v_subdivisions - 1) : 0);
+
+			for_each_row_range(v_subdivisions, options, [&](size_t begin, size_t end)
 			{
-				for (size_t col = 0; col < u_subdivisions; ++col)
-				{
-					float u = static_cast<float>(col) / (u_subdivisions - 1);
-					float v = static_cast<float>(row) / (v_subdivisions - 1);
+				// Each range generates into a row-sized scratch buffer and then interleaves into its own slice.
+				SoAVertexData scratch;
+				scratch.resize(u_subdivisions);
+				const SoARow row_data = get_soa_row(scratch, 0);
 
-					glm::vec3 pt = { map(u, 0.0f, 1.0f, -1.0f, 1.0f),
-									 map(v, 0.0f, 1.0f, -1.0f, 1.0f),
-									 0.0f };
-					pt.x *= width;
-					pt.y *= height;
-					pt += center;
+				for (size_t row = begin; row < end; ++row)
+				{
+					generate_grid_row(row, width, height, u_subdivisions, v_subdivisions, center, row_data, m_indices.data() + row * indices_per_row);
 
-					m_positions.push_back(pt);
-					m_texture_coordinates.push_back({ u, v });
-
-					// If `u_divisions` is set to 4, we have:
-					// 
-					// 0 -- 1 -- 2 -- 3
-					// | \  | \  |  \ |
-					// 4 -- 5 -- 6 -- 7
-					// . . . 
-					// .
-					// .
-					// Note: we assume a clockwise winding pattern.
-
-					// We don't need to form any triangles for the last row
-					size_t cell = col + u_subdivisions * row;
-					if ((row + 1) % v_subdivisions != 0)
+					const size_t first_vertex = row * u_subdivisions;
+					for (size_t col = 0; col < u_subdivisions; ++col)
 					{
-						// Form the first triangle (i.e. 0 -> 5 -> 4...).
-						if ((col + 1) % u_subdivisions != 0)
-						{
-							m_indices.push_back(cell);
-							m_indices.push_back(cell + u_subdivisions + 1);
-							m_indices.push_back(cell + u_subdivisions);
-						}
-
-						// Only form this triangle if we aren't on the first (0-th) column.
-						if (col % u_subdivisions != 0)
-						{
-							m_indices.push_back(cell);
-							m_indices.push_back(cell + u_subdivisions);
-							m_indices.push_back(cell - 1);
-						}
+						m_positions[first_vertex + col] = { row_data.position_x[col], row_data.position_y[col], row_data.position_z[col] };
+						m_normals[first_vertex + col] = { row_data.normal_x[col], row_data.normal_y[col], row_data.normal_z[col] };
+						m_texture_coordinates[first_vertex + col] = { row_data.texture_coordinate_u[col], row_data.texture_coordinate_v[col] };
 					}
 				}
-			}
-
-			m_normals.resize(get_vertex_count(), { 0.0f, 0.0f, 1.0f });
+			});
 
 			set_colors_solid({ 1.0f, 1.0f, 1.0f });
 		}
 
+		SoAVertexData Grid::generate_soa(float width, float height, uint32_t u_subdivisions, uint32_t v_subdivisions, const glm::vec3& center, const GenerationOptions& options)
+		{
+			const size_t indices_per_row = get_grid_indices_per_row(u_subdivisions);
+
+			SoAVertexData data;
+			data.resize(static_cast<size_t>(u_subdivisions) * v_subdivisions);
+			data.indices.resize((v_subdivisions > 1) ? indices_per_row * (v_subdivisions - 1) : 0);
+
+			for_each_row_range(v_subdivisions, options, [&](size_t begin, size_t end)
+			{
+				for (size_t row = begin; row < end; ++row)
+				{
+					generate_grid_row(row, width, height, u_subdivisions, v_subdivisions, center, get_soa_row(data, row * u_subdivisions), data.indices.data() + row * indices_per_row);
+				}
+			});
+
+			return data;
+		}
+
 		Circle::Circle(float radius, const glm::vec3& center, uint32_t subdivisions)
 		{
 			m_positions.push_back(center);
@@ -357,46 +1453,65 @@ namespace plume
 			m_texture_coordinates.resize(get_vertex_count(), { 0.0f, 0.0f });
 		}
 
-		Sphere::Sphere(float radius, const glm::vec3& center, size_t u_divisions, size_t v_divisions)
+		Sphere::Sphere(float radius, const glm::vec3& center, size_t u_divisions, size_t v_divisions, const GenerationOptions& options)
 		{
+			const size_t row_size = u_divisions + 1;
+			const size_t quad_count = u_divisions * v_divisions;
+			const SphereColumns columns{ u_divisions };
+
+			m_positions.resize(row_size * (v_divisions + 1));
+			m_normals.resize(m_positions.size());
+			m_texture_coordinates.resize(m_positions.size());
+			m_indices.resize(quad_count * 6);
+
 			// Calculate vertex positions.
-			for (int i = 0; i <= v_divisions; ++i)
+			for_each_row_range(v_divisions + 1, options, [&](size_t begin, size_t end)
 			{
-				float v = i / static_cast<float>(v_divisions);		// Fraction along the v-axis, 0..1
-				float phi = v * glm::pi<float>();					// Vertical angle, 0..pi
+				SoAVertexData scratch;
+				scratch.resize(row_size);
+				const SoARow row_data = get_soa_row(scratch, 0);
 
-				for (int j = 0; j <= u_divisions; ++j)
+				for (size_t row = begin; row < end; ++row)
 				{
-					float u = j / static_cast<float>(u_divisions);	// Fraction along the u-axis, 0..1
-					float theta = u * (glm::pi<float>() * 2);		// Rotational angle, 0..2 * pi
-
-					// Spherical to Cartesian coordinates.
-					float x = cosf(theta) * sinf(phi);
-					float y = cosf(phi);
-					float z = sinf(theta) * sinf(phi);
-					auto vertex = glm::vec3(x, y, z) * radius + center;
+					generate_sphere_row(row, radius, center, u_divisions, v_divisions, columns, row_data);
 
-					m_positions.push_back(vertex);
-					m_normals.push_back(glm::normalize(vertex));
+					const size_t first_vertex = row * row_size;
+					for (size_t j = 0; j < row_size; ++j)
+					{
+						m_positions[first_vertex + j] = { row_data.position_x[j], row_data.position_y[j], row_data.position_z[j] };
+						m_normals[first_vertex + j] = { row_data.normal_x[j], row_data.normal_y[j], row_data.normal_z[j] };
+						m_texture_coordinates[first_vertex + j] = { row_data.texture_coordinate_u[j], row_data.texture_coordinate_v[j] };
+					}
 				}
-			}
+			});
 
 			set_colors_solid({ 1.0f, 1.0f, 1.0f });
 
 			// Calculate indices.
-			for (int i = 0; i < u_divisions * v_divisions + u_divisions; ++i)
+			generate_sphere_indices(u_divisions, v_divisions, options, m_indices.data());
+		}
+
+		SoAVertexData Sphere::generate_soa(float radius, const glm::vec3& center, size_t u_divisions, size_t v_divisions, const GenerationOptions& options)
+		{
+			const size_t row_size = u_divisions + 1;
+			const size_t quad_count = u_divisions * v_divisions;
+			const SphereColumns columns{ u_divisions };
+
+			SoAVertexData data;
+			data.resize(row_size * (v_divisions + 1));
+			data.indices.resize(quad_count * 6);
+
+			for_each_row_range(v_divisions + 1, options, [&](size_t begin, size_t end)
 			{
-				m_indices.push_back(i);
-				m_indices.push_back(i + u_divisions + 1);
-				m_indices.push_back(i + u_divisions);
+				for (size_t row = begin; row < end; ++row)
+				{
+					generate_sphere_row(row, radius, center, u_divisions, v_divisions, columns, get_soa_row(data, row * row_size));
+				}
+			});
 
-				m_indices.push_back(i + u_divisions + 1);
-				m_indices.push_back(i);
-				m_indices.push_back(i + 1);
-			}
+			generate_sphere_indices(u_divisions, v_divisions, options, data.indices.data());
 
-			// TODO: figure out how to calculate uv-coordinates.
-			m_texture_coordinates.resize(get_vertex_count(), { 0.0f, 0.0f });
+			return data;
 		}
 
 		IcoSphere::IcoSphere(float radius, const glm::vec3& center)
@@ -0,0 +1,123 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "Instancing.h"
+#include "ThreadPool.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		InstanceData InstanceData::create(const glm::mat4& model, uint32_t material_id)
+		{
+			InstanceData instance = {};
+			instance.model = model;
+			instance.material_id = material_id;
+
+			// The inverse transpose of a 3x3 matrix with columns (a, b, c) is its cofactor matrix divided by the
+			// determinant, and the columns of the cofactor matrix are simply (b x c, c x a, a x b).
+			const glm::vec3 a{ model[0] };
+			const glm::vec3 b{ model[1] };
+			const glm::vec3 c{ model[2] };
+
+			const glm::vec3 bc = glm::cross(b, c);
+			const glm::vec3 ca = glm::cross(c, a);
+			const glm::vec3 ab = glm::cross(a, b);
+
+			// A singular transform has no inverse: fall back to the cofactors, which still point in the right direction 
+			// for any non-degenerate normals (these are re-normalized in the shader anyways).
+			const float determinant = glm::dot(a, bc);
+			const float scale = (determinant != 0.0f) ? 1.0f / determinant : 1.0f;
+
+			instance.normal_matrix[0] = glm::vec4{ bc * scale, 0.0f };
+			instance.normal_matrix[1] = glm::vec4{ ca * scale, 0.0f };
+			instance.normal_matrix[2] = glm::vec4{ ab * scale, 0.0f };
+
+			return instance;
+		}
+
+		void pack_instances(const std::vector<glm::mat4>& models, const std::vector<uint32_t>& material_ids, void* destination)
+		{
+			if (!material_ids.empty() && material_ids.size() != models.size())
+			{
+				throw std::runtime_error("The number of material IDs must match the number of instances");
+			}
+
+			InstanceData* instances = static_cast<InstanceData*>(destination);
+
+			const size_t grain_size = 4096;
+			utils::ThreadPool::global().parallel_for(0, models.size(), grain_size, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					instances[i] = InstanceData::create(models[i], material_ids.empty() ? 0 : material_ids[i]);
+				}
+			});
+		}
+
+		VertexInputState get_instance_input_state(uint32_t binding, uint32_t first_location)
+		{
+			VertexInputState state;
+			state.bindings.push_back({
+				binding,
+				sizeof(InstanceData),
+				vk::VertexInputRate::eInstance
+			});
+
+			uint32_t location = first_location;
+			for (uint32_t column = 0; column < 4; ++column)
+			{
+				state.attributes.push_back({ location++, binding, vk::Format::eR32G32B32A32Sfloat, static_cast<uint32_t>(offsetof(InstanceData, model) + sizeof(glm::vec4) * column) });
+			}
+			for (uint32_t column = 0; column < 3; ++column)
+			{
+				state.attributes.push_back({ location++, binding, vk::Format::eR32G32B32Sfloat, static_cast<uint32_t>(offsetof(InstanceData, normal_matrix) + sizeof(glm::vec4) * column) });
+			}
+			state.attributes.push_back({ location++, binding, vk::Format::eR32Uint, static_cast<uint32_t>(offsetof(InstanceData, material_id)) });
+
+			return state;
+		}
+
+		VertexInputState get_sphere_instance_input_state(uint32_t binding, uint32_t first_location)
+		{
+			VertexInputState state;
+			state.bindings.push_back({
+				binding,
+				sizeof(SphereInstance),
+				vk::VertexInputRate::eInstance
+			});
+
+			state.attributes.push_back({ first_location, binding, vk::Format::eR32G32B32A32Sfloat, static_cast<uint32_t>(offsetof(SphereInstance, center)) });
+			state.attributes.push_back({ first_location + 1, binding, vk::Format::eR32G32B32A32Sfloat, static_cast<uint32_t>(offsetof(SphereInstance, color)) });
+
+			return state;
+		}
+
+	} // namespace geom
+
+} // namespace plume
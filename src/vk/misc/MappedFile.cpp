@@ -0,0 +1,142 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <stdexcept>
+
+#include "MappedFile.h"
+
+#if defined(PLUME_MSW)
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace plume
+{
+
+	namespace fsys
+	{
+
+		MappedFile::MappedFile(const std::string& path) :
+			m_path(path)
+		{
+#if defined(PLUME_MSW)
+			HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				throw std::runtime_error("Failed to open file: " + path);
+			}
+
+			LARGE_INTEGER size;
+			GetFileSizeEx(file, &size);
+			m_file_handle = reinterpret_cast<intptr_t>(file);
+			m_size = static_cast<size_t>(size.QuadPart);
+
+			// Empty files cannot be mapped.
+			if (m_size == 0)
+			{
+				return;
+			}
+
+			m_mapping_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!m_mapping_handle)
+			{
+				CloseHandle(file);
+				throw std::runtime_error("Failed to create a file mapping for: " + path);
+			}
+
+			m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+			if (!m_data)
+			{
+				CloseHandle(m_mapping_handle);
+				CloseHandle(file);
+				throw std::runtime_error("Failed to map file: " + path);
+			}
+#else
+			const int file_descriptor = open(path.c_str(), O_RDONLY);
+			if (file_descriptor < 0)
+			{
+				throw std::runtime_error("Failed to open file: " + path);
+			}
+
+			struct stat file_status;
+			if (fstat(file_descriptor, &file_status) != 0)
+			{
+				close(file_descriptor);
+				throw std::runtime_error("Failed to query the size of file: " + path);
+			}
+			m_file_handle = file_descriptor;
+			m_size = static_cast<size_t>(file_status.st_size);
+
+			// Empty files cannot be mapped.
+			if (m_size == 0)
+			{
+				return;
+			}
+
+			void* mapped_ptr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+			if (mapped_ptr == MAP_FAILED)
+			{
+				close(file_descriptor);
+				throw std::runtime_error("Failed to map file: " + path);
+			}
+			m_data = static_cast<const uint8_t*>(mapped_ptr);
+#endif
+		}
+
+		MappedFile::~MappedFile()
+		{
+#if defined(PLUME_MSW)
+			if (m_data)
+			{
+				UnmapViewOfFile(m_data);
+			}
+			if (m_mapping_handle)
+			{
+				CloseHandle(m_mapping_handle);
+			}
+			if (m_file_handle != -1)
+			{
+				CloseHandle(reinterpret_cast<HANDLE>(m_file_handle));
+			}
+#else
+			if (m_data)
+			{
+				munmap(const_cast<uint8_t*>(m_data), m_size);
+			}
+			if (m_file_handle != -1)
+			{
+				close(static_cast<int>(m_file_handle));
+			}
+#endif
+		}
+
+	} // namespace fsys
+
+} // namespace plume
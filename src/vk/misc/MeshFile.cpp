@@ -0,0 +1,373 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <cstring>
+#include <fstream>
+
+#include "MeshFile.h"
+#include "ResourceManager.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		namespace
+		{
+
+			const char mesh_file_magic[4] = { 'P', 'L', 'M', 'H' };
+
+			size_t get_index_size(vk::IndexType index_type)
+			{
+				return (index_type == vk::IndexType::eUint16) ? sizeof(uint16_t) : sizeof(uint32_t);
+			}
+
+			size_t align_up(size_t value, size_t alignment)
+			{
+				return (value + alignment - 1) / alignment * alignment;
+			}
+
+			void write_indices(const std::vector<uint32_t>& indices, vk::IndexType index_type, std::vector<uint8_t>& destination)
+			{
+				destination.resize(indices.size() * get_index_size(index_type));
+				if (index_type == vk::IndexType::eUint32)
+				{
+					memcpy(destination.data(), indices.data(), destination.size());
+					return;
+				}
+
+				uint16_t* destination_16 = reinterpret_cast<uint16_t*>(destination.data());
+				for (size_t i = 0; i < indices.size(); ++i)
+				{
+					destination_16[i] = static_cast<uint16_t>(indices[i]);
+				}
+			}
+
+		} // anonymous
+
+		std::shared_ptr<MeshFile> MeshFile::load(const std::string& file_name)
+		{
+			return std::shared_ptr<MeshFile>(new MeshFile(fsys::ResourceManager::map_file(file_name)));
+		}
+
+		void MeshFile::write(const std::string& path, const Geometry& geometry, const MeshFileWriteOptions& options)
+		{
+			const size_t vertex_count = geometry.get_vertex_count();
+			const vk::IndexType index_type = geometry.get_index_type();
+
+			MeshFileHeader header = {};
+			memcpy(header.magic, mesh_file_magic, sizeof(mesh_file_magic));
+			header.version = MeshFileHeader::current_version;
+			header.vertex_count = static_cast<uint32_t>(vertex_count);
+			header.index_count = static_cast<uint32_t>(geometry.num_indices());
+			header.vertex_stride = Geometry::get_vertex_stride(options.encoding);
+			header.attribute_mode = static_cast<uint32_t>(options.attribute_mode);
+			header.position_encoding = static_cast<uint32_t>(options.encoding.positions);
+			header.normal_encoding = static_cast<uint32_t>(options.encoding.normals);
+			header.color_encoding = static_cast<uint32_t>(options.encoding.colors);
+			header.texture_coordinate_encoding = static_cast<uint32_t>(options.encoding.texture_coordinates);
+			header.index_type = static_cast<uint32_t>(index_type);
+			header.topology = static_cast<uint32_t>(geometry.get_topology());
+			header.primitive_restart = geometry.is_primitive_restart_enabled() ? 1 : 0;
+			header.lod_count = options.lods ? static_cast<uint32_t>(options.lods->levels.size()) : 0;
+			header.meshlet_count = options.meshlets ? static_cast<uint32_t>(options.meshlets->meshlets.size()) : 0;
+
+			const PositionDequantization dequantization = geometry.get_position_dequantization(options.encoding);
+			for (int i = 0; i < 3; ++i)
+			{
+				header.dequantization_offset[i] = dequantization.offset[i];
+				header.dequantization_scale[i] = dequantization.scale[i];
+			}
+
+			// Bounds (an axis-aligned box and a sphere that encloses it).
+			glm::vec3 min_bounds{ 0.0f };
+			glm::vec3 max_bounds{ 0.0f };
+			if (vertex_count > 0)
+			{
+				min_bounds = max_bounds = geometry.get_positions()[0];
+				for (const auto& position : geometry.get_positions())
+				{
+					min_bounds = glm::min(min_bounds, position);
+					max_bounds = glm::max(max_bounds, position);
+				}
+			}
+			const glm::vec3 center = (min_bounds + max_bounds) * 0.5f;
+			for (int i = 0; i < 3; ++i)
+			{
+				header.bounds_min[i] = min_bounds[i];
+				header.bounds_max[i] = max_bounds[i];
+				header.bounding_sphere[i] = center[i];
+			}
+			header.bounding_sphere[3] = glm::length(max_bounds - min_bounds) * 0.5f;
+
+			// Gather the contents of each section.
+			std::vector<std::vector<uint8_t>> sections(static_cast<size_t>(MeshFileSection::COUNT));
+			auto section = [&](MeshFileSection id) -> std::vector<uint8_t>& { return sections[static_cast<size_t>(id)]; };
+			auto copy_section = [&](MeshFileSection id, const void* data, size_t size) 
+			{ 
+				section(id).resize(size);
+				if (size > 0)
+				{
+					memcpy(section(id).data(), data, size);
+				}
+			};
+
+			section(MeshFileSection::VERTICES).resize(geometry.get_packed_vertex_attributes_size(options.encoding));
+			geometry.pack_vertex_attributes(section(MeshFileSection::VERTICES).data(), options.attribute_mode, options.encoding);
+
+			section(MeshFileSection::INDICES).resize(geometry.get_packed_indices_size());
+			geometry.pack_indices(section(MeshFileSection::INDICES).data());
+
+			if (options.lods)
+			{
+				copy_section(MeshFileSection::LOD_LEVELS, options.lods->levels.data(), sizeof(LevelOfDetail) * options.lods->levels.size());
+				write_indices(options.lods->indices, index_type, section(MeshFileSection::LOD_INDICES));
+			}
+
+			if (options.meshlets)
+			{
+				copy_section(MeshFileSection::MESHLETS, options.meshlets->meshlets.data(), sizeof(Meshlet) * options.meshlets->meshlets.size());
+				write_indices(options.meshlets->indices, index_type, section(MeshFileSection::MESHLET_INDICES));
+			}
+
+			// Lay out the sections after the header, each aligned so that it can be used in place.
+			size_t offset = align_up(sizeof(MeshFileHeader), MeshFileHeader::section_alignment);
+			for (size_t i = 0; i < sections.size(); ++i)
+			{
+				header.sections[i].offset = offset;
+				header.sections[i].size = sections[i].size();
+				offset = align_up(offset + sections[i].size(), MeshFileHeader::section_alignment);
+			}
+			header.file_size = offset;
+
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				throw std::runtime_error("Failed to open file for writing: " + path);
+			}
+
+			const char padding[MeshFileHeader::section_alignment] = {};
+			size_t written = 0;
+			auto write_padded = [&](const void* data, size_t size, size_t target_offset)
+			{
+				file.write(padding, target_offset - written);
+				file.write(static_cast<const char*>(data), size);
+				written = target_offset + size;
+			};
+
+			write_padded(&header, sizeof(header), 0);
+			for (size_t i = 0; i < sections.size(); ++i)
+			{
+				write_padded(sections[i].data(), sections[i].size(), static_cast<size_t>(header.sections[i].offset));
+			}
+			file.write(padding, header.file_size - written);
+
+			if (!file.good())
+			{
+				throw std::runtime_error("Failed to write file: " + path);
+			}
+		}
+
+		MeshFile::MeshFile(const std::shared_ptr<fsys::MappedFile>& mapped_file) :
+			m_mapped_file(mapped_file)
+		{
+			const std::string& path = m_mapped_file->get_path();
+			const size_t file_size = m_mapped_file->get_size();
+
+			if (file_size < sizeof(MeshFileHeader) || memcmp(get_header().magic, mesh_file_magic, sizeof(mesh_file_magic)) != 0)
+			{
+				throw std::runtime_error("The file " + path + " is not a .plmesh file");
+			}
+
+			const MeshFileHeader& header = get_header();
+			if (header.version != MeshFileHeader::current_version)
+			{
+				throw std::runtime_error("The file " + path + " was written with .plmesh version " + std::to_string(header.version) + 
+										 ", but version " + std::to_string(MeshFileHeader::current_version) + " is required");
+			}
+			if (header.file_size != file_size)
+			{
+				throw std::runtime_error("The file " + path + " is truncated");
+			}
+			if (header.index_type != static_cast<uint32_t>(vk::IndexType::eUint16) && 
+				header.index_type != static_cast<uint32_t>(vk::IndexType::eUint32))
+			{
+				throw std::runtime_error("The file " + path + " has an invalid index type");
+			}
+
+			// The vertex layout must be one that `Geometry::pack_vertex_attributes()` can produce.
+			if (header.attribute_mode > static_cast<uint32_t>(AttributeMode::MODE_SPLIT_POSITIONS) ||
+				header.position_encoding > static_cast<uint32_t>(PositionEncoding::POSITION_UNORM16) ||
+				header.normal_encoding > static_cast<uint32_t>(NormalEncoding::NORMAL_OCTAHEDRAL_SNORM16) ||
+				header.color_encoding > static_cast<uint32_t>(ColorEncoding::COLOR_UNORM8) ||
+				header.texture_coordinate_encoding > static_cast<uint32_t>(TextureCoordinateEncoding::TEXTURE_COORDINATES_FLOAT16) ||
+				header.vertex_stride != Geometry::get_vertex_stride(get_encoding()))
+			{
+				throw std::runtime_error("The file " + path + " has an invalid vertex layout");
+			}
+
+			for (const auto& entry : header.sections)
+			{
+				if (entry.offset % MeshFileHeader::section_alignment != 0 || entry.offset > file_size || entry.size > file_size - entry.offset)
+				{
+					throw std::runtime_error("The file " + path + " has an invalid section table");
+				}
+			}
+
+			// Every section must have exactly the size implied by the header, so that the accessors never read out of bounds.
+			const size_t index_size = get_index_size(get_index_type());
+			auto expect_size = [&](MeshFileSection section, size_t expected)
+			{
+				if (get_section_size(section) != expected)
+				{
+					throw std::runtime_error("The file " + path + " has a section with an unexpected size");
+				}
+			};
+
+			expect_size(MeshFileSection::VERTICES, size_t{ header.vertex_count } * header.vertex_stride);
+			expect_size(MeshFileSection::INDICES, size_t{ header.index_count } * index_size);
+			expect_size(MeshFileSection::LOD_LEVELS, size_t{ header.lod_count } * sizeof(LevelOfDetail));
+			expect_size(MeshFileSection::MESHLETS, size_t{ header.meshlet_count } * sizeof(Meshlet));
+
+			if (get_section_size(MeshFileSection::LOD_INDICES) % index_size != 0 || 
+				get_section_size(MeshFileSection::MESHLET_INDICES) % index_size != 0)
+			{
+				throw std::runtime_error("The file " + path + " has a section with an unexpected size");
+			}
+
+			// Every index must refer to an existing vertex, so that the index sections can be drawn (or used to address 
+			// per-vertex data) without further checks. Only the main index section can contain strip separators.
+			auto check_indices = [&](MeshFileSection section, bool allow_primitive_restart)
+			{
+				const size_t count = get_section_size(section) / index_size;
+				const uint32_t restart_index = (index_size == sizeof(uint16_t)) ? 0xFFFF : Geometry::primitive_restart_index;
+				for (size_t i = 0; i < count; ++i)
+				{
+					const uint32_t index = (index_size == sizeof(uint16_t)) ? 
+										   static_cast<const uint16_t*>(get_section_data(section))[i] : 
+										   static_cast<const uint32_t*>(get_section_data(section))[i];
+
+					if (index >= header.vertex_count && !(allow_primitive_restart && index == restart_index))
+					{
+						throw std::runtime_error("The file " + path + " has an index that refers to a vertex that does not exist");
+					}
+				}
+				return count;
+			};
+
+			check_indices(MeshFileSection::INDICES, header.primitive_restart != 0);
+			const size_t lod_index_count = check_indices(MeshFileSection::LOD_INDICES, false);
+			const size_t meshlet_index_count = check_indices(MeshFileSection::MESHLET_INDICES, false);
+
+			// The same goes for the ranges of indices that each LOD level and meshlet refers to.
+			auto is_valid_range = [](uint32_t first, uint32_t count, size_t total) { return first <= total && count <= total - first; };
+			for (uint32_t i = 0; i < header.lod_count; ++i)
+			{
+				if (!is_valid_range(get_lods()[i].first_index, get_lods()[i].index_count, lod_index_count))
+				{
+					throw std::runtime_error("The file " + path + " has a level of detail whose indices are out of range");
+				}
+			}
+			for (uint32_t i = 0; i < header.meshlet_count; ++i)
+			{
+				if (!is_valid_range(get_meshlets()[i].first_index, get_meshlets()[i].index_count, meshlet_index_count))
+				{
+					throw std::runtime_error("The file " + path + " has a meshlet whose indices are out of range");
+				}
+			}
+		}
+
+		const void* MeshFile::get_section_data(MeshFileSection section) const
+		{
+			return m_mapped_file->get_data() + get_header().sections[static_cast<size_t>(section)].offset;
+		}
+
+		VertexEncoding MeshFile::get_encoding() const
+		{
+			const MeshFileHeader& header = get_header();
+
+			VertexEncoding encoding;
+			encoding.positions = static_cast<PositionEncoding>(header.position_encoding);
+			encoding.normals = static_cast<NormalEncoding>(header.normal_encoding);
+			encoding.colors = static_cast<ColorEncoding>(header.color_encoding);
+			encoding.texture_coordinates = static_cast<TextureCoordinateEncoding>(header.texture_coordinate_encoding);
+
+			return encoding;
+		}
+
+		PositionDequantization MeshFile::get_position_dequantization() const
+		{
+			const MeshFileHeader& header = get_header();
+
+			PositionDequantization dequantization;
+			for (int i = 0; i < 3; ++i)
+			{
+				dequantization.offset[i] = header.dequantization_offset[i];
+				dequantization.scale[i] = header.dequantization_scale[i];
+			}
+
+			return dequantization;
+		}
+
+		MeshFileGeometry::MeshFileGeometry(const std::shared_ptr<MeshFile>& mesh_file) :
+			m_mesh_file(mesh_file)
+		{
+			const MeshFileHeader& header = m_mesh_file->get_header();
+
+			unpack_vertex_attributes(m_mesh_file->get_section_data(MeshFileSection::VERTICES), 
+									 header.vertex_count, 
+									 m_mesh_file->get_attribute_mode(), 
+									 m_mesh_file->get_encoding(), 
+									 m_mesh_file->get_position_dequantization());
+
+			if (m_mesh_file->get_index_type() == vk::IndexType::eUint32)
+			{
+				m_indices.resize(header.index_count);
+				if (header.index_count > 0)
+				{
+					memcpy(m_indices.data(), m_mesh_file->get_section_data(MeshFileSection::INDICES), m_mesh_file->get_section_size(MeshFileSection::INDICES));
+				}
+			}
+			else
+			{
+				// Widen 16-bit indices, preserving the primitive restart index.
+				const uint16_t* indices = static_cast<const uint16_t*>(m_mesh_file->get_section_data(MeshFileSection::INDICES));
+				m_indices.resize(header.index_count);
+				for (size_t i = 0; i < m_indices.size(); ++i)
+				{
+					m_indices[i] = (indices[i] == 0xFFFF && header.primitive_restart) ? primitive_restart_index : indices[i];
+				}
+			}
+
+			// Stripified geometry is always generated from a triangle list (see `Geometry::stripify()`).
+			m_is_stripified = header.primitive_restart != 0;
+			m_topology = m_is_stripified ? vk::PrimitiveTopology::eTriangleList : static_cast<vk::PrimitiveTopology>(header.topology);
+		}
+
+	} // namespace geom
+
+} // namespace plume
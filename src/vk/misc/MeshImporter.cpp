@@ -0,0 +1,1561 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+#include "MeshImporter.h"
+#include "Log.h"
+#include "MappedFile.h"
+#include "ResourceManager.h"
+#include "ThreadPool.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		namespace
+		{
+
+			using Clock = std::chrono::high_resolution_clock;
+
+			float get_elapsed_milliseconds(Clock::time_point start)
+			{
+				return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+			}
+
+			const uint32_t invalid_index = 0xFFFFFFFF;
+
+			// The number of vertices (or triangles) that are converted by a single task.
+			const size_t vertex_grain_size = 1 << 14;
+
+			uint64_t hash_combine(uint64_t seed, uint64_t value)
+			{
+				// The 64-bit finalizer from MurmurHash3.
+				seed ^= value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2);
+				seed ^= seed >> 33;
+				seed *= 0xFF51AFD7ED558CCDull;
+				seed ^= seed >> 33;
+				return seed;
+			}
+
+			//! Assigns each of the items [0, `hashes.size()`) to an output vertex, merging items that compare equal with 
+			//! `equal(a, b)`. Uses an open-addressing (linear probing) hash table on the precomputed `hashes`. Returns the
+			//! first item of each output vertex, in order of first occurrence, and writes each item's vertex to `remap`.
+			template<class Equal>
+			std::vector<uint32_t> deduplicate(const std::vector<uint64_t>& hashes, Equal equal, std::vector<uint32_t>& remap)
+			{
+				size_t capacity = 16;
+				while (capacity < hashes.size() * 2)
+				{
+					capacity <<= 1;
+				}
+				const size_t mask = capacity - 1;
+
+				std::vector<uint32_t> table(capacity, invalid_index);
+				std::vector<uint32_t> unique_items;
+				remap.resize(hashes.size());
+
+				for (size_t item = 0; item < hashes.size(); ++item)
+				{
+					for (size_t slot = hashes[item] & mask; ; slot = (slot + 1) & mask)
+					{
+						const uint32_t vertex = table[slot];
+						if (vertex == invalid_index)
+						{
+							table[slot] = static_cast<uint32_t>(unique_items.size());
+							remap[item] = table[slot];
+							unique_items.push_back(static_cast<uint32_t>(item));
+							break;
+						}
+
+						const uint32_t candidate = unique_items[vertex];
+						if (hashes[candidate] == hashes[item] && equal(candidate, static_cast<uint32_t>(item)))
+						{
+							remap[item] = vertex;
+							break;
+						}
+					}
+				}
+
+				return unique_items;
+			}
+
+			/***********************************************************************************
+			 *
+			 * Text parsing
+			 *
+			 ***********************************************************************************/
+
+			inline const char* skip_whitespace(const char* p, const char* end)
+			{
+				while (p < end && (*p == ' ' || *p == '\t'))
+				{
+					++p;
+				}
+				return p;
+			}
+
+			inline const char* skip_line(const char* p, const char* end)
+			{
+				while (p < end && *p != '\n')
+				{
+					++p;
+				}
+				return (p < end) ? p + 1 : p;
+			}
+
+			inline bool is_end_of_line(const char* p, const char* end)
+			{
+				return p >= end || *p == '\n' || *p == '\r' || *p == '#';
+			}
+
+			double power_of_ten(int exponent)
+			{
+				static const double table[] =
+				{
+					1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+					1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+				};
+
+				if (exponent >= 0 && exponent <= 22)
+				{
+					return table[exponent];
+				}
+				if (exponent < 0 && exponent >= -22)
+				{
+					return 1.0 / table[-exponent];
+				}
+				return pow(10.0, exponent);
+			}
+
+			//! Parses a decimal floating point number. This is much faster than `strtof()`, which is locale-dependent and
+			//! requires a null-terminated string, at the cost of (at most) one unit in the last place of precision.
+			const char* parse_float(const char* p, const char* end, float& value)
+			{
+				p = skip_whitespace(p, end);
+
+				bool is_negative = false;
+				if (p < end && (*p == '-' || *p == '+'))
+				{
+					is_negative = (*p == '-');
+					++p;
+				}
+
+				// Accumulate up to 19 significant digits, which always fit in 64 bits.
+				uint64_t mantissa = 0;
+				int exponent = 0;
+				int digits = 0;
+				while (p < end && *p >= '0' && *p <= '9')
+				{
+					if (digits < 19)
+					{
+						mantissa = mantissa * 10 + (*p - '0');
+						digits += (mantissa != 0);
+					}
+					else
+					{
+						++exponent;
+					}
+					++p;
+				}
+
+				if (p < end && *p == '.')
+				{
+					++p;
+					while (p < end && *p >= '0' && *p <= '9')
+					{
+						if (digits < 19)
+						{
+							mantissa = mantissa * 10 + (*p - '0');
+							digits += (mantissa != 0);
+							--exponent;
+						}
+						++p;
+					}
+				}
+
+				if (p < end && (*p == 'e' || *p == 'E'))
+				{
+					++p;
+
+					bool is_negative_exponent = false;
+					if (p < end && (*p == '-' || *p == '+'))
+					{
+						is_negative_exponent = (*p == '-');
+						++p;
+					}
+
+					int explicit_exponent = 0;
+					while (p < end && *p >= '0' && *p <= '9')
+					{
+						explicit_exponent = std::min(explicit_exponent * 10 + (*p - '0'), 10000);
+						++p;
+					}
+					exponent += is_negative_exponent ? -explicit_exponent : explicit_exponent;
+				}
+
+				const double result = static_cast<double>(mantissa) * ((exponent != 0) ? power_of_ten(exponent) : 1.0);
+				value = static_cast<float>(is_negative ? -result : result);
+
+				return p;
+			}
+
+			const char* parse_int(const char* p, const char* end, int64_t& value)
+			{
+				p = skip_whitespace(p, end);
+
+				bool is_negative = false;
+				if (p < end && (*p == '-' || *p == '+'))
+				{
+					is_negative = (*p == '-');
+					++p;
+				}
+
+				int64_t result = 0;
+				while (p < end && *p >= '0' && *p <= '9')
+				{
+					result = result * 10 + (*p - '0');
+					++p;
+				}
+				value = is_negative ? -result : result;
+
+				return p;
+			}
+
+			/***********************************************************************************
+			 *
+			 * OBJ
+			 *
+			 ***********************************************************************************/
+
+			struct ObjCorner
+			{
+				uint32_t position;
+				uint32_t texture_coordinate;
+				uint32_t normal;
+
+				bool operator==(const ObjCorner& other) const 
+				{ 
+					return position == other.position && texture_coordinate == other.texture_coordinate && normal == other.normal; 
+				}
+			};
+
+			enum class ObjLineType
+			{
+				POSITION,
+				TEXTURE_COORDINATE,
+				NORMAL,
+				FACE,
+				OTHER
+			};
+
+			inline ObjLineType classify_obj_line(const char* p, const char* end)
+			{
+				if (p + 1 >= end)
+				{
+					return ObjLineType::OTHER;
+				}
+
+				const bool is_separated = (p[1] == ' ' || p[1] == '\t');
+				if (p[0] == 'v')
+				{
+					if (is_separated) return ObjLineType::POSITION;
+					if (p + 2 < end && (p[2] == ' ' || p[2] == '\t'))
+					{
+						if (p[1] == 't') return ObjLineType::TEXTURE_COORDINATE;
+						if (p[1] == 'n') return ObjLineType::NORMAL;
+					}
+				}
+				else if (p[0] == 'f' && is_separated)
+				{
+					return ObjLineType::FACE;
+				}
+
+				return ObjLineType::OTHER;
+			}
+
+			//! A range of lines in an OBJ file. Chunks are parsed in two passes: the first counts the elements in each 
+			//! chunk, which determines where each chunk writes its elements (and how relative indices are resolved), and 
+			//! the second parses them.
+			struct ObjChunk
+			{
+				const char* begin;
+				const char* end;
+
+				size_t position_count = 0;
+				size_t texture_coordinate_count = 0;
+				size_t normal_count = 0;
+
+				size_t position_base = 0;
+				size_t texture_coordinate_base = 0;
+				size_t normal_base = 0;
+
+				bool has_colors = false;
+				std::vector<ObjCorner> corners;
+			};
+
+			//! Resolves a (1-based, possibly negative) OBJ index into a 0-based index.
+			inline uint32_t resolve_obj_index(int64_t index, size_t current_count)
+			{
+				if (index > 0)
+				{
+					return static_cast<uint32_t>(index - 1);
+				}
+				if (index < 0 && static_cast<size_t>(-index) <= current_count)
+				{
+					return static_cast<uint32_t>(current_count + index);
+				}
+				throw std::runtime_error("Encountered an invalid index while parsing an OBJ file");
+			}
+
+			void parse_obj_chunk(ObjChunk& chunk, 
+								 std::vector<glm::vec3>& positions, 
+								 std::vector<glm::vec3>& colors, 
+								 std::vector<glm::vec2>& texture_coordinates, 
+								 std::vector<glm::vec3>& normals, 
+								 bool flip_winding)
+			{
+				size_t position_count = chunk.position_base;
+				size_t texture_coordinate_count = chunk.texture_coordinate_base;
+				size_t normal_count = chunk.normal_base;
+
+				std::vector<ObjCorner> polygon;
+				const char* end = chunk.end;
+
+				for (const char* p = chunk.begin; p < end; p = skip_line(p, end))
+				{
+					p = skip_whitespace(p, end);
+
+					switch (classify_obj_line(p, end))
+					{
+					case ObjLineType::POSITION:
+					{
+						glm::vec3& position = positions[position_count];
+						p = parse_float(p + 1, end, position.x);
+						p = parse_float(p, end, position.y);
+						p = parse_float(p, end, position.z);
+
+						// Optional components follow the position: a single one is the homogeneous weight (which is ignored), 
+						// while exactly three are a vertex color.
+						float extra[3];
+						uint32_t extra_count = 0;
+						p = skip_whitespace(p, end);
+						while (extra_count < 3 && !is_end_of_line(p, end))
+						{
+							p = parse_float(p, end, extra[extra_count++]);
+							p = skip_whitespace(p, end);
+						}
+
+						glm::vec3& color = colors[position_count];
+						if (extra_count == 3)
+						{
+							color = glm::vec3{ extra[0], extra[1], extra[2] };
+							chunk.has_colors = true;
+						}
+						else
+						{
+							color = glm::vec3{ 1.0f };
+						}
+						position_count++;
+						break;
+					}
+					case ObjLineType::TEXTURE_COORDINATE:
+					{
+						glm::vec2& texture_coordinate = texture_coordinates[texture_coordinate_count++];
+						p = parse_float(p + 2, end, texture_coordinate.x);
+						p = parse_float(p, end, texture_coordinate.y);
+
+						// OBJ texture coordinates have a bottom-left origin, while Vulkan's is top-left.
+						texture_coordinate.y = 1.0f - texture_coordinate.y;
+						break;
+					}
+					case ObjLineType::NORMAL:
+					{
+						glm::vec3& normal = normals[normal_count++];
+						p = parse_float(p + 2, end, normal.x);
+						p = parse_float(p, end, normal.y);
+						p = parse_float(p, end, normal.z);
+						break;
+					}
+					case ObjLineType::FACE:
+					{
+						polygon.clear();
+						p = skip_whitespace(p + 1, end);
+
+						// Each corner has the form "p", "p/t", "p//n", or "p/t/n".
+						while (!is_end_of_line(p, end))
+						{
+							ObjCorner corner = { invalid_index, invalid_index, invalid_index };
+							int64_t index = 0;
+
+							p = parse_int(p, end, index);
+							corner.position = resolve_obj_index(index, position_count);
+
+							if (p < end && *p == '/')
+							{
+								++p;
+								if (p < end && *p != '/')
+								{
+									p = parse_int(p, end, index);
+									corner.texture_coordinate = resolve_obj_index(index, texture_coordinate_count);
+								}
+								if (p < end && *p == '/')
+								{
+									p = parse_int(p + 1, end, index);
+									corner.normal = resolve_obj_index(index, normal_count);
+								}
+							}
+
+							polygon.push_back(corner);
+							p = skip_whitespace(p, end);
+						}
+
+						// Triangulate the polygon as a fan.
+						for (size_t i = 2; i < polygon.size(); ++i)
+						{
+							chunk.corners.push_back(polygon[0]);
+							chunk.corners.push_back(polygon[flip_winding ? i : i - 1]);
+							chunk.corners.push_back(polygon[flip_winding ? i - 1 : i]);
+						}
+						break;
+					}
+					default:
+						break;
+					}
+				}
+			}
+
+			/***********************************************************************************
+			 *
+			 * JSON (for glTF)
+			 *
+			 ***********************************************************************************/
+
+			struct JsonValue
+			{
+				enum class Type
+				{
+					NUL,
+					BOOLEAN,
+					NUMBER,
+					STRING,
+					ARRAY,
+					OBJECT
+				};
+
+				//! Returns the member named `key`, or a null value if this isn't an object or there is no such member.
+				const JsonValue& operator[](const std::string& key) const
+				{
+					static const JsonValue null_value;
+					if (type != Type::OBJECT)
+					{
+						return null_value;
+					}
+					auto it = object.find(key);
+					return (it != object.end()) ? it->second : null_value;
+				}
+
+				//! Returns the element at `index`, or a null value if this isn't an array or the index is out of range.
+				const JsonValue& operator[](size_t index) const
+				{
+					static const JsonValue null_value;
+					return (type == Type::ARRAY && index < array.size()) ? array[index] : null_value;
+				}
+
+				bool is_null() const { return type == Type::NUL; }
+
+				size_t size() const { return (type == Type::ARRAY) ? array.size() : 0; }
+
+				double as_number(double fallback = 0.0) const { return (type == Type::NUMBER) ? number : fallback; }
+
+				size_t as_size(size_t fallback = 0) const { return (type == Type::NUMBER && number >= 0.0) ? static_cast<size_t>(number) : fallback; }
+
+				Type type = Type::NUL;
+				bool boolean = false;
+				double number = 0.0;
+				std::string string;
+				std::vector<JsonValue> array;
+				std::map<std::string, JsonValue> object;
+			};
+
+			class JsonParser
+			{
+			public:
+
+				JsonParser(const char* begin, const char* end) :
+					m_p(begin),
+					m_end(end)
+				{
+				}
+
+				JsonValue parse()
+				{
+					JsonValue value = parse_value(0);
+					skip();
+					if (m_p != m_end)
+					{
+						fail("unexpected characters after the root value");
+					}
+					return value;
+				}
+
+			private:
+
+				// Guards against stack overflows caused by malicious or corrupt files.
+				static const int max_depth = 256;
+
+				void fail(const std::string& reason) const
+				{
+					throw std::runtime_error("Failed to parse glTF JSON: " + reason);
+				}
+
+				void skip()
+				{
+					while (m_p < m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r'))
+					{
+						++m_p;
+					}
+				}
+
+				void expect(char c)
+				{
+					skip();
+					if (m_p >= m_end || *m_p != c)
+					{
+						fail(std::string("expected '") + c + "'");
+					}
+					++m_p;
+				}
+
+				bool consume_literal(const char* literal)
+				{
+					const size_t length = strlen(literal);
+					if (static_cast<size_t>(m_end - m_p) >= length && strncmp(m_p, literal, length) == 0)
+					{
+						m_p += length;
+						return true;
+					}
+					return false;
+				}
+
+				JsonValue parse_value(int depth)
+				{
+					if (depth > max_depth)
+					{
+						fail("the document is nested too deeply");
+					}
+
+					skip();
+					if (m_p >= m_end)
+					{
+						fail("unexpected end of input");
+					}
+
+					JsonValue value;
+					switch (*m_p)
+					{
+					case '{':
+						value.type = JsonValue::Type::OBJECT;
+						++m_p;
+						skip();
+						if (m_p < m_end && *m_p == '}')
+						{
+							++m_p;
+							break;
+						}
+						while (true)
+						{
+							skip();
+							std::string key = parse_string();
+							expect(':');
+							value.object[key] = parse_value(depth + 1);
+							skip();
+							if (m_p < m_end && *m_p == ',')
+							{
+								++m_p;
+								continue;
+							}
+							expect('}');
+							break;
+						}
+						break;
+					case '[':
+						value.type = JsonValue::Type::ARRAY;
+						++m_p;
+						skip();
+						if (m_p < m_end && *m_p == ']')
+						{
+							++m_p;
+							break;
+						}
+						while (true)
+						{
+							value.array.push_back(parse_value(depth + 1));
+							skip();
+							if (m_p < m_end && *m_p == ',')
+							{
+								++m_p;
+								continue;
+							}
+							expect(']');
+							break;
+						}
+						break;
+					case '"':
+						value.type = JsonValue::Type::STRING;
+						value.string = parse_string();
+						break;
+					case 't':
+					case 'f':
+						value.type = JsonValue::Type::BOOLEAN;
+						value.boolean = (*m_p == 't');
+						if (!consume_literal(value.boolean ? "true" : "false"))
+						{
+							fail("invalid literal");
+						}
+						break;
+					case 'n':
+						if (!consume_literal("null"))
+						{
+							fail("invalid literal");
+						}
+						break;
+					default:
+					{
+						float number = 0.0f;
+						const char* number_end = parse_float(m_p, m_end, number);
+						if (number_end == m_p)
+						{
+							fail("unexpected character");
+						}
+
+						// Integers (i.e. indices and byte offsets) must be exact, so they are not parsed as floats.
+						const char* q = (*m_p == '-') ? m_p + 1 : m_p;
+						bool is_integer = true;
+						for (; q < number_end; ++q)
+						{
+							is_integer = is_integer && (*q >= '0' && *q <= '9');
+						}
+						if (is_integer)
+						{
+							int64_t integer = 0;
+							parse_int(m_p, number_end, integer);
+							value.number = static_cast<double>(integer);
+						}
+						else
+						{
+							value.number = number;
+						}
+
+						value.type = JsonValue::Type::NUMBER;
+						m_p = number_end;
+						break;
+					}
+					}
+
+					return value;
+				}
+
+				std::string parse_string()
+				{
+					if (m_p >= m_end || *m_p != '"')
+					{
+						fail("expected a string");
+					}
+					++m_p;
+
+					std::string result;
+					while (m_p < m_end && *m_p != '"')
+					{
+						if (*m_p != '\\')
+						{
+							result.push_back(*m_p++);
+							continue;
+						}
+
+						if (++m_p >= m_end)
+						{
+							break;
+						}
+
+						switch (*m_p++)
+						{
+						case '"': result.push_back('"'); break;
+						case '\\': result.push_back('\\'); break;
+						case '/': result.push_back('/'); break;
+						case 'b': result.push_back('\b'); break;
+						case 'f': result.push_back('\f'); break;
+						case 'n': result.push_back('\n'); break;
+						case 'r': result.push_back('\r'); break;
+						case 't': result.push_back('\t'); break;
+						case 'u':
+						{
+							if (m_end - m_p < 4)
+							{
+								fail("invalid unicode escape");
+							}
+							const uint32_t code_point = static_cast<uint32_t>(std::stoul(std::string(m_p, m_p + 4), nullptr, 16));
+							m_p += 4;
+
+							// Encode as UTF-8 (surrogate pairs are not combined, which only affects names, not data).
+							if (code_point < 0x80)
+							{
+								result.push_back(static_cast<char>(code_point));
+							}
+							else if (code_point < 0x800)
+							{
+								result.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+								result.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+							}
+							else
+							{
+								result.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+								result.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+								result.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+							}
+							break;
+						}
+						default:
+							fail("invalid escape sequence");
+						}
+					}
+
+					if (m_p >= m_end)
+					{
+						fail("unterminated string");
+					}
+					++m_p;
+
+					return result;
+				}
+
+				const char* m_p;
+				const char* m_end;
+			};
+
+			/***********************************************************************************
+			 *
+			 * glTF
+			 *
+			 ***********************************************************************************/
+
+			std::vector<uint8_t> decode_base64(const char* p, const char* end)
+			{
+				auto decode = [](char c) -> int
+				{
+					if (c >= 'A' && c <= 'Z') return c - 'A';
+					if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+					if (c >= '0' && c <= '9') return c - '0' + 52;
+					if (c == '+' || c == '-') return 62;
+					if (c == '/' || c == '_') return 63;
+					return -1;
+				};
+
+				std::vector<uint8_t> result;
+				result.reserve((end - p) * 3 / 4);
+
+				uint32_t accumulator = 0;
+				int bits = 0;
+				for (; p < end && *p != '='; ++p)
+				{
+					const int value = decode(*p);
+					if (value < 0)
+					{
+						throw std::runtime_error("Encountered an invalid base64 character in a glTF data URI");
+					}
+
+					accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+					bits += 6;
+					if (bits >= 8)
+					{
+						bits -= 8;
+						result.push_back(static_cast<uint8_t>((accumulator >> bits) & 0xFF));
+					}
+				}
+
+				return result;
+			}
+
+			std::string decode_uri(const std::string& uri)
+			{
+				std::string result;
+				for (size_t i = 0; i < uri.size(); ++i)
+				{
+					if (uri[i] == '%' && i + 2 < uri.size())
+					{
+						result.push_back(static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16)));
+						i += 2;
+					}
+					else
+					{
+						result.push_back(uri[i]);
+					}
+				}
+				return result;
+			}
+
+			struct GltfBuffer
+			{
+				const uint8_t* data = nullptr;
+				size_t size = 0;
+			};
+
+			//! A typed, strided view of the elements of a glTF accessor.
+			struct GltfAccessor
+			{
+				const uint8_t* data = nullptr;		// Null if the accessor has no buffer view (all elements are zero)
+				size_t count = 0;
+				size_t stride = 0;
+				uint32_t component_type = 0;
+				uint32_t component_count = 0;
+				bool is_normalized = false;
+
+				//! Reads component `component` of element `element` as a float, applying normalization if necessary.
+				float read_float(size_t element, uint32_t component) const
+				{
+					if (!data || component >= component_count)
+					{
+						return 0.0f;
+					}
+
+					const uint8_t* p = data + element * stride;
+					switch (component_type)
+					{
+					case 5126: { float v; memcpy(&v, p + component * 4, 4); return v; }
+					case 5121: { const float v = p[component]; return is_normalized ? v / 255.0f : v; }
+					case 5120: { const float v = static_cast<int8_t>(p[component]); return is_normalized ? std::max(v / 127.0f, -1.0f) : v; }
+					case 5123: { uint16_t v; memcpy(&v, p + component * 2, 2); return is_normalized ? v / 65535.0f : v; }
+					case 5122: { int16_t v; memcpy(&v, p + component * 2, 2); return is_normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+					case 5125: { uint32_t v; memcpy(&v, p + component * 4, 4); return static_cast<float>(v); }
+					default: return 0.0f;
+					}
+				}
+
+				uint32_t read_index(size_t element) const
+				{
+					if (!data)
+					{
+						return 0;
+					}
+
+					const uint8_t* p = data + element * stride;
+					switch (component_type)
+					{
+					case 5121: return p[0];
+					case 5123: { uint16_t v; memcpy(&v, p, 2); return v; }
+					case 5125: { uint32_t v; memcpy(&v, p, 4); return v; }
+					default: throw std::runtime_error("glTF index accessors must use unsigned byte, short, or int components");
+					}
+				}
+			};
+
+			GltfAccessor resolve_gltf_accessor(const JsonValue& document, const std::vector<GltfBuffer>& buffers, size_t index)
+			{
+				const JsonValue& accessor = document["accessors"][index];
+				if (accessor.is_null())
+				{
+					throw std::runtime_error("A glTF primitive references an accessor that does not exist");
+				}
+				if (!accessor["sparse"].is_null())
+				{
+					throw std::runtime_error("Sparse glTF accessors are not supported");
+				}
+
+				static const std::map<std::string, uint32_t> component_counts = { { "SCALAR", 1 }, { "VEC2", 2 }, { "VEC3", 3 }, { "VEC4", 4 } };
+				static const std::map<uint32_t, uint32_t> component_sizes = { { 5120, 1 }, { 5121, 1 }, { 5122, 2 }, { 5123, 2 }, { 5125, 4 }, { 5126, 4 } };
+
+				auto count_it = component_counts.find(accessor["type"].string);
+				auto size_it = component_sizes.find(static_cast<uint32_t>(accessor["componentType"].as_size()));
+				if (count_it == component_counts.end() || size_it == component_sizes.end())
+				{
+					throw std::runtime_error("A glTF accessor has an unsupported type or component type");
+				}
+
+				GltfAccessor result;
+				result.count = accessor["count"].as_size();
+				result.component_type = size_it->first;
+				result.component_count = count_it->second;
+				result.is_normalized = accessor["normalized"].boolean;
+
+				const size_t element_size = size_it->second * count_it->second;
+				result.stride = element_size;
+
+				const JsonValue& buffer_view_index = accessor["bufferView"];
+				if (buffer_view_index.is_null() || result.count == 0)
+				{
+					return result;
+				}
+
+				const JsonValue& buffer_view = document["bufferViews"][buffer_view_index.as_size()];
+				const size_t buffer_index = buffer_view["buffer"].as_size(buffers.size());
+				if (buffer_view.is_null() || buffer_index >= buffers.size())
+				{
+					throw std::runtime_error("A glTF accessor references a buffer view or buffer that does not exist");
+				}
+
+				const GltfBuffer& buffer = buffers[buffer_index];
+				const size_t view_offset = buffer_view["byteOffset"].as_size();
+				const size_t view_length = buffer_view["byteLength"].as_size();
+				const size_t offset = view_offset + accessor["byteOffset"].as_size();
+				result.stride = buffer_view["byteStride"].as_size(element_size);
+
+				// Every element must lie within both the buffer view and the buffer.
+				const size_t last_byte = offset + result.stride * (result.count - 1) + element_size;
+				if (last_byte > view_offset + view_length || last_byte > buffer.size)
+				{
+					throw std::runtime_error("A glTF accessor extends beyond the end of its buffer");
+				}
+
+				result.data = buffer.data + offset;
+				return result;
+			}
+
+			std::string get_directory(const std::string& path)
+			{
+				const size_t separator = path.find_last_of("/\\");
+				return (separator == std::string::npos) ? std::string() : path.substr(0, separator + 1);
+			}
+
+			std::string get_lowercase_extension(const std::string& path)
+			{
+				const size_t dot = path.find_last_of('.');
+				std::string extension = (dot == std::string::npos) ? std::string() : path.substr(dot);
+				std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(tolower(c)); });
+				return extension;
+			}
+
+		} // anonymous
+
+		std::shared_ptr<ImportedGeometry> ImportedGeometry::load(const std::string& file_name, const ImportOptions& options)
+		{
+			const std::string path = fsys::ResourceManager::default_path + file_name;
+			const std::string extension = get_lowercase_extension(path);
+
+			if (extension == ".obj")
+			{
+				return load_obj(path, options);
+			}
+			if (extension == ".gltf" || extension == ".glb")
+			{
+				return load_gltf(path, options);
+			}
+
+			throw std::runtime_error("Unsupported mesh file extension: " + path);
+		}
+
+		std::shared_ptr<ImportedGeometry> ImportedGeometry::load_obj(const std::string& path, const ImportOptions& options)
+		{
+			const auto start = Clock::now();
+			auto& thread_pool = utils::ThreadPool::global();
+
+			fsys::MappedFile file{ path };
+			const char* begin = reinterpret_cast<const char*>(file.get_data());
+			const char* end = begin + file.get_size();
+
+			// Split the file into chunks that end on line boundaries.
+			std::vector<ObjChunk> chunks;
+			const size_t chunk_size = std::max<size_t>(options.chunk_size, 1);
+			for (const char* p = begin; p < end; )
+			{
+				const char* chunk_end = (static_cast<size_t>(end - p) > chunk_size) ? skip_line(p + chunk_size, end) : end;
+
+				ObjChunk chunk;
+				chunk.begin = p;
+				chunk.end = chunk_end;
+				chunks.push_back(std::move(chunk));
+
+				p = chunk_end;
+			}
+
+			// Pass 1: count the elements of each chunk.
+			thread_pool.parallel_for(0, chunks.size(), 1, [&](size_t chunk_begin, size_t chunk_end)
+			{
+				for (size_t c = chunk_begin; c < chunk_end; ++c)
+				{
+					ObjChunk& chunk = chunks[c];
+					for (const char* p = chunk.begin; p < chunk.end; p = skip_line(p, chunk.end))
+					{
+						switch (classify_obj_line(skip_whitespace(p, chunk.end), chunk.end))
+						{
+						case ObjLineType::POSITION: chunk.position_count++; break;
+						case ObjLineType::TEXTURE_COORDINATE: chunk.texture_coordinate_count++; break;
+						case ObjLineType::NORMAL: chunk.normal_count++; break;
+						default: break;
+						}
+					}
+				}
+			});
+
+			size_t position_count = 0;
+			size_t texture_coordinate_count = 0;
+			size_t normal_count = 0;
+			for (auto& chunk : chunks)
+			{
+				chunk.position_base = position_count;
+				chunk.texture_coordinate_base = texture_coordinate_count;
+				chunk.normal_base = normal_count;
+				position_count += chunk.position_count;
+				texture_coordinate_count += chunk.texture_coordinate_count;
+				normal_count += chunk.normal_count;
+			}
+
+			// Pass 2: parse each chunk directly into the shared attribute arrays.
+			std::vector<glm::vec3> positions(position_count);
+			std::vector<glm::vec3> colors(position_count);
+			std::vector<glm::vec2> texture_coordinates(texture_coordinate_count);
+			std::vector<glm::vec3> normals(normal_count);
+
+			thread_pool.parallel_for(0, chunks.size(), 1, [&](size_t chunk_begin, size_t chunk_end)
+			{
+				for (size_t c = chunk_begin; c < chunk_end; ++c)
+				{
+					parse_obj_chunk(chunks[c], positions, colors, texture_coordinates, normals, options.flip_winding);
+				}
+			});
+
+			// Gather the corners of every chunk.
+			std::vector<size_t> corner_offsets(chunks.size() + 1, 0);
+			bool has_colors = false;
+			for (size_t c = 0; c < chunks.size(); ++c)
+			{
+				corner_offsets[c + 1] = corner_offsets[c] + chunks[c].corners.size();
+				has_colors = has_colors || chunks[c].has_colors;
+			}
+
+			std::vector<ObjCorner> corners(corner_offsets.back());
+			thread_pool.parallel_for(0, chunks.size(), 1, [&](size_t chunk_begin, size_t chunk_end)
+			{
+				for (size_t c = chunk_begin; c < chunk_end; ++c)
+				{
+					std::copy(chunks[c].corners.begin(), chunks[c].corners.end(), corners.begin() + corner_offsets[c]);
+					std::vector<ObjCorner>().swap(chunks[c].corners);
+				}
+			});
+
+			for (const auto& corner : corners)
+			{
+				if (corner.position >= position_count ||
+					(corner.texture_coordinate != invalid_index && corner.texture_coordinate >= texture_coordinate_count) ||
+					(corner.normal != invalid_index && corner.normal >= normal_count))
+				{
+					throw std::runtime_error("An OBJ face references a vertex attribute that does not exist: " + path);
+				}
+			}
+
+			auto geometry = std::shared_ptr<ImportedGeometry>(new ImportedGeometry());
+			ImportStatistics& statistics = geometry->m_import_statistics;
+			statistics.parse_milliseconds = get_elapsed_milliseconds(start);
+
+			// Each unique corner becomes a vertex.
+			const auto deduplicate_start = Clock::now();
+			std::vector<uint32_t> unique_corners;
+			if (options.deduplicate_vertices)
+			{
+				std::vector<uint64_t> hashes(corners.size());
+				thread_pool.parallel_for(0, corners.size(), vertex_grain_size, [&](size_t corner_begin, size_t corner_end)
+				{
+					for (size_t i = corner_begin; i < corner_end; ++i)
+					{
+						uint64_t hash = hash_combine(0, corners[i].position);
+						hash = hash_combine(hash, corners[i].texture_coordinate);
+						hashes[i] = hash_combine(hash, corners[i].normal);
+					}
+				});
+
+				unique_corners = deduplicate(hashes, [&](uint32_t a, uint32_t b) { return corners[a] == corners[b]; }, geometry->m_indices);
+			}
+			else
+			{
+				unique_corners.resize(corners.size());
+				geometry->m_indices.resize(corners.size());
+				for (size_t i = 0; i < corners.size(); ++i)
+				{
+					unique_corners[i] = static_cast<uint32_t>(i);
+					geometry->m_indices[i] = static_cast<uint32_t>(i);
+				}
+			}
+			statistics.deduplicate_milliseconds = get_elapsed_milliseconds(deduplicate_start);
+
+			const size_t vertex_count = unique_corners.size();
+			geometry->m_positions.resize(vertex_count);
+			if (has_colors)
+			{
+				geometry->m_colors.resize(vertex_count);
+			}
+			if (texture_coordinate_count > 0)
+			{
+				geometry->m_texture_coordinates.resize(vertex_count);
+			}
+			if (normal_count > 0)
+			{
+				geometry->m_normals.resize(vertex_count);
+			}
+
+			thread_pool.parallel_for(0, vertex_count, vertex_grain_size, [&](size_t vertex_begin, size_t vertex_end)
+			{
+				for (size_t v = vertex_begin; v < vertex_end; ++v)
+				{
+					const ObjCorner& corner = corners[unique_corners[v]];
+
+					geometry->m_positions[v] = positions[corner.position];
+					if (has_colors)
+					{
+						geometry->m_colors[v] = colors[corner.position];
+					}
+					if (texture_coordinate_count > 0)
+					{
+						geometry->m_texture_coordinates[v] = (corner.texture_coordinate != invalid_index) ? texture_coordinates[corner.texture_coordinate] : glm::vec2{ 0.0f };
+					}
+					if (normal_count > 0)
+					{
+						geometry->m_normals[v] = (corner.normal != invalid_index) ? normals[corner.normal] : glm::vec3{ 0.0f };
+					}
+				}
+			});
+
+			geometry->complete_attributes();
+
+			statistics.file_size = file.get_size();
+			statistics.input_vertex_count = corners.size();
+			statistics.vertex_count = vertex_count;
+			statistics.triangle_count = corners.size() / 3;
+			statistics.total_milliseconds = get_elapsed_milliseconds(start);
+
+			PL_LOG_DEBUG("Imported %s: %zu vertices (%zu before deduplication), %zu triangles in %.2f ms (%.1f MB/s)\n",
+						 path.c_str(), 
+						 statistics.vertex_count, 
+						 statistics.input_vertex_count,
+						 statistics.triangle_count, 
+						 statistics.total_milliseconds, 
+						 statistics.get_throughput());
+
+			return geometry;
+		}
+
+		std::shared_ptr<ImportedGeometry> ImportedGeometry::load_gltf(const std::string& path, const ImportOptions& options)
+		{
+			const auto start = Clock::now();
+			auto& thread_pool = utils::ThreadPool::global();
+
+			fsys::MappedFile file{ path };
+			const uint8_t* data = file.get_data();
+			const size_t size = file.get_size();
+
+			// A binary glTF (.glb) file consists of a header followed by a JSON chunk and an optional binary chunk.
+			const char* json_begin = reinterpret_cast<const char*>(data);
+			const char* json_end = json_begin + size;
+			GltfBuffer binary_chunk;
+
+			if (size >= 12 && memcmp(data, "glTF", 4) == 0)
+			{
+				uint32_t header[3];
+				memcpy(header, data, sizeof(header));
+				if (header[1] != 2 || header[2] > size)
+				{
+					throw std::runtime_error("Unsupported or truncated binary glTF file: " + path);
+				}
+
+				for (size_t offset = 12; offset + 8 <= header[2]; )
+				{
+					uint32_t chunk_header[2];
+					memcpy(chunk_header, data + offset, sizeof(chunk_header));
+
+					const size_t chunk_begin = offset + 8;
+					const size_t chunk_length = chunk_header[0];
+					if (chunk_length > header[2] - chunk_begin)
+					{
+						throw std::runtime_error("A chunk extends beyond the end of the binary glTF file: " + path);
+					}
+
+					if (chunk_header[1] == 0x4E4F534A)	// "JSON"
+					{
+						json_begin = reinterpret_cast<const char*>(data + chunk_begin);
+						json_end = json_begin + chunk_length;
+					}
+					else if (chunk_header[1] == 0x004E4942 && !binary_chunk.data)	// "BIN"
+					{
+						binary_chunk.data = data + chunk_begin;
+						binary_chunk.size = chunk_length;
+					}
+
+					offset = chunk_begin + ((chunk_length + 3) & ~size_t{ 3 });
+				}
+			}
+
+			const JsonValue document = JsonParser{ json_begin, json_end }.parse();
+
+			if (document["asset"]["version"].string.compare(0, 1, "2") != 0)
+			{
+				throw std::runtime_error("Only glTF 2.0 files are supported: " + path);
+			}
+
+			// Resolve every buffer: embedded base64 data, an external file (which is memory-mapped), or the binary chunk.
+			std::vector<GltfBuffer> buffers;
+			std::vector<std::vector<uint8_t>> decoded_buffers;
+			std::vector<std::unique_ptr<fsys::MappedFile>> external_buffers;
+			size_t external_size = 0;
+
+			for (size_t i = 0; i < document["buffers"].size(); ++i)
+			{
+				const JsonValue& uri = document["buffers"][i]["uri"];
+
+				GltfBuffer buffer;
+				if (uri.is_null())
+				{
+					buffer = binary_chunk;
+				}
+				else if (uri.string.compare(0, 5, "data:") == 0)
+				{
+					const size_t comma = uri.string.find(',');
+					if (comma == std::string::npos || uri.string.find(";base64") == std::string::npos)
+					{
+						throw std::runtime_error("Only base64 data URIs are supported in glTF buffers: " + path);
+					}
+
+					decoded_buffers.push_back(decode_base64(uri.string.data() + comma + 1, uri.string.data() + uri.string.size()));
+					buffer.data = decoded_buffers.back().data();
+					buffer.size = decoded_buffers.back().size();
+				}
+				else
+				{
+					external_buffers.emplace_back(new fsys::MappedFile{ get_directory(path) + decode_uri(uri.string) });
+					buffer.data = external_buffers.back()->get_data();
+					buffer.size = external_buffers.back()->get_size();
+					external_size += buffer.size;
+				}
+
+				buffers.push_back(buffer);
+			}
+
+			// Gather the triangle primitives of every mesh.
+			struct Primitive
+			{
+				GltfAccessor positions;
+				GltfAccessor normals;
+				GltfAccessor texture_coordinates;
+				GltfAccessor colors;
+				GltfAccessor indices;
+				bool has_indices;
+				size_t vertex_base;
+				size_t index_base;
+			};
+
+			std::vector<Primitive> primitives;
+			size_t vertex_count = 0;
+			size_t index_count = 0;
+			bool has_normals = false;
+			bool has_texture_coordinates = false;
+			bool has_colors = false;
+
+			for (size_t m = 0; m < document["meshes"].size(); ++m)
+			{
+				const JsonValue& mesh_primitives = document["meshes"][m]["primitives"];
+				for (size_t p = 0; p < mesh_primitives.size(); ++p)
+				{
+					const JsonValue& source = mesh_primitives[p];
+					if (source["mode"].as_size(4) != 4)
+					{
+						PL_LOG_DEBUG("Skipping glTF primitive %zu of mesh %zu, which does not use the TRIANGLES mode\n", p, m);
+						continue;
+					}
+
+					const JsonValue& attributes = source["attributes"];
+					if (attributes["POSITION"].is_null())
+					{
+						continue;
+					}
+
+					auto resolve = [&](const JsonValue& index) 
+					{ 
+						return index.is_null() ? GltfAccessor{} : resolve_gltf_accessor(document, buffers, index.as_size()); 
+					};
+
+					Primitive primitive;
+					primitive.positions = resolve(attributes["POSITION"]);
+					primitive.normals = resolve(attributes["NORMAL"]);
+					primitive.texture_coordinates = resolve(attributes["TEXCOORD_0"]);
+					primitive.colors = resolve(attributes["COLOR_0"]);
+					primitive.indices = resolve(source["indices"]);
+					primitive.has_indices = !source["indices"].is_null();
+					primitive.vertex_base = vertex_count;
+					primitive.index_base = index_count;
+
+					const size_t primitive_vertex_count = primitive.positions.count;
+					for (const GltfAccessor* accessor : { &primitive.normals, &primitive.texture_coordinates, &primitive.colors })
+					{
+						if (accessor->count != 0 && accessor->count != primitive_vertex_count)
+						{
+							throw std::runtime_error("The attributes of a glTF primitive have different counts: " + path);
+						}
+					}
+
+					has_normals = has_normals || primitive.normals.count > 0;
+					has_texture_coordinates = has_texture_coordinates || primitive.texture_coordinates.count > 0;
+					has_colors = has_colors || primitive.colors.count > 0;
+
+					vertex_count += primitive_vertex_count;
+					index_count += (primitive.has_indices ? primitive.indices.count : primitive_vertex_count) / 3 * 3;
+					primitives.push_back(primitive);
+				}
+			}
+
+			auto geometry = std::shared_ptr<ImportedGeometry>(new ImportedGeometry());
+			ImportStatistics& statistics = geometry->m_import_statistics;
+
+			// Convert the attributes and indices of each primitive in parallel.
+			std::vector<glm::vec3> positions(vertex_count);
+			std::vector<glm::vec3> normals(has_normals ? vertex_count : 0);
+			std::vector<glm::vec2> texture_coordinates(has_texture_coordinates ? vertex_count : 0);
+			std::vector<glm::vec3> colors(has_colors ? vertex_count : 0);
+			std::vector<uint32_t> indices(index_count);
+
+			for (const auto& primitive : primitives)
+			{
+				thread_pool.parallel_for(0, primitive.positions.count, vertex_grain_size, [&](size_t vertex_begin, size_t vertex_end)
+				{
+					for (size_t i = vertex_begin; i < vertex_end; ++i)
+					{
+						const size_t v = primitive.vertex_base + i;
+						positions[v] = { primitive.positions.read_float(i, 0), primitive.positions.read_float(i, 1), primitive.positions.read_float(i, 2) };
+
+						if (has_normals)
+						{
+							normals[v] = { primitive.normals.read_float(i, 0), primitive.normals.read_float(i, 1), primitive.normals.read_float(i, 2) };
+						}
+						if (has_texture_coordinates)
+						{
+							texture_coordinates[v] = { primitive.texture_coordinates.read_float(i, 0), primitive.texture_coordinates.read_float(i, 1) };
+						}
+						if (has_colors)
+						{
+							colors[v] = (primitive.colors.count > 0) ? 
+										glm::vec3{ primitive.colors.read_float(i, 0), primitive.colors.read_float(i, 1), primitive.colors.read_float(i, 2) } : 
+										glm::vec3{ 1.0f };
+						}
+					}
+				});
+
+				const size_t vertex_total = primitive.positions.count;
+				const size_t triangle_count = (primitive.has_indices ? primitive.indices.count : vertex_total) / 3;
+				std::atomic<bool> is_out_of_range{ false };
+
+				thread_pool.parallel_for(0, triangle_count, vertex_grain_size, [&](size_t triangle_begin, size_t triangle_end)
+				{
+					for (size_t t = triangle_begin; t < triangle_end; ++t)
+					{
+						uint32_t triangle[3];
+						for (size_t k = 0; k < 3; ++k)
+						{
+							triangle[k] = primitive.has_indices ? primitive.indices.read_index(t * 3 + k) : static_cast<uint32_t>(t * 3 + k);
+							if (triangle[k] >= vertex_total)
+							{
+								is_out_of_range = true;
+								triangle[k] = 0;
+							}
+						}
+						if (options.flip_winding)
+						{
+							std::swap(triangle[1], triangle[2]);
+						}
+
+						for (size_t k = 0; k < 3; ++k)
+						{
+							indices[primitive.index_base + t * 3 + k] = static_cast<uint32_t>(primitive.vertex_base) + triangle[k];
+						}
+					}
+				});
+
+				if (is_out_of_range)
+				{
+					throw std::runtime_error("A glTF primitive references a vertex that does not exist: " + path);
+				}
+			}
+
+			statistics.parse_milliseconds = get_elapsed_milliseconds(start);
+
+			// Merge vertices whose attributes are bitwise identical.
+			const auto deduplicate_start = Clock::now();
+			if (options.deduplicate_vertices)
+			{
+				std::vector<uint64_t> hashes(vertex_count);
+				auto hash_bytes = [](uint64_t seed, const void* bytes, size_t length)
+				{
+					const uint32_t* words = static_cast<const uint32_t*>(bytes);
+					for (size_t i = 0; i < length / sizeof(uint32_t); ++i)
+					{
+						seed = hash_combine(seed, words[i]);
+					}
+					return seed;
+				};
+
+				thread_pool.parallel_for(0, vertex_count, vertex_grain_size, [&](size_t vertex_begin, size_t vertex_end)
+				{
+					for (size_t v = vertex_begin; v < vertex_end; ++v)
+					{
+						uint64_t hash = hash_bytes(0, &positions[v], sizeof(glm::vec3));
+						if (has_normals) hash = hash_bytes(hash, &normals[v], sizeof(glm::vec3));
+						if (has_texture_coordinates) hash = hash_bytes(hash, &texture_coordinates[v], sizeof(glm::vec2));
+						if (has_colors) hash = hash_bytes(hash, &colors[v], sizeof(glm::vec3));
+						hashes[v] = hash;
+					}
+				});
+
+				auto equal = [&](uint32_t a, uint32_t b)
+				{
+					return memcmp(&positions[a], &positions[b], sizeof(glm::vec3)) == 0 &&
+						   (!has_normals || memcmp(&normals[a], &normals[b], sizeof(glm::vec3)) == 0) &&
+						   (!has_texture_coordinates || memcmp(&texture_coordinates[a], &texture_coordinates[b], sizeof(glm::vec2)) == 0) &&
+						   (!has_colors || memcmp(&colors[a], &colors[b], sizeof(glm::vec3)) == 0);
+				};
+
+				std::vector<uint32_t> remap;
+				const std::vector<uint32_t> unique_vertices = deduplicate(hashes, equal, remap);
+
+				auto gather = [&](auto& attribute)
+				{
+					if (attribute.empty())
+					{
+						return;
+					}
+
+					typename std::remove_reference<decltype(attribute)>::type gathered(unique_vertices.size());
+					thread_pool.parallel_for(0, unique_vertices.size(), vertex_grain_size, [&](size_t vertex_begin, size_t vertex_end)
+					{
+						for (size_t v = vertex_begin; v < vertex_end; ++v)
+						{
+							gathered[v] = attribute[unique_vertices[v]];
+						}
+					});
+					attribute.swap(gathered);
+				};
+
+				gather(positions);
+				gather(normals);
+				gather(texture_coordinates);
+				gather(colors);
+
+				thread_pool.parallel_for(0, indices.size(), vertex_grain_size, [&](size_t index_begin, size_t index_end)
+				{
+					for (size_t i = index_begin; i < index_end; ++i)
+					{
+						indices[i] = remap[indices[i]];
+					}
+				});
+			}
+			statistics.deduplicate_milliseconds = get_elapsed_milliseconds(deduplicate_start);
+
+			geometry->m_positions = std::move(positions);
+			geometry->m_normals = std::move(normals);
+			geometry->m_texture_coordinates = std::move(texture_coordinates);
+			geometry->m_colors = std::move(colors);
+			geometry->m_indices = std::move(indices);
+			geometry->complete_attributes();
+
+			statistics.file_size = size + external_size;
+			statistics.input_vertex_count = vertex_count;
+			statistics.vertex_count = geometry->get_vertex_count();
+			statistics.triangle_count = geometry->num_indices() / 3;
+			statistics.total_milliseconds = get_elapsed_milliseconds(start);
+
+			PL_LOG_DEBUG("Imported %s: %zu vertices (%zu before deduplication), %zu triangles in %.2f ms (%.1f MB/s)\n",
+						 path.c_str(), 
+						 statistics.vertex_count, 
+						 statistics.input_vertex_count,
+						 statistics.triangle_count, 
+						 statistics.total_milliseconds, 
+						 statistics.get_throughput());
+
+			return geometry;
+		}
+
+		void ImportedGeometry::complete_attributes()
+		{
+			const size_t vertex_count = get_vertex_count();
+
+			if (m_colors.size() != vertex_count)
+			{
+				set_colors_solid({ 1.0f, 1.0f, 1.0f });
+			}
+			if (m_texture_coordinates.size() != vertex_count)
+			{
+				m_texture_coordinates.assign(vertex_count, glm::vec2{ 0.0f });
+			}
+
+			// Compute area-weighted vertex normals for any vertex that doesn't have one.
+			if (m_normals.size() != vertex_count)
+			{
+				m_normals.assign(vertex_count, glm::vec3{ 0.0f });
+			}
+
+			std::vector<bool> is_missing(vertex_count);
+			bool is_any_missing = false;
+			for (size_t v = 0; v < vertex_count; ++v)
+			{
+				is_missing[v] = (glm::dot(m_normals[v], m_normals[v]) == 0.0f);
+				is_any_missing = is_any_missing || is_missing[v];
+			}
+
+			if (!is_any_missing)
+			{
+				return;
+			}
+
+			for (size_t i = 0; i + 2 < m_indices.size(); i += 3)
+			{
+				const glm::vec3& p0 = m_positions[m_indices[i + 0]];
+				const glm::vec3& p1 = m_positions[m_indices[i + 1]];
+				const glm::vec3& p2 = m_positions[m_indices[i + 2]];
+				const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+
+				for (size_t k = 0; k < 3; ++k)
+				{
+					if (is_missing[m_indices[i + k]])
+					{
+						m_normals[m_indices[i + k]] += normal;
+					}
+				}
+			}
+
+			for (size_t v = 0; v < vertex_count; ++v)
+			{
+				const float length = glm::length(m_normals[v]);
+				if (is_missing[v] && length > 0.0f)
+				{
+					m_normals[v] /= length;
+				}
+			}
+		}
+
+	} // namespace geom
+
+} // namespace plume
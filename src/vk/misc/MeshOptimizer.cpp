@@ -0,0 +1,594 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <limits>
+#include <unordered_map>
+
+#include "MeshOptimizer.h"
+#include "Log.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		namespace
+		{
+
+			// Tuning constants from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation".
+			const uint32_t max_cache_size = 32;
+			const float cache_decay_power = 1.5f;
+			const float last_triangle_score = 0.75f;
+			const float valence_boost_scale = 2.0f;
+			const float valence_boost_power = 0.5f;
+
+			// The size of the FIFO cache that is simulated when splitting an index buffer into clusters.
+			const uint32_t cluster_cache_size = 16;
+
+			float compute_vertex_score(int32_t cache_position, uint32_t remaining_triangles)
+			{
+				// Vertices that aren't used by any remaining triangles should never be selected.
+				if (remaining_triangles == 0)
+				{
+					return -1.0f;
+				}
+
+				float score = 0.0f;
+				if (cache_position >= 0)
+				{
+					// Vertices that were used by the last triangle get a fixed score, so that the algorithm doesn't 
+					// prefer triangles that share an edge with the last triangle (which produces long, thin strips).
+					if (cache_position < 3)
+					{
+						score = last_triangle_score;
+					}
+					else
+					{
+						const float scaler = 1.0f / (max_cache_size - 3);
+						score = powf(1.0f - (cache_position - 3) * scaler, cache_decay_power);
+					}
+				}
+
+				// Boost vertices with few remaining triangles, so that lone triangles aren't left behind.
+				score += valence_boost_scale * powf(static_cast<float>(remaining_triangles), -valence_boost_power);
+
+				return score;
+			}
+
+			void validate_triangle_list(const std::vector<uint32_t>& indices, size_t vertex_count)
+			{
+				if (indices.size() % 3 != 0)
+				{
+					throw std::runtime_error("The number of indices must be a multiple of 3 (a triangle list)");
+				}
+
+				for (auto index : indices)
+				{
+					if (index >= vertex_count)
+					{
+						throw std::runtime_error("One or more indices refer to a vertex that does not exist");
+					}
+				}
+			}
+
+			//! Simulates a FIFO cache of `cache_size` entries and returns the number of misses caused by `triangle`. The 
+			//! cache is represented by the "time" at which each vertex was last inserted: a vertex is in the cache if 
+			//! fewer than `cache_size` insertions have occurred since then.
+			uint32_t simulate_fifo_triangle(const uint32_t* triangle, std::vector<uint32_t>& timestamps, uint32_t& time, uint32_t cache_size)
+			{
+				uint32_t misses = 0;
+				for (size_t k = 0; k < 3; ++k)
+				{
+					if (time - timestamps[triangle[k]] > cache_size)
+					{
+						timestamps[triangle[k]] = time++;
+						++misses;
+					}
+				}
+				return misses;
+			}
+
+		} // anonymous
+
+		VertexCacheStatistics analyze_vertex_cache(const std::vector<uint32_t>& indices, size_t vertex_count, uint32_t cache_size)
+		{
+			validate_triangle_list(indices, vertex_count);
+
+			VertexCacheStatistics statistics;
+			if (indices.empty())
+			{
+				return statistics;
+			}
+
+			std::vector<uint32_t> timestamps(vertex_count, 0);
+			uint32_t time = cache_size + 1;
+
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				statistics.vertices_transformed += simulate_fifo_triangle(&indices[i], timestamps, time, cache_size);
+			}
+
+			std::vector<bool> is_referenced(vertex_count, false);
+			size_t unique_vertices = 0;
+			for (auto index : indices)
+			{
+				if (!is_referenced[index])
+				{
+					is_referenced[index] = true;
+					++unique_vertices;
+				}
+			}
+
+			statistics.acmr = static_cast<float>(statistics.vertices_transformed) / (indices.size() / 3);
+			statistics.atvr = static_cast<float>(statistics.vertices_transformed) / unique_vertices;
+
+			return statistics;
+		}
+
+		std::vector<uint32_t> optimize_vertex_cache(const std::vector<uint32_t>& indices, size_t vertex_count)
+		{
+			validate_triangle_list(indices, vertex_count);
+
+			const size_t triangle_count = indices.size() / 3;
+
+			// Build the vertex-triangle adjacency in a compressed (CSR) layout: the triangles that use vertex `v` are 
+			// stored at `adjacency[offsets[v]...offsets[v] + remaining[v]]`.
+			std::vector<uint32_t> remaining(vertex_count, 0);
+			for (auto index : indices)
+			{
+				remaining[index]++;
+			}
+
+			std::vector<uint32_t> offsets(vertex_count + 1, 0);
+			for (size_t v = 0; v < vertex_count; ++v)
+			{
+				offsets[v + 1] = offsets[v] + remaining[v];
+			}
+
+			std::vector<uint32_t> adjacency(indices.size());
+			{
+				std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+				for (size_t i = 0; i < indices.size(); ++i)
+				{
+					adjacency[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			std::vector<int32_t> cache_positions(vertex_count, -1);
+			std::vector<float> vertex_scores(vertex_count);
+			for (size_t v = 0; v < vertex_count; ++v)
+			{
+				vertex_scores[v] = compute_vertex_score(-1, remaining[v]);
+			}
+
+			std::vector<bool> is_emitted(triangle_count, false);
+			std::vector<uint32_t> cache;
+			std::vector<uint32_t> next_cache;
+			cache.reserve(max_cache_size + 3);
+			next_cache.reserve(max_cache_size + 3);
+
+			std::vector<uint32_t> optimized_indices;
+			optimized_indices.reserve(indices.size());
+
+			int64_t best_triangle = -1;
+			size_t scan_cursor = 0;
+
+			for (size_t emitted = 0; emitted < triangle_count; ++emitted)
+			{
+				// If none of the triangles that touch the cache are left, continue with the next unprocessed triangle.
+				if (best_triangle < 0)
+				{
+					while (is_emitted[scan_cursor])
+					{
+						++scan_cursor;
+					}
+					best_triangle = static_cast<int64_t>(scan_cursor);
+				}
+
+				const uint32_t* triangle = &indices[static_cast<size_t>(best_triangle) * 3];
+				is_emitted[static_cast<size_t>(best_triangle)] = true;
+				optimized_indices.insert(optimized_indices.end(), triangle, triangle + 3);
+
+				// Remove the triangle from the adjacency of each of its vertices.
+				for (size_t k = 0; k < 3; ++k)
+				{
+					const uint32_t v = triangle[k];
+					auto begin = adjacency.begin() + offsets[v];
+					auto end = begin + remaining[v];
+					auto it = std::find(begin, end, static_cast<uint32_t>(best_triangle));
+
+					std::iter_swap(it, end - 1);
+					remaining[v]--;
+				}
+
+				// The triangle's vertices move to the front of the (LRU) cache.
+				next_cache.clear();
+				for (size_t k = 0; k < 3; ++k)
+				{
+					if (std::find(next_cache.begin(), next_cache.end(), triangle[k]) == next_cache.end())
+					{
+						next_cache.push_back(triangle[k]);
+					}
+				}
+				for (auto v : cache)
+				{
+					if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+					{
+						next_cache.push_back(v);
+					}
+				}
+
+				// Update the scores of every vertex in the new cache, as well as those that were just evicted.
+				for (size_t i = 0; i < next_cache.size(); ++i)
+				{
+					const uint32_t v = next_cache[i];
+					cache_positions[v] = (i < max_cache_size) ? static_cast<int32_t>(i) : -1;
+					vertex_scores[v] = compute_vertex_score(cache_positions[v], remaining[v]);
+				}
+				if (next_cache.size() > max_cache_size)
+				{
+					next_cache.resize(max_cache_size);
+				}
+				std::swap(cache, next_cache);
+
+				// The next triangle is the highest scoring triangle that uses at least one vertex in the cache.
+				best_triangle = -1;
+				float best_score = -1.0f;
+				for (auto v : cache)
+				{
+					for (uint32_t i = offsets[v]; i < offsets[v] + remaining[v]; ++i)
+					{
+						const uint32_t candidate = adjacency[i];
+						const uint32_t* candidate_triangle = &indices[candidate * 3];
+						const float score = vertex_scores[candidate_triangle[0]] + vertex_scores[candidate_triangle[1]] + vertex_scores[candidate_triangle[2]];
+
+						if (score > best_score)
+						{
+							best_score = score;
+							best_triangle = candidate;
+						}
+					}
+				}
+			}
+
+			return optimized_indices;
+		}
+
+		std::vector<uint32_t> optimize_overdraw(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold)
+		{
+			validate_triangle_list(indices, positions.size());
+
+			const size_t triangle_count = indices.size() / 3;
+			if (triangle_count == 0)
+			{
+				return indices;
+			}
+
+			std::vector<uint32_t> timestamps(positions.size(), 0);
+			uint32_t time = cluster_cache_size + 1;
+
+			// Hard boundaries: triangles whose vertices all miss the cache, i.e. where the cache is effectively flushed.
+			// Reordering clusters that start at these triangles has (almost) no effect on vertex cache efficiency.
+			std::vector<size_t> hard_boundaries;
+			for (size_t t = 0; t < triangle_count; ++t)
+			{
+				if (simulate_fifo_triangle(&indices[t * 3], timestamps, time, cluster_cache_size) == 3 || t == 0)
+				{
+					hard_boundaries.push_back(t);
+				}
+			}
+			hard_boundaries.push_back(triangle_count);
+
+			// Soft boundaries: split each cluster further, as long as the smaller clusters (each rendered with a cold
+			// cache) stay within `threshold` times the ACMR of the cluster they came from.
+			std::vector<size_t> boundaries;
+			for (size_t c = 0; c + 1 < hard_boundaries.size(); ++c)
+			{
+				const size_t cluster_begin = hard_boundaries[c];
+				const size_t cluster_end = hard_boundaries[c + 1];
+
+				time += cluster_cache_size + 1;
+				uint32_t cluster_misses = 0;
+				for (size_t t = cluster_begin; t < cluster_end; ++t)
+				{
+					cluster_misses += simulate_fifo_triangle(&indices[t * 3], timestamps, time, cluster_cache_size);
+				}
+				const float cluster_acmr = static_cast<float>(cluster_misses) / (cluster_end - cluster_begin);
+
+				boundaries.push_back(cluster_begin);
+
+				time += cluster_cache_size + 1;
+				size_t sub_cluster_begin = cluster_begin;
+				uint32_t sub_cluster_misses = 0;
+				for (size_t t = cluster_begin; t + 1 < cluster_end; ++t)
+				{
+					sub_cluster_misses += simulate_fifo_triangle(&indices[t * 3], timestamps, time, cluster_cache_size);
+
+					const float sub_cluster_acmr = static_cast<float>(sub_cluster_misses) / (t + 1 - sub_cluster_begin);
+					if (sub_cluster_acmr <= cluster_acmr * threshold)
+					{
+						sub_cluster_begin = t + 1;
+						sub_cluster_misses = 0;
+						boundaries.push_back(sub_cluster_begin);
+
+						// The next sub-cluster starts with a cold cache.
+						time += cluster_cache_size + 1;
+					}
+				}
+			}
+			boundaries.push_back(triangle_count);
+
+			// Compute the (area-weighted) centroid of the entire mesh.
+			glm::vec3 mesh_centroid{ 0.0f };
+			float mesh_area = 0.0f;
+			for (size_t t = 0; t < triangle_count; ++t)
+			{
+				const glm::vec3& a = positions[indices[t * 3 + 0]];
+				const glm::vec3& b = positions[indices[t * 3 + 1]];
+				const glm::vec3& c = positions[indices[t * 3 + 2]];
+				const float area = glm::length(glm::cross(b - a, c - a));
+
+				mesh_centroid += (a + b + c) * (area / 3.0f);
+				mesh_area += area;
+			}
+			mesh_centroid = (mesh_area > 0.0f) ? mesh_centroid / mesh_area : mesh_centroid;
+
+			// Clusters that face away from the center of the mesh are more likely to occlude other clusters, so they
+			// should be drawn first. The sort key is the signed distance of the cluster's centroid from the mesh centroid,
+			// measured along the cluster's average normal.
+			struct Cluster
+			{
+				size_t begin;
+				size_t end;
+				float sort_key;
+			};
+
+			std::vector<Cluster> clusters;
+			float total_sort_key = 0.0f;
+			for (size_t c = 0; c + 1 < boundaries.size(); ++c)
+			{
+				glm::vec3 cluster_centroid{ 0.0f };
+				glm::vec3 cluster_normal{ 0.0f };
+				float cluster_area = 0.0f;
+
+				for (size_t t = boundaries[c]; t < boundaries[c + 1]; ++t)
+				{
+					const glm::vec3& a = positions[indices[t * 3 + 0]];
+					const glm::vec3& b = positions[indices[t * 3 + 1]];
+					const glm::vec3& c = positions[indices[t * 3 + 2]];
+					const glm::vec3 normal = glm::cross(b - a, c - a);	// Length is twice the triangle's area
+					const float area = glm::length(normal);
+
+					cluster_centroid += (a + b + c) * (area / 3.0f);
+					cluster_normal += normal;
+					cluster_area += area;
+				}
+
+				cluster_centroid = (cluster_area > 0.0f) ? cluster_centroid / cluster_area : cluster_centroid;
+				const float normal_length = glm::length(cluster_normal);
+				cluster_normal = (normal_length > 0.0f) ? cluster_normal / normal_length : cluster_normal;
+
+				const float sort_key = glm::dot(cluster_centroid - mesh_centroid, cluster_normal);
+				total_sort_key += sort_key * cluster_area;
+
+				clusters.push_back({ boundaries[c], boundaries[c + 1], sort_key });
+			}
+
+			// The sign of each normal depends on the mesh's winding order. For (mostly) closed meshes, outward-facing
+			// normals produce positive sort keys on average, so flip the ordering if the opposite is true.
+			const bool flip = total_sort_key < 0.0f;
+			std::stable_sort(clusters.begin(), clusters.end(), [&](const Cluster& a, const Cluster& b) {
+				return flip ? a.sort_key < b.sort_key : a.sort_key > b.sort_key;
+			});
+
+			std::vector<uint32_t> optimized_indices;
+			optimized_indices.reserve(indices.size());
+			for (const auto& cluster : clusters)
+			{
+				optimized_indices.insert(optimized_indices.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+			}
+
+			return optimized_indices;
+		}
+
+		std::vector<uint32_t> optimize_vertex_fetch_remap(const std::vector<uint32_t>& indices, size_t vertex_count)
+		{
+			validate_triangle_list(indices, vertex_count);
+
+			const uint32_t unassigned = std::numeric_limits<uint32_t>::max();
+			std::vector<uint32_t> remap(vertex_count, unassigned);
+			uint32_t next_index = 0;
+
+			for (auto index : indices)
+			{
+				if (remap[index] == unassigned)
+				{
+					remap[index] = next_index++;
+				}
+			}
+
+			for (auto& mapping : remap)
+			{
+				if (mapping == unassigned)
+				{
+					mapping = next_index++;
+				}
+			}
+
+			return remap;
+		}
+
+		std::vector<uint32_t> stripify(const std::vector<uint32_t>& indices, size_t vertex_count, uint32_t restart_index)
+		{
+			validate_triangle_list(indices, vertex_count);
+
+			const size_t triangle_count = indices.size() / 3;
+
+			auto edge_key = [](uint32_t from, uint32_t to) { return (static_cast<uint64_t>(from) << 32) | to; };
+
+			// Map each directed edge to the triangle(s) that contain it. Degenerate triangles are never emitted.
+			std::unordered_multimap<uint64_t, uint32_t> edges;
+			edges.reserve(indices.size());
+			std::vector<bool> is_emitted(triangle_count, false);
+
+			for (size_t t = 0; t < triangle_count; ++t)
+			{
+				const uint32_t* triangle = &indices[t * 3];
+				if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0])
+				{
+					is_emitted[t] = true;
+					continue;
+				}
+
+				for (size_t k = 0; k < 3; ++k)
+				{
+					edges.emplace(edge_key(triangle[k], triangle[(k + 1) % 3]), static_cast<uint32_t>(t));
+				}
+			}
+
+			// Returns an unprocessed triangle that contains the directed edge `from` -> `to`, or -1.
+			auto find_neighbor = [&](uint32_t from, uint32_t to) -> int64_t
+			{
+				auto range = edges.equal_range(edge_key(from, to));
+				for (auto it = range.first; it != range.second; ++it)
+				{
+					if (!is_emitted[it->second])
+					{
+						return it->second;
+					}
+				}
+				return -1;
+			};
+
+			// Returns the vertex of `triangle` that follows the directed edge `from` -> `to`.
+			auto opposite_vertex = [&](size_t triangle, uint32_t from, uint32_t to) -> uint32_t
+			{
+				const uint32_t* vertices = &indices[triangle * 3];
+				for (size_t k = 0; k < 3; ++k)
+				{
+					if (vertices[k] == from && vertices[(k + 1) % 3] == to)
+					{
+						return vertices[(k + 2) % 3];
+					}
+				}
+				return vertices[0];
+			};
+
+			std::vector<uint32_t> strips;
+			strips.reserve(indices.size());
+
+			for (size_t t = 0; t < triangle_count; ++t)
+			{
+				if (is_emitted[t])
+				{
+					continue;
+				}
+
+				// Triangle `i` of a strip is (v[i], v[i + 1], v[i + 2]) if `i` is even and (v[i + 1], v[i], v[i + 2]) if
+				// `i` is odd. Rotate the first triangle so that the second triangle of the strip (if any) can follow it.
+				const uint32_t* triangle = &indices[t * 3];
+				size_t rotation = 0;
+				for (size_t r = 0; r < 3; ++r)
+				{
+					if (find_neighbor(triangle[(r + 2) % 3], triangle[(r + 1) % 3]) >= 0)
+					{
+						rotation = r;
+						break;
+					}
+				}
+
+				if (!strips.empty())
+				{
+					strips.push_back(restart_index);
+				}
+
+				uint32_t previous = triangle[(rotation + 1) % 3];
+				uint32_t last = triangle[(rotation + 2) % 3];
+				strips.push_back(triangle[rotation]);
+				strips.push_back(previous);
+				strips.push_back(last);
+				is_emitted[t] = true;
+
+				for (size_t strip_triangle = 1; ; ++strip_triangle)
+				{
+					const bool is_odd = (strip_triangle % 2) == 1;
+					const uint32_t from = is_odd ? last : previous;
+					const uint32_t to = is_odd ? previous : last;
+
+					const int64_t neighbor = find_neighbor(from, to);
+					if (neighbor < 0)
+					{
+						break;
+					}
+
+					const uint32_t next = opposite_vertex(static_cast<size_t>(neighbor), from, to);
+					strips.push_back(next);
+					is_emitted[static_cast<size_t>(neighbor)] = true;
+
+					previous = last;
+					last = next;
+				}
+			}
+
+			return strips;
+		}
+
+		MeshOptimizationStatistics optimize_mesh(Geometry& geometry, bool reduce_overdraw, float overdraw_threshold)
+		{
+			if (geometry.get_topology() != vk::PrimitiveTopology::eTriangleList)
+			{
+				throw std::runtime_error("Mesh optimization requires a geometry with the vk::PrimitiveTopology::eTriangleList topology");
+			}
+
+			const size_t vertex_count = geometry.get_vertex_count();
+
+			MeshOptimizationStatistics statistics;
+			statistics.before = analyze_vertex_cache(geometry.get_indices(), vertex_count);
+
+			std::vector<uint32_t> indices = optimize_vertex_cache(geometry.get_indices(), vertex_count);
+			if (reduce_overdraw)
+			{
+				indices = optimize_overdraw(indices, geometry.get_positions(), overdraw_threshold);
+			}
+
+			geometry.set_indices(indices);
+			geometry.remap_vertices(optimize_vertex_fetch_remap(indices, vertex_count));
+
+			statistics.after = analyze_vertex_cache(geometry.get_indices(), vertex_count);
+
+			PL_LOG_DEBUG("Mesh optimization: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", 
+						 statistics.before.acmr, 
+						 statistics.after.acmr, 
+						 statistics.before.atvr, 
+						 statistics.after.atvr);
+
+			return statistics;
+		}
+
+	} // namespace geom
+
+} // namespace plume
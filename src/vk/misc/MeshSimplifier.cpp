@@ -0,0 +1,481 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		namespace
+		{
+
+			//! A symmetric 4x4 matrix that measures the sum of squared distances from a point to a set of (area 
+			//! weighted) planes, following Garland and Heckbert's "Surface Simplification Using Quadric Error Metrics".
+			struct Quadric
+			{
+				double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+				double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+				double c = 0.0;
+				double area = 0.0;
+
+				void add_plane(const glm::vec3& n, float d, float weight)
+				{
+					a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z;
+					a11 += weight * n.y * n.y; a12 += weight * n.y * n.z;
+					a22 += weight * n.z * n.z;
+					b0 += weight * n.x * d; b1 += weight * n.y * d; b2 += weight * n.z * d;
+					c += weight * d * d;
+					area += weight;
+				}
+
+				Quadric& operator+=(const Quadric& other)
+				{
+					a00 += other.a00; a01 += other.a01; a02 += other.a02;
+					a11 += other.a11; a12 += other.a12;
+					a22 += other.a22;
+					b0 += other.b0; b1 += other.b1; b2 += other.b2;
+					c += other.c;
+					area += other.area;
+					return *this;
+				}
+
+				double evaluate(const glm::vec3& p) const
+				{
+					const double x = p.x, y = p.y, z = p.z;
+					const double result = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z +
+										  a11 * y * y + 2.0 * a12 * y * z +
+										  a22 * z * z +
+										  2.0 * (b0 * x + b1 * y + b2 * z) + c;
+
+					// Guard against small negative values caused by floating point error.
+					return result > 0.0 ? result : 0.0;
+				}
+			};
+
+			struct Collapse
+			{
+				uint32_t from;
+				uint32_t to;
+				float error;
+			};
+
+			uint64_t edge_key(uint32_t from, uint32_t to)
+			{
+				return (static_cast<uint64_t>(from) << 32) | to;
+			}
+
+			template<class T>
+			float squared_attribute_distance(const std::vector<T>& attribute, size_t vertex_count, uint32_t a, uint32_t b)
+			{
+				if (attribute.size() != vertex_count)
+				{
+					return 0.0f;
+				}
+
+				const T difference = attribute[a] - attribute[b];
+				return glm::dot(difference, difference);
+			}
+
+			//! Hashes (and compares) positions bitwise, in order to find vertices that share a position.
+			struct PositionHash
+			{
+				size_t operator()(const glm::vec3& p) const
+				{
+					uint32_t bits[3];
+					memcpy(bits, &p, sizeof(bits));
+					return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+				}
+			};
+
+			struct PositionEqual
+			{
+				bool operator()(const glm::vec3& a, const glm::vec3& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+			};
+
+		} // anonymous
+
+		float LodChain::compute_screen_space_error(float error, float distance, float vertical_fov, float viewport_height)
+		{
+			if (distance <= 0.0f)
+			{
+				return std::numeric_limits<float>::max();
+			}
+
+			return (error / (2.0f * distance * tanf(vertical_fov * 0.5f))) * viewport_height;
+		}
+
+		size_t LodChain::select_level(float distance, float vertical_fov, float viewport_height, float pixel_threshold, float scale) const
+		{
+			size_t selected = 0;
+			for (size_t i = 1; i < levels.size(); ++i)
+			{
+				if (compute_screen_space_error(levels[i].error * scale, distance, vertical_fov, viewport_height) > pixel_threshold)
+				{
+					break;
+				}
+				selected = i;
+			}
+
+			return selected;
+		}
+
+		void LodChain::pack_indices(void* destination, vk::IndexType index_type) const
+		{
+			if (index_type == vk::IndexType::eUint32)
+			{
+				memcpy(destination, indices.data(), sizeof(uint32_t) * indices.size());
+				return;
+			}
+
+			uint16_t* destination_16 = static_cast<uint16_t*>(destination);
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				destination_16[i] = static_cast<uint16_t>(indices[i]);
+			}
+		}
+
+		std::vector<uint32_t> simplify(const Geometry& geometry,
+									   const std::vector<uint32_t>& indices,
+									   size_t target_index_count,
+									   float target_error,
+									   const SimplificationOptions& options,
+									   float* result_error)
+		{
+			const auto& positions = geometry.get_positions();
+			const size_t vertex_count = geometry.get_vertex_count();
+
+			if (indices.size() % 3 != 0)
+			{
+				throw std::runtime_error("The number of indices must be a multiple of 3 (a triangle list)");
+			}
+
+			// Vertices that share their position with another vertex lie on an attribute seam (i.e. a discontinuity in
+			// texture coordinates or normals): moving one of them would tear the surface apart, so they are locked.
+			std::vector<bool> is_locked(vertex_count, false);
+			{
+				std::unordered_map<glm::vec3, uint32_t, PositionHash, PositionEqual> first_vertex_at_position;
+				for (uint32_t v = 0; v < vertex_count; ++v)
+				{
+					auto result = first_vertex_at_position.emplace(positions[v], v);
+					if (!result.second)
+					{
+						is_locked[v] = true;
+						is_locked[result.first->second] = true;
+					}
+				}
+			}
+
+			// Vertices on open boundaries (edges that are used by a single triangle) are locked as well, so that the 
+			// silhouette of the mesh doesn't shrink.
+			{
+				std::unordered_set<uint64_t> directed_edges;
+				directed_edges.reserve(indices.size());
+				for (size_t i = 0; i < indices.size(); i += 3)
+				{
+					for (size_t k = 0; k < 3; ++k)
+					{
+						directed_edges.insert(edge_key(indices[i + k], indices[i + (k + 1) % 3]));
+					}
+				}
+				for (auto key : directed_edges)
+				{
+					const uint32_t from = static_cast<uint32_t>(key >> 32);
+					const uint32_t to = static_cast<uint32_t>(key & 0xFFFFFFFF);
+					if (directed_edges.find(edge_key(to, from)) == directed_edges.end())
+					{
+						is_locked[from] = true;
+						is_locked[to] = true;
+					}
+				}
+			}
+
+			// Accumulate the (area weighted) plane of every triangle into the quadrics of its vertices.
+			std::vector<Quadric> quadrics(vertex_count);
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				const glm::vec3& p0 = positions[indices[i + 0]];
+				const glm::vec3& p1 = positions[indices[i + 1]];
+				const glm::vec3& p2 = positions[indices[i + 2]];
+
+				glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				const float length = glm::length(normal);
+				if (length == 0.0f)
+				{
+					continue;
+				}
+				normal /= length;
+
+				const float area = length * 0.5f;
+				const float d = -glm::dot(normal, p0);
+				for (size_t k = 0; k < 3; ++k)
+				{
+					quadrics[indices[i + k]].add_plane(normal, d, area);
+				}
+			}
+
+			// Degenerate triangles are removed up front.
+			std::vector<uint32_t> result;
+			result.reserve(indices.size());
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				if (indices[i] != indices[i + 1] && indices[i + 1] != indices[i + 2] && indices[i + 2] != indices[i])
+				{
+					result.insert(result.end(), indices.begin() + i, indices.begin() + i + 3);
+				}
+			}
+
+			float max_error = 0.0f;
+			std::vector<uint32_t> remap(vertex_count);
+			std::iota(remap.begin(), remap.end(), 0);
+			std::vector<uint32_t> triangle_counts(vertex_count);
+			std::vector<uint32_t> offsets(vertex_count + 1);
+			std::vector<uint32_t> adjacency;
+			std::vector<Collapse> collapses;
+			std::vector<bool> is_touched(vertex_count);
+
+			// Each pass collapses as many independent edges as possible (cheapest first), then rebuilds the index list.
+			while (result.size() > target_index_count)
+			{
+				// Build the vertex-triangle adjacency of the current triangles.
+				std::fill(triangle_counts.begin(), triangle_counts.end(), 0);
+				for (auto index : result)
+				{
+					triangle_counts[index]++;
+				}
+				offsets[0] = 0;
+				for (size_t v = 0; v < vertex_count; ++v)
+				{
+					offsets[v + 1] = offsets[v] + triangle_counts[v];
+				}
+				adjacency.resize(result.size());
+				{
+					std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+					for (size_t i = 0; i < result.size(); ++i)
+					{
+						adjacency[cursors[result[i]]++] = static_cast<uint32_t>(i / 3);
+					}
+				}
+
+				// Gather every candidate collapse (from -> to) along with its error.
+				collapses.clear();
+				for (size_t i = 0; i < result.size(); i += 3)
+				{
+					for (size_t k = 0; k < 3; ++k)
+					{
+						const uint32_t a = result[i + k];
+						const uint32_t b = result[i + (k + 1) % 3];
+
+						for (int direction = 0; direction < 2; ++direction)
+						{
+							const uint32_t from = direction ? b : a;
+							const uint32_t to = direction ? a : b;
+							if (is_locked[from])
+							{
+								continue;
+							}
+
+							Quadric quadric = quadrics[from];
+							quadric += quadrics[to];
+
+							const double area = std::max(quadric.area, 1e-12);
+							const float geometric_error = static_cast<float>(quadric.evaluate(positions[to]) / area);
+
+							// Attribute differences are weighted by the share of the surface that the removed vertex represents.
+							const float attribute_share = static_cast<float>(quadrics[from].area / area);
+							const float attribute_error = attribute_share * (
+								options.normal_weight * squared_attribute_distance(geometry.get_normals(), vertex_count, from, to) +
+								options.color_weight * squared_attribute_distance(geometry.get_colors(), vertex_count, from, to) +
+								options.texture_coordinate_weight * squared_attribute_distance(geometry.get_texture_coordinates(), vertex_count, from, to));
+
+							collapses.push_back({ from, to, sqrtf(geometric_error + attribute_error) });
+						}
+					}
+				}
+
+				std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+				std::fill(is_touched.begin(), is_touched.end(), false);
+				size_t remaining_index_count = result.size();
+				size_t collapse_count = 0;
+
+				for (const auto& collapse : collapses)
+				{
+					if (collapse.error > target_error || remaining_index_count <= target_index_count)
+					{
+						break;
+					}
+
+					// Collapses within a pass must not share vertices (or neighbors), so that the flip test below is exact.
+					if (is_touched[collapse.from] || is_touched[collapse.to])
+					{
+						continue;
+					}
+
+					// Reject the collapse if any of the triangles that survive it would flip over.
+					bool is_valid = true;
+					uint32_t removed_triangles = 0;
+					for (uint32_t j = offsets[collapse.from]; j < offsets[collapse.from + 1] && is_valid; ++j)
+					{
+						const uint32_t* triangle = &result[adjacency[j] * 3];
+						if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+						{
+							removed_triangles++;
+							continue;
+						}
+
+						glm::vec3 before[3];
+						glm::vec3 after[3];
+						for (size_t k = 0; k < 3; ++k)
+						{
+							before[k] = positions[triangle[k]];
+							after[k] = (triangle[k] == collapse.from) ? positions[collapse.to] : before[k];
+						}
+
+						const glm::vec3 normal_before = glm::cross(before[1] - before[0], before[2] - before[0]);
+						const glm::vec3 normal_after = glm::cross(after[1] - after[0], after[2] - after[0]);
+						is_valid = glm::dot(normal_before, normal_after) > 0.0f;
+					}
+
+					if (!is_valid)
+					{
+						continue;
+					}
+
+					for (uint32_t j = offsets[collapse.from]; j < offsets[collapse.from + 1]; ++j)
+					{
+						const uint32_t* triangle = &result[adjacency[j] * 3];
+						is_touched[triangle[0]] = true;
+						is_touched[triangle[1]] = true;
+						is_touched[triangle[2]] = true;
+					}
+
+					remap[collapse.from] = collapse.to;
+					quadrics[collapse.to] += quadrics[collapse.from];
+					max_error = std::max(max_error, collapse.error);
+
+					remaining_index_count -= removed_triangles * 3;
+					collapse_count++;
+				}
+
+				if (collapse_count == 0)
+				{
+					break;
+				}
+
+				// Apply the collapses and remove the triangles that became degenerate.
+				size_t write = 0;
+				for (size_t i = 0; i < result.size(); i += 3)
+				{
+					uint32_t triangle[3];
+					for (size_t k = 0; k < 3; ++k)
+					{
+						triangle[k] = remap[result[i + k]];
+					}
+
+					if (triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[2] != triangle[0])
+					{
+						result[write++] = triangle[0];
+						result[write++] = triangle[1];
+						result[write++] = triangle[2];
+					}
+				}
+				result.resize(write);
+
+				// Reset the remap table for the next pass.
+				std::iota(remap.begin(), remap.end(), 0);
+			}
+
+			if (result_error)
+			{
+				*result_error = max_error;
+			}
+
+			return result;
+		}
+
+		LodChain generate_lod_chain(const Geometry& geometry, const SimplificationOptions& options)
+		{
+			if (geometry.get_topology() != vk::PrimitiveTopology::eTriangleList)
+			{
+				throw std::runtime_error("LOD chains can only be generated for geometry with the vk::PrimitiveTopology::eTriangleList topology");
+			}
+
+			const size_t vertex_count = geometry.get_vertex_count();
+
+			// Errors are specified relative to the size of the mesh.
+			glm::vec3 min_bounds{ std::numeric_limits<float>::max() };
+			glm::vec3 max_bounds{ -std::numeric_limits<float>::max() };
+			for (const auto& position : geometry.get_positions())
+			{
+				min_bounds = glm::min(min_bounds, position);
+				max_bounds = glm::max(max_bounds, position);
+			}
+			const float radius = (vertex_count > 0) ? glm::length(max_bounds - min_bounds) * 0.5f : 0.0f;
+			const float target_error = options.max_error * radius;
+
+			LodChain chain;
+
+			std::vector<uint32_t> level_indices = optimize_vertex_cache(geometry.get_indices(), vertex_count);
+			chain.levels.push_back({ 0, static_cast<uint32_t>(level_indices.size()), 0.0f });
+			chain.indices = level_indices;
+
+			for (uint32_t level = 1; level < options.max_levels; ++level)
+			{
+				const LevelOfDetail previous = chain.levels.back();
+				const size_t target_index_count = static_cast<size_t>(previous.index_count * options.reduction_ratio) / 3 * 3;
+
+				float error = 0.0f;
+				level_indices = simplify(geometry, geometry.get_indices(), target_index_count, target_error, options, &error);
+
+				// Stop once simplification is blocked by the error bound (or locked vertices).
+				if (level_indices.empty() || level_indices.size() > previous.index_count * 0.95f)
+				{
+					break;
+				}
+
+				level_indices = optimize_vertex_cache(level_indices, vertex_count);
+
+				chain.levels.push_back({ static_cast<uint32_t>(chain.indices.size()), 
+										 static_cast<uint32_t>(level_indices.size()), 
+										 std::max(error, previous.error) });
+				chain.indices.insert(chain.indices.end(), level_indices.begin(), level_indices.end());
+			}
+
+			return chain;
+		}
+
+	} // namespace geom
+
+} // namespace plume
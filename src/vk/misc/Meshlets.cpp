@@ -0,0 +1,202 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "Meshlets.h"
+
+namespace plume
+{
+
+	namespace geom
+	{
+
+		namespace
+		{
+
+			void compute_meshlet_bounds(const Geometry& geometry, const uint32_t* indices, size_t index_count, Meshlet& meshlet)
+			{
+				const auto& positions = geometry.get_positions();
+
+				// Bounding sphere: centered on the meshlet's bounding box, enclosing every vertex.
+				glm::vec3 min_bounds = positions[indices[0]];
+				glm::vec3 max_bounds = positions[indices[0]];
+				for (size_t i = 1; i < index_count; ++i)
+				{
+					min_bounds = glm::min(min_bounds, positions[indices[i]]);
+					max_bounds = glm::max(max_bounds, positions[indices[i]]);
+				}
+
+				const glm::vec3 center = (min_bounds + max_bounds) * 0.5f;
+				float radius = 0.0f;
+				for (size_t i = 0; i < index_count; ++i)
+				{
+					radius = std::max(radius, glm::distance(center, positions[indices[i]]));
+				}
+
+				// Normal cone: the axis is the average of the (unit) triangle normals, and the cone's half-angle is the 
+				// largest angle between the axis and any of those normals.
+				std::vector<glm::vec3> normals;
+				normals.reserve(index_count / 3);
+
+				glm::vec3 axis{ 0.0f };
+				for (size_t i = 0; i < index_count; i += 3)
+				{
+					const glm::vec3& p0 = positions[indices[i + 0]];
+					const glm::vec3& p1 = positions[indices[i + 1]];
+					const glm::vec3& p2 = positions[indices[i + 2]];
+
+					const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+					const float length = glm::length(normal);
+					if (length > 0.0f)
+					{
+						normals.push_back(normal / length);
+						axis += normals.back();
+					}
+				}
+
+				float cutoff = 1.0f;
+				const float axis_length = glm::length(axis);
+				if (axis_length > 0.0f)
+				{
+					axis /= axis_length;
+
+					float min_dot = 1.0f;
+					for (const auto& normal : normals)
+					{
+						min_dot = std::min(min_dot, glm::dot(axis, normal));
+					}
+
+					// If the cone spans more than a hemisphere, the meshlet can never be back-facing as a whole.
+					cutoff = (min_dot <= 0.0f) ? 1.0f : sqrtf(1.0f - min_dot * min_dot);
+				}
+
+				meshlet.bounding_sphere = glm::vec4{ center.x, center.y, center.z, radius };
+				meshlet.normal_cone = glm::vec4{ axis.x, axis.y, axis.z, cutoff };
+			}
+
+		} // anonymous
+
+		MeshletCullingParameters MeshletCullingParameters::create(const glm::mat4& model, const glm::mat4& view_projection, const glm::vec3& camera_position, float scale)
+		{
+			MeshletCullingParameters parameters;
+			parameters.model = model;
+			parameters.camera_position = glm::vec4{ camera_position.x, camera_position.y, camera_position.z, scale };
+
+			// Extract the planes from the rows of the (column-major) view-projection matrix, following Gribb and Hartmann's
+			// "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix".
+			auto row = [&](int i) { return glm::vec4{ view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i] }; };
+
+			parameters.frustum_planes[0] = row(3) + row(0);
+			parameters.frustum_planes[1] = row(3) - row(0);
+			parameters.frustum_planes[2] = row(3) + row(1);
+			parameters.frustum_planes[3] = row(3) - row(1);
+			parameters.frustum_planes[4] = row(3) + row(2);
+			parameters.frustum_planes[5] = row(3) - row(2);
+
+			for (auto& plane : parameters.frustum_planes)
+			{
+				const float length = glm::length(glm::vec3{ plane.x, plane.y, plane.z });
+				plane = plane / length;
+			}
+
+			return parameters;
+		}
+
+		MeshletMesh build_meshlets(const Geometry& geometry, uint32_t max_vertices, uint32_t max_triangles)
+		{
+			if (geometry.get_topology() != vk::PrimitiveTopology::eTriangleList)
+			{
+				throw std::runtime_error("Meshlets can only be built from geometry with the vk::PrimitiveTopology::eTriangleList topology");
+			}
+			if (max_vertices < 3 || max_triangles < 1)
+			{
+				throw std::runtime_error("Meshlets must be able to hold at least one triangle");
+			}
+
+			const auto& indices = geometry.get_indices();
+
+			MeshletMesh mesh;
+			mesh.indices.reserve(indices.size());
+
+			// The meshlet that each vertex was last added to, which is used to count the unique vertices of a meshlet.
+			const uint32_t unassigned = std::numeric_limits<uint32_t>::max();
+			std::vector<uint32_t> vertex_meshlet(geometry.get_vertex_count(), unassigned);
+
+			Meshlet current = {};
+			auto flush = [&]()
+			{
+				if (current.index_count == 0)
+				{
+					return;
+				}
+				compute_meshlet_bounds(geometry, &mesh.indices[current.first_index], current.index_count, current);
+				mesh.meshlets.push_back(current);
+
+				current = {};
+				current.first_index = static_cast<uint32_t>(mesh.indices.size());
+			};
+
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				const uint32_t meshlet_id = static_cast<uint32_t>(mesh.meshlets.size());
+
+				uint32_t new_vertices = 0;
+				for (size_t k = 0; k < 3; ++k)
+				{
+					// Count each vertex only once, even if the triangle is degenerate.
+					const bool is_repeated = (k > 0 && indices[i + k] == indices[i]) || (k > 1 && indices[i + k] == indices[i + 1]);
+					if (vertex_meshlet[indices[i + k]] != meshlet_id && !is_repeated)
+					{
+						new_vertices++;
+					}
+				}
+
+				// Start a new meshlet if this triangle doesn't fit.
+				if (current.vertex_count + new_vertices > max_vertices || current.index_count / 3 + 1 > max_triangles)
+				{
+					flush();
+				}
+
+				const uint32_t target_id = static_cast<uint32_t>(mesh.meshlets.size());
+				for (size_t k = 0; k < 3; ++k)
+				{
+					const uint32_t index = indices[i + k];
+					if (vertex_meshlet[index] != target_id)
+					{
+						vertex_meshlet[index] = target_id;
+						current.vertex_count++;
+					}
+					mesh.indices.push_back(index);
+				}
+				current.index_count += 3;
+			}
+			flush();
+
+			return mesh;
+		}
+
+	} // namespace geom
+
+} // namespace plume
@@ -0,0 +1,194 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+#include "ThreadPool.h"
+
+namespace plume
+{
+
+	namespace utils
+	{
+
+		ThreadPool& ThreadPool::global()
+		{
+			static ThreadPool pool{ std::max(std::thread::hardware_concurrency(), 2u) - 1 };
+			return pool;
+		}
+
+		ThreadPool::ThreadPool(size_t thread_count)
+		{
+			for (size_t i = 0; i < thread_count; ++i)
+			{
+				m_threads.emplace_back([this]() { worker_loop(); });
+			}
+		}
+
+		ThreadPool::~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_is_stopping = true;
+			}
+			m_condition.notify_all();
+
+			for (auto& thread : m_threads)
+			{
+				thread.join();
+			}
+		}
+
+		void ThreadPool::submit(std::function<void()> task)
+		{
+			if (m_threads.empty())
+			{
+				task();
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_tasks.push_back(std::move(task));
+			}
+			m_condition.notify_one();
+		}
+
+		void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain_size, const std::function<void(size_t, size_t)>& func)
+		{
+			if (begin >= end)
+			{
+				return;
+			}
+
+			const size_t count = end - begin;
+			grain_size = std::max<size_t>(grain_size, 1);
+
+			// A few chunks per thread balances the load when chunks take different amounts of time.
+			const size_t max_chunks = (m_threads.size() + 1) * 4;
+			const size_t chunk_count = std::min((count + grain_size - 1) / grain_size, max_chunks);
+
+			if (chunk_count <= 1 || m_threads.empty())
+			{
+				func(begin, end);
+				return;
+			}
+
+			// The state is shared with the helper tasks, which may start running after this function has returned (if 
+			// the calling thread processed every chunk itself).
+			struct State
+			{
+				std::function<void(size_t, size_t)> func;
+				size_t begin;
+				size_t count;
+				size_t chunk_count;
+				std::atomic<size_t> next_chunk{ 0 };
+				std::atomic<size_t> completed_chunks{ 0 };
+				std::exception_ptr exception;
+				std::mutex mutex;
+				std::condition_variable condition;
+			};
+
+			auto state = std::make_shared<State>();
+			state->func = func;
+			state->begin = begin;
+			state->count = count;
+			state->chunk_count = chunk_count;
+
+			auto process_chunks = [](const std::shared_ptr<State>& state)
+			{
+				for (size_t chunk = state->next_chunk++; chunk < state->chunk_count; chunk = state->next_chunk++)
+				{
+					const size_t chunk_begin = state->begin + (state->count * chunk) / state->chunk_count;
+					const size_t chunk_end = state->begin + (state->count * (chunk + 1)) / state->chunk_count;
+
+					try
+					{
+						state->func(chunk_begin, chunk_end);
+					}
+					catch (...)
+					{
+						std::lock_guard<std::mutex> lock(state->mutex);
+						if (!state->exception)
+						{
+							state->exception = std::current_exception();
+						}
+					}
+
+					if (++state->completed_chunks == state->chunk_count)
+					{
+						std::lock_guard<std::mutex> lock(state->mutex);
+						state->condition.notify_all();
+					}
+				}
+			};
+
+			const size_t helper_count = std::min(m_threads.size(), chunk_count - 1);
+			for (size_t i = 0; i < helper_count; ++i)
+			{
+				submit([state, process_chunks]() { process_chunks(state); });
+			}
+
+			// The calling thread works on chunks too, and then only waits for chunks that are already being processed.
+			process_chunks(state);
+			{
+				std::unique_lock<std::mutex> lock(state->mutex);
+				state->condition.wait(lock, [&]() { return state->completed_chunks == state->chunk_count; });
+			}
+
+			if (state->exception)
+			{
+				std::rethrow_exception(state->exception);
+			}
+		}
+
+		void ThreadPool::worker_loop()
+		{
+			while (true)
+			{
+				std::function<void()> task;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_condition.wait(lock, [this]() { return m_is_stopping || !m_tasks.empty(); });
+
+					if (m_is_stopping && m_tasks.empty())
+					{
+						return;
+					}
+
+					task = std::move(m_tasks.front());
+					m_tasks.pop_front();
+				}
+				task();
+			}
+		}
+
+	} // namespace utils
+
+} // namespace plume
@@ -60,6 +60,221 @@ namespace plume
 			return image_aspect_flags;
 		}
 
+		uint32_t get_format_component_count(vk::Format format)
+		{
+			switch (format)
+			{
+			case vk::Format::eR8Unorm:
+			case vk::Format::eR8Snorm:
+			case vk::Format::eR8Uscaled:
+			case vk::Format::eR8Sscaled:
+			case vk::Format::eR8Uint:
+			case vk::Format::eR8Sint:
+			case vk::Format::eR8Srgb:
+			case vk::Format::eR16Unorm:
+			case vk::Format::eR16Snorm:
+			case vk::Format::eR16Uscaled:
+			case vk::Format::eR16Sscaled:
+			case vk::Format::eR16Uint:
+			case vk::Format::eR16Sint:
+			case vk::Format::eR16Sfloat:
+			case vk::Format::eR32Uint:
+			case vk::Format::eR32Sint:
+			case vk::Format::eR32Sfloat:
+				return 1;
+			case vk::Format::eR8G8Unorm:
+			case vk::Format::eR8G8Snorm:
+			case vk::Format::eR8G8Uscaled:
+			case vk::Format::eR8G8Sscaled:
+			case vk::Format::eR8G8Uint:
+			case vk::Format::eR8G8Sint:
+			case vk::Format::eR8G8Srgb:
+			case vk::Format::eR16G16Unorm:
+			case vk::Format::eR16G16Snorm:
+			case vk::Format::eR16G16Uscaled:
+			case vk::Format::eR16G16Sscaled:
+			case vk::Format::eR16G16Uint:
+			case vk::Format::eR16G16Sint:
+			case vk::Format::eR16G16Sfloat:
+			case vk::Format::eR32G32Uint:
+			case vk::Format::eR32G32Sint:
+			case vk::Format::eR32G32Sfloat:
+				return 2;
+			case vk::Format::eR8G8B8Unorm:
+			case vk::Format::eR8G8B8Snorm:
+			case vk::Format::eR8G8B8Uscaled:
+			case vk::Format::eR8G8B8Sscaled:
+			case vk::Format::eR8G8B8Uint:
+			case vk::Format::eR8G8B8Sint:
+			case vk::Format::eR8G8B8Srgb:
+			case vk::Format::eB8G8R8Unorm:
+			case vk::Format::eB8G8R8Snorm:
+			case vk::Format::eB8G8R8Uscaled:
+			case vk::Format::eB8G8R8Sscaled:
+			case vk::Format::eB8G8R8Uint:
+			case vk::Format::eB8G8R8Sint:
+			case vk::Format::eB8G8R8Srgb:
+			case vk::Format::eR16G16B16Unorm:
+			case vk::Format::eR16G16B16Snorm:
+			case vk::Format::eR16G16B16Uscaled:
+			case vk::Format::eR16G16B16Sscaled:
+			case vk::Format::eR16G16B16Uint:
+			case vk::Format::eR16G16B16Sint:
+			case vk::Format::eR16G16B16Sfloat:
+			case vk::Format::eR32G32B32Uint:
+			case vk::Format::eR32G32B32Sint:
+			case vk::Format::eR32G32B32Sfloat:
+			case vk::Format::eB10G11R11UfloatPack32:
+				return 3;
+			case vk::Format::eR8G8B8A8Unorm:
+			case vk::Format::eR8G8B8A8Snorm:
+			case vk::Format::eR8G8B8A8Uscaled:
+			case vk::Format::eR8G8B8A8Sscaled:
+			case vk::Format::eR8G8B8A8Uint:
+			case vk::Format::eR8G8B8A8Sint:
+			case vk::Format::eR8G8B8A8Srgb:
+			case vk::Format::eB8G8R8A8Unorm:
+			case vk::Format::eB8G8R8A8Snorm:
+			case vk::Format::eB8G8R8A8Uscaled:
+			case vk::Format::eB8G8R8A8Sscaled:
+			case vk::Format::eB8G8R8A8Uint:
+			case vk::Format::eB8G8R8A8Sint:
+			case vk::Format::eB8G8R8A8Srgb:
+			case vk::Format::eR16G16B16A16Unorm:
+			case vk::Format::eR16G16B16A16Snorm:
+			case vk::Format::eR16G16B16A16Uscaled:
+			case vk::Format::eR16G16B16A16Sscaled:
+			case vk::Format::eR16G16B16A16Uint:
+			case vk::Format::eR16G16B16A16Sint:
+			case vk::Format::eR16G16B16A16Sfloat:
+			case vk::Format::eR32G32B32A32Uint:
+			case vk::Format::eR32G32B32A32Sint:
+			case vk::Format::eR32G32B32A32Sfloat:
+			case vk::Format::eA2R10G10B10UnormPack32:
+			case vk::Format::eA2R10G10B10SnormPack32:
+			case vk::Format::eA2R10G10B10UscaledPack32:
+			case vk::Format::eA2R10G10B10SscaledPack32:
+			case vk::Format::eA2R10G10B10UintPack32:
+			case vk::Format::eA2R10G10B10SintPack32:
+			case vk::Format::eA2B10G10R10UnormPack32:
+			case vk::Format::eA2B10G10R10SnormPack32:
+			case vk::Format::eA2B10G10R10UscaledPack32:
+			case vk::Format::eA2B10G10R10SscaledPack32:
+			case vk::Format::eA2B10G10R10UintPack32:
+			case vk::Format::eA2B10G10R10SintPack32:
+				return 4;
+			default:
+				return 0;
+			}
+		}
+
+		FormatNumericType get_format_numeric_type(vk::Format format)
+		{
+			switch (format)
+			{
+			case vk::Format::eR8Unorm:
+			case vk::Format::eR8Snorm:
+			case vk::Format::eR8Uscaled:
+			case vk::Format::eR8Sscaled:
+			case vk::Format::eR8Srgb:
+			case vk::Format::eR8G8Unorm:
+			case vk::Format::eR8G8Snorm:
+			case vk::Format::eR8G8Uscaled:
+			case vk::Format::eR8G8Sscaled:
+			case vk::Format::eR8G8Srgb:
+			case vk::Format::eR8G8B8Unorm:
+			case vk::Format::eR8G8B8Snorm:
+			case vk::Format::eR8G8B8Uscaled:
+			case vk::Format::eR8G8B8Sscaled:
+			case vk::Format::eR8G8B8Srgb:
+			case vk::Format::eB8G8R8Unorm:
+			case vk::Format::eB8G8R8Snorm:
+			case vk::Format::eB8G8R8Uscaled:
+			case vk::Format::eB8G8R8Sscaled:
+			case vk::Format::eB8G8R8Srgb:
+			case vk::Format::eR8G8B8A8Unorm:
+			case vk::Format::eR8G8B8A8Snorm:
+			case vk::Format::eR8G8B8A8Uscaled:
+			case vk::Format::eR8G8B8A8Sscaled:
+			case vk::Format::eR8G8B8A8Srgb:
+			case vk::Format::eB8G8R8A8Unorm:
+			case vk::Format::eB8G8R8A8Snorm:
+			case vk::Format::eB8G8R8A8Uscaled:
+			case vk::Format::eB8G8R8A8Sscaled:
+			case vk::Format::eB8G8R8A8Srgb:
+			case vk::Format::eR16Unorm:
+			case vk::Format::eR16Snorm:
+			case vk::Format::eR16Uscaled:
+			case vk::Format::eR16Sscaled:
+			case vk::Format::eR16Sfloat:
+			case vk::Format::eR16G16Unorm:
+			case vk::Format::eR16G16Snorm:
+			case vk::Format::eR16G16Uscaled:
+			case vk::Format::eR16G16Sscaled:
+			case vk::Format::eR16G16Sfloat:
+			case vk::Format::eR16G16B16Unorm:
+			case vk::Format::eR16G16B16Snorm:
+			case vk::Format::eR16G16B16Uscaled:
+			case vk::Format::eR16G16B16Sscaled:
+			case vk::Format::eR16G16B16Sfloat:
+			case vk::Format::eR16G16B16A16Unorm:
+			case vk::Format::eR16G16B16A16Snorm:
+			case vk::Format::eR16G16B16A16Uscaled:
+			case vk::Format::eR16G16B16A16Sscaled:
+			case vk::Format::eR16G16B16A16Sfloat:
+			case vk::Format::eR32Sfloat:
+			case vk::Format::eR32G32Sfloat:
+			case vk::Format::eR32G32B32Sfloat:
+			case vk::Format::eR32G32B32A32Sfloat:
+			case vk::Format::eA2R10G10B10UnormPack32:
+			case vk::Format::eA2R10G10B10SnormPack32:
+			case vk::Format::eA2R10G10B10UscaledPack32:
+			case vk::Format::eA2R10G10B10SscaledPack32:
+			case vk::Format::eA2B10G10R10UnormPack32:
+			case vk::Format::eA2B10G10R10SnormPack32:
+			case vk::Format::eA2B10G10R10UscaledPack32:
+			case vk::Format::eA2B10G10R10SscaledPack32:
+			case vk::Format::eB10G11R11UfloatPack32:
+				return FormatNumericType::FLOAT;
+			case vk::Format::eR8Sint:
+			case vk::Format::eR8G8Sint:
+			case vk::Format::eR8G8B8Sint:
+			case vk::Format::eB8G8R8Sint:
+			case vk::Format::eR8G8B8A8Sint:
+			case vk::Format::eB8G8R8A8Sint:
+			case vk::Format::eR16Sint:
+			case vk::Format::eR16G16Sint:
+			case vk::Format::eR16G16B16Sint:
+			case vk::Format::eR16G16B16A16Sint:
+			case vk::Format::eR32Sint:
+			case vk::Format::eR32G32Sint:
+			case vk::Format::eR32G32B32Sint:
+			case vk::Format::eR32G32B32A32Sint:
+			case vk::Format::eA2R10G10B10SintPack32:
+			case vk::Format::eA2B10G10R10SintPack32:
+				return FormatNumericType::SINT;
+			case vk::Format::eR8Uint:
+			case vk::Format::eR8G8Uint:
+			case vk::Format::eR8G8B8Uint:
+			case vk::Format::eB8G8R8Uint:
+			case vk::Format::eR8G8B8A8Uint:
+			case vk::Format::eB8G8R8A8Uint:
+			case vk::Format::eR16Uint:
+			case vk::Format::eR16G16Uint:
+			case vk::Format::eR16G16B16Uint:
+			case vk::Format::eR16G16B16A16Uint:
+			case vk::Format::eR32Uint:
+			case vk::Format::eR32G32Uint:
+			case vk::Format::eR32G32B32Uint:
+			case vk::Format::eR32G32B32A32Uint:
+			case vk::Format::eA2R10G10B10UintPack32:
+			case vk::Format::eA2B10G10R10UintPack32:
+				return FormatNumericType::UINT;
+			default:
+				return FormatNumericType::UNKNOWN;
+			}
+		}
+
 		vk::SampleCountFlagBits sample_count_to_flags(uint32_t count)
 		{
 			switch (count)
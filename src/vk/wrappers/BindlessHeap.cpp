@@ -0,0 +1,243 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "BindlessHeap.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		uint32_t BindlessHeap::IndexAllocator::allocate()
+		{
+			if (!free_indices.empty())
+			{
+				uint32_t index = free_indices.back();
+				free_indices.pop_back();
+				live[index] = true;
+
+				return index;
+			}
+
+			if (next_index >= capacity)
+			{
+				throw std::runtime_error("The bindless heap is full: consider constructing it with a larger capacity");
+			}
+
+			live.push_back(true);
+
+			return next_index++;
+		}
+
+		void BindlessHeap::IndexAllocator::retire(uint32_t index, uint64_t frame)
+		{
+			if (index >= next_index)
+			{
+				throw std::runtime_error("Attempting to remove an index that was never allocated from the bindless heap");
+			}
+
+			// Retiring an index twice would put it on the free-list twice, and two later allocations would share a slot.
+			if (!live[index])
+			{
+				throw std::runtime_error("Attempting to remove an index that was already removed from the bindless heap");
+			}
+
+			live[index] = false;
+			retired_indices.push_back({ index, frame });
+		}
+
+		void BindlessHeap::IndexAllocator::recycle(uint64_t current_frame, uint64_t frames_in_flight)
+		{
+			auto it = std::remove_if(retired_indices.begin(), retired_indices.end(), [&](const std::pair<uint32_t, uint64_t>& retired) {
+				if (current_frame - retired.second >= frames_in_flight)
+				{
+					free_indices.push_back(retired.first);
+					return true;
+				}
+				return false;
+			});
+
+			retired_indices.erase(it, retired_indices.end());
+		}
+
+		BindlessHeap::BindlessHeap(const Device& device, uint32_t max_images, uint32_t max_buffers, uint32_t frames_in_flight) :
+
+			m_device_ptr(&device),
+			m_frames_in_flight(std::max(frames_in_flight, 1u)),
+			m_current_frame(0)
+		{
+#if defined(VK_EXT_descriptor_indexing)
+			if (!m_device_ptr->is_device_extension_enabled(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+			{
+				throw std::runtime_error("A BindlessHeap requires the VK_EXT_descriptor_indexing device extension to be enabled");
+			}
+
+			// The device only enables the descriptor indexing features that the physical device reports.
+			const auto& features = m_device_ptr->get_descriptor_indexing_features();
+			const std::vector<std::pair<bool, const char*>> required_features =
+			{
+				{ features.shader_sampled_image_array_non_uniform_indexing, "shaderSampledImageArrayNonUniformIndexing" },
+				{ features.shader_storage_buffer_array_non_uniform_indexing, "shaderStorageBufferArrayNonUniformIndexing" },
+				{ features.sampled_image_update_after_bind, "descriptorBindingSampledImageUpdateAfterBind" },
+				{ features.storage_buffer_update_after_bind, "descriptorBindingStorageBufferUpdateAfterBind" },
+				{ features.update_unused_while_pending, "descriptorBindingUpdateUnusedWhilePending" },
+				{ features.partially_bound, "descriptorBindingPartiallyBound" },
+				{ features.runtime_descriptor_array, "runtimeDescriptorArray" }
+			};
+			for (const auto& required_feature : required_features)
+			{
+				if (!required_feature.first)
+				{
+					throw std::runtime_error(std::string("A BindlessHeap requires the VK_EXT_descriptor_indexing feature `") + required_feature.second + 
+											 "`, which is not supported by this device (or the device was created without its instance)");
+				}
+			}
+
+			m_image_indices.capacity = std::max(max_images, 1u);
+			m_buffer_indices.capacity = std::max(max_buffers, 1u);
+
+			std::vector<vk::DescriptorSetLayoutBinding> bindings(2);
+			bindings[0].binding = image_binding;
+			bindings[0].descriptorCount = m_image_indices.capacity;
+			bindings[0].descriptorType = vk::DescriptorType::eCombinedImageSampler;
+			bindings[0].stageFlags = vk::ShaderStageFlagBits::eAll;
+
+			bindings[1].binding = buffer_binding;
+			bindings[1].descriptorCount = m_buffer_indices.capacity;
+			bindings[1].descriptorType = vk::DescriptorType::eStorageBuffer;
+			bindings[1].stageFlags = vk::ShaderStageFlagBits::eAll;
+
+			// Every element of both arrays may be updated while the set is bound, and elements that are never accessed
+			// dynamically by a shader don't need to contain valid descriptors.
+			const std::vector<VkDescriptorBindingFlagsEXT> binding_flags(2, VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+																			VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT |
+																			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT);
+
+			VkDescriptorSetLayoutBindingFlagsCreateInfoEXT binding_flags_create_info = {};
+			binding_flags_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+			binding_flags_create_info.bindingCount = static_cast<uint32_t>(binding_flags.size());
+			binding_flags_create_info.pBindingFlags = binding_flags.data();
+
+			vk::DescriptorSetLayoutCreateInfo descriptor_set_layout_create_info;
+			descriptor_set_layout_create_info.bindingCount = static_cast<uint32_t>(bindings.size());
+			descriptor_set_layout_create_info.flags = vk::DescriptorSetLayoutCreateFlags(VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT);
+			descriptor_set_layout_create_info.pBindings = bindings.data();
+			descriptor_set_layout_create_info.pNext = &binding_flags_create_info;
+
+			m_descriptor_set_layout_handle = m_device_ptr->get_handle().createDescriptorSetLayoutUnique(descriptor_set_layout_create_info);
+
+			// The pool only ever holds the heap's single descriptor set.
+			std::vector<vk::DescriptorPoolSize> pool_sizes =
+			{
+				{ vk::DescriptorType::eCombinedImageSampler, m_image_indices.capacity },
+				{ vk::DescriptorType::eStorageBuffer, m_buffer_indices.capacity }
+			};
+
+			vk::DescriptorPoolCreateInfo descriptor_pool_create_info;
+			descriptor_pool_create_info.flags = vk::DescriptorPoolCreateFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT);
+			descriptor_pool_create_info.maxSets = 1;
+			descriptor_pool_create_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+			descriptor_pool_create_info.pPoolSizes = pool_sizes.data();
+
+			m_descriptor_pool_handle = m_device_ptr->get_handle().createDescriptorPoolUnique(descriptor_pool_create_info);
+
+			vk::DescriptorSetLayout descriptor_set_layout = m_descriptor_set_layout_handle.get();
+
+			vk::DescriptorSetAllocateInfo descriptor_set_allocate_info;
+			descriptor_set_allocate_info.descriptorPool = m_descriptor_pool_handle.get();
+			descriptor_set_allocate_info.descriptorSetCount = 1;
+			descriptor_set_allocate_info.pSetLayouts = &descriptor_set_layout;
+
+			m_descriptor_set = m_device_ptr->get_handle().allocateDescriptorSets(descriptor_set_allocate_info)[0];
+#else
+			throw std::runtime_error("A BindlessHeap requires Vulkan headers that define VK_EXT_descriptor_indexing");
+#endif
+		}
+
+		uint32_t BindlessHeap::add_image(const vk::DescriptorImageInfo& image_info)
+		{
+			uint32_t index = m_image_indices.allocate();
+			update_image(index, image_info);
+
+			return index;
+		}
+
+		uint32_t BindlessHeap::add_buffer(const vk::DescriptorBufferInfo& buffer_info)
+		{
+			uint32_t index = m_buffer_indices.allocate();
+			update_buffer(index, buffer_info);
+
+			return index;
+		}
+
+		void BindlessHeap::update_image(uint32_t index, const vk::DescriptorImageInfo& image_info)
+		{
+			if (!m_image_indices.is_live(index))
+			{
+				throw std::runtime_error("Attempting to update an image index that is not currently allocated from the bindless heap");
+			}
+
+			vk::WriteDescriptorSet write_descriptor_set;
+			write_descriptor_set.descriptorCount = 1;
+			write_descriptor_set.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+			write_descriptor_set.dstArrayElement = index;
+			write_descriptor_set.dstBinding = image_binding;
+			write_descriptor_set.dstSet = m_descriptor_set;
+			write_descriptor_set.pImageInfo = &image_info;
+
+			m_device_ptr->get_handle().updateDescriptorSets(write_descriptor_set, {});
+		}
+
+		void BindlessHeap::update_buffer(uint32_t index, const vk::DescriptorBufferInfo& buffer_info)
+		{
+			if (!m_buffer_indices.is_live(index))
+			{
+				throw std::runtime_error("Attempting to update a buffer index that is not currently allocated from the bindless heap");
+			}
+
+			vk::WriteDescriptorSet write_descriptor_set;
+			write_descriptor_set.descriptorCount = 1;
+			write_descriptor_set.descriptorType = vk::DescriptorType::eStorageBuffer;
+			write_descriptor_set.dstArrayElement = index;
+			write_descriptor_set.dstBinding = buffer_binding;
+			write_descriptor_set.dstSet = m_descriptor_set;
+			write_descriptor_set.pBufferInfo = &buffer_info;
+
+			m_device_ptr->get_handle().updateDescriptorSets(write_descriptor_set, {});
+		}
+
+		void BindlessHeap::next_frame()
+		{
+			++m_current_frame;
+
+			m_image_indices.recycle(m_current_frame, m_frames_in_flight);
+			m_buffer_indices.recycle(m_current_frame, m_frames_in_flight);
+		}
+
+	} // namespace graphics
+
+} // namespace plume
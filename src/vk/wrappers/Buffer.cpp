@@ -77,11 +77,80 @@ namespace plume
 			m_device_ptr->get_handle().bindBufferMemory(m_buffer_handle.get(), m_device_memory->get_handle(), 0);
 		}
 
+		void Buffer::write_immediately(const std::function<void(void*)>& func, vk::DeviceSize size, vk::DeviceSize offset)
+		{
+			if (size == VK_WHOLE_SIZE)
+			{
+				size = m_requested_size - offset;
+			}
+
+			if (offset + size > m_requested_size)
+			{
+				throw std::runtime_error("Attempting to write past the end of the buffer");
+			}
+
+			// Map the atom aligned range that contains the requested bytes, so that it can be flushed as-is.
+			vk::MappedMemoryRange mapped_memory_range = build_mapped_memory_range(size, offset);
+
+			uint8_t* mapped_ptr = static_cast<uint8_t*>(m_device_memory->map(mapped_memory_range.offset, mapped_memory_range.size));
+			func(mapped_ptr + (offset - mapped_memory_range.offset));
+
+			// If the device memory associated with this buffer is not host coherent, we need to flush before unmapping.
+			if (!m_device_memory->is_host_coherent())
+			{
+				m_device_ptr->get_handle().flushMappedMemoryRanges(mapped_memory_range);
+			}
+
+			m_device_memory->unmap();
+		}
+
+		void Buffer::read_immediately(const std::function<void(const void*)>& func, vk::DeviceSize size, vk::DeviceSize offset) const
+		{
+			if (size == VK_WHOLE_SIZE)
+			{
+				size = m_requested_size - offset;
+			}
+
+			if (offset + size > m_requested_size)
+			{
+				throw std::runtime_error("Attempting to read past the end of the buffer");
+			}
+
+			vk::MappedMemoryRange mapped_memory_range = build_mapped_memory_range(size, offset);
+
+			const uint8_t* mapped_ptr = static_cast<const uint8_t*>(m_device_memory->map(mapped_memory_range.offset, mapped_memory_range.size));
+
+			// If the device memory associated with this buffer is not host coherent, device writes must be made visible to the host.
+			if (!m_device_memory->is_host_coherent())
+			{
+				m_device_ptr->get_handle().invalidateMappedMemoryRanges(mapped_memory_range);
+			}
+
+			func(mapped_ptr + (offset - mapped_memory_range.offset));
+
+			m_device_memory->unmap();
+		}
+
+		vk::MappedMemoryRange Buffer::build_mapped_memory_range(vk::DeviceSize size, vk::DeviceSize offset) const
+		{
+			// The offset of a flushed or invalidated range must be a multiple of `nonCoherentAtomSize`, and its size must 
+			// either be a multiple of `nonCoherentAtomSize` or end at the end of the memory allocation.
+			const vk::DeviceSize atom_size = std::max<vk::DeviceSize>(m_device_ptr->get_physical_device_limits().nonCoherentAtomSize, 1);
+			const vk::DeviceSize aligned_begin = (offset / atom_size) * atom_size;
+			const vk::DeviceSize aligned_end = ((offset + size + atom_size - 1) / atom_size) * atom_size;
+
+			vk::MappedMemoryRange mapped_memory_range;
+			mapped_memory_range.memory = m_device_memory->get_handle();
+			mapped_memory_range.offset = aligned_begin;
+			mapped_memory_range.size = (aligned_end >= m_device_memory->get_allocation_size()) ? VK_WHOLE_SIZE : aligned_end - aligned_begin;
+
+			return mapped_memory_range;
+		}
+
 		vk::DescriptorBufferInfo Buffer::build_descriptor_info(vk::DeviceSize offset, vk::DeviceSize range) const
 		{
-			if (range != VK_WHOLE_SIZE &&
-				range < 0 ||
-				range <= m_device_memory->get_allocation_size() - offset)
+			if (offset > m_requested_size ||
+				(range != VK_WHOLE_SIZE && offset + range > m_requested_size))
 			{
 				throw std::runtime_error("Invalid value for `range` parameter of `build_descriptor_info()`");
 			}
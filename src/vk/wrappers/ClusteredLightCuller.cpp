@@ -0,0 +1,243 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <algorithm>
+
+#include "ClusteredLightCuller.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		namespace
+		{
+
+			// Must match the bindings and workgroup size in `cluster_lights.comp` (and `pbr_clustered.frag`)
+			const uint32_t binding_id_lights = 0;
+			const uint32_t binding_id_light_grid = 1;
+			const uint32_t binding_id_light_indices = 2;
+			const uint32_t binding_id_light_index_count = 3;
+			const uint32_t binding_id_parameters = 4;
+			const uint32_t workgroup_size = 64;
+
+			vk::DeviceSize align_up(vk::DeviceSize value, vk::DeviceSize alignment)
+			{
+				return (value + alignment - 1) / alignment * alignment;
+			}
+
+		} // anonymous
+
+		void ClusteredLightCuller::DirtyRange::add(size_t first, size_t count)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			if (is_empty())
+			{
+				begin = first;
+				end = first + count;
+			}
+			else
+			{
+				begin = std::min(begin, first);
+				end = std::max(end, first + count);
+			}
+		}
+
+		ClusteredLightCuller::ClusteredLightCuller(const Device& device, 
+												   const std::shared_ptr<ShaderModule>& compute_shader_module, 
+												   uint32_t max_lights, 
+												   uint32_t width, 
+												   uint32_t height, 
+												   uint32_t tile_size, 
+												   uint32_t slice_count, 
+												   uint32_t average_lights_per_cluster, 
+												   uint32_t frames_in_flight) :
+
+			m_device_ptr(&device),
+			m_max_lights(max_lights),
+			m_width(width),
+			m_height(height),
+			m_tile_size(tile_size),
+			m_slice_count(slice_count),
+			m_pipeline(device, compute_shader_module),
+			m_frames(frames_in_flight)
+		{
+			if (max_lights == 0 || width == 0 || height == 0 || tile_size == 0 || slice_count == 0 || average_lights_per_cluster == 0 || frames_in_flight == 0)
+			{
+				throw std::runtime_error("The light count, framebuffer size, tile size, slice count, light budget and frames-in-flight of a clustered light culler must all be non-zero");
+			}
+
+			m_cluster_count = ((width + tile_size - 1) / tile_size) * ((height + tile_size - 1) / tile_size) * slice_count;
+			m_light_index_capacity = m_cluster_count * average_lights_per_cluster;
+
+			// Each frame's regions are bound at an offset, which must respect the device's alignment requirements.
+			const auto& limits = m_device_ptr->get_physical_device_limits();
+			m_light_region_size = align_up(max_lights * sizeof(geom::PointLight), limits.minStorageBufferOffsetAlignment);
+			m_parameters_region_size = align_up(sizeof(geom::ClusteredLightingParameters), limits.minUniformBufferOffsetAlignment);
+
+			m_light_buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eStorageBuffer, frames_in_flight * m_light_region_size);
+			m_light_grid_buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eStorageBuffer, m_cluster_count * sizeof(uint32_t) * 2);
+			m_light_index_buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eStorageBuffer, m_light_index_capacity * sizeof(uint32_t));
+			m_light_index_count_buffer = std::make_unique<Buffer>(*m_device_ptr, 
+																  vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst, 
+																  sizeof(uint32_t));
+			m_parameters_buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eUniformBuffer, frames_in_flight * m_parameters_region_size);
+
+			m_descriptor_allocator = DescriptorAllocator::create(*m_device_ptr, 1, frames_in_flight);
+
+			DescriptorWriter descriptor_writer{ *m_device_ptr };
+			for (uint32_t frame_index = 0; frame_index < frames_in_flight; ++frame_index)
+			{
+				auto& frame = m_frames[frame_index];
+				frame.descriptor_set = m_descriptor_allocator->allocate(m_pipeline.get_descriptor_set_layout(0), m_pipeline.get_descriptor_set_layout_bindings(0));
+
+				descriptor_writer.write_ssbo(frame.descriptor_set, binding_id_light_index_count, *m_light_index_count_buffer);
+				write_lighting_descriptors(descriptor_writer, frame.descriptor_set, frame_index);
+			}
+			descriptor_writer.flush();
+		}
+
+		void ClusteredLightCuller::begin_frame(uint32_t frame_index)
+		{
+			if (frame_index >= get_frames_in_flight())
+			{
+				throw std::runtime_error("The frame index passed to `begin_frame()` is greater than or equal to the number of frames-in-flight");
+			}
+
+			m_current_frame_index = frame_index;
+
+			// Bring this frame's region up-to-date with every light that was set while it was in-flight.
+			auto& frame = m_frames[frame_index];
+			if (!frame.lights.is_empty())
+			{
+				const size_t end = std::min(frame.lights.end, m_lights.size());
+				if (frame.lights.begin < end)
+				{
+					m_light_buffer->upload_immediately(m_lights.data() + frame.lights.begin, 
+													   (end - frame.lights.begin) * sizeof(geom::PointLight), 
+													   get_light_region_offset(frame_index) + frame.lights.begin * sizeof(geom::PointLight));
+				}
+				frame.lights = DirtyRange{};
+			}
+		}
+
+		void ClusteredLightCuller::set_lights(const std::vector<geom::PointLight>& lights)
+		{
+			if (lights.size() > m_max_lights)
+			{
+				throw std::runtime_error("The number of lights passed to `set_lights()` exceeds the capacity of the clustered light culler");
+			}
+
+			m_lights = lights;
+			m_light_count = static_cast<uint32_t>(lights.size());
+			commit_lights(0, m_lights.size());
+		}
+
+		void ClusteredLightCuller::set_light(uint32_t index, const geom::PointLight& light)
+		{
+			if (index >= m_light_count)
+			{
+				throw std::runtime_error("The index passed to `set_light()` is greater than or equal to the number of lights");
+			}
+
+			m_lights[index] = light;
+			commit_lights(index, 1);
+		}
+
+		void ClusteredLightCuller::update(const glm::mat4& view, const glm::mat4& projection, float z_near, float z_far)
+		{
+			const auto parameters = geom::ClusteredLightingParameters::create(view, projection, m_width, m_height, z_near, z_far, m_tile_size, m_slice_count);
+			m_parameters_buffer->upload_immediately(&parameters, sizeof(geom::ClusteredLightingParameters), get_parameters_region_offset(m_current_frame_index));
+		}
+
+		void ClusteredLightCuller::record(CommandBuffer& command_buffer) const
+		{
+			// The light grid and light indices are shared by every frame, so the previous frame's fragment shaders must be 
+			// done with them before they are rewritten below.
+			command_buffer.barrier_graphics_read_compute_write_storage_buffer();
+
+			command_buffer.fill_buffer(*m_light_index_count_buffer, 0);
+			command_buffer.barrier_transfer_write_compute_read_write_storage_buffer();
+
+			// Every cluster writes its entry of the light grid, even when there are no lights.
+			command_buffer.bind_pipeline(m_pipeline);
+			command_buffer.bind_descriptor_sets(m_pipeline, 0, { m_frames[m_current_frame_index].descriptor_set });
+			command_buffer.update_push_constant_ranges(m_pipeline, "light_count", m_light_count);
+			command_buffer.update_push_constant_ranges(m_pipeline, "light_index_capacity", m_light_index_capacity);
+			command_buffer.dispatch((m_cluster_count + workgroup_size - 1) / workgroup_size);
+
+			command_buffer.barrier_compute_write_storage_buffer_graphics_read();
+		}
+
+		void ClusteredLightCuller::write_lighting_descriptors(DescriptorWriter& descriptor_writer, vk::DescriptorSet set, uint32_t frame_index) const
+		{
+			if (frame_index >= get_frames_in_flight())
+			{
+				throw std::runtime_error("The frame index passed to `write_lighting_descriptors()` is greater than or equal to the number of frames-in-flight");
+			}
+
+			descriptor_writer.write_ssbo(set, binding_id_lights, *m_light_buffer, get_light_region_offset(frame_index), m_max_lights * sizeof(geom::PointLight))
+							 .write_ssbo(set, binding_id_light_grid, *m_light_grid_buffer)
+							 .write_ssbo(set, binding_id_light_indices, *m_light_index_buffer)
+							 .write_ubo(set, binding_id_parameters, *m_parameters_buffer, get_parameters_region_offset(frame_index), sizeof(geom::ClusteredLightingParameters));
+		}
+
+		uint32_t ClusteredLightCuller::read_light_index_count() const
+		{
+			uint32_t light_index_count = 0;
+			m_light_index_count_buffer->read_immediately([&](const void* mapped_ptr) { memcpy(&light_index_count, mapped_ptr, sizeof(uint32_t)); }, sizeof(uint32_t));
+
+			return light_index_count;
+		}
+
+		void ClusteredLightCuller::commit_lights(size_t first_light, size_t light_count)
+		{
+			if (light_count == 0)
+			{
+				return;
+			}
+
+			m_light_buffer->upload_immediately(m_lights.data() + first_light, 
+											   light_count * sizeof(geom::PointLight), 
+											   get_light_region_offset(m_current_frame_index) + first_light * sizeof(geom::PointLight));
+
+			for (uint32_t frame_index = 0; frame_index < get_frames_in_flight(); ++frame_index)
+			{
+				if (frame_index != m_current_frame_index)
+				{
+					m_frames[frame_index].lights.add(first_light, light_count);
+				}
+			}
+		}
+
+	} // namespace graphics
+
+} // namespace plume
@@ -25,6 +25,7 @@
 */
 
 #include "CommandBuffer.h"
+#include "DescriptorAllocator.h"
 
 namespace plume
 {
@@ -151,6 +152,96 @@ namespace plume
 											dynamic_offsets.data());
 		}
 
+		void CommandBuffer::push_descriptor_set(const Pipeline& pipeline, uint32_t set, const std::vector<vk::WriteDescriptorSet>& writes)
+		{
+			check_recording_state();
+
+			// The set can only be pushed if the pipeline's layout for it was created with the push descriptor flag. Layouts that
+			// were inferred from reflection never are, so those sets fall back to a transient descriptor set below.
+			if (pipeline.is_push_descriptor_set(set) && m_device_ptr->is_device_extension_enabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+			{
+				if (!m_push_descriptor_set_proc)
+				{
+					m_push_descriptor_set_proc = (PFN_vkCmdPushDescriptorSetKHR)vkGetDeviceProcAddr(m_device_ptr->get_handle(), "vkCmdPushDescriptorSetKHR");
+				}
+
+				if (m_push_descriptor_set_proc)
+				{
+					m_push_descriptor_set_proc(get_handle(),
+											   static_cast<VkPipelineBindPoint>(pipeline.get_pipeline_bind_point()),
+											   pipeline.get_pipeline_layout_handle(),
+											   set,
+											   static_cast<uint32_t>(writes.size()),
+											   reinterpret_cast<const VkWriteDescriptorSet*>(writes.data()));
+					return;
+				}
+			}
+
+			if (!m_push_descriptor_fallback)
+			{
+				throw std::runtime_error("VK_KHR_push_descriptor is not available and no fallback descriptor allocator was set with `set_push_descriptor_fallback()`");
+			}
+
+			// Emulate the push with a transient descriptor set that lives until the allocator's current frame is reused.
+			vk::DescriptorSet descriptor_set = m_push_descriptor_fallback->allocate_transient(pipeline.get_descriptor_set_layout(set), pipeline.get_descriptor_set_layout_bindings(set));
+
+			std::vector<vk::WriteDescriptorSet> patched_writes = writes;
+			for (auto& write : patched_writes)
+			{
+				write.dstSet = descriptor_set;
+			}
+			m_device_ptr->get_handle().updateDescriptorSets(patched_writes, {});
+
+			bind_descriptor_sets(pipeline, set, { descriptor_set });
+		}
+
+		void CommandBuffer::push_descriptor_set(const Pipeline& pipeline, 
+												uint32_t set, 
+												const std::map<uint32_t, vk::DescriptorBufferInfo>& buffer_infos, 
+												const std::map<uint32_t, vk::DescriptorImageInfo>& image_infos)
+		{
+			const auto& bindings = pipeline.get_descriptor_set_layout_bindings(set);
+
+			auto find_descriptor_type = [&](uint32_t binding)
+			{
+				auto it = std::find_if(bindings.begin(), bindings.end(), [&](const vk::DescriptorSetLayoutBinding& layout_binding) {
+					return layout_binding.binding == binding;
+				});
+
+				if (it == bindings.end())
+				{
+					throw std::runtime_error("Attempting to push a descriptor to a binding that is not used by the pipeline");
+				}
+
+				return it->descriptorType;
+			};
+
+			// Note that the info structs are owned by the maps, so the pointers below remain valid until the push is recorded.
+			std::vector<vk::WriteDescriptorSet> writes;
+			for (const auto& mapping : buffer_infos)
+			{
+				vk::WriteDescriptorSet write_descriptor_set;
+				write_descriptor_set.descriptorCount = 1;
+				write_descriptor_set.descriptorType = find_descriptor_type(mapping.first);
+				write_descriptor_set.dstBinding = mapping.first;
+				write_descriptor_set.pBufferInfo = &mapping.second;
+
+				writes.push_back(write_descriptor_set);
+			}
+			for (const auto& mapping : image_infos)
+			{
+				vk::WriteDescriptorSet write_descriptor_set;
+				write_descriptor_set.descriptorCount = 1;
+				write_descriptor_set.descriptorType = find_descriptor_type(mapping.first);
+				write_descriptor_set.dstBinding = mapping.first;
+				write_descriptor_set.pImageInfo = &mapping.second;
+
+				writes.push_back(write_descriptor_set);
+			}
+
+			push_descriptor_set(pipeline, set, writes);
+		}
+
 		void CommandBuffer::draw(const DrawParamsNonIndexed& draw_params)
 		{
 			check_recording_state();
@@ -174,6 +265,82 @@ namespace plume
 									 draw_params.m_first_instance);
 		}
 
+		void CommandBuffer::draw_indexed_indirect(const Buffer& buffer, uint32_t draw_count, vk::DeviceSize offset, uint32_t stride)
+		{
+			check_recording_state();
+			check_render_pass_state();
+
+			if (!(buffer.get_buffer_usage_flags() & vk::BufferUsageFlagBits::eIndirectBuffer))
+			{
+				throw std::runtime_error("The buffer object passed to `draw_indexed_indirect()` was not created with the\
+									      vk::BufferUsageFlagBits::eIndirectBuffer bit set");
+			}
+
+			get_handle().drawIndexedIndirect(buffer.get_handle(), offset, draw_count, stride);
+		}
+
+		void CommandBuffer::draw_indexed_indirect_count(const Buffer& buffer, const Buffer& count_buffer, uint32_t max_draw_count, vk::DeviceSize offset, vk::DeviceSize count_offset, uint32_t stride)
+		{
+			check_recording_state();
+			check_render_pass_state();
+
+			if (!(buffer.get_buffer_usage_flags() & vk::BufferUsageFlagBits::eIndirectBuffer) ||
+				!(count_buffer.get_buffer_usage_flags() & vk::BufferUsageFlagBits::eIndirectBuffer))
+			{
+				throw std::runtime_error("The buffer objects passed to `draw_indexed_indirect_count()` were not created with the\
+									      vk::BufferUsageFlagBits::eIndirectBuffer bit set");
+			}
+
+			if (!m_draw_indexed_indirect_count_proc)
+			{
+				if (m_device_ptr->is_device_extension_enabled("VK_KHR_draw_indirect_count"))
+				{
+					m_draw_indexed_indirect_count_proc = (PFN_vkCmdDrawIndexedIndirectCountAMD)vkGetDeviceProcAddr(m_device_ptr->get_handle(), "vkCmdDrawIndexedIndirectCountKHR");
+				}
+				else if (m_device_ptr->is_device_extension_enabled(VK_AMD_DRAW_INDIRECT_COUNT_EXTENSION_NAME))
+				{
+					m_draw_indexed_indirect_count_proc = (PFN_vkCmdDrawIndexedIndirectCountAMD)vkGetDeviceProcAddr(m_device_ptr->get_handle(), "vkCmdDrawIndexedIndirectCountAMD");
+				}
+			}
+
+			if (!m_draw_indexed_indirect_count_proc)
+			{
+				throw std::runtime_error("Neither VK_KHR_draw_indirect_count nor VK_AMD_draw_indirect_count is available, so `draw_indexed_indirect_count()` cannot be recorded");
+			}
+
+			m_draw_indexed_indirect_count_proc(get_handle(), buffer.get_handle(), offset, count_buffer.get_handle(), count_offset, max_draw_count, stride);
+		}
+
+		bool CommandBuffer::supports_draw_indirect_count() const
+		{
+			return m_device_ptr->is_device_extension_enabled("VK_KHR_draw_indirect_count") || 
+				   m_device_ptr->is_device_extension_enabled(VK_AMD_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+		}
+
+		void CommandBuffer::dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
+		{
+			check_recording_state();
+
+			if (m_is_inside_render_pass)
+			{
+				throw std::runtime_error("Compute dispatches cannot be recorded inside of a render pass");
+			}
+
+			get_handle().dispatch(group_count_x, group_count_y, group_count_z);
+		}
+
+		void CommandBuffer::fill_buffer(const Buffer& buffer, uint32_t data, vk::DeviceSize offset, vk::DeviceSize size)
+		{
+			check_recording_state();
+
+			if (m_is_inside_render_pass)
+			{
+				throw std::runtime_error("Transfer commands cannot be recorded inside of a render pass");
+			}
+
+			get_handle().fillBuffer(buffer.get_handle(), offset, size, data);
+		}
+
 		void CommandBuffer::end_render_pass()
 		{
 			check_recording_state();
@@ -405,6 +572,20 @@ namespace plume
 										 {}, {}, {}, image_memory_barrier);
 		}
 
+		void CommandBuffer::barrier_transfer_write_compute_read_write_storage_buffer()
+		{
+			check_recording_state();
+
+			static vk::MemoryBarrier memory_barrier;
+			memory_barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+			memory_barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+
+			get_handle().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,			// Source stage mask
+										 vk::PipelineStageFlagBits::eComputeShader,		// Destination stage mask
+										 {},											// Dependency flags (can only be vk::DependencyFlagBits::eByRegion)
+										 memory_barrier, {}, {});						// Memory barriers, buffer memory barriers, image memory barriers
+		}
+
 		void CommandBuffer::barrier_compute_write_storage_buffer_compute_read_storage_buffer()
 		{
 			check_recording_state();
@@ -431,6 +612,26 @@ namespace plume
 										 {}, {}, {});									// Memory barriers, buffer memory barriers, image memory barriers
 		}
 
+		void CommandBuffer::barrier_compute_read_storage_image_compute_overwrite_storage_image(const Image& image, const vk::ImageSubresourceRange& image_subresource_range)
+		{
+			check_recording_state();
+
+			vk::ImageMemoryBarrier image_memory_barrier;
+			image_memory_barrier.srcAccessMask = {};
+			image_memory_barrier.dstAccessMask = vk::AccessFlagBits::eShaderWrite;
+			image_memory_barrier.oldLayout = vk::ImageLayout::eUndefined;
+			image_memory_barrier.newLayout = vk::ImageLayout::eGeneral;
+			image_memory_barrier.image = image.get_handle();
+			image_memory_barrier.subresourceRange = image_subresource_range;
+
+			image.m_current_layout = image_memory_barrier.newLayout;
+
+			get_handle().pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,		// Source stage mask
+										 vk::PipelineStageFlagBits::eComputeShader,		// Destination stage mask
+										 {},											// Dependency flags (can only be vk::DependencyFlagBits::eByRegion)
+										 {}, {}, image_memory_barrier);					// Memory barriers, buffer memory barriers, image memory barriers
+		}
+
 		void CommandBuffer::barrier_compute_write_storage_buffer_graphics_read_as_index()
 		{
 			check_recording_state();
@@ -459,6 +660,40 @@ namespace plume
 										 memory_barrier, {}, {});						// Memory barriers, buffer memory barriers, image memory barriers
 		}
 
+		void CommandBuffer::barrier_graphics_read_as_draw_indirect_transfer_write()
+		{
+			check_recording_state();
+
+			get_handle().pipelineBarrier(vk::PipelineStageFlagBits::eDrawIndirect,		// Source stage mask
+										 vk::PipelineStageFlagBits::eTransfer,			// Destination stage mask
+										 {},											// Dependency flags (can only be vk::DependencyFlagBits::eByRegion)
+										 {}, {}, {});									// Memory barriers, buffer memory barriers, image memory barriers
+		}
+
+		void CommandBuffer::barrier_graphics_read_compute_write_storage_buffer(vk::PipelineStageFlags read_stage_flags)
+		{
+			check_recording_state();
+
+			get_handle().pipelineBarrier(read_stage_flags,								// Source stage mask
+										 vk::PipelineStageFlagBits::eComputeShader,		// Destination stage mask
+										 {},											// Dependency flags (can only be vk::DependencyFlagBits::eByRegion)
+										 {}, {}, {});									// Memory barriers, buffer memory barriers, image memory barriers
+		}
+
+		void CommandBuffer::barrier_compute_write_storage_buffer_graphics_read(vk::PipelineStageFlags read_stage_flags)
+		{
+			check_recording_state();
+
+			static vk::MemoryBarrier memory_barrier;
+			memory_barrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+			memory_barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+
+			get_handle().pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,		// Source stage mask
+										 read_stage_flags,								// Destination stage mask
+										 {},											// Dependency flags (can only be vk::DependencyFlagBits::eByRegion)
+										 memory_barrier, {}, {});						// Memory barriers, buffer memory barriers, image memory barriers
+		}
+
 		void CommandBuffer::barrier_compute_write_storage_image_graphics_read(const Image& image,
 			vk::PipelineStageFlags read_stage_flags,
 			const vk::ImageSubresourceRange& image_subresource_range)
@@ -522,6 +757,29 @@ namespace plume
 										 {}, {}, image_memory_barrier);						// Memory barriers, buffer memory barriers, image memory barriers
 		}
 
+		void CommandBuffer::barrier_compute_read_graphics_write_depth_attachment(const Image& image, const vk::ImageSubresourceRange& image_subresource_range)
+		{
+			check_recording_state();
+
+			// Write-after-read hazards only require an execution dependency, but the image still has to be transitioned
+			// back into a layout that can be used as a depth attachment.
+			vk::ImageMemoryBarrier image_memory_barrier;
+			image_memory_barrier.srcAccessMask = {};
+			image_memory_barrier.dstAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+			image_memory_barrier.oldLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+			image_memory_barrier.newLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+			image_memory_barrier.image = image.get_handle();
+			image_memory_barrier.subresourceRange = image_subresource_range;
+
+			image.m_current_layout = image_memory_barrier.newLayout;
+
+			get_handle().pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,				// Source stage mask
+										 vk::PipelineStageFlagBits::eEarlyFragmentTests |
+										 vk::PipelineStageFlagBits::eLateFragmentTests,			// Destination stage mask
+										 {},													// Dependency flags (can only be vk::DependencyFlagBits::eByRegion)
+										 {}, {}, image_memory_barrier);							// Memory barriers, buffer memory barriers, image memory barriers
+		}
+
 		void CommandBuffer::barrier_graphics_write_depth_attachment_graphics_read(const Image& image,
 			vk::PipelineStageFlags read_stage_flags,
 			const vk::ImageSubresourceRange& image_subresource_range)
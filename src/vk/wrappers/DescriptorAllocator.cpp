@@ -0,0 +1,227 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DescriptorAllocator.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		namespace
+		{
+
+			// The upper bound on the number of sets that a single pool in the chain will be created with.
+			const uint32_t max_sets_per_pool = 4096;
+
+		} // anonymous
+
+		DescriptorAllocator::DescriptorAllocator(const Device& device, uint32_t frames_in_flight, uint32_t initial_sets_per_pool) :
+
+			m_device_ptr(&device),
+			m_frame_chains(std::max(frames_in_flight, 1u)),
+			m_current_frame_index(0),
+			m_next_sets_per_pool(std::max(initial_sets_per_pool, 1u)),
+			m_observed_sets(0)
+		{
+		}
+
+		void DescriptorAllocator::begin_frame(uint32_t frame_index)
+		{
+			if (frame_index >= m_frame_chains.size())
+			{
+				throw std::runtime_error("The frame index passed to `begin_frame()` is greater than or equal to the number of frames-in-flight");
+			}
+
+			m_current_frame_index = frame_index;
+			reset_chain(m_frame_chains[m_current_frame_index]);
+		}
+
+		size_t DescriptorAllocator::get_pool_count() const
+		{
+			size_t pool_count = m_persistent_chain.pools.size();
+			for (const auto& chain : m_frame_chains)
+			{
+				pool_count += chain.pools.size();
+			}
+
+			return pool_count;
+		}
+
+		std::map<vk::DescriptorType, uint32_t> DescriptorAllocator::count_descriptors(const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+		{
+			// Note that, unlike `DescriptorSetLayoutBuilder::get_descriptor_type_to_count_mapping()`, arrays of 
+			// descriptors count as `descriptorCount` separate descriptors here, since that is how much space they
+			// occupy in the pool.
+			std::map<vk::DescriptorType, uint32_t> descriptor_counts;
+			for (const auto& binding : bindings)
+			{
+				descriptor_counts[binding.descriptorType] += binding.descriptorCount;
+			}
+
+			return descriptor_counts;
+		}
+
+		bool DescriptorAllocator::can_fit(const PoolInternals& pool, const std::map<vk::DescriptorType, uint32_t>& descriptor_counts)
+		{
+			if (pool.available_sets == 0)
+			{
+				return false;
+			}
+
+			for (const auto& mapping : descriptor_counts)
+			{
+				auto it = pool.available_mapping.find(mapping.first);
+				if (it == pool.available_mapping.end() || it->second < mapping.second)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		vk::DescriptorSet DescriptorAllocator::allocate_from_chain(PoolChain& chain, vk::DescriptorSetLayout layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+		{
+			auto descriptor_counts = count_descriptors(bindings);
+
+			// Record this request, so that future pools are sized according to how the allocator is actually used.
+			m_observed_sets++;
+			for (const auto& mapping : descriptor_counts)
+			{
+				m_observed_descriptors_mapping[mapping.first] += mapping.second;
+			}
+
+			vk::DescriptorSetAllocateInfo descriptor_set_allocate_info;
+			descriptor_set_allocate_info.descriptorSetCount = 1;
+			descriptor_set_allocate_info.pSetLayouts = &layout;
+
+			while (true)
+			{
+				// Every pool in the chain has been exhausted: append a new one.
+				if (chain.current == chain.pools.size())
+				{
+					chain.pools.push_back(create_pool(descriptor_counts));
+				}
+
+				auto& pool = chain.pools[chain.current];
+				if (can_fit(pool, descriptor_counts))
+				{
+					descriptor_set_allocate_info.descriptorPool = pool.handle.get();
+
+					// Use the non-throwing version of this call, since running out of pool memory is expected.
+					vk::DescriptorSet descriptor_set;
+					vk::Result result = m_device_ptr->get_handle().allocateDescriptorSets(&descriptor_set_allocate_info, &descriptor_set);
+
+					if (result == vk::Result::eSuccess)
+					{
+						pool.available_sets--;
+						for (const auto& mapping : descriptor_counts)
+						{
+							pool.available_mapping.at(mapping.first) -= mapping.second;
+						}
+
+						return descriptor_set;
+					}
+					else if (result != vk::Result::eErrorOutOfPoolMemoryKHR &&
+							 result != vk::Result::eErrorFragmentedPool)
+					{
+						throw std::runtime_error("Failed to allocate a descriptor set: " + vk::to_string(result));
+					}
+					else if (pool.available_sets == pool.max_sets)
+					{
+						// The driver rejected an allocation from a pool that was created specifically to hold it.
+						throw std::runtime_error("Failed to allocate a descriptor set from a freshly created descriptor pool");
+					}
+				}
+
+				// This pool is full (or too fragmented): move on to the next one.
+				chain.current++;
+			}
+		}
+
+		DescriptorAllocator::PoolInternals DescriptorAllocator::create_pool(const std::map<vk::DescriptorType, uint32_t>& descriptor_counts)
+		{
+			const uint32_t sets_per_pool = m_next_sets_per_pool;
+			m_next_sets_per_pool = std::min(m_next_sets_per_pool * 2, max_sets_per_pool);
+
+			PoolInternals pool;
+			pool.max_sets = sets_per_pool;
+			pool.available_sets = sets_per_pool;
+
+			// Scale the average number of descriptors (of each type) per set up to the number of sets that this
+			// pool will hold. Make sure that the request that triggered the creation of this pool always fits.
+			for (const auto& mapping : m_observed_descriptors_mapping)
+			{
+				double average_per_set = static_cast<double>(mapping.second) / static_cast<double>(m_observed_sets);
+				uint32_t count = static_cast<uint32_t>(std::ceil(average_per_set * sets_per_pool));
+
+				pool.capacity_mapping[mapping.first] = std::max(count, 1u);
+			}
+			for (const auto& mapping : descriptor_counts)
+			{
+				pool.capacity_mapping[mapping.first] = std::max(pool.capacity_mapping[mapping.first], mapping.second);
+			}
+			pool.available_mapping = pool.capacity_mapping;
+
+			std::vector<vk::DescriptorPoolSize> descriptor_pool_sizes;
+			for (const auto& mapping : pool.capacity_mapping)
+			{
+				descriptor_pool_sizes.push_back({ mapping.first, mapping.second });
+			}
+
+			vk::DescriptorPoolCreateInfo descriptor_pool_create_info;
+			descriptor_pool_create_info.maxSets = sets_per_pool;
+			descriptor_pool_create_info.poolSizeCount = static_cast<uint32_t>(descriptor_pool_sizes.size());
+			descriptor_pool_create_info.pPoolSizes = descriptor_pool_sizes.data();
+
+			pool.handle = m_device_ptr->get_handle().createDescriptorPoolUnique(descriptor_pool_create_info);
+
+			PL_LOG_DEBUG("Creating a new descriptor pool with room for %u sets\n", sets_per_pool);
+
+			return pool;
+		}
+
+		void DescriptorAllocator::reset_chain(PoolChain& chain)
+		{
+			// Only the pools up to (and including) the current pool have been allocated from.
+			for (size_t i = 0; i < chain.pools.size() && i <= chain.current; ++i)
+			{
+				auto& pool = chain.pools[i];
+
+				m_device_ptr->get_handle().resetDescriptorPool(pool.handle.get(), {});
+
+				pool.available_sets = pool.max_sets;
+				pool.available_mapping = pool.capacity_mapping;
+			}
+
+			chain.current = 0;
+		}
+
+	} // namespace graphics
+
+} // namespace plume
@@ -39,6 +39,9 @@ namespace plume
 				throw std::runtime_error("Adding a new binding must be called between `begin_descriptor_set_record()` and `end_descriptor_set_record()`");
 			}
 
+			// Any layout that was previously cached for this set no longer matches its bindings.
+			m_cached_layouts_mapping.erase(m_current_set);
+
 			m_descriptor_sets_mapping[m_current_set].push_back({
 				binding,		// binding (as it appears in the shader code)
 				type,			// descriptor type (i.e. vk::DescriptorType::eUniformBuffer)
@@ -62,6 +65,7 @@ namespace plume
 			{
 				vk::DescriptorSetLayoutCreateInfo descriptor_set_layout_create_info;
 				descriptor_set_layout_create_info.bindingCount = static_cast<uint32_t>(mapping.second.size());
+				descriptor_set_layout_create_info.flags = get_layout_flags_for_set(mapping.first);
 				descriptor_set_layout_create_info.pBindings = mapping.second.data();
 
 				auto layout = m_device_ptr->get_handle().createDescriptorSetLayout(descriptor_set_layout_create_info);
@@ -80,11 +84,38 @@ namespace plume
 
 			vk::DescriptorSetLayoutCreateInfo descriptor_set_layout_create_info;
 			descriptor_set_layout_create_info.bindingCount = static_cast<uint32_t>(m_descriptor_sets_mapping.at(set).size());
+			descriptor_set_layout_create_info.flags = get_layout_flags_for_set(set);
 			descriptor_set_layout_create_info.pBindings = m_descriptor_sets_mapping.at(set).data();
 
 			return m_device_ptr->get_handle().createDescriptorSetLayout(descriptor_set_layout_create_info);
 		}
 
+		vk::DescriptorSetLayout DescriptorSetLayoutBuilder::get_cached_layout_for_set(uint32_t set) const
+		{
+			auto it = m_cached_layouts_mapping.find(set);
+			if (it != m_cached_layouts_mapping.end())
+			{
+				return it->second.get();
+			}
+
+			if (m_is_recording)
+			{
+				throw std::runtime_error("The LayoutBuilder is still in a recording state - call `end_descriptor_set_record()` before `get_cached_layout_for_set()`.");
+			}
+
+			vk::DescriptorSetLayoutCreateInfo descriptor_set_layout_create_info;
+			descriptor_set_layout_create_info.bindingCount = static_cast<uint32_t>(m_descriptor_sets_mapping.at(set).size());
+			descriptor_set_layout_create_info.flags = get_layout_flags_for_set(set);
+			descriptor_set_layout_create_info.pBindings = m_descriptor_sets_mapping.at(set).data();
+
+			auto layout = m_device_ptr->get_handle().createDescriptorSetLayoutUnique(descriptor_set_layout_create_info);
+			vk::DescriptorSetLayout layout_handle = layout.get();
+
+			m_cached_layouts_mapping.insert(std::make_pair(set, std::move(layout)));
+
+			return layout_handle;
+		}
+
 		std::map<vk::DescriptorType, uint32_t> DescriptorSetLayoutBuilder::get_descriptor_type_to_count_mapping() const
 		{
 			std::map<vk::DescriptorType, uint32_t> descriptor_type_to_count_mapping =
@@ -0,0 +1,253 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <algorithm>
+
+#include "DescriptorSetCache.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		namespace
+		{
+
+			inline void hash_combine(size_t& seed, uint64_t value)
+			{
+				seed ^= std::hash<uint64_t>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+			}
+
+		} // anonymous
+
+		DescriptorSetCache::ResourceList& DescriptorSetCache::ResourceList::add_buffer(uint32_t binding, vk::DescriptorType type, const vk::DescriptorBufferInfo& buffer_info, uint32_t array_element)
+		{
+			m_records.push_back({ binding, array_element, type, { handle_to_key(static_cast<VkBuffer>(buffer_info.buffer)), buffer_info.offset, buffer_info.range } });
+			return *this;
+		}
+
+		DescriptorSetCache::ResourceList& DescriptorSetCache::ResourceList::add_image(uint32_t binding, vk::DescriptorType type, const vk::DescriptorImageInfo& image_info, uint32_t array_element)
+		{
+			m_records.push_back({ binding, array_element, type, { handle_to_key(static_cast<VkSampler>(image_info.sampler)), handle_to_key(static_cast<VkImageView>(image_info.imageView)), static_cast<uint64_t>(image_info.imageLayout) } });
+			return *this;
+		}
+
+		DescriptorSetCache::ResourceList& DescriptorSetCache::ResourceList::add_texel_buffer(uint32_t binding, vk::DescriptorType type, vk::BufferView buffer_view, uint32_t array_element)
+		{
+			m_records.push_back({ binding, array_element, type, { handle_to_key(static_cast<VkBufferView>(buffer_view)), 0, 0 } });
+			return *this;
+		}
+
+		DescriptorSetCache::DescriptorSetCache(const Device& device, const std::shared_ptr<DescriptorAllocator>& allocator, uint32_t max_unused_frames, size_t max_entries) :
+
+			m_device_ptr(&device),
+			m_allocator(allocator),
+			m_writer(device),
+			m_max_unused_frames(max_unused_frames),
+			m_max_entries(std::max(max_entries, static_cast<size_t>(1))),
+			m_current_frame(0),
+			m_hit_count(0),
+			m_miss_count(0)
+		{
+			if (!m_allocator)
+			{
+				throw std::runtime_error("A DescriptorSetCache requires a valid DescriptorAllocator");
+			}
+		}
+
+		vk::DescriptorSet DescriptorSetCache::get(vk::DescriptorSetLayout layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const ResourceList& resources)
+		{
+			// Sort the records so that the order in which resources were added doesn't affect the lookup.
+			auto records = resources.m_records;
+			std::sort(records.begin(), records.end(), [](const ResourceList::Record& a, const ResourceList::Record& b) {
+				return (a.binding != b.binding) ? a.binding < b.binding : a.array_element < b.array_element;
+			});
+
+			const size_t hash = compute_hash(layout, records);
+
+			auto range = m_lookup.equal_range(hash);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				auto entry = it->second;
+				if (entry->layout == layout && entry->records == records)
+				{
+					// Move the entry to the front of the LRU list.
+					entry->last_used_frame = m_current_frame;
+					m_entries.splice(m_entries.begin(), m_entries, entry);
+					++m_hit_count;
+
+					return entry->descriptor_set;
+				}
+			}
+
+			++m_miss_count;
+
+			vk::DescriptorSet descriptor_set = acquire_descriptor_set(layout, bindings);
+
+			for (const auto& record : records)
+			{
+				if (is_image_record(record))
+				{
+					m_writer.write_images(descriptor_set, record.binding, record.type, { vk::DescriptorImageInfo{ 
+						key_to_handle<VkSampler>(record.handles[0]), 
+						key_to_handle<VkImageView>(record.handles[1]), 
+						static_cast<vk::ImageLayout>(record.handles[2]) } }, record.array_element);
+				}
+				else if (record.type == vk::DescriptorType::eUniformTexelBuffer || record.type == vk::DescriptorType::eStorageTexelBuffer)
+				{
+					m_writer.write_texel_buffers(descriptor_set, record.binding, record.type, { key_to_handle<VkBufferView>(record.handles[0]) }, record.array_element);
+				}
+				else
+				{
+					m_writer.write_buffers(descriptor_set, record.binding, record.type, { vk::DescriptorBufferInfo{ 
+						key_to_handle<VkBuffer>(record.handles[0]), 
+						record.handles[1], 
+						record.handles[2] } }, record.array_element);
+				}
+			}
+			m_writer.flush();
+
+			m_entries.push_front({ layout, std::move(records), hash, descriptor_set, m_current_frame });
+			m_lookup.insert({ hash, m_entries.begin() });
+
+			if (m_entries.size() > m_max_entries)
+			{
+				evict(std::prev(m_entries.end()));
+			}
+
+			return descriptor_set;
+		}
+
+		void DescriptorSetCache::next_frame()
+		{
+			++m_current_frame;
+
+			// Entries are sorted by recency, so stale entries are always at the back of the list.
+			while (!m_entries.empty() && m_current_frame - m_entries.back().last_used_frame > m_max_unused_frames)
+			{
+				evict(std::prev(m_entries.end()));
+			}
+		}
+
+		void DescriptorSetCache::clear()
+		{
+			while (!m_entries.empty())
+			{
+				evict(m_entries.begin());
+			}
+		}
+
+		bool DescriptorSetCache::is_image_record(const ResourceList::Record& record)
+		{
+			return record.type == vk::DescriptorType::eSampler ||
+				   record.type == vk::DescriptorType::eCombinedImageSampler ||
+				   record.type == vk::DescriptorType::eSampledImage ||
+				   record.type == vk::DescriptorType::eStorageImage ||
+				   record.type == vk::DescriptorType::eInputAttachment;
+		}
+
+		size_t DescriptorSetCache::compute_hash(vk::DescriptorSetLayout layout, const std::vector<ResourceList::Record>& records)
+		{
+			size_t seed = 0;
+			hash_combine(seed, handle_to_key(static_cast<VkDescriptorSetLayout>(layout)));
+
+			for (const auto& record : records)
+			{
+				hash_combine(seed, (static_cast<uint64_t>(record.binding) << 32) | record.array_element);
+				hash_combine(seed, static_cast<uint64_t>(record.type));
+				hash_combine(seed, record.handles[0]);
+				hash_combine(seed, record.handles[1]);
+				hash_combine(seed, record.handles[2]);
+			}
+
+			return seed;
+		}
+
+		vk::DescriptorSet DescriptorSetCache::acquire_descriptor_set(vk::DescriptorSetLayout layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+		{
+			auto retired = m_retired_sets_mapping.find(handle_to_key(static_cast<VkDescriptorSetLayout>(layout)));
+
+			if (retired != m_retired_sets_mapping.end())
+			{
+				// A retired set can only be rewritten once every frame that might have referenced it has completed.
+				const uint64_t frames_in_flight = m_allocator->get_frames_in_flight();
+
+				auto& retired_sets = retired->second;
+				auto it = std::find_if(retired_sets.begin(), retired_sets.end(), [&](const RetiredSet& retired_set) {
+					return m_current_frame - retired_set.last_used_frame >= frames_in_flight;
+				});
+
+				if (it != retired_sets.end())
+				{
+					vk::DescriptorSet descriptor_set = it->descriptor_set;
+					retired_sets.erase(it);
+
+					return descriptor_set;
+				}
+			}
+
+			return m_allocator->allocate(layout, bindings);
+		}
+
+		void DescriptorSetCache::evict(std::list<Entry>::iterator it)
+		{
+			auto range = m_lookup.equal_range(it->hash);
+			for (auto lookup = range.first; lookup != range.second; ++lookup)
+			{
+				if (lookup->second == it)
+				{
+					m_lookup.erase(lookup);
+					break;
+				}
+			}
+
+			m_retired_sets_mapping[handle_to_key(static_cast<VkDescriptorSetLayout>(it->layout))].push_back({ it->descriptor_set, it->last_used_frame });
+			m_entries.erase(it);
+		}
+
+		void DescriptorSetCache::invalidate_handle(uint64_t handle)
+		{
+			for (auto it = m_entries.begin(); it != m_entries.end(); )
+			{
+				auto next = std::next(it);
+
+				bool references_handle = std::any_of(it->records.begin(), it->records.end(), [&](const ResourceList::Record& record) {
+					// Only image records store a second handle (the image view): for buffers, this is an offset.
+					return record.handles[0] == handle || (is_image_record(record) && record.handles[1] == handle);
+				});
+
+				if (references_handle)
+				{
+					evict(it);
+				}
+				it = next;
+			}
+		}
+
+	} // namespace graphics
+
+} // namespace plume
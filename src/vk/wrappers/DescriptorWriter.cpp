@@ -0,0 +1,315 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DescriptorWriter.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		namespace
+		{
+
+			//! Proxy function for creating a descriptor update template object
+			VkResult create_descriptor_update_template(VkDevice device, const VkDescriptorUpdateTemplateCreateInfoKHR* create_info, const VkAllocationCallbacks* allocator, VkDescriptorUpdateTemplateKHR* descriptor_update_template)
+			{
+				auto func = (PFN_vkCreateDescriptorUpdateTemplateKHR)vkGetDeviceProcAddr(device, "vkCreateDescriptorUpdateTemplateKHR");
+
+				if (func != nullptr)
+				{
+					return func(device, create_info, allocator, descriptor_update_template);
+				}
+				else
+				{
+					return VK_ERROR_EXTENSION_NOT_PRESENT;
+				}
+			}
+
+			//! Proxy function for destroying a descriptor update template object
+			void destroy_descriptor_update_template(VkDevice device, VkDescriptorUpdateTemplateKHR descriptor_update_template, const VkAllocationCallbacks* allocator)
+			{
+				auto func = (PFN_vkDestroyDescriptorUpdateTemplateKHR)vkGetDeviceProcAddr(device, "vkDestroyDescriptorUpdateTemplateKHR");
+
+				if (func != nullptr)
+				{
+					func(device, descriptor_update_template, allocator);
+				}
+			}
+
+		} // anonymous
+
+		bool DescriptorWriter::is_buffer_type(vk::DescriptorType type)
+		{
+			return (type == vk::DescriptorType::eUniformBuffer ||
+				type == vk::DescriptorType::eUniformBufferDynamic ||
+				type == vk::DescriptorType::eStorageBuffer ||
+				type == vk::DescriptorType::eStorageBufferDynamic);
+		}
+
+		bool DescriptorWriter::is_image_type(vk::DescriptorType type)
+		{
+			return (type == vk::DescriptorType::eSampler ||
+				type == vk::DescriptorType::eCombinedImageSampler ||
+				type == vk::DescriptorType::eSampledImage ||
+				type == vk::DescriptorType::eStorageImage ||
+				type == vk::DescriptorType::eInputAttachment);
+		}
+
+		bool DescriptorWriter::is_texel_buffer_type(vk::DescriptorType type)
+		{
+			return (type == vk::DescriptorType::eUniformTexelBuffer ||
+				type == vk::DescriptorType::eStorageTexelBuffer);
+		}
+
+		DescriptorWriter& DescriptorWriter::write_buffers(vk::DescriptorSet set, uint32_t binding, vk::DescriptorType type, const std::vector<vk::DescriptorBufferInfo>& buffer_infos, uint32_t array_element)
+		{
+			if (!is_buffer_type(type))
+			{
+				throw std::runtime_error("The descriptor type passed to `write_buffers()` is not a uniform or storage buffer type");
+			}
+
+			m_writes.push_back({ set, binding, array_element, static_cast<uint32_t>(buffer_infos.size()), type, nullptr, nullptr, nullptr });
+			m_write_info_indices.push_back(m_buffer_infos.size());
+			m_buffer_infos.insert(m_buffer_infos.end(), buffer_infos.begin(), buffer_infos.end());
+
+			return *this;
+		}
+
+		DescriptorWriter& DescriptorWriter::write_images(vk::DescriptorSet set, uint32_t binding, vk::DescriptorType type, const std::vector<vk::DescriptorImageInfo>& image_infos, uint32_t array_element)
+		{
+			if (!is_image_type(type))
+			{
+				throw std::runtime_error("The descriptor type passed to `write_images()` is not a sampler, image, or input attachment type");
+			}
+
+			m_writes.push_back({ set, binding, array_element, static_cast<uint32_t>(image_infos.size()), type, nullptr, nullptr, nullptr });
+			m_write_info_indices.push_back(m_image_infos.size());
+			m_image_infos.insert(m_image_infos.end(), image_infos.begin(), image_infos.end());
+
+			return *this;
+		}
+
+		DescriptorWriter& DescriptorWriter::write_texel_buffers(vk::DescriptorSet set, uint32_t binding, vk::DescriptorType type, const std::vector<vk::BufferView>& buffer_views, uint32_t array_element)
+		{
+			if (!is_texel_buffer_type(type))
+			{
+				throw std::runtime_error("The descriptor type passed to `write_texel_buffers()` is not a texel buffer type");
+			}
+
+			m_writes.push_back({ set, binding, array_element, static_cast<uint32_t>(buffer_views.size()), type, nullptr, nullptr, nullptr });
+			m_write_info_indices.push_back(m_buffer_views.size());
+			m_buffer_views.insert(m_buffer_views.end(), buffer_views.begin(), buffer_views.end());
+
+			return *this;
+		}
+
+		void DescriptorWriter::flush()
+		{
+			if (m_writes.empty())
+			{
+				return;
+			}
+
+			// Now that all of the info containers have stopped growing, point each write at its infos.
+			for (size_t i = 0; i < m_writes.size(); ++i)
+			{
+				auto& write = m_writes[i];
+				size_t info_index = m_write_info_indices[i];
+
+				if (is_buffer_type(write.descriptorType))
+				{
+					write.pBufferInfo = &m_buffer_infos[info_index];
+				}
+				else if (is_image_type(write.descriptorType))
+				{
+					write.pImageInfo = &m_image_infos[info_index];
+				}
+				else
+				{
+					write.pTexelBufferView = &m_buffer_views[info_index];
+				}
+			}
+
+			m_device_ptr->get_handle().updateDescriptorSets(m_writes, {});
+
+			clear();
+		}
+
+		std::shared_ptr<DescriptorUpdateTemplate> DescriptorUpdateTemplate::create(const Device& device,
+																				   vk::DescriptorSetLayout layout,
+																				   uint32_t set,
+																				   const std::vector<std::shared_ptr<ShaderModule>>& modules)
+		{
+			// Gather the bindings of the requested set, merging descriptors that are shared between shader stages.
+			std::vector<vk::DescriptorSetLayoutBinding> bindings;
+			for (const auto& module : modules)
+			{
+				for (const auto& descriptor : module->get_descriptors())
+				{
+					if (descriptor.layout_set != set)
+					{
+						continue;
+					}
+
+					auto predicate = [&](const vk::DescriptorSetLayoutBinding& binding) { return binding.binding == descriptor.layout_binding.binding; };
+					if (std::find_if(bindings.begin(), bindings.end(), predicate) == bindings.end())
+					{
+						bindings.push_back(descriptor.layout_binding);
+					}
+				}
+			}
+
+			return std::shared_ptr<DescriptorUpdateTemplate>(new DescriptorUpdateTemplate(device, layout, bindings));
+		}
+
+		DescriptorUpdateTemplate::DescriptorUpdateTemplate(const Device& device, vk::DescriptorSetLayout layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings) :
+
+			m_device_ptr(&device),
+			m_descriptor_update_template_handle(VK_NULL_HANDLE),
+			m_update_func(nullptr),
+			m_data_size(0)
+		{
+			// Lay out the entries in order of increasing binding index, so that the packed data matches the 
+			// order in which the descriptors appear in the shader.
+			auto sorted_bindings = bindings;
+			std::sort(sorted_bindings.begin(), sorted_bindings.end(), [](const auto& a, const auto& b) { return a.binding < b.binding; });
+
+			for (const auto& binding : sorted_bindings)
+			{
+				size_t stride = 0;
+				if (DescriptorWriter::is_buffer_type(binding.descriptorType))
+				{
+					stride = sizeof(vk::DescriptorBufferInfo);
+				}
+				else if (DescriptorWriter::is_image_type(binding.descriptorType))
+				{
+					stride = sizeof(vk::DescriptorImageInfo);
+				}
+				else
+				{
+					stride = sizeof(vk::BufferView);
+				}
+
+				VkDescriptorUpdateTemplateEntryKHR entry = {};
+				entry.dstBinding = binding.binding;
+				entry.dstArrayElement = 0;
+				entry.descriptorCount = binding.descriptorCount;
+				entry.descriptorType = static_cast<VkDescriptorType>(binding.descriptorType);
+				entry.offset = m_data_size;
+				entry.stride = stride;
+
+				m_entries.push_back(entry);
+				m_data_size += stride * binding.descriptorCount;
+			}
+
+			// Only create a native template object if the extension is available: otherwise, `update()` will
+			// translate the packed data into regular descriptor writes.
+			if (m_device_ptr->is_device_extension_enabled(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME))
+			{
+				VkDescriptorUpdateTemplateCreateInfoKHR descriptor_update_template_create_info = {};
+				descriptor_update_template_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+				descriptor_update_template_create_info.descriptorUpdateEntryCount = static_cast<uint32_t>(m_entries.size());
+				descriptor_update_template_create_info.pDescriptorUpdateEntries = m_entries.data();
+				descriptor_update_template_create_info.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+				descriptor_update_template_create_info.descriptorSetLayout = static_cast<VkDescriptorSetLayout>(layout);
+
+				VkDevice device_handle = static_cast<VkDevice>(m_device_ptr->get_handle());
+				if (create_descriptor_update_template(device_handle, &descriptor_update_template_create_info, nullptr, &m_descriptor_update_template_handle) == VK_SUCCESS)
+				{
+					// Look up the update entry point once, since `update()` is likely to be called very frequently.
+					m_update_func = (PFN_vkUpdateDescriptorSetWithTemplateKHR)vkGetDeviceProcAddr(device_handle, "vkUpdateDescriptorSetWithTemplateKHR");
+				}
+				else
+				{
+					m_descriptor_update_template_handle = VK_NULL_HANDLE;
+				}
+			}
+		}
+
+		DescriptorUpdateTemplate::~DescriptorUpdateTemplate()
+		{
+			if (is_native())
+			{
+				destroy_descriptor_update_template(static_cast<VkDevice>(m_device_ptr->get_handle()), m_descriptor_update_template_handle, nullptr);
+			}
+		}
+
+		size_t DescriptorUpdateTemplate::get_binding_offset(uint32_t binding) const
+		{
+			for (const auto& entry : m_entries)
+			{
+				if (entry.dstBinding == binding)
+				{
+					return entry.offset;
+				}
+			}
+
+			throw std::runtime_error("The binding passed to `get_binding_offset()` is not part of this descriptor update template");
+		}
+
+		void DescriptorUpdateTemplate::update(vk::DescriptorSet set, const void* data) const
+		{
+			if (is_native() && m_update_func)
+			{
+				m_update_func(static_cast<VkDevice>(m_device_ptr->get_handle()), static_cast<VkDescriptorSet>(set), m_descriptor_update_template_handle, data);
+				return;
+			}
+
+			// Fallback: build one write per entry that points directly into the packed data. This works because
+			// each entry's stride is exactly the size of the corresponding info struct.
+			const uint8_t* data_as_bytes = static_cast<const uint8_t*>(data);
+
+			std::vector<vk::WriteDescriptorSet> writes;
+			for (const auto& entry : m_entries)
+			{
+				auto type = static_cast<vk::DescriptorType>(entry.descriptorType);
+				const uint8_t* entry_data = data_as_bytes + entry.offset;
+
+				vk::WriteDescriptorSet write = { set, entry.dstBinding, entry.dstArrayElement, entry.descriptorCount, type, nullptr, nullptr, nullptr };
+				if (DescriptorWriter::is_buffer_type(type))
+				{
+					write.pBufferInfo = reinterpret_cast<const vk::DescriptorBufferInfo*>(entry_data);
+				}
+				else if (DescriptorWriter::is_image_type(type))
+				{
+					write.pImageInfo = reinterpret_cast<const vk::DescriptorImageInfo*>(entry_data);
+				}
+				else
+				{
+					write.pTexelBufferView = reinterpret_cast<const vk::BufferView*>(entry_data);
+				}
+
+				writes.push_back(write);
+			}
+
+			m_device_ptr->get_handle().updateDescriptorSets(writes, {});
+		}
+
+	} // namespace graphics
+
+} // namespace plume
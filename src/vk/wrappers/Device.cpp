@@ -38,7 +38,8 @@ namespace plume
 					   vk::SurfaceKHR surface, 
 					   vk::QueueFlags required_queue_flags, 
 					   bool use_swapchain, 
-					   const std::vector<const char*>& required_device_extensions) :
+					   const std::vector<const char*>& required_device_extensions,
+					   vk::Instance instance) :
 
 			m_required_device_extensions(required_device_extensions)
 		{
@@ -157,6 +158,55 @@ namespace plume
 			// requests should be ignored by the driver. 
 			// See: https://www.khronos.org/registry/vulkan/specs/1.0/html/vkspec.html#extended-functionality-device-layer-deprecation
 			vk::DeviceCreateInfo device_create_info;
+
+#if defined(VK_EXT_descriptor_indexing)
+			// If descriptor indexing was requested, enable the subset of its features that is required for "bindless"
+			// resource arrays (see BindlessHeap), but only the ones that the physical device actually reports: enabling
+			// an unsupported feature would cause device creation to fail. Note that VK_EXT_descriptor_indexing depends 
+			// on VK_KHR_maintenance3 and the VK_KHR_get_physical_device_properties2 instance extension.
+			VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptor_indexing_features = {};
+			descriptor_indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+			if (is_device_extension_enabled(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+			{
+				if (!is_device_extension_enabled(VK_KHR_MAINTENANCE3_EXTENSION_NAME))
+				{
+					m_required_device_extensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+				}
+
+				VkPhysicalDeviceDescriptorIndexingFeaturesEXT supported_features = {};
+				supported_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+				auto get_features_proc = instance ? (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR") : nullptr;
+				if (get_features_proc)
+				{
+					VkPhysicalDeviceFeatures2KHR features = {};
+					features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+					features.pNext = &supported_features;
+
+					get_features_proc(physical_device, &features);
+				}
+
+				descriptor_indexing_features.shaderSampledImageArrayNonUniformIndexing = supported_features.shaderSampledImageArrayNonUniformIndexing;
+				descriptor_indexing_features.shaderStorageBufferArrayNonUniformIndexing = supported_features.shaderStorageBufferArrayNonUniformIndexing;
+				descriptor_indexing_features.descriptorBindingSampledImageUpdateAfterBind = supported_features.descriptorBindingSampledImageUpdateAfterBind;
+				descriptor_indexing_features.descriptorBindingStorageBufferUpdateAfterBind = supported_features.descriptorBindingStorageBufferUpdateAfterBind;
+				descriptor_indexing_features.descriptorBindingUpdateUnusedWhilePending = supported_features.descriptorBindingUpdateUnusedWhilePending;
+				descriptor_indexing_features.descriptorBindingPartiallyBound = supported_features.descriptorBindingPartiallyBound;
+				descriptor_indexing_features.runtimeDescriptorArray = supported_features.runtimeDescriptorArray;
+
+				m_descriptor_indexing_features.shader_sampled_image_array_non_uniform_indexing = descriptor_indexing_features.shaderSampledImageArrayNonUniformIndexing == VK_TRUE;
+				m_descriptor_indexing_features.shader_storage_buffer_array_non_uniform_indexing = descriptor_indexing_features.shaderStorageBufferArrayNonUniformIndexing == VK_TRUE;
+				m_descriptor_indexing_features.sampled_image_update_after_bind = descriptor_indexing_features.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE;
+				m_descriptor_indexing_features.storage_buffer_update_after_bind = descriptor_indexing_features.descriptorBindingStorageBufferUpdateAfterBind == VK_TRUE;
+				m_descriptor_indexing_features.update_unused_while_pending = descriptor_indexing_features.descriptorBindingUpdateUnusedWhilePending == VK_TRUE;
+				m_descriptor_indexing_features.partially_bound = descriptor_indexing_features.descriptorBindingPartiallyBound == VK_TRUE;
+				m_descriptor_indexing_features.runtime_descriptor_array = descriptor_indexing_features.runtimeDescriptorArray == VK_TRUE;
+
+				device_create_info.pNext = &descriptor_indexing_features;
+			}
+#endif
+
 			device_create_info.enabledExtensionCount = static_cast<uint32_t>(m_required_device_extensions.size());
 			device_create_info.pEnabledFeatures = &m_gpu_details.m_features;
 			device_create_info.ppEnabledExtensionNames = m_required_device_extensions.data();
@@ -226,6 +276,20 @@ namespace plume
 			throw std::runtime_error("Could not find a matching queue family");
 		}
 
+		bool Device::is_device_extension_supported(const std::string& name) const
+		{
+			auto predicate = [&](const vk::ExtensionProperties& extension_properties) { return name == extension_properties.extensionName; };
+
+			return std::find_if(m_gpu_details.m_extension_properties.begin(), m_gpu_details.m_extension_properties.end(), predicate) != m_gpu_details.m_extension_properties.end();
+		}
+
+		bool Device::is_device_extension_enabled(const std::string& name) const
+		{
+			auto predicate = [&](const char* extension_name) { return name == extension_name; };
+
+			return std::find_if(m_required_device_extensions.begin(), m_required_device_extensions.end(), predicate) != m_required_device_extensions.end();
+		}
+
 		Device::SwapchainSupportDetails Device::get_swapchain_support_details(vk::SurfaceKHR surface) const
 		{
 			SwapchainSupportDetails support_details;
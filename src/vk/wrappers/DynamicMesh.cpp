@@ -0,0 +1,286 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DynamicMesh.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		void DynamicMesh::DirtyRange::add(size_t first, size_t count)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			// Ranges are merged conservatively: anything between two separate writes is re-uploaded as well, which keeps
+			// the bookkeeping to a single copy per frame.
+			if (is_empty())
+			{
+				begin = first;
+				end = first + count;
+			}
+			else
+			{
+				begin = std::min(begin, first);
+				end = std::max(end, first + count);
+			}
+		}
+
+		DynamicMesh::DynamicMesh(const Device& device, uint32_t vertex_stride, uint32_t frames_in_flight, size_t vertex_capacity, size_t index_capacity) :
+			m_device_ptr(&device),
+			m_vertex_stride(vertex_stride),
+			m_vertex_capacity(std::max(vertex_capacity, size_t{ 1 })),
+			m_index_capacity(std::max(index_capacity, size_t{ 1 })),
+			m_frames(frames_in_flight)
+		{
+			if (frames_in_flight == 0 || vertex_stride == 0)
+			{
+				throw std::runtime_error("A dynamic mesh requires at least one frame-in-flight and a non-zero vertex stride");
+			}
+
+			m_vertex_buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eVertexBuffer, frames_in_flight * m_vertex_capacity * m_vertex_stride);
+			m_index_buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eIndexBuffer, frames_in_flight * m_index_capacity * sizeof(uint32_t));
+		}
+
+		void DynamicMesh::begin_frame(uint32_t frame_index)
+		{
+			if (frame_index >= get_frames_in_flight())
+			{
+				throw std::runtime_error("The frame index passed to `begin_frame()` is greater than or equal to the number of frames-in-flight");
+			}
+
+			m_current_frame_index = frame_index;
+
+			// A retired buffer may only be referenced by frames that were recorded before it was replaced, so it is safe to 
+			// destroy once every frame-in-flight has begun again.
+			for (auto& retired : m_retired_buffers)
+			{
+				--retired.frames_remaining;
+			}
+			m_retired_buffers.erase(std::remove_if(m_retired_buffers.begin(), m_retired_buffers.end(), [](const RetiredBuffer& retired) { return retired.frames_remaining == 0; }), m_retired_buffers.end());
+
+			// Bring this frame's region up-to-date with every write that happened while it was in-flight.
+			auto& frame = m_frames[frame_index];
+			if (!frame.vertices.is_empty())
+			{
+				const size_t end = std::min(frame.vertices.end, m_vertex_count);
+				if (frame.vertices.begin < end)
+				{
+					const size_t size = (end - frame.vertices.begin) * m_vertex_stride;
+					m_vertex_buffer->upload_immediately(m_vertices.data() + frame.vertices.begin * m_vertex_stride, size, get_vertex_region_offset(frame_index) + frame.vertices.begin * m_vertex_stride);
+				}
+				frame.vertices = DirtyRange{};
+			}
+			if (!frame.indices.is_empty())
+			{
+				const size_t end = std::min(frame.indices.end, m_index_count);
+				if (frame.indices.begin < end)
+				{
+					const size_t size = (end - frame.indices.begin) * sizeof(uint32_t);
+					m_index_buffer->upload_immediately(m_indices.data() + frame.indices.begin, size, get_index_region_offset(frame_index) + frame.indices.begin * sizeof(uint32_t));
+				}
+				frame.indices = DirtyRange{};
+			}
+		}
+
+		void DynamicMesh::resize(size_t vertex_count, size_t index_count)
+		{
+			if (vertex_count > std::numeric_limits<uint32_t>::max() || index_count > std::numeric_limits<uint32_t>::max())
+			{
+				throw std::runtime_error("A dynamic mesh cannot address more than 2^32 vertices or indices");
+			}
+
+			// The CPU-side copy keeps its allocation when shrinking, so a mesh whose size oscillates never reallocates.
+			m_vertex_count = vertex_count;
+			m_index_count = index_count;
+			if (m_vertices.size() < vertex_count * m_vertex_stride)
+			{
+				m_vertices.resize(vertex_count * m_vertex_stride);
+			}
+			if (m_indices.size() < index_count)
+			{
+				m_indices.resize(index_count);
+			}
+
+			if (vertex_count > m_vertex_capacity)
+			{
+				grow_vertex_buffer(std::max(vertex_count, m_vertex_capacity * 2));
+			}
+			if (index_count > m_index_capacity)
+			{
+				grow_index_buffer(std::max(index_count, m_index_capacity * 2));
+			}
+		}
+
+		void DynamicMesh::write_vertices(const void* vertices, size_t first_vertex, size_t vertex_count)
+		{
+			if (first_vertex + vertex_count > m_vertex_count)
+			{
+				throw std::runtime_error("Attempting to write vertices past the end of the dynamic mesh: call `resize()` first");
+			}
+
+			memcpy(m_vertices.data() + first_vertex * m_vertex_stride, vertices, vertex_count * m_vertex_stride);
+			commit_vertices(first_vertex, vertex_count);
+		}
+
+		void DynamicMesh::write_indices(const uint32_t* indices, size_t first_index, size_t index_count)
+		{
+			if (first_index + index_count > m_index_count)
+			{
+				throw std::runtime_error("Attempting to write indices past the end of the dynamic mesh: call `resize()` first");
+			}
+
+			std::copy(indices, indices + index_count, m_indices.begin() + first_index);
+			commit_indices(first_index, index_count);
+		}
+
+		void DynamicMesh::update(const geom::Geometry& geometry, const geom::VertexEncoding& encoding)
+		{
+			if (geom::Geometry::get_vertex_stride(encoding) != m_vertex_stride)
+			{
+				throw std::runtime_error("The vertex stride of the geometry does not match the vertex stride of the dynamic mesh");
+			}
+
+			const auto& indices = geometry.get_indices();
+			resize(geometry.get_vertex_count(), indices.size());
+
+			// Pack directly into the CPU-side copy, which avoids an intermediate allocation.
+			geometry.pack_vertex_attributes(m_vertices.data(), geom::AttributeMode::MODE_INTERLEAVED, encoding);
+			std::copy(indices.begin(), indices.end(), m_indices.begin());
+
+			commit_vertices(0, m_vertex_count);
+			commit_indices(0, m_index_count);
+		}
+
+		void DynamicMesh::bind(CommandBuffer& command_buffer, uint32_t binding) const
+		{
+			command_buffer.bind_vertex_buffer(*m_vertex_buffer, binding, get_vertex_region_offset(m_current_frame_index));
+			if (m_index_count > 0)
+			{
+				command_buffer.bind_index_buffer(*m_index_buffer, static_cast<uint32_t>(get_index_region_offset(m_current_frame_index)));
+			}
+		}
+
+		void DynamicMesh::draw(CommandBuffer& command_buffer, uint32_t instance_count) const
+		{
+			if (m_index_count > 0)
+			{
+				command_buffer.draw_indexed(CommandBuffer::DrawParamsIndexed{ static_cast<uint32_t>(m_index_count), instance_count });
+			}
+			else if (m_vertex_count > 0)
+			{
+				command_buffer.draw(CommandBuffer::DrawParamsNonIndexed{ static_cast<uint32_t>(m_vertex_count), instance_count });
+			}
+		}
+
+		void DynamicMesh::commit_vertices(size_t first_vertex, size_t vertex_count)
+		{
+			if (vertex_count == 0)
+			{
+				return;
+			}
+
+			m_vertex_buffer->upload_immediately(m_vertices.data() + first_vertex * m_vertex_stride, vertex_count * m_vertex_stride, get_vertex_region_offset(m_current_frame_index) + first_vertex * m_vertex_stride);
+
+			for (uint32_t frame_index = 0; frame_index < get_frames_in_flight(); ++frame_index)
+			{
+				if (frame_index != m_current_frame_index)
+				{
+					m_frames[frame_index].vertices.add(first_vertex, vertex_count);
+				}
+			}
+		}
+
+		void DynamicMesh::commit_indices(size_t first_index, size_t index_count)
+		{
+			if (index_count == 0)
+			{
+				return;
+			}
+
+			m_index_buffer->upload_immediately(m_indices.data() + first_index, index_count * sizeof(uint32_t), get_index_region_offset(m_current_frame_index) + first_index * sizeof(uint32_t));
+
+			for (uint32_t frame_index = 0; frame_index < get_frames_in_flight(); ++frame_index)
+			{
+				if (frame_index != m_current_frame_index)
+				{
+					m_frames[frame_index].indices.add(first_index, index_count);
+				}
+			}
+		}
+
+		void DynamicMesh::grow_vertex_buffer(size_t vertex_capacity)
+		{
+			PL_LOG_DEBUG("Growing dynamic mesh vertex buffer to %zu vertices per frame\n", vertex_capacity);
+
+			// Frames that are still in-flight reference the old buffer, so it is retired rather than destroyed. Only the 
+			// current frame's region is filled right away: every other region is marked dirty and gets filled the next 
+			// time that its frame begins.
+			m_retired_buffers.push_back({ std::move(m_vertex_buffer), get_frames_in_flight() });
+			m_vertex_capacity = vertex_capacity;
+			m_vertex_buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eVertexBuffer, get_frames_in_flight() * m_vertex_capacity * m_vertex_stride);
+
+			if (m_vertex_count > 0)
+			{
+				m_vertex_buffer->upload_immediately(m_vertices.data(), m_vertex_count * m_vertex_stride, get_vertex_region_offset(m_current_frame_index));
+			}
+			for (uint32_t frame_index = 0; frame_index < get_frames_in_flight(); ++frame_index)
+			{
+				if (frame_index != m_current_frame_index)
+				{
+					m_frames[frame_index].vertices.add(0, m_vertex_count);
+				}
+			}
+		}
+
+		void DynamicMesh::grow_index_buffer(size_t index_capacity)
+		{
+			PL_LOG_DEBUG("Growing dynamic mesh index buffer to %zu indices per frame\n", index_capacity);
+
+			m_retired_buffers.push_back({ std::move(m_index_buffer), get_frames_in_flight() });
+			m_index_capacity = index_capacity;
+			m_index_buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eIndexBuffer, get_frames_in_flight() * m_index_capacity * sizeof(uint32_t));
+
+			if (m_index_count > 0)
+			{
+				m_index_buffer->upload_immediately(m_indices.data(), m_index_count * sizeof(uint32_t), get_index_region_offset(m_current_frame_index));
+			}
+			for (uint32_t frame_index = 0; frame_index < get_frames_in_flight(); ++frame_index)
+			{
+				if (frame_index != m_current_frame_index)
+				{
+					m_frames[frame_index].indices.add(0, m_index_count);
+				}
+			}
+		}
+
+	} // namespace graphics
+
+} // namespace plume
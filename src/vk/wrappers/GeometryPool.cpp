@@ -0,0 +1,321 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "GeometryPool.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		size_t GeometryPool::FreeList::allocate(size_t count)
+		{
+			// First-fit: carve the allocation out of the front of the first region that is large enough.
+			for (auto it = regions.begin(); it != regions.end(); ++it)
+			{
+				if (it->second >= count)
+				{
+					const size_t offset = it->first;
+					it->first += count;
+					it->second -= count;
+					if (it->second == 0)
+					{
+						regions.erase(it);
+					}
+					return offset;
+				}
+			}
+
+			const size_t offset = end;
+			end += count;
+			return offset;
+		}
+
+		void GeometryPool::FreeList::release(size_t offset, size_t count)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			auto it = std::lower_bound(regions.begin(), regions.end(), std::make_pair(offset, size_t{ 0 }));
+			it = regions.insert(it, { offset, count });
+
+			// Merge with the following region, then with the preceding region.
+			auto next = std::next(it);
+			if (next != regions.end() && it->first + it->second == next->first)
+			{
+				it->second += next->second;
+				regions.erase(next);
+			}
+			if (it != regions.begin())
+			{
+				auto previous = std::prev(it);
+				if (previous->first + previous->second == it->first)
+				{
+					previous->second += it->second;
+					regions.erase(it);
+					it = previous;
+				}
+			}
+
+			// A region that reaches the end of the used range simply shrinks the used range.
+			if (it->first + it->second == end)
+			{
+				end = it->first;
+				regions.erase(it);
+			}
+		}
+
+		GeometryPool::GeometryPool(const Device& device, size_t vertex_capacity, size_t index_capacity, geom::AttributeMode mode, const geom::VertexEncoding& encoding) :
+
+			m_device_ptr(&device),
+			m_attribute_mode(mode),
+			m_encoding(encoding),
+			m_vertex_capacity(std::max<size_t>(vertex_capacity, 1)),
+			m_index_capacity(std::max<size_t>(index_capacity, 1))
+		{
+			// Each binding returned by the geometry corresponds to one vertex stream (and therefore one buffer) in the pool.
+			for (const auto& binding : geom::Geometry::get_vertex_input_binding_descriptions(0, m_attribute_mode, m_encoding))
+			{
+				m_stream_strides.push_back(binding.stride);
+				m_vertex_buffers.push_back(std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eVertexBuffer, m_vertex_capacity * binding.stride));
+			}
+
+			m_index_buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eIndexBuffer, m_index_capacity * sizeof(uint32_t));
+			m_index_buffer->set_index_type(vk::IndexType::eUint32);
+		}
+
+		GeometryPool::Handle GeometryPool::add(const geom::Geometry& geometry)
+		{
+			const size_t vertex_count = geometry.get_vertex_count();
+			const auto& indices = geometry.get_indices();
+
+			// Reserve space for the new mesh, growing the buffers if the free space at the end isn't large enough.
+			const size_t vertex_offset = m_free_vertices.allocate(vertex_count);
+			const size_t first_index = m_free_indices.allocate(indices.size());
+
+			if (m_free_vertices.end > std::numeric_limits<uint32_t>::max() || m_free_indices.end > std::numeric_limits<uint32_t>::max())
+			{
+				throw std::runtime_error("The geometry pool cannot address more than 2^32 vertices or indices");
+			}
+			if (m_free_vertices.end > m_vertex_capacity)
+			{
+				grow_vertex_buffers(std::max(m_free_vertices.end, m_vertex_capacity * 2));
+			}
+			if (m_free_indices.end > m_index_capacity)
+			{
+				grow_index_buffer(std::max(m_free_indices.end, m_index_capacity * 2));
+			}
+
+			// Pack the vertices once, then copy each stream into its own buffer. Streams are packed one after another, in
+			// the same order as the bindings.
+			if (vertex_count > 0)
+			{
+				std::vector<uint8_t> packed(geometry.get_packed_vertex_attributes_size(m_encoding));
+				geometry.pack_vertex_attributes(packed.data(), m_attribute_mode, m_encoding);
+
+				size_t source_offset = 0;
+				for (size_t stream = 0; stream < m_vertex_buffers.size(); ++stream)
+				{
+					const size_t stream_size = vertex_count * m_stream_strides[stream];
+					m_vertex_buffers[stream]->upload_immediately(packed.data() + source_offset, stream_size, vertex_offset * m_stream_strides[stream]);
+					source_offset += stream_size;
+				}
+			}
+
+			// Indices are local to the mesh: the vertex offset is applied when drawing.
+			if (!indices.empty())
+			{
+				m_index_buffer->upload_immediately(indices.data(), indices.size() * sizeof(uint32_t), first_index * sizeof(uint32_t));
+			}
+
+			Entry entry;
+			entry.range.first_index = static_cast<uint32_t>(first_index);
+			entry.range.index_count = static_cast<uint32_t>(indices.size());
+			entry.range.vertex_offset = static_cast<uint32_t>(vertex_offset);
+			entry.range.vertex_count = static_cast<uint32_t>(vertex_count);
+			entry.range.dequantization = geometry.get_position_dequantization(m_encoding);
+			entry.is_live = true;
+
+			m_used_vertex_count += vertex_count;
+			m_used_index_count += indices.size();
+
+			if (!m_free_handles.empty())
+			{
+				const Handle handle = m_free_handles.back();
+				m_free_handles.pop_back();
+				m_entries[handle] = entry;
+				return handle;
+			}
+
+			m_entries.push_back(entry);
+			return static_cast<Handle>(m_entries.size() - 1);
+		}
+
+		void GeometryPool::free(Handle handle)
+		{
+			const GeometryRange range = get_entry(handle).range;
+
+			m_free_vertices.release(range.vertex_offset, range.vertex_count);
+			m_free_indices.release(range.first_index, range.index_count);
+
+			m_used_vertex_count -= range.vertex_count;
+			m_used_index_count -= range.index_count;
+
+			m_entries[handle].is_live = false;
+			m_free_handles.push_back(handle);
+		}
+
+		void GeometryPool::compact()
+		{
+			std::vector<Handle> live_handles;
+			for (Handle handle = 0; handle < m_entries.size(); ++handle)
+			{
+				if (m_entries[handle].is_live)
+				{
+					live_handles.push_back(handle);
+				}
+			}
+
+			// Slide each mesh's vertices towards the front of the pool, in order of their current offsets, so that no 
+			// mesh ever overwrites another mesh that hasn't been moved yet.
+			std::sort(live_handles.begin(), live_handles.end(), [&](Handle a, Handle b) { return m_entries[a].range.vertex_offset < m_entries[b].range.vertex_offset; });
+
+			std::vector<size_t> vertex_offsets(m_entries.size());
+			size_t cursor = 0;
+			for (Handle handle : live_handles)
+			{
+				vertex_offsets[handle] = cursor;
+				cursor += m_entries[handle].range.vertex_count;
+			}
+
+			for (size_t stream = 0; stream < m_vertex_buffers.size(); ++stream)
+			{
+				const uint32_t stride = m_stream_strides[stream];
+				m_vertex_buffers[stream]->write_immediately([&](void* mapped_ptr)
+				{
+					uint8_t* vertices = static_cast<uint8_t*>(mapped_ptr);
+					for (Handle handle : live_handles)
+					{
+						const GeometryRange& range = m_entries[handle].range;
+						memmove(vertices + vertex_offsets[handle] * stride, vertices + range.vertex_offset * stride, range.vertex_count * stride);
+					}
+				});
+			}
+
+			for (Handle handle : live_handles)
+			{
+				m_entries[handle].range.vertex_offset = static_cast<uint32_t>(vertex_offsets[handle]);
+			}
+
+			// Repeat for the indices, which are local to each mesh and therefore don't need to be rewritten.
+			std::sort(live_handles.begin(), live_handles.end(), [&](Handle a, Handle b) { return m_entries[a].range.first_index < m_entries[b].range.first_index; });
+
+			m_index_buffer->write_immediately([&](void* mapped_ptr)
+			{
+				uint32_t* indices = static_cast<uint32_t*>(mapped_ptr);
+
+				cursor = 0;
+				for (Handle handle : live_handles)
+				{
+					GeometryRange& range = m_entries[handle].range;
+					if (range.first_index != cursor)
+					{
+						memmove(indices + cursor, indices + range.first_index, range.index_count * sizeof(uint32_t));
+						range.first_index = static_cast<uint32_t>(cursor);
+					}
+					cursor += range.index_count;
+				}
+			});
+
+			m_free_vertices = FreeList{};
+			m_free_vertices.end = m_used_vertex_count;
+			m_free_indices = FreeList{};
+			m_free_indices.end = m_used_index_count;
+		}
+
+		void GeometryPool::bind(CommandBuffer& command_buffer, uint32_t first_binding) const
+		{
+			for (size_t stream = 0; stream < m_vertex_buffers.size(); ++stream)
+			{
+				command_buffer.bind_vertex_buffer(*m_vertex_buffers[stream], first_binding + static_cast<uint32_t>(stream));
+			}
+			command_buffer.bind_index_buffer(*m_index_buffer);
+		}
+
+		const GeometryPool::Entry& GeometryPool::get_entry(Handle handle) const
+		{
+			if (handle >= m_entries.size() || !m_entries[handle].is_live)
+			{
+				throw std::runtime_error("Invalid geometry pool handle");
+			}
+
+			return m_entries[handle];
+		}
+
+		void GeometryPool::grow_vertex_buffers(size_t vertex_capacity)
+		{
+			PL_LOG_DEBUG("Growing geometry pool vertex buffers to %zu vertices\n", vertex_capacity);
+
+			for (size_t stream = 0; stream < m_vertex_buffers.size(); ++stream)
+			{
+				auto buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eVertexBuffer, vertex_capacity * m_stream_strides[stream]);
+
+				// The buffers are host visible, so the old contents can be copied directly.
+				const size_t old_size = m_vertex_capacity * m_stream_strides[stream];
+				m_vertex_buffers[stream]->write_immediately([&](void* source_ptr)
+				{
+					buffer->write_immediately([&](void* destination_ptr) { memcpy(destination_ptr, source_ptr, old_size); }, old_size);
+				});
+
+				m_vertex_buffers[stream] = std::move(buffer);
+			}
+
+			m_vertex_capacity = vertex_capacity;
+		}
+
+		void GeometryPool::grow_index_buffer(size_t index_capacity)
+		{
+			PL_LOG_DEBUG("Growing geometry pool index buffer to %zu indices\n", index_capacity);
+
+			auto buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eIndexBuffer, index_capacity * sizeof(uint32_t));
+			buffer->set_index_type(vk::IndexType::eUint32);
+
+			const size_t old_size = m_index_capacity * sizeof(uint32_t);
+			m_index_buffer->write_immediately([&](void* source_ptr)
+			{
+				buffer->write_immediately([&](void* destination_ptr) { memcpy(destination_ptr, source_ptr, old_size); }, old_size);
+			});
+
+			m_index_buffer = std::move(buffer);
+			m_index_capacity = index_capacity;
+		}
+
+	} // namespace graphics
+
+} // namespace plume
@@ -0,0 +1,210 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <algorithm>
+#include <array>
+
+#include "HiZPyramid.h"
+#include "DescriptorWriter.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		namespace
+		{
+
+			// Must match the bindings and workgroup size in `hiz_init.comp`, `hiz_init_ms.comp` and `hiz_downsample.comp`
+			const uint32_t binding_id_source = 0;
+			const uint32_t binding_id_destination = 1;
+			const uint32_t workgroup_size = 8;
+
+			uint32_t get_group_count(uint32_t size)
+			{
+				return (size + workgroup_size - 1) / workgroup_size;
+			}
+
+		} // anonymous
+
+		HiZPyramid::HiZPyramid(const Device& device, 
+							   const Image& depth_image, 
+							   const ImageView& depth_image_view,
+							   const std::shared_ptr<ShaderModule>& init_shader_module,
+							   const std::shared_ptr<ShaderModule>& downsample_shader_module) :
+
+			m_device_ptr(&device),
+			m_depth_image_ptr(&depth_image),
+			m_width(depth_image.get_dimensions().width),
+			m_height(depth_image.get_dimensions().height),
+			m_sample_count(static_cast<VkSampleCountFlags>(depth_image.get_sample_count())),
+			m_has_timestamps(device.get_physical_device_properties().limits.timestampComputeAndGraphics == VK_TRUE),
+			m_init_pipeline(device, init_shader_module),
+			m_downsample_pipeline(device, downsample_shader_module)
+		{
+			if (!(depth_image.get_image_usage_flags() & vk::ImageUsageFlagBits::eSampled))
+			{
+				throw std::runtime_error("The depth image used to build a Hi-Z pyramid must be created with vk::ImageUsageFlagBits::eSampled");
+			}
+
+			// The rg32f storage image format is not part of the set of formats that every device supports.
+			if (!device.get_physical_device_features().shaderStorageImageExtendedFormats)
+			{
+				throw std::runtime_error("Building a Hi-Z pyramid requires the `shaderStorageImageExtendedFormats` device feature");
+			}
+
+			// A full mip chain: the last level is always 1x1.
+			m_level_count = 1;
+			for (uint32_t size = std::max(m_width, m_height); size > 1; size >>= 1)
+			{
+				++m_level_count;
+			}
+
+			m_image = std::make_unique<Image>(*m_device_ptr, 
+											  vk::ImageType::e2D, 
+											  vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+											  vk::Format::eR32G32Sfloat,
+											  vk::Extent3D{ m_width, m_height, 1 }, 
+											  1, 
+											  m_level_count);
+			m_image_view = std::make_unique<ImageView>(*m_device_ptr, *m_image, vk::ImageViewType::e2D, Image::build_multiple_layer_subresource(0, 1, 0, m_level_count));
+			for (uint32_t level = 0; level < m_level_count; ++level)
+			{
+				m_level_image_views.push_back(std::make_unique<ImageView>(*m_device_ptr, *m_image, vk::ImageViewType::e2D, Image::build_multiple_layer_subresource(0, 1, level, 1)));
+			}
+
+			// Texels are read with `texelFetch()`, but the sampler must still allow every level to be accessed.
+			auto sampler_options = Sampler::Options()
+								   .address_modes(vk::SamplerAddressMode::eClampToEdge)
+								   .min_mag_filters(vk::Filter::eNearest)
+								   .mipmap_mode(vk::SamplerMipmapMode::eNearest)
+								   .lod(0.0f, static_cast<float>(m_level_count), 0.0f);
+			m_sampler = std::make_unique<Sampler>(*m_device_ptr, sampler_options);
+
+			// All of the sets are allocated once: level `n` is built from level `n - 1`, so there is one set per level.
+			m_descriptor_allocator = DescriptorAllocator::create(*m_device_ptr, 1, m_level_count);
+			m_init_descriptor_set = m_descriptor_allocator->allocate(m_init_pipeline.get_descriptor_set_layout(0), m_init_pipeline.get_descriptor_set_layout_bindings(0));
+
+			auto build_storage_image_info = [](const ImageView& image_view)
+			{
+				return vk::DescriptorImageInfo{ {}, image_view.get_handle(), vk::ImageLayout::eGeneral };
+			};
+
+			DescriptorWriter descriptor_writer{ *m_device_ptr };
+			descriptor_writer.write_cis(m_init_descriptor_set, binding_id_source, depth_image_view, *m_sampler)
+							 .write_images(m_init_descriptor_set, binding_id_destination, vk::DescriptorType::eStorageImage, { build_storage_image_info(*m_level_image_views[0]) });
+
+			for (uint32_t level = 1; level < m_level_count; ++level)
+			{
+				auto descriptor_set = m_descriptor_allocator->allocate(m_downsample_pipeline.get_descriptor_set_layout(0), m_downsample_pipeline.get_descriptor_set_layout_bindings(0));
+				descriptor_writer.write_images(descriptor_set, binding_id_source, vk::DescriptorType::eStorageImage, { build_storage_image_info(*m_level_image_views[level - 1]) })
+								 .write_images(descriptor_set, binding_id_destination, vk::DescriptorType::eStorageImage, { build_storage_image_info(*m_level_image_views[level]) });
+
+				m_downsample_descriptor_sets.push_back(descriptor_set);
+			}
+			descriptor_writer.flush();
+
+			// Two timestamps bracket the build: one before the depth barrier and one after the last dispatch.
+			if (m_has_timestamps)
+			{
+				vk::QueryPoolCreateInfo query_pool_create_info;
+				query_pool_create_info.queryType = vk::QueryType::eTimestamp;
+				query_pool_create_info.queryCount = 2;
+
+				m_query_pool = m_device_ptr->get_handle().createQueryPoolUnique(query_pool_create_info);
+			}
+		}
+
+		void HiZPyramid::record(CommandBuffer& command_buffer)
+		{
+			if (m_has_timestamps)
+			{
+				command_buffer.reset_query_pool(m_query_pool.get(), 0, 2);
+				command_buffer.write_timestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_query_pool.get(), 0);
+			}
+
+			const auto depth_subresource_range = Image::build_single_layer_subresource(utils::format_to_aspect_mask(m_depth_image_ptr->get_format()));
+			command_buffer.barrier_graphics_write_depth_attachment_compute_read(*m_depth_image_ptr, depth_subresource_range);
+
+			// Every level is overwritten, so the previous contents can be discarded. This also orders this frame's writes
+			// after any compute shader that read the pyramid during the previous frame.
+			command_buffer.barrier_compute_read_storage_image_compute_overwrite_storage_image(*m_image, Image::build_multiple_layer_subresource(0, 1, 0, m_level_count));
+
+			command_buffer.bind_pipeline(m_init_pipeline);
+			command_buffer.bind_descriptor_sets(m_init_pipeline, 0, { m_init_descriptor_set });
+			if (m_sample_count > 1)
+			{
+				command_buffer.update_push_constant_ranges(m_init_pipeline, "sample_count", static_cast<int32_t>(m_sample_count));
+			}
+			command_buffer.dispatch(get_group_count(m_width), get_group_count(m_height));
+
+			command_buffer.bind_pipeline(m_downsample_pipeline);
+			for (uint32_t level = 1; level < m_level_count; ++level)
+			{
+				// Storage images stay in vk::ImageLayout::eGeneral, so a global memory barrier is enough.
+				command_buffer.barrier_compute_write_storage_buffer_compute_read_storage_buffer();
+				command_buffer.bind_descriptor_sets(m_downsample_pipeline, 0, { m_downsample_descriptor_sets[level - 1] });
+				command_buffer.dispatch(get_group_count(std::max(m_width >> level, 1u)), get_group_count(std::max(m_height >> level, 1u)));
+			}
+
+			// Make the last level visible to subsequent compute passes (i.e. the occlusion culler) and hand the depth
+			// image back to the graphics pipeline.
+			command_buffer.barrier_compute_write_storage_buffer_compute_read_storage_buffer();
+			command_buffer.barrier_compute_read_graphics_write_depth_attachment(*m_depth_image_ptr, depth_subresource_range);
+
+			if (m_has_timestamps)
+			{
+				command_buffer.write_timestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_query_pool.get(), 1);
+			}
+
+			m_has_recorded = true;
+		}
+
+		float HiZPyramid::get_last_gpu_time_ms() const
+		{
+			if (!m_has_timestamps || !m_has_recorded)
+			{
+				return 0.0f;
+			}
+
+			std::array<uint64_t, 2> timestamps;
+			m_device_ptr->get_handle().getQueryPoolResults<uint64_t>(m_query_pool.get(), 
+																	 0, 
+																	 static_cast<uint32_t>(timestamps.size()), 
+																	 timestamps, 
+																	 sizeof(uint64_t), 
+																	 vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+
+			// The timestamp period is the number of nanoseconds per tick.
+			const float nanoseconds = static_cast<float>(timestamps[1] - timestamps[0]) * m_device_ptr->get_physical_device_properties().limits.timestampPeriod;
+
+			return nanoseconds * 1e-6f;
+		}
+
+	} // namespace graphics
+
+} // namespace plume
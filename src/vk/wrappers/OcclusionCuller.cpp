@@ -0,0 +1,269 @@
+/*
+*
+* MIT License
+*
+* Copyright(c) 2017 Michael Walczyk
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files(the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <algorithm>
+
+#include "OcclusionCuller.h"
+#include "DescriptorWriter.h"
+
+namespace plume
+{
+
+	namespace graphics
+	{
+
+		namespace
+		{
+
+			// Must match the bindings and workgroup size in `occlusion_cull.comp`
+			const uint32_t binding_id_objects = 0;
+			const uint32_t binding_id_draws = 1;
+			const uint32_t binding_id_draw_count = 2;
+			const uint32_t binding_id_parameters = 3;
+			const uint32_t binding_id_hiz_pyramid = 4;
+			const uint32_t workgroup_size = 64;
+
+			vk::DeviceSize align_up(vk::DeviceSize value, vk::DeviceSize alignment)
+			{
+				return (value + alignment - 1) / alignment * alignment;
+			}
+
+		} // anonymous
+
+		void OcclusionCuller::DirtyRange::add(size_t first, size_t count)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			if (is_empty())
+			{
+				begin = first;
+				end = first + count;
+			}
+			else
+			{
+				begin = std::min(begin, first);
+				end = std::max(end, first + count);
+			}
+		}
+
+		OcclusionCuller::OcclusionCuller(const Device& device, const std::shared_ptr<ShaderModule>& compute_shader_module, uint32_t max_objects, uint32_t frames_in_flight) :
+			m_device_ptr(&device),
+			m_max_objects(max_objects),
+			m_pipeline(device, compute_shader_module),
+			m_frames(frames_in_flight)
+		{
+			if (max_objects == 0 || frames_in_flight == 0)
+			{
+				throw std::runtime_error("An occlusion culler must be able to hold at least one object and requires at least one frame-in-flight");
+			}
+
+			// Each frame's regions are bound at an offset, which must respect the device's alignment requirements.
+			const auto& limits = m_device_ptr->get_physical_device_limits();
+			m_object_region_size = align_up(max_objects * sizeof(geom::CullingObject), limits.minStorageBufferOffsetAlignment);
+			m_parameters_region_size = align_up(sizeof(geom::OcclusionCullingParameters), limits.minUniformBufferOffsetAlignment);
+
+			m_object_buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eStorageBuffer, frames_in_flight * m_object_region_size);
+			m_draw_buffer = std::make_unique<Buffer>(*m_device_ptr, 
+													 vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst, 
+													 max_objects * sizeof(vk::DrawIndexedIndirectCommand));
+			m_draw_count_buffer = std::make_unique<Buffer>(*m_device_ptr, 
+														   vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst, 
+														   sizeof(uint32_t));
+			m_parameters_buffer = std::make_unique<Buffer>(*m_device_ptr, vk::BufferUsageFlagBits::eUniformBuffer, frames_in_flight * m_parameters_region_size);
+
+			// The sets are allocated once and live for as long as the culler: only the pyramid binding changes afterwards.
+			m_descriptor_allocator = DescriptorAllocator::create(*m_device_ptr, 1, frames_in_flight);
+
+			DescriptorWriter descriptor_writer{ *m_device_ptr };
+			for (uint32_t frame_index = 0; frame_index < frames_in_flight; ++frame_index)
+			{
+				auto& frame = m_frames[frame_index];
+				frame.descriptor_set = m_descriptor_allocator->allocate(m_pipeline.get_descriptor_set_layout(0), m_pipeline.get_descriptor_set_layout_bindings(0));
+
+				descriptor_writer.write_ssbo(frame.descriptor_set, binding_id_objects, *m_object_buffer, get_object_region_offset(frame_index), max_objects * sizeof(geom::CullingObject))
+								 .write_ssbo(frame.descriptor_set, binding_id_draws, *m_draw_buffer)
+								 .write_ssbo(frame.descriptor_set, binding_id_draw_count, *m_draw_count_buffer)
+								 .write_ubo(frame.descriptor_set, binding_id_parameters, *m_parameters_buffer, get_parameters_region_offset(frame_index), sizeof(geom::OcclusionCullingParameters));
+			}
+			descriptor_writer.flush();
+		}
+
+		void OcclusionCuller::begin_frame(uint32_t frame_index)
+		{
+			if (frame_index >= get_frames_in_flight())
+			{
+				throw std::runtime_error("The frame index passed to `begin_frame()` is greater than or equal to the number of frames-in-flight");
+			}
+
+			m_current_frame_index = frame_index;
+
+			// Bring this frame's region up-to-date with every object that was set while it was in-flight.
+			auto& frame = m_frames[frame_index];
+			if (!frame.objects.is_empty())
+			{
+				const size_t end = std::min(frame.objects.end, m_objects.size());
+				if (frame.objects.begin < end)
+				{
+					m_object_buffer->upload_immediately(m_objects.data() + frame.objects.begin, 
+														(end - frame.objects.begin) * sizeof(geom::CullingObject), 
+														get_object_region_offset(frame_index) + frame.objects.begin * sizeof(geom::CullingObject));
+				}
+				frame.objects = DirtyRange{};
+			}
+		}
+
+		void OcclusionCuller::set_objects(const std::vector<geom::CullingObject>& objects)
+		{
+			if (objects.size() > m_max_objects)
+			{
+				throw std::runtime_error("The number of objects passed to `set_objects()` exceeds the capacity of the occlusion culler");
+			}
+
+			m_objects = objects;
+			m_object_count = static_cast<uint32_t>(objects.size());
+			commit_objects(0, m_objects.size());
+		}
+
+		void OcclusionCuller::set_object(uint32_t index, const geom::CullingObject& object)
+		{
+			if (index >= m_object_count)
+			{
+				throw std::runtime_error("The index passed to `set_object()` is greater than or equal to the number of objects");
+			}
+
+			m_objects[index] = object;
+			commit_objects(index, 1);
+		}
+
+		void OcclusionCuller::update(const geom::OcclusionCullingParameters& parameters)
+		{
+			m_parameters_buffer->upload_immediately(&parameters, sizeof(geom::OcclusionCullingParameters), get_parameters_region_offset(m_current_frame_index));
+		}
+
+		void OcclusionCuller::set_hiz_pyramid(const ImageView& image_view, const Sampler& sampler, vk::ImageLayout image_layout)
+		{
+			DescriptorWriter descriptor_writer{ *m_device_ptr };
+			for (const auto& frame : m_frames)
+			{
+				descriptor_writer.write_cis(frame.descriptor_set, binding_id_hiz_pyramid, image_view, sampler, image_layout);
+			}
+			descriptor_writer.flush();
+
+			m_has_hiz_pyramid = true;
+		}
+
+		void OcclusionCuller::record(CommandBuffer& command_buffer) const
+		{
+			if (!m_has_hiz_pyramid)
+			{
+				throw std::runtime_error("Must call `set_hiz_pyramid()` before recording the occlusion culling pass");
+			}
+
+			// The previous frame's draws read both buffers as indirect buffers, so they must finish before the clears below.
+			command_buffer.barrier_graphics_read_as_draw_indirect_transfer_write();
+
+			// When the draw count can't be read on the device, `draw()` issues every command in the buffer. Empty commands 
+			// (zero indices and zero instances) are valid no-ops, so the tail past the visible objects is cleared.
+			if (!uses_draw_indirect_count(command_buffer))
+			{
+				command_buffer.fill_buffer(*m_draw_buffer, 0);
+			}
+			command_buffer.fill_buffer(*m_draw_count_buffer, 0);
+			command_buffer.barrier_transfer_write_compute_read_write_storage_buffer();
+
+			if (m_object_count > 0)
+			{
+				command_buffer.bind_pipeline(m_pipeline);
+				command_buffer.bind_descriptor_sets(m_pipeline, 0, { m_frames[m_current_frame_index].descriptor_set });
+				command_buffer.update_push_constant_ranges(m_pipeline, "object_count", m_object_count);
+				command_buffer.dispatch((m_object_count + workgroup_size - 1) / workgroup_size);
+			}
+
+			command_buffer.barrier_compute_write_storage_buffer_graphics_read_as_draw_indirect();
+		}
+
+		void OcclusionCuller::draw(CommandBuffer& command_buffer) const
+		{
+			if (m_object_count == 0)
+			{
+				return;
+			}
+
+			if (uses_draw_indirect_count(command_buffer))
+			{
+				command_buffer.draw_indexed_indirect_count(*m_draw_buffer, *m_draw_count_buffer, m_object_count);
+				return;
+			}
+
+			// Otherwise, issue every command in batches that respect the device limit (which is one without the multi-draw 
+			// indirect feature).
+			const uint32_t max_draw_count = std::max(m_device_ptr->get_physical_device_limits().maxDrawIndirectCount, 1u);
+			for (uint32_t first = 0; first < m_object_count; first += max_draw_count)
+			{
+				const uint32_t draw_count = std::min(max_draw_count, m_object_count - first);
+				command_buffer.draw_indexed_indirect(*m_draw_buffer, draw_count, first * sizeof(vk::DrawIndexedIndirectCommand));
+			}
+		}
+
+		bool OcclusionCuller::uses_draw_indirect_count(const CommandBuffer& command_buffer) const
+		{
+			return command_buffer.supports_draw_indirect_count() && m_object_count <= m_device_ptr->get_physical_device_limits().maxDrawIndirectCount;
+		}
+
+		uint32_t OcclusionCuller::read_draw_count() const
+		{
+			uint32_t draw_count = 0;
+			m_draw_count_buffer->read_immediately([&](const void* mapped_ptr) { memcpy(&draw_count, mapped_ptr, sizeof(uint32_t)); }, sizeof(uint32_t));
+
+			return draw_count;
+		}
+
+		void OcclusionCuller::commit_objects(size_t first_object, size_t object_count)
+		{
+			if (object_count == 0)
+			{
+				return;
+			}
+
+			m_object_buffer->upload_immediately(m_objects.data() + first_object, 
+												object_count * sizeof(geom::CullingObject), 
+												get_object_region_offset(m_current_frame_index) + first_object * sizeof(geom::CullingObject));
+
+			for (uint32_t frame_index = 0; frame_index < get_frames_in_flight(); ++frame_index)
+			{
+				if (frame_index != m_current_frame_index)
+				{
+					m_frames[frame_index].objects.add(first_object, object_count);
+				}
+			}
+		}
+
+	} // namespace graphics
+
+} // namespace plume
@@ -25,6 +25,7 @@
 */
 
 #include "Pipeline.h"
+#include "Utils.h"
 
 namespace plume
 {
@@ -111,13 +112,43 @@ namespace plume
 			}
 		}
 
-		void Pipeline::build_descriptor_set_layouts()
+		void Pipeline::build_descriptor_set_layouts(const std::map<uint32_t, vk::DescriptorSetLayout>& external_descriptor_set_layouts,
+												   const std::set<uint32_t>& push_descriptor_sets)
 		{
+			// A push descriptor set layout can't be inferred from reflection, since it needs a special creation flag.
+			for (auto set : push_descriptor_sets)
+			{
+				if (external_descriptor_set_layouts.find(set) == external_descriptor_set_layouts.end())
+				{
+					throw std::runtime_error("Descriptor set #" + std::to_string(set) + " is marked as a push descriptor set, but no explicit descriptor set layout was provided for it");
+				}
+			}
+			m_push_descriptor_sets = push_descriptor_sets;
+
+			// Externally owned layouts take precedence over anything found during reflection.
+			for (const auto& mapping : external_descriptor_set_layouts)
+			{
+				m_descriptor_set_layouts_mapping.insert(mapping);
+			}
+
 			// Iterate through the map of descriptors, which maps descriptor set IDs (i.e. 0, 1, 2) to
 			// a list of descriptors (i.e. uniform buffers, samplers), and create a descriptor set layout
 			// for each set.
 			for (const auto& mapping : m_descriptors_mapping)
 			{
+				if (external_descriptor_set_layouts.find(mapping.first) != external_descriptor_set_layouts.end())
+				{
+					continue;
+				}
+
+				for (const auto& descriptor_set_layout_binding : mapping.second)
+				{
+					if (descriptor_set_layout_binding.descriptorCount == 0)
+					{
+						throw std::runtime_error("Descriptor set #" + std::to_string(mapping.first) + " contains an unsized array: an explicit descriptor set layout must be provided for this set");
+					}
+				}
+
 				vk::DescriptorSetLayoutCreateInfo descriptor_set_layout_create_info;
 				descriptor_set_layout_create_info.bindingCount = static_cast<uint32_t>(mapping.second.size());
 				descriptor_set_layout_create_info.pBindings = mapping.second.data();
@@ -234,6 +265,9 @@ namespace plume
 			m_viewports = { 0.0f, 0.0f, 640.0f, 480.0f, 0.0f, 1.0f };
 			m_scissors = { { 0, 0 }, { 640, 480 } };
 
+			// Write all color components by default.
+			m_color_write_mask = default_color_blend_attachment.colorWriteMask;
+
 			// Set the default subpass index.
 			m_subpass_index = 0;
 		}
@@ -263,6 +297,57 @@ namespace plume
 				throw std::runtime_error("At least one vertex shader stage is required to build a graphics pipeline");
 			}
 
+			// Every input of the vertex shader must be fed by one of the vertex input attributes (for example, those built
+			// from a geom::VertexLayout). Extra attributes are allowed and simply ignored by the shader. The attribute's format
+			// must be read as the same numeric type as the input. Its component count may differ: extra components are discarded
+			// and missing ones are filled with (0, 0, 1), so a format with fewer components is only reported as a debug message.
+			for (const auto& stage : options.m_shader_stages)
+			{
+				if (stage->get_stage() != vk::ShaderStageFlagBits::eVertex)
+				{
+					continue;
+				}
+
+				for (const auto& input : stage->get_stage_inputs())
+				{
+					auto it = std::find_if(options.m_vertex_input_attribute_descriptions.begin(),
+										   options.m_vertex_input_attribute_descriptions.end(),
+										   [&](const auto& attribute) { return attribute.location == input.layout_location; });
+
+					if (it == options.m_vertex_input_attribute_descriptions.end())
+					{
+						throw std::runtime_error("The vertex shader input `" + input.name + "` at location " + std::to_string(input.layout_location) + 
+												 " is not provided by any of the pipeline's vertex input attribute descriptions");
+					}
+
+					const uint32_t format_component_count = utils::get_format_component_count(it->format);
+					if (format_component_count != 0 && format_component_count < input.component_count)
+					{
+						PL_LOG_DEBUG("The vertex shader input `%s` at location %u has %u components, but its vertex input attribute's format only has %u: the rest will be filled with defaults\n", 
+									 input.name.c_str(), input.layout_location, input.component_count, format_component_count);
+					}
+
+					utils::FormatNumericType expected_numeric_type;
+					switch (input.base_type)
+					{
+					case spirv_cross::SPIRType::Float: expected_numeric_type = utils::FormatNumericType::FLOAT; break;
+					case spirv_cross::SPIRType::Int: expected_numeric_type = utils::FormatNumericType::SINT; break;
+					case spirv_cross::SPIRType::UInt: expected_numeric_type = utils::FormatNumericType::UINT; break;
+					default: expected_numeric_type = utils::FormatNumericType::UNKNOWN; break;
+					}
+
+					const utils::FormatNumericType format_numeric_type = utils::get_format_numeric_type(it->format);
+					if (expected_numeric_type != utils::FormatNumericType::UNKNOWN && 
+						format_numeric_type != utils::FormatNumericType::UNKNOWN && 
+						format_numeric_type != expected_numeric_type)
+					{
+						throw std::runtime_error("The vertex shader input `" + input.name + "` at location " + std::to_string(input.layout_location) + 
+												 " does not have the same numeric type (float, signed, or unsigned integer) as its vertex input attribute's format " + 
+												 vk::to_string(it->format));
+					}
+				}
+			}
+
 			if (options.m_input_assembly_state_create_info.topology == vk::PrimitiveTopology::ePatchList &&
 				!(m_shader_stage_active_mapping.at(vk::ShaderStageFlagBits::eTessellationControl) &&
 					m_shader_stage_active_mapping.at(vk::ShaderStageFlagBits::eTessellationEvaluation)))	// TODO: are tessellation evaluation shaders optional?
@@ -275,6 +360,13 @@ namespace plume
 			dynamic_state_create_info.dynamicStateCount = static_cast<uint32_t>(options.m_dynamic_states.size());
 			dynamic_state_create_info.pDynamicStates = options.m_dynamic_states.data();
 
+			// Apply the color write mask to a copy of the blend state, so that the (shared) default attachment state isn't modified.
+			vk::PipelineColorBlendAttachmentState color_blend_attachment_state = *options.m_color_blend_state_create_info.pAttachments;
+			color_blend_attachment_state.colorWriteMask = options.m_color_write_mask;
+
+			vk::PipelineColorBlendStateCreateInfo color_blend_state_create_info = options.m_color_blend_state_create_info;
+			color_blend_state_create_info.pAttachments = &color_blend_attachment_state;
+
 			vk::PipelineVertexInputStateCreateInfo vertex_input_state_create_info;
 			vertex_input_state_create_info.pVertexAttributeDescriptions = options.m_vertex_input_attribute_descriptions.data();
 			vertex_input_state_create_info.pVertexBindingDescriptions = options.m_vertex_input_binding_descriptions.data();
@@ -287,9 +379,8 @@ namespace plume
 			viewport_state_create_info.scissorCount = static_cast<uint32_t>(options.m_scissors.size());
 			viewport_state_create_info.viewportCount = static_cast<uint32_t>(options.m_viewports.size());
 
-			// TODO: there should be another constructor that takes a vector of descriptor set layouts as a parameter.
-			bool infer_layouts = true;
-			if (infer_layouts) build_descriptor_set_layouts();
+			// Infer any descriptor set layouts that weren't explicitly provided.
+			build_descriptor_set_layouts(options.m_descriptor_set_layouts, options.m_push_descriptor_sets);
 
 			// Get all of the values in the push constant ranges map. 
 			std::vector<vk::PushConstantRange> push_constant_ranges;
@@ -317,7 +408,7 @@ namespace plume
 			graphics_pipeline_create_info.basePipelineHandle = vk::Pipeline{};
 			graphics_pipeline_create_info.basePipelineIndex = -1;
 			graphics_pipeline_create_info.layout = m_pipeline_layout_handle.get();
-			graphics_pipeline_create_info.pColorBlendState = &options.m_color_blend_state_create_info;
+			graphics_pipeline_create_info.pColorBlendState = &color_blend_state_create_info;
 			graphics_pipeline_create_info.pDepthStencilState = &options.m_depth_stencil_state_create_info;
 			graphics_pipeline_create_info.pDynamicState = (dynamic_state_create_info.dynamicStateCount > 0) ? &dynamic_state_create_info : nullptr;
 			graphics_pipeline_create_info.pInputAssemblyState = &options.m_input_assembly_state_create_info;
@@ -334,7 +425,10 @@ namespace plume
 			m_pipeline_handle = m_device_ptr->get_handle().createGraphicsPipelineUnique({}, graphics_pipeline_create_info);
 		}
 
-		ComputePipeline::ComputePipeline(const Device& device, const std::shared_ptr<ShaderModule>& compute_shader_module) :
+		ComputePipeline::ComputePipeline(const Device& device, 
+										 const std::shared_ptr<ShaderModule>& compute_shader_module, 
+										 const std::map<uint32_t, vk::DescriptorSetLayout>& external_descriptor_set_layouts,
+										 const std::set<uint32_t>& push_descriptor_sets) :
 
 			Pipeline(device)
 		{
@@ -342,9 +436,8 @@ namespace plume
 			add_push_constants_to_global_map(compute_shader_module);
 			add_descriptors_to_global_map(compute_shader_module);
 
-			// TODO: there should be another constructor that takes a vector of descriptor set layouts as a parameter.
-			bool infer_layouts = true;
-			if (infer_layouts) build_descriptor_set_layouts();
+			// Infer any descriptor set layouts that weren't explicitly provided.
+			build_descriptor_set_layouts(external_descriptor_set_layouts, push_descriptor_sets);
 
 			// Get all of the values in the push constant ranges map. 
 			std::vector<vk::PushConstantRange> push_constant_ranges;
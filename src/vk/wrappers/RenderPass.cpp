@@ -105,7 +105,7 @@ namespace plume
 			m_attachment_mapping.insert({ name, attachment_description });
 		}
 
-		void RenderPassBuilder::add_depth_stencil_attachment(const std::string& name, vk::Format format, uint32_t sample_count)
+		void RenderPassBuilder::add_depth_stencil_attachment(const std::string& name, vk::Format format, uint32_t sample_count, vk::AttachmentStoreOp store_op)
 		{
 			check_attachment_name_unique(name);
 
@@ -122,7 +122,7 @@ namespace plume
 			attachment_description.samples = utils::sample_count_to_flags(sample_count);
 			attachment_description.stencilLoadOp = utils::is_stencil_format(format) ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eDontCare;
 			attachment_description.stencilStoreOp = utils::is_stencil_format(format) ? vk::AttachmentStoreOp::eStore : vk::AttachmentStoreOp::eDontCare;
-			attachment_description.storeOp = vk::AttachmentStoreOp::eDontCare;
+			attachment_description.storeOp = store_op;
 
 			// Add to global map of string names to attachment descriptions.
 			m_attachment_mapping.insert({ name, attachment_description });
@@ -184,6 +184,8 @@ namespace plume
 				input.layout_location = compiler_glsl.get_decoration(resource.id, spv::Decoration::DecorationLocation);
 				input.name = resource.name;
 				input.size = get_size_from_type(type, type.vecsize, 1);
+				input.component_count = type.vecsize;
+				input.base_type = type.basetype;
 
 				//std::cout << "Stage input - location: " << input.layout_location << ", name: " << input.name << ", size: " << input.size << " (rows: " << type.vecsize << ", cols: " << type.columns << ")\n";
 				m_stage_inputs.emplace_back(input);
@@ -246,12 +248,35 @@ namespace plume
 
 		void ShaderModule::resource_to_descriptor(const spirv_cross::CompilerGLSL& compiler, const spirv_cross::Resource& resource, vk::DescriptorType descriptor_type)
 		{
-			// TODO: parse the descriptor count (array size)
 			auto full_type = compiler.get_type(resource.type_id);
 
+			// Arrays of descriptors consume one descriptor per element: multi-dimensional arrays are flattened. An array
+			// dimension of zero denotes a runtime (unsized) array, whose size must be provided by the application.
+			uint32_t descriptor_count = 1;
+			bool is_unsized_array = false;
+			for (size_t i = 0; i < full_type.array.size(); ++i)
+			{
+				uint32_t dimension = full_type.array[i];
+
+				// The array size might be a specialization constant, in which case `dimension` is the ID of that constant.
+				if (!full_type.array_size_literal[i])
+				{
+					dimension = compiler.get_constant(dimension).scalar();
+				}
+
+				if (dimension == 0)
+				{
+					is_unsized_array = true;
+				}
+				else
+				{
+					descriptor_count *= dimension;
+				}
+			}
+
 			vk::DescriptorSetLayoutBinding descriptor_set_layout_binding;
 			descriptor_set_layout_binding.binding = compiler.get_decoration(resource.id, spv::Decoration::DecorationBinding);
-			descriptor_set_layout_binding.descriptorCount = 1;
+			descriptor_set_layout_binding.descriptorCount = is_unsized_array ? 0 : descriptor_count;
 			descriptor_set_layout_binding.descriptorType = descriptor_type;
 			descriptor_set_layout_binding.pImmutableSamplers = nullptr;
 			descriptor_set_layout_binding.stageFlags = vk::ShaderStageFlagBits::eAll; // TODO: for now, use `all` to prevent error messages - should be: m_shader_stage;
@@ -260,6 +285,7 @@ namespace plume
 			descriptor.layout_set = compiler.get_decoration(resource.id, spv::Decoration::DecorationDescriptorSet);
 			descriptor.name = resource.name;
 			descriptor.layout_binding = descriptor_set_layout_binding;
+			descriptor.is_unsized_array = is_unsized_array;
 
 			m_descriptors.push_back(descriptor);
 		}